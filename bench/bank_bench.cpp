@@ -0,0 +1,1145 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AllocationTracker.hpp"
+#include "AsyncBankService.hpp"
+#include "BankService.hpp"
+#include "Database.hpp"
+#include "LogLedgerStore.hpp"
+#include "MemoryLedgerStore.hpp"
+#include "Logger.hpp"
+#include "Metrics.hpp"
+#include "PostgresLedgerStore.hpp"
+#include "ShardedLedger.hpp"
+#include "SlowQueryLog.hpp"
+#include "Trace.hpp"
+#include "User.hpp"
+
+#ifdef BANK_HAVE_CORO
+#include "CoroBankService.hpp"
+#endif
+
+#ifndef BANK_VERSION
+#define BANK_VERSION "unknown"
+#endif
+
+// End-to-end load generator: seeds a population with COPY, then drives a
+// mix of operations through BankService from several threads and reports
+// throughput and latency percentiles as JSON. With --memory the same mix
+// runs against a MemoryLedgerStore, which isolates the service layer, and
+// with --data-dir against the embedded LogLedgerStore. With --sharded the
+// money movements go through a ShardedLedger instead of BankService, and
+// --async and --thread-per-request compare two ways of keeping many calls
+// in flight; --coro keeps them in flight from coroutines on each thread.
+
+namespace {
+
+struct BenchOptions {
+    int users = 1000;
+    int accountsPerUser = 2;
+    int transactionsPerAccount = 20;
+    double zipf = 1.1;              // Account popularity skew; 0 is uniform
+    int threads = 4;
+    double warmupSeconds = 2.0;
+    double durationSeconds = 10.0;
+    int mix[4] = {40, 20, 30, 10};  // deposit, withdraw, transfer, history
+    bool seed = true;
+    bool reset = false;
+    bool seedOnly = false;
+    bool memory = false;            // MemoryLedgerStore instead of the database
+    std::string dataDir;            // LogLedgerStore instead of the database
+    int shards = 0;                 // ShardedLedger with this many shards instead of BankService
+    int inflight = 32;              // Calls each thread keeps outstanding with --sharded/--async/...
+    int asyncWorkers = 0;           // AsyncBankService with this many workers (-1: one per core)
+    bool threadPerRequest = false;  // A std::async thread per call, on the same number of connections
+    int coroConnections = 0;        // CoroBankService with this many connections per thread
+    std::string outputPath;
+    std::string metricsPath;        // Prometheus text of the measured services, written at the end
+    std::string tracePath;          // Chrome trace of the measured run, written at the end
+    double slowQueryMillis = 0.0;   // Log and EXPLAIN measured statements at least this slow
+    std::string logPath;            // Audit log of the measured services
+    unsigned int randomSeed = 42;
+};
+
+enum Operation { Deposit, Withdraw, Transfer, History, OperationCount };
+
+const char* kOperationNames[OperationCount] = {"deposit", "withdraw", "transfer", "history"};
+
+/**
+ * @brief Draws account ranks 0..n-1 with P(rank k) proportional to 1 / (k + 1)^s
+ */
+class ZipfSampler {
+public:
+    ZipfSampler(std::size_t n, double s)
+        : m_cdf(n)
+    {
+        double sum = 0.0;
+        for (std::size_t k = 0; k < n; ++k) {
+            sum += 1.0 / std::pow(static_cast<double>(k + 1), s);
+            m_cdf[k] = sum;
+        }
+        for (auto& value : m_cdf) {
+            value /= sum;
+        }
+    }
+
+    template <typename Rng>
+    std::size_t operator()(Rng& rng) const {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        auto it = std::lower_bound(m_cdf.begin(), m_cdf.end(), u);
+        return it == m_cdf.end() ? m_cdf.size() - 1 : static_cast<std::size_t>(it - m_cdf.begin());
+    }
+
+private:
+    std::vector<double> m_cdf;
+};
+
+struct Percentiles {
+    std::size_t count = 0;
+    double p50 = 0.0;
+    double p99 = 0.0;
+    double p999 = 0.0;
+    double max = 0.0;
+};
+
+Percentiles percentiles(std::vector<double> samples) {
+    Percentiles result;
+    result.count = samples.size();
+    if (samples.empty()) {
+        return result;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto at = [&samples](double p) {
+        std::size_t rank = static_cast<std::size_t>(std::ceil(p / 100.0 * samples.size()));
+        return samples[std::min(samples.size() - 1, rank > 0 ? rank - 1 : 0)];
+    };
+    result.p50 = at(50.0);
+    result.p99 = at(99.0);
+    result.p999 = at(99.9);
+    result.max = samples.back();
+    return result;
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+std::string accountNumber(int accountId) {
+    std::ostringstream ss;
+    ss << "BEN" << std::setw(10) << std::setfill('0') << accountId;
+    return ss.str();
+}
+
+std::string cents(long long amount) {
+    std::ostringstream ss;
+    ss << amount / 100 << "." << std::setw(2) << std::setfill('0') << amount % 100;
+    return ss.str();
+}
+
+/**
+ * @brief Load users, accounts and transactions with COPY into empty tables
+ */
+bool seedPopulation(bank::Database& db, const BenchOptions& options, double& seconds) {
+    auto start = std::chrono::steady_clock::now();
+
+    auto counts = db.query("SELECT (SELECT COUNT(*) FROM users) + (SELECT COUNT(*) FROM accounts)");
+    if (counts.empty()) {
+        return false;
+    }
+    if (counts[0][0] != "0" && !options.reset) {
+        std::cerr << "Error: Database is not empty; pass --reset to wipe it or --no-seed to reuse it\n";
+        return false;
+    }
+    if (options.reset && 
+        !db.execute("TRUNCATE transactions, accounts, users RESTART IDENTITY CASCADE")) 
+    {
+        return false;
+    }
+
+    constexpr std::size_t kFlushBytes = 8 << 20;
+    std::mt19937 rng(options.randomSeed);
+    std::string passwordHash = bank::User::hashPassword("bench123");
+    std::string data;
+
+    if (!db.beginTransaction()) {
+        return false;
+    }
+
+    for (int userId = 1; userId <= options.users; ++userId) {
+        std::string name = "bench" + std::to_string(userId);
+        data += std::to_string(userId) + "\t" + name + "\t" + passwordHash + "\tBench User " +
+                std::to_string(userId) + "\t" + name + "@bench.invalid\t\\N\n";
+        if (data.size() >= kFlushBytes || userId == options.users) {
+            if (!db.copyIn("users", "user_id, username, password_hash, full_name, email, phone", data)) {
+                db.rollbackTransaction();
+                return false;
+            }
+            data.clear();
+        }
+    }
+
+    // Transactions are written in the same pass so every balance_after adds up
+    std::string transactions;
+    std::uniform_int_distribution<long long> amountCents(100, 50000);
+    const char* types[] = {"savings", "checking"};
+    int accountCount = options.users * options.accountsPerUser;
+    for (int accountId = 1; accountId <= accountCount; ++accountId) {
+        int userId = (accountId - 1) / options.accountsPerUser + 1;
+        long long balance = 0;
+        for (int i = 0; i < options.transactionsPerAccount; ++i) {
+            long long amount = amountCents(rng);
+            balance += amount;
+            // Spread the history over the past year, oldest first
+            int secondsAgo = 365 * 86400 - (i + 1) * (365 * 86400 / (options.transactionsPerAccount + 1));
+            transactions += std::to_string(accountId) + "\tdeposit\t" + cents(amount) + "\t" + 
+                            cents(balance) + "\tSeed deposit\t" +
+                            "\\N\t" + std::to_string(secondsAgo) + "\n";
+        }
+        data += std::to_string(accountId) + "\t" + std::to_string(userId) + "\t" + 
+                accountNumber(accountId) + "\t" + types[accountId % 2] + "\t" + cents(balance) + 
+                "\t0.00\tactive\n";
+
+        bool last = accountId == accountCount;
+        if (data.size() >= kFlushBytes || last) {
+            if (!db.copyIn("accounts", "account_id, user_id, account_number, account_type, "
+                           "balance, interest_rate, status", data)) 
+            {
+                db.rollbackTransaction();
+                return false;
+            }
+            data.clear();
+        }
+        if (transactions.size() >= kFlushBytes || last) {
+            // created_at is loaded as seconds ago into a staging column below
+            if (!transactions.empty() && 
+                !db.copyIn("bench_seed_transactions", "account_id, transaction_type, amount, "
+                           "balance_after, description, related_account_id, seconds_ago", transactions)) 
+            {
+                db.rollbackTransaction();
+                return false;
+            }
+            transactions.clear();
+        }
+    }
+
+    bool ok = db.execute(
+            "INSERT INTO transactions (account_id, transaction_type, amount, balance_after, "
+            "description, related_account_id, created_at) "
+            "SELECT account_id, transaction_type, amount, balance_after, description, "
+            "related_account_id, CURRENT_TIMESTAMP - make_interval(secs => seconds_ago) "
+            "FROM bench_seed_transactions ORDER BY account_id, seconds_ago DESC") &&
+        db.execute("SELECT setval('users_user_id_seq', (SELECT MAX(user_id) FROM users))") &&
+        db.execute("SELECT setval('accounts_account_id_seq', (SELECT MAX(account_id) FROM accounts))") &&
+        db.commitTransaction() &&
+        db.execute("ANALYZE users") && db.execute("ANALYZE accounts") && db.execute("ANALYZE transactions");
+    if (!ok) {
+        db.rollbackTransaction();
+        return false;
+    }
+
+    seconds = secondsSince(start);
+    return true;
+}
+
+/**
+ * @brief Build the same population as seedPopulation() in an empty store
+ *
+ * Work is committed every kSeedScope accounts, so a logging store writes
+ * few large frames instead of one per row.
+ */
+bool seedStore(bank::LedgerStore& store, const BenchOptions& options, double& seconds) {
+    constexpr int kSeedScope = 1000;
+    auto start = std::chrono::steady_clock::now();
+    if (store.findUserById(1).has_value()) {
+        std::cerr << "Error: Store is not empty; use a new --data-dir or --no-seed to reuse it\n";
+        return false;
+    }
+    std::mt19937 rng(options.randomSeed);
+    std::string passwordHash = bank::User::hashPassword("bench123");
+    std::uniform_int_distribution<long long> amountCents(100, 50000);
+
+    if (!store.begin()) {
+        return false;
+    }
+    for (int userId = 1; userId <= options.users; ++userId) {
+        std::string name = "bench" + std::to_string(userId);
+        bank::User user(-1, name, passwordHash, "Bench User " + std::to_string(userId), 
+                        name + "@bench.invalid", "");
+        if (!store.insertUser(user).has_value()) {
+            store.rollback();
+            return false;
+        }
+    }
+
+    int accountCount = options.users * options.accountsPerUser;
+    for (int accountId = 1; accountId <= accountCount; ++accountId) {
+        if (accountId % kSeedScope == 0 && !(store.commit() && store.begin())) {
+            return false;
+        }
+        int userId = (accountId - 1) / options.accountsPerUser + 1;
+        bank::Account account(-1, userId, accountNumber(accountId), 
+                              accountId % 2 ? bank::AccountType::Checking : bank::AccountType::Savings,
+                              0.0, 0.0, bank::AccountStatus::Active);
+        if (!store.insertAccount(account).has_value()) {
+            store.rollback();
+            return false;
+        }
+
+        // History timestamps are "now"; only the balance chart would notice
+        for (int i = 0; i < options.transactionsPerAccount; ++i) {
+            double amount = amountCents(rng) / 100.0;
+            auto balance = store.adjustBalance(accountId, amount);
+            bank::Transaction transaction;
+            transaction.setAccountId(accountId);
+            transaction.setType(bank::TransactionType::Deposit);
+            transaction.setAmount(amount);
+            transaction.setBalanceAfter(balance.value_or(0.0));
+            transaction.setDescription("Seed deposit");
+            if (!balance.has_value() || !store.appendTransaction(transaction)) {
+                store.rollback();
+                return false;
+            }
+        }
+    }
+    if (!store.commit()) {
+        return false;
+    }
+
+    seconds = secondsSince(start);
+    return true;
+}
+
+struct WorkerResult {
+    std::vector<double> latencies[OperationCount];
+    std::size_t failed[OperationCount] = {};
+    bool countedAllocations = false;    // Only calls made on the client thread can be counted
+    std::uint64_t allocations[OperationCount] = {};
+    std::uint64_t allocatedBytes[OperationCount] = {};
+};
+
+/**
+ * @brief Run one operation of the mix; target is only used by transfers
+ */
+bool perform(bank::BankService& service, Operation operation, int account, int target, double amount) {
+    switch (operation) {
+        case Deposit:
+            return service.deposit(account, amount, "Bench deposit");
+        case Withdraw:
+            return service.withdraw(account, amount, "Bench withdrawal");
+        case Transfer:
+            return target != account && service.transfer(account, target, amount, "Bench transfer");
+        case History:
+            service.getTransactionHistory(account, 50);
+            return true;
+        case OperationCount:
+            break;
+    }
+    return true;
+}
+
+/**
+ * @brief Pick a transfer target different from the source where possible
+ */
+int pickTarget(const ZipfSampler& zipf, const std::vector<int>& accountByRank, int account, std::mt19937_64& rng) {
+    int target = accountByRank[zipf(rng)];
+    if (target == account) {
+        target = accountByRank[(zipf(rng) + 1) % accountByRank.size()];
+    }
+    return target;
+}
+
+void runWorker(bank::BankService& service, const BenchOptions& options, 
+               const ZipfSampler& zipf, const std::vector<int>& accountByRank, unsigned int seed,
+               std::chrono::steady_clock::time_point measureFrom, 
+               std::chrono::steady_clock::time_point stopAt, WorkerResult& result)
+{
+    std::mt19937_64 rng(seed);
+    std::discrete_distribution<int> pickOperation(std::begin(options.mix), std::end(options.mix));
+    std::uniform_int_distribution<int> amountCents(100, 20000);
+
+    while (true) {
+        auto start = std::chrono::steady_clock::now();
+        if (start >= stopAt) {
+            break;
+        }
+
+        auto operation = static_cast<Operation>(pickOperation(rng));
+        int account = accountByRank[zipf(rng)];
+        double amount = amountCents(rng) / 100.0;
+        int target = operation == Transfer ? pickTarget(zipf, accountByRank, account, rng) : -1;
+        bank::alloc::Scope allocations;
+        bool ok = perform(service, operation, account, target, amount);
+        bank::alloc::Counts allocated = allocations.elapsed();
+
+        if (start >= measureFrom) {
+            result.latencies[operation].push_back(
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            if (!ok) {
+                ++result.failed[operation];
+            }
+            result.allocations[operation] += allocated.allocations;
+            result.allocatedBytes[operation] += allocated.bytes;
+        }
+    }
+    result.countedAllocations = bank::alloc::kEnabled;
+}
+
+/**
+ * @brief Same mix through a ShardedLedger, with up to options.inflight commands outstanding
+ *
+ * History reads become balance inquiries, the only read the ledger has.
+ */
+void runShardedWorker(bank::ShardedLedger& ledger, const BenchOptions& options,
+                      const ZipfSampler& zipf, const std::vector<int>& accountByRank, unsigned int seed,
+                      std::chrono::steady_clock::time_point measureFrom,
+                      std::chrono::steady_clock::time_point stopAt, WorkerResult& result)
+{
+    std::mt19937_64 rng(seed);
+    std::discrete_distribution<int> pickOperation(std::begin(options.mix), std::end(options.mix));
+    std::uniform_int_distribution<int> amountCents(100, 20000);
+
+    // Completions run on the ledger's threads
+    std::mutex mutex;
+    std::condition_variable slotFree;
+    int outstanding = 0;
+
+    while (true) {
+        auto start = std::chrono::steady_clock::now();
+        if (start >= stopAt) {
+            break;
+        }
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            slotFree.wait(lock, [&]() { return outstanding < options.inflight; });
+            ++outstanding;
+        }
+        start = std::chrono::steady_clock::now();
+
+        auto operation = static_cast<Operation>(pickOperation(rng));
+        int account = accountByRank[zipf(rng)];
+        double amount = amountCents(rng) / 100.0;
+        auto done = [&, operation, start](bool ok, double) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (start >= measureFrom) {
+                result.latencies[operation].push_back(
+                    std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+                if (!ok) {
+                    ++result.failed[operation];
+                }
+            }
+            --outstanding;
+            slotFree.notify_one();
+        };
+        switch (operation) {
+            case Deposit:
+                ledger.deposit(account, amount, "Bench deposit", done);
+                break;
+            case Withdraw:
+                ledger.withdraw(account, amount, "Bench withdrawal", done);
+                break;
+            case Transfer:
+                ledger.transfer(account, pickTarget(zipf, accountByRank, account, rng), amount,
+                                "Bench transfer", done);
+                break;
+            case History:
+            case OperationCount:
+                ledger.inquire(account, done);
+                break;
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    slotFree.wait(lock, [&]() { return outstanding == 0; });
+}
+
+/**
+ * @brief Services handed to one request thread at a time, for --thread-per-request
+ */
+class ServicePool {
+public:
+    void add(std::unique_ptr<bank::BankService> service) {
+        m_idle.push_back(service.get());
+        m_services.push_back(std::move(service));
+    }
+
+    template <typename Call>
+    auto with(Call call) -> decltype(call(std::declval<bank::BankService&>())) {
+        bank::BankService* service;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_available.wait(lock, [this]() { return !m_idle.empty(); });
+            service = m_idle.back();
+            m_idle.pop_back();
+        }
+        auto result = call(*service);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_idle.push_back(service);
+        }
+        m_available.notify_one();
+        return result;
+    }
+
+private:
+    std::vector<std::unique_ptr<bank::BankService>> m_services;
+    std::vector<bank::BankService*> m_idle;
+    std::mutex m_mutex;
+    std::condition_variable m_available;
+};
+
+/**
+ * @brief Starts one operation and returns a way to wait for its outcome
+ */
+using StartCall = std::function<std::function<bool()>(Operation operation, int account, int target, double amount)>;
+
+/**
+ * @brief Same mix with up to options.inflight calls outstanding, each awaited in order
+ */
+void runPipelinedWorker(const StartCall& start, const BenchOptions& options,
+                        const ZipfSampler& zipf, const std::vector<int>& accountByRank, unsigned int seed,
+                        std::chrono::steady_clock::time_point measureFrom,
+                        std::chrono::steady_clock::time_point stopAt, WorkerResult& result)
+{
+    struct Outstanding {
+        Operation operation;
+        std::chrono::steady_clock::time_point start;
+        std::function<bool()> wait;
+    };
+
+    std::mt19937_64 rng(seed);
+    std::discrete_distribution<int> pickOperation(std::begin(options.mix), std::end(options.mix));
+    std::uniform_int_distribution<int> amountCents(100, 20000);
+    std::deque<Outstanding> outstanding;
+
+    auto complete = [&]() {
+        Outstanding call = std::move(outstanding.front());
+        outstanding.pop_front();
+        bool ok = call.wait();
+        if (call.start >= measureFrom) {
+            result.latencies[call.operation].push_back(
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - call.start).count());
+            if (!ok) {
+                ++result.failed[call.operation];
+            }
+        }
+    };
+
+    while (true) {
+        auto now = std::chrono::steady_clock::now();
+        if (now >= stopAt) {
+            break;
+        }
+        if (outstanding.size() >= static_cast<std::size_t>(options.inflight)) {
+            complete();
+            continue;
+        }
+
+        auto operation = static_cast<Operation>(pickOperation(rng));
+        int account = accountByRank[zipf(rng)];
+        int target = operation == Transfer ? pickTarget(zipf, accountByRank, account, rng) : -1;
+        double amount = amountCents(rng) / 100.0;
+        outstanding.push_back({operation, now, start(operation, account, target, amount)});
+    }
+    while (!outstanding.empty()) {
+        complete();
+    }
+}
+
+#ifdef BANK_HAVE_CORO
+/**
+ * @brief One client of runCoroutineWorker: the mix, one call at a time
+ */
+bank::Task<void> runCoroutineClient(bank::CoroBankService& service, const BenchOptions& options,
+                                    const ZipfSampler& zipf, const std::vector<int>& accountByRank,
+                                    unsigned int seed, std::chrono::steady_clock::time_point measureFrom,
+                                    std::chrono::steady_clock::time_point stopAt, WorkerResult& result)
+{
+    std::mt19937_64 rng(seed);
+    std::discrete_distribution<int> pickOperation(std::begin(options.mix), std::end(options.mix));
+    std::uniform_int_distribution<int> amountCents(100, 20000);
+
+    while (true) {
+        auto start = std::chrono::steady_clock::now();
+        if (start >= stopAt) {
+            break;
+        }
+
+        auto operation = static_cast<Operation>(pickOperation(rng));
+        int account = accountByRank[zipf(rng)];
+        double amount = amountCents(rng) / 100.0;
+        bool ok = true;
+        switch (operation) {
+            case Deposit:
+                ok = co_await service.deposit(account, amount, "Bench deposit");
+                break;
+            case Withdraw:
+                ok = co_await service.withdraw(account, amount, "Bench withdrawal");
+                break;
+            case Transfer: {
+                int target = pickTarget(zipf, accountByRank, account, rng);
+                ok = target != account;
+                if (ok) {
+                    ok = co_await service.transfer(account, target, amount, "Bench transfer");
+                }
+                break;
+            }
+            case History:
+            case OperationCount: {
+                auto history = co_await service.getTransactionHistory(account, 50);
+                break;
+            }
+        }
+
+        if (start >= measureFrom) {
+            result.latencies[operation].push_back(
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            if (!ok) {
+                ++result.failed[operation];
+            }
+        }
+    }
+}
+
+bank::Task<void> openCoroutineService(bank::CoroBankService& service, bool& opened) {
+    opened = co_await service.open();
+}
+
+/**
+ * @brief Same mix from options.inflight coroutines sharing this thread's connections
+ */
+void runCoroutineWorker(const bank::CoroBankService::ConnectionFactory& connect, const BenchOptions& options,
+                        const ZipfSampler& zipf, const std::vector<int>& accountByRank, unsigned int seed,
+                        std::chrono::steady_clock::time_point measureFrom,
+                        std::chrono::steady_clock::time_point stopAt, WorkerResult& result)
+{
+    bank::EventLoop loop;
+    bank::CoroBankService service(loop, connect, static_cast<std::size_t>(options.coroConnections));
+    bool opened = false;
+    loop.spawn(openCoroutineService(service, opened));
+    if (!loop.run() || !opened) {
+        std::cerr << "Error: " << service.getLastError() << loop.getLastError() << "\n";
+        return;
+    }
+
+    for (int i = 0; i < options.inflight; ++i) {
+        loop.spawn(runCoroutineClient(service, options, zipf, accountByRank, seed * 1000 + i,
+                                      measureFrom, stopAt, result));
+    }
+    if (!loop.run()) {
+        std::cerr << "Error: " << loop.getLastError() << "\n";
+    }
+}
+#endif
+
+void writeLatency(std::ostream& out, const Percentiles& p) {
+    out << "{\"count\": " << p.count << ", \"p50_ms\": " << p.p50 << ", \"p99_ms\": " << p.p99
+        << ", \"p999_ms\": " << p.p999 << ", \"max_ms\": " << p.max << "}";
+}
+
+void printUsage() {
+    std::cout << "Bank Management Benchmark\n\n";
+    std::cout << "Runs against the database named by DB_HOST, DB_PORT, DB_NAME, DB_USER and\n";
+    std::cout << "DB_PASSWORD. Use a throwaway database: seeding requires empty tables.\n";
+    std::cout << "With --memory or --data-dir no database is used.\n";
+    std::cout << "\nUsage:\n";
+    std::cout << "  ./bank_bench [options]\n";
+    std::cout << "      [--users <n>]                      Seeded users (default: 1000)\n";
+    std::cout << "      [--accounts-per-user <n>]          Accounts per user (default: 2)\n";
+    std::cout << "      [--transactions <n>]               History per account (default: 20)\n";
+    std::cout << "      [--zipf <s>]                       Account popularity skew (default: 1.1)\n";
+    std::cout << "      [--threads <n>]                    Client threads (default: 4)\n";
+    std::cout << "      [--warmup <s>]                     Unmeasured seconds (default: 2)\n";
+    std::cout << "      [--duration <s>]                   Measured seconds (default: 10)\n";
+    std::cout << "      [--mix <d,w,t,h>]                  Deposit, withdraw, transfer and history\n";
+    std::cout << "                                         weights (default: 40,20,30,10)\n";
+    std::cout << "      [--reset]                          Empty the tables before seeding\n";
+    std::cout << "      [--no-seed]                        Reuse the population of an earlier run\n";
+    std::cout << "      [--seed-only]                      Seed and exit\n";
+    std::cout << "      [--memory]                         Use the in-memory ledger store\n";
+    std::cout << "      [--data-dir <dir>]                 Use the embedded log store in <dir>\n";
+    std::cout << "      [--sharded <n>]                    Move money through a ledger with n shards\n";
+    std::cout << "      [--inflight <n>]                   Outstanding calls per thread with --sharded,\n";
+    std::cout << "                                         --async, --thread-per-request or --coro\n";
+    std::cout << "                                         (default: 32)\n";
+    std::cout << "      [--async <n>]                      Call through an AsyncBankService with n\n";
+    std::cout << "                                         workers (0: one per core)\n";
+    std::cout << "      [--thread-per-request <n>]         Start a thread per call, sharing n\n";
+    std::cout << "                                         connections (0: one per core)\n";
+#ifdef BANK_HAVE_CORO
+    std::cout << "      [--coro <n>]                       Call from --inflight coroutines per thread\n";
+    std::cout << "                                         sharing n connections per thread\n";
+#endif
+    std::cout << "      [--output <file>]                  JSON report (default: stdout)\n";
+    std::cout << "      [--metrics <file>]                 Per-statement and per-operation metrics\n";
+    std::cout << "                                         in the Prometheus text format\n";
+    std::cout << "      [--trace <file>]                   Chrome trace of the last events per thread\n";
+    std::cout << "      [--log <file>]                     Audit log of the measured services, to see\n";
+    std::cout << "                                         what logging every operation costs\n";
+    std::cout << "      [--slow-query-ms <ms>]             Log statements taking at least <ms> to\n";
+    std::cout << "                                         stderr and EXPLAIN the first of each shape\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "-h" || arg == "--help") {
+            printUsage();
+            return 0;
+        } else if (arg == "--users" && hasValue) {
+            options.users = std::atoi(argv[++i]);
+        } else if (arg == "--accounts-per-user" && hasValue) {
+            options.accountsPerUser = std::atoi(argv[++i]);
+        } else if (arg == "--transactions" && hasValue) {
+            options.transactionsPerAccount = std::atoi(argv[++i]);
+        } else if (arg == "--zipf" && hasValue) {
+            options.zipf = std::atof(argv[++i]);
+        } else if (arg == "--threads" && hasValue) {
+            options.threads = std::atoi(argv[++i]);
+        } else if (arg == "--warmup" && hasValue) {
+            options.warmupSeconds = std::atof(argv[++i]);
+        } else if (arg == "--duration" && hasValue) {
+            options.durationSeconds = std::atof(argv[++i]);
+        } else if (arg == "--mix" && hasValue) {
+            char separator;
+            std::istringstream mix(argv[++i]);
+            if (!(mix >> options.mix[0] >> separator >> options.mix[1] >> separator 
+                      >> options.mix[2] >> separator >> options.mix[3])) {
+                std::cerr << "--mix expects four comma separated weights\n";
+                return 1;
+            }
+        } else if (arg == "--reset") {
+            options.reset = true;
+        } else if (arg == "--no-seed") {
+            options.seed = false;
+        } else if (arg == "--seed-only") {
+            options.seedOnly = true;
+        } else if (arg == "--memory") {
+            options.memory = true;
+        } else if (arg == "--data-dir" && hasValue) {
+            options.dataDir = argv[++i];
+        } else if (arg == "--sharded" && hasValue) {
+            options.shards = std::atoi(argv[++i]);
+            if (options.shards < 1) {
+                std::cerr << "--sharded expects at least one shard\n";
+                return 1;
+            }
+        } else if (arg == "--inflight" && hasValue) {
+            options.inflight = std::atoi(argv[++i]);
+        } else if ((arg == "--async" || arg == "--thread-per-request") && hasValue) {
+            int workers = std::atoi(argv[++i]);
+            options.asyncWorkers = workers > 0 ? workers : -1;
+            options.threadPerRequest = arg == "--thread-per-request";
+#ifdef BANK_HAVE_CORO
+        } else if (arg == "--coro" && hasValue) {
+            options.coroConnections = std::atoi(argv[++i]);
+            if (options.coroConnections < 1) {
+                std::cerr << "--coro expects at least one connection\n";
+                return 1;
+            }
+#endif
+        } else if (arg == "--output" && hasValue) {
+            options.outputPath = argv[++i];
+        } else if (arg == "--metrics" && hasValue) {
+            options.metricsPath = argv[++i];
+        } else if (arg == "--trace" && hasValue) {
+            options.tracePath = argv[++i];
+        } else if (arg == "--log" && hasValue) {
+            options.logPath = argv[++i];
+        } else if (arg == "--slow-query-ms" && hasValue) {
+            options.slowQueryMillis = std::atof(argv[++i]);
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n\n";
+            printUsage();
+            return 1;
+        }
+    }
+
+    int mixTotal = options.mix[0] + options.mix[1] + options.mix[2] + options.mix[3];
+    if (options.users < 1 || options.accountsPerUser < 1 || options.transactionsPerAccount < 0 ||
+        options.threads < 1 || options.inflight < 1 || options.durationSeconds <= 0 || options.zipf < 0 || mixTotal <= 0 ||
+        *std::min_element(std::begin(options.mix), std::end(options.mix)) < 0) 
+    {
+        std::cerr << "Invalid option value\n";
+        return 1;
+    }
+
+    if (options.coroConnections > 0 && (options.memory || !options.dataDir.empty())) {
+        std::cerr << "--coro needs the database\n";
+        return 1;
+    }
+    if (options.coroConnections > 0 && (options.shards > 0 || options.asyncWorkers != 0)) {
+        std::cerr << "--coro cannot be combined with --sharded, --async or --thread-per-request\n";
+        return 1;
+    }
+    if (!options.metricsPath.empty() && (options.coroConnections > 0 || options.shards > 0)) {
+        std::cerr << "--metrics records BankService calls, which --coro and --sharded bypass\n";
+        return 1;
+    }
+    if (!options.logPath.empty() && (options.coroConnections > 0 || options.shards > 0)) {
+        std::cerr << "--log records BankService calls, which --coro and --sharded bypass\n";
+        return 1;
+    }
+
+    const char* dbHost = std::getenv("DB_HOST");
+    const char* dbPort = std::getenv("DB_PORT");
+    const char* dbName = std::getenv("DB_NAME");
+    const char* dbUser = std::getenv("DB_USER");
+    const char* dbPassword = std::getenv("DB_PASSWORD");
+
+    std::string host = dbHost ? dbHost : "localhost";
+    std::string port = dbPort ? dbPort : "5432";
+    std::string name = dbName ? dbName : "bank_management";
+    std::string user = dbUser ? dbUser : "postgres";
+    std::string password = dbPassword ? dbPassword : "";
+
+    auto connect = [&]() {
+        auto db = std::make_shared<bank::Database>(host, port, name, user, password);
+        db->connect();
+        return db;
+    };
+
+    // Services behind --async or --thread-per-request; otherwise one per client thread
+    int serviceCount = options.coroConnections > 0 ? 0 : options.threads;
+    if (options.asyncWorkers != 0) {
+        serviceCount = options.asyncWorkers > 0 ? options.asyncWorkers
+                                                : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+
+    // Only the measured connections and services record, not seeding
+    std::shared_ptr<bank::MetricsRegistry> metrics;
+    if (!options.metricsPath.empty()) {
+        metrics = std::make_shared<bank::MetricsRegistry>();
+    }
+    std::shared_ptr<bank::Logger> logger;
+    if (!options.logPath.empty()) {
+        bank::LoggerOptions logOptions;
+        logOptions.path = options.logPath;
+        logger = std::make_shared<bank::Logger>(logOptions);
+        if (!logger->open()) {
+            std::cerr << "Error: " << logger->getLastError() << "\n";
+            return 1;
+        }
+    }
+    std::shared_ptr<bank::SlowQueryLog> slowQueries;
+    if (options.slowQueryMillis > 0) {
+        bank::SlowQueryOptions slowQueryOptions;
+        slowQueryOptions.thresholdMillis = options.slowQueryMillis;
+        slowQueries = std::make_shared<bank::SlowQueryLog>(slowQueryOptions, connect);
+        slowQueries->open();
+    }
+
+    double seedSeconds = 0.0;
+    std::vector<int> accountByRank;
+    std::shared_ptr<bank::MemoryLedgerStore> store;
+    std::vector<std::shared_ptr<bank::Database>> connections;
+
+    if (options.memory || !options.dataDir.empty()) {
+        if (options.memory) {
+            store = std::make_shared<bank::MemoryLedgerStore>();
+        } else {
+            bank::LogStoreOptions storeOptions;
+            storeOptions.directory = options.dataDir;
+            auto logStore = std::make_shared<bank::LogLedgerStore>(storeOptions);
+            if (!logStore->open()) {
+                std::cerr << "Error: " << logStore->getLastError() << "\n";
+                return 1;
+            }
+            store = logStore;
+        }
+
+        // A memory store always starts empty, so it is always seeded
+        if (options.seed || options.memory) {
+            std::cerr << "Seeding " << options.users << " users, " << options.users * options.accountsPerUser
+                      << " accounts into the store...\n";
+            if (!seedStore(*store, options, seedSeconds)) {
+                std::cerr << "Error: Seeding failed: " << store->getLastError() << "\n";
+                return 1;
+            }
+            std::cerr << "Seeded in " << seedSeconds << " s\n";
+        }
+        if (options.seedOnly) {
+            return 0;
+        }
+        for (int userId = 1; userId <= options.users; ++userId) {
+            for (const auto& account : store->findAccountsByUser(userId)) {
+                if (account.getStatus() == bank::AccountStatus::Active) {
+                    accountByRank.push_back(account.getAccountId());
+                }
+            }
+        }
+    } else {
+        auto admin = connect();
+        if (!admin->isConnected()) {
+            std::cerr << "Error: " << admin->getLastError() << "\n";
+            return 1;
+        }
+
+        if (options.seed) {
+            std::cerr << "Seeding " << options.users << " users, " << options.users * options.accountsPerUser
+                      << " accounts...\n";
+            bool staged = admin->execute(
+                "CREATE TEMP TABLE bench_seed_transactions (account_id INTEGER, transaction_type VARCHAR(20), "
+                "amount DECIMAL(15, 2), balance_after DECIMAL(15, 2), description TEXT, "
+                "related_account_id INTEGER, seconds_ago INTEGER)");
+            if (!staged || !seedPopulation(*admin, options, seedSeconds)) {
+                std::cerr << "Error: Seeding failed: " << admin->getLastError() << "\n";
+                return 1;
+            }
+            std::cerr << "Seeded in " << seedSeconds << " s\n";
+        }
+        if (options.seedOnly) {
+            return 0;
+        }
+
+        auto rows = admin->query("SELECT account_id FROM accounts WHERE status = 'active' ORDER BY account_id");
+        for (const auto& row : rows) {
+            accountByRank.push_back(std::stoi(row[0]));
+        }
+
+        for (int i = 0; i < serviceCount; ++i) {
+            auto db = connect();
+            if (!db->isConnected()) {
+                std::cerr << "Error: " << db->getLastError() << "\n";
+                return 1;
+            }
+            db->setMetrics(metrics);
+            db->setSlowQueryLog(slowQueries);
+            connections.push_back(db);
+        }
+    }
+
+    // Popularity rank -> account id, shuffled so hot accounts are spread over users
+    if (accountByRank.size() < 2) {
+        std::cerr << "Error: Need at least two active accounts\n";
+        return 1;
+    }
+    std::shuffle(accountByRank.begin(), accountByRank.end(), std::mt19937(options.randomSeed));
+    ZipfSampler zipf(accountByRank.size(), options.zipf);
+
+    // The ledger persists through a single store; Postgres gets its own connection
+    std::unique_ptr<bank::ShardedLedger> ledger;
+    if (options.shards > 0) {
+        std::shared_ptr<bank::LedgerStore> ledgerStore = store;
+        if (!ledgerStore) {
+            ledgerStore = std::make_shared<bank::PostgresLedgerStore>(connect());
+        }
+        bank::ShardedLedgerOptions ledgerOptions;
+        ledgerOptions.shards = static_cast<std::size_t>(options.shards);
+        ledger = std::make_unique<bank::ShardedLedger>(ledgerStore, ledgerOptions);
+    }
+
+    auto makeService = [&](int i) {
+        auto service = store ? std::make_unique<bank::BankService>(store)
+                             : std::make_unique<bank::BankService>(connections[i]);
+        service->setMetrics(metrics);
+        service->setLogger(logger);
+        return service;
+    };
+
+    // Both keep options.inflight calls per client thread outstanding on serviceCount services
+    std::unique_ptr<bank::AsyncBankService> async;
+    ServicePool requestServices;
+    StartCall startCall;
+    if (options.asyncWorkers != 0 && !options.threadPerRequest) {
+        int created = 0;
+        bank::AsyncServiceOptions asyncOptions;
+        asyncOptions.workers = static_cast<std::size_t>(serviceCount);
+        async = std::make_unique<bank::AsyncBankService>([&]() { return makeService(created++); }, asyncOptions);
+        if (!async->open()) {
+            std::cerr << "Error: " << async->getLastError() << "\n";
+            return 1;
+        }
+        startCall = [&](Operation operation, int account, int target, double amount) -> std::function<bool()> {
+            std::shared_future<bool> outcome;
+            switch (operation) {
+                case Deposit:
+                    outcome = async->deposit(account, amount, "Bench deposit").share();
+                    break;
+                case Withdraw:
+                    outcome = async->withdraw(account, amount, "Bench withdrawal").share();
+                    break;
+                case Transfer:
+                    outcome = async->transfer(account, target, amount, "Bench transfer").share();
+                    break;
+                case History:
+                case OperationCount: {
+                    auto history = async->getTransactionHistory(account, 50).share();
+                    return [history]() { history.wait(); return true; };
+                }
+            }
+            return [outcome]() { return outcome.get(); };
+        };
+    } else if (options.threadPerRequest) {
+        for (int i = 0; i < serviceCount; ++i) {
+            requestServices.add(makeService(i));
+        }
+        startCall = [&](Operation operation, int account, int target, double amount) -> std::function<bool()> {
+            auto outcome = std::async(std::launch::async, [&, operation, account, target, amount]() {
+                return requestServices.with([&](bank::BankService& service) {
+                    return perform(service, operation, account, target, amount);
+                });
+            }).share();
+            return [outcome]() { return outcome.get(); };
+        };
+    }
+
+    if (!options.tracePath.empty()) {
+        bank::trace::start();
+    }
+    std::cerr << "Running " << options.threads << " threads for " << options.durationSeconds << " s...\n";
+    auto begin = std::chrono::steady_clock::now();
+    auto measureFrom = begin + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(options.warmupSeconds));
+    auto stopAt = measureFrom + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(options.durationSeconds));
+
+    std::vector<WorkerResult> results(options.threads);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < options.threads; ++i) {
+        threads.emplace_back([&, i]() {
+            bank::trace::setThreadName("client " + std::to_string(i + 1));
+            if (ledger) {
+                runShardedWorker(*ledger, options, zipf, accountByRank, options.randomSeed + i + 1,
+                                 measureFrom, stopAt, results[i]);
+                return;
+            }
+#ifdef BANK_HAVE_CORO
+            if (options.coroConnections > 0) {
+                runCoroutineWorker([&](bank::EventLoop& loop) {
+                    return std::make_unique<bank::CoroDatabase>(loop, host, port, name, user, password);
+                }, options, zipf, accountByRank, options.randomSeed + i + 1, measureFrom, stopAt, results[i]);
+                return;
+            }
+#endif
+            if (startCall) {
+                runPipelinedWorker(startCall, options, zipf, accountByRank, options.randomSeed + i + 1,
+                                   measureFrom, stopAt, results[i]);
+                return;
+            }
+            auto service = makeService(i);
+            runWorker(*service, options, zipf, accountByRank, options.randomSeed + i + 1,
+                      measureFrom, stopAt, results[i]);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (!options.tracePath.empty()) {
+        bank::trace::stop();
+        if (!bank::trace::writeChromeTrace(options.tracePath)) {
+            std::cerr << "Error: Could not write " << options.tracePath << "\n";
+        }
+    }
+    double measuredSeconds = std::chrono::duration<double>(
+        std::min(std::chrono::steady_clock::now(), stopAt) - measureFrom).count();
+    if (ledger && !ledger->getLastError().empty()) {
+        std::cerr << "Error: " << ledger->getLastError() << "\n";
+    }
+
+    std::vector<double> all;
+    std::vector<double> byOperation[OperationCount];
+    std::size_t failed[OperationCount] = {};
+    bool countedAllocations = false;
+    std::uint64_t allocations[OperationCount] = {};
+    std::uint64_t allocatedBytes[OperationCount] = {};
+    for (const auto& result : results) {
+        for (int op = 0; op < OperationCount; ++op) {
+            byOperation[op].insert(byOperation[op].end(), result.latencies[op].begin(), result.latencies[op].end());
+            all.insert(all.end(), result.latencies[op].begin(), result.latencies[op].end());
+            failed[op] += result.failed[op];
+            allocations[op] += result.allocations[op];
+            allocatedBytes[op] += result.allocatedBytes[op];
+        }
+        countedAllocations = countedAllocations || result.countedAllocations;
+    }
+
+    std::ofstream file;
+    if (!options.outputPath.empty()) {
+        file.open(options.outputPath, std::ios::trunc);
+        if (!file) {
+            std::cerr << "Error: Could not open " << options.outputPath << "\n";
+            return 1;
+        }
+    }
+    std::ostream& out = options.outputPath.empty() ? std::cout : file;
+
+    out << std::fixed << std::setprecision(3);
+    out << "{\n";
+    out << "  \"version\": \"" << BANK_VERSION << "\",\n";
+    out << "  \"backend\": \"" << (options.memory ? "memory" : !options.dataDir.empty() ? "log" : "postgres") << "\",\n";
+    out << "  \"config\": {\"users\": " << options.users << ", \"accounts_per_user\": " 
+        << options.accountsPerUser << ", \"transactions_per_account\": " << options.transactionsPerAccount
+        << ", \"zipf\": " << options.zipf << ", \"threads\": " << options.threads 
+        << ", \"warmup_s\": " << options.warmupSeconds << ", \"duration_s\": " << options.durationSeconds
+        << ", \"mix\": [" << options.mix[0] << ", " << options.mix[1] << ", " << options.mix[2] 
+        << ", " << options.mix[3] << "]},\n";
+    if (options.coroConnections > 0) {
+        out << "  \"pipeline\": {\"mode\": \"coroutine\", \"services\": " << options.coroConnections
+            << ", \"inflight\": " << options.inflight << "},\n";
+    }
+    if (options.asyncWorkers != 0) {
+        out << "  \"pipeline\": {\"mode\": \"" << (options.threadPerRequest ? "thread_per_request" : "async")
+            << "\", \"services\": " << serviceCount << ", \"inflight\": " << options.inflight;
+        if (async) {
+            auto stats = async->getPoolStats();
+            out << ", \"executed\": " << stats.executed << ", \"stolen\": " << stats.stolen
+                << ", \"blocked\": " << stats.blocked;
+        }
+        out << "},\n";
+    }
+    if (ledger) {
+        auto stats = ledger->getStats();
+        out << "  \"ledger\": {\"shards\": " << options.shards << ", \"inflight\": " << options.inflight
+            << ", \"cross_shard_transfers\": " << stats.crossShardTransfers << ", \"refunds\": " << stats.refunds
+            << ", \"batches\": " << stats.batches << ", \"store_scopes\": " << stats.storeScopes << "},\n";
+    }
+    if (logger) {
+        logger->flush();
+        out << "  \"log\": {\"written\": " << logger->getWritten() << ", \"dropped\": " << logger->getDropped()
+            << "},\n";
+    }
+    out << "  \"seed_s\": " << seedSeconds << ",\n";
+    out << "  \"operations\": " << all.size() << ",\n";
+    out << "  \"tps\": " << (measuredSeconds > 0 ? all.size() / measuredSeconds : 0.0) << ",\n";
+    out << "  \"latency\": ";
+    writeLatency(out, percentiles(all));
+    out << ",\n  \"by_operation\": {\n";
+    for (int op = 0; op < OperationCount; ++op) {
+        std::size_t calls = byOperation[op].size();
+        out << "    \"" << kOperationNames[op] << "\": {\"failed\": " << failed[op] << ", \"latency\": ";
+        writeLatency(out, percentiles(std::move(byOperation[op])));
+        if (countedAllocations) {
+            out << ", \"allocs_per_op\": " << (calls > 0 ? static_cast<double>(allocations[op]) / calls : 0.0)
+                << ", \"bytes_per_op\": " << (calls > 0 ? static_cast<double>(allocatedBytes[op]) / calls : 0.0);
+        }
+        out << "}" << (op + 1 < OperationCount ? "," : "") << "\n";
+    }
+    out << "  }\n}\n";
+
+    if (metrics && !metrics->writeFile(options.metricsPath)) {
+        std::cerr << "Error: Could not write " << options.metricsPath << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,396 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <optional>
+#include <string>
+#include <vector>
+#include "Account.hpp"
+#include "AllocationTracker.hpp"
+#include "LedgerRows.hpp"
+#include "LedgerStatements.hpp"
+#include "MemoryLedgerStore.hpp"
+#include "RequestArena.hpp"
+#include "RowReader.hpp"
+#include "Transaction.hpp"
+#include "Timestamp.hpp"
+#include "TransactionBatch.hpp"
+#include "User.hpp"
+
+// Microbenchmarks for the per-row decoding paths of BankService and
+// Database, and for activity totals from rollups against a scan. Runs
+// without a database; every benchmark reports time and heap allocations
+// per iteration.
+
+// With BANK_ALLOC_TRACKING, AllocationTracker already replaces operator new
+#ifndef BANK_ALLOC_TRACKING
+namespace {
+
+std::atomic<std::size_t> g_allocations{0};
+std::atomic<std::size_t> g_allocatedBytes{0};
+
+} // namespace
+
+// Count every heap allocation made by the process. The deletes are kept
+// out of line so GCC does not pair them with std::allocator's inlined new.
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+__attribute__((noinline)) void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+#endif
+
+namespace {
+
+/**
+ * @brief Allocations made so far, by this thread or the whole process
+ */
+bank::alloc::Counts allocationCounts() {
+#ifdef BANK_ALLOC_TRACKING
+    return bank::alloc::threadCounts();
+#else
+    return {g_allocations.load(), g_allocatedBytes.load()};
+#endif
+}
+
+/**
+ * @brief Keep the compiler from discarding a computed value
+ */
+template <typename T>
+void doNotOptimize(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+struct Result {
+    std::string name;
+    double nanosPerIteration;
+    double allocationsPerIteration;
+    double bytesPerIteration;
+};
+
+struct HarnessOptions {
+    std::string filter;
+    double minSeconds = 0.2;
+    int repetitions = 5;
+    bool json = false;
+};
+
+/**
+ * @brief Time a function: calibrate the iteration count to minSeconds,
+ *        then keep the fastest of several repetitions
+ */
+template <typename Fn>
+void run(const HarnessOptions& options, std::vector<Result>& results, const std::string& name, Fn fn) {
+    if (!options.filter.empty() && name.find(options.filter) == std::string::npos) {
+        return;
+    }
+
+    auto timeIterations = [&fn](std::size_t iterations) {
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < iterations; ++i) {
+            fn(i);
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    std::size_t iterations = 1;
+    while (timeIterations(iterations) < options.minSeconds / 10 && iterations < (std::size_t(1) << 30)) {
+        iterations *= 2;
+    }
+    iterations *= 10;
+
+    Result best{name, 0.0, 0.0, 0.0};
+    for (int rep = 0; rep < options.repetitions; ++rep) {
+        bank::alloc::Counts before = allocationCounts();
+        double seconds = timeIterations(iterations);
+        bank::alloc::Counts after = allocationCounts();
+        double nanos = seconds * 1e9 / iterations;
+        if (rep == 0 || nanos < best.nanosPerIteration) {
+            best.nanosPerIteration = nanos;
+        }
+        best.allocationsPerIteration = static_cast<double>(after.allocations - before.allocations) / iterations;
+        best.bytesPerIteration = static_cast<double>(after.bytes - before.bytes) / iterations;
+    }
+    results.push_back(best);
+}
+
+/**
+ * @brief In-memory stand-in for a PGresult holding text values
+ */
+class SyntheticResult {
+public:
+    SyntheticResult(std::vector<std::string> row, int rowCount)
+        : m_row(std::move(row))
+        , m_rowCount(rowCount)
+    {
+    }
+
+    int rows() const { return m_rowCount; }
+    int columns() const { return static_cast<int>(m_row.size()); }
+    const char* value(int, int column) const { return m_row[column].c_str(); }
+    int length(int, int column) const { return static_cast<int>(m_row[column].size()); }
+
+private:
+    std::vector<std::string> m_row;
+    int m_rowCount;
+};
+
+void printUsage() {
+    std::cout << "Bank Management Microbenchmarks\n\n";
+    std::cout << "Usage:\n";
+    std::cout << "  ./bank_microbench [options]\n";
+    std::cout << "      [--filter <text>]                  Only run benchmarks whose name contains text\n";
+    std::cout << "      [--min-time <s>]                   Time per repetition (default: 0.2)\n";
+    std::cout << "      [--repetitions <n>]                Fastest of n runs is reported (default: 5)\n";
+    std::cout << "      [--json]                           Print results as JSON\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    HarnessOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            printUsage();
+            return 0;
+        } else if (arg == "--filter" && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (arg == "--min-time" && i + 1 < argc) {
+            options.minSeconds = std::atof(argv[++i]);
+        } else if (arg == "--repetitions" && i + 1 < argc) {
+            options.repetitions = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--json") {
+            options.json = true;
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n\n";
+            printUsage();
+            return 1;
+        }
+    }
+
+    std::vector<Result> results;
+
+    // Field decoding as done by the BankService row decoders
+    const std::string ids[] = {"1", "4711", "123456", "2147483"};
+    const std::string amounts[] = {"0.00", "12.50", "98765.43", "1500000.00"};
+    run(options, results, "decode/stoi", [&](std::size_t i) {
+        doNotOptimize(std::stoi(ids[i & 3]));
+    });
+    run(options, results, "decode/stod", [&](std::size_t i) {
+        doNotOptimize(std::stod(amounts[i & 3]));
+    });
+
+    const std::string accountTypes[] = {"savings", "checking", "fixed_deposit", "checking"};
+    const std::string accountStatuses[] = {"active", "inactive", "frozen", "active"};
+    const std::string transactionTypes[] = {"deposit", "withdrawal", "transfer_in", "transfer_out"};
+    run(options, results, "Account::stringToType", [&](std::size_t i) {
+        doNotOptimize(bank::Account::stringToType(accountTypes[i & 3]));
+    });
+    run(options, results, "Account::stringToStatus", [&](std::size_t i) {
+        doNotOptimize(bank::Account::stringToStatus(accountStatuses[i & 3]));
+    });
+    run(options, results, "Transaction::stringToType", [&](std::size_t i) {
+        doNotOptimize(bank::Transaction::stringToType(transactionTypes[i & 3]));
+    });
+
+    // Timestamps as PostgreSQL prints them and as ISO-8601 with an offset
+    const std::string timestamps[] = {"2024-03-01 09:15:42.123456", "2024-03-01 09:15:43.5",
+                                      "2024-03-01T09:16:00Z", "2024-03-01T10:16:01.25+01:00"};
+    run(options, results, "Timestamp::parse", [&](std::size_t i) {
+        doNotOptimize(bank::Timestamp::parse(timestamps[i & 3]));
+    });
+    run(options, results, "Timestamp::format", [](std::size_t i) {
+        char text[bank::Timestamp::kTextLength];
+        bank::Timestamp::fromMicros(1709280942123456 + static_cast<std::int64_t>(i) * 1000000).format(text);
+        doNotOptimize(text);
+    });
+    run(options, results, "Account::generateAccountNumber", [](std::size_t) {
+        doNotOptimize(bank::Account::generateAccountNumber());
+    });
+    run(options, results, "User::hashPassword", [](std::size_t) {
+        doNotOptimize(bank::User::hashPassword("correct horse battery staple"));
+    });
+
+    // Row materialization, shaped like the account and transaction queries
+    SyntheticResult accounts({"4711", "42", "ACC0123456789", "checking", "1520.75", "1.25", "active"}, 100);
+    SyntheticResult transactions({"981273", "4711", "transfer_out", "250.00", "1270.75", 
+                                  "Rent for the month of March", "", "2024-03-01 09:15:42.123456"}, 50);
+    run(options, results, "readRows/accounts_100x7", [&](std::size_t) {
+        doNotOptimize(bank::readRows(accounts));
+    });
+    run(options, results, "readRows/transactions_50x8", [&](std::size_t) {
+        doNotOptimize(bank::readRows(transactions));
+    });
+
+    // The same rows in a request arena, released after every iteration like BankService does
+    bank::RequestArena arena;
+    run(options, results, "readRows/transactions_50x8_arena", [&](std::size_t) {
+        doNotOptimize(bank::readRows(transactions, arena.resource()));
+        arena.release();
+    });
+
+    // Materialize and decode, i.e. the whole client-side cost of a history page
+    run(options, results, "decode/transaction_page_50", [&](std::size_t) {
+        auto rows = bank::readRows(transactions);
+        std::vector<bank::Transaction> page;
+        page.reserve(rows.size());
+        for (const auto& row : rows) {
+            bank::Transaction t;
+            t.setTransactionId(std::stoi(row[0]));
+            t.setAccountId(std::stoi(row[1]));
+            t.setType(bank::Transaction::stringToType(row[2]));
+            t.setAmount(std::stod(row[3]));
+            t.setBalanceAfter(std::stod(row[4]));
+            t.setDescription(row[5]);
+            t.setRelatedAccountId(row[6].empty() ? -1 : std::stoi(row[6]));
+            t.setCreatedAt(bank::Timestamp::parse(row[7]).value_or(bank::Timestamp()));
+            page.push_back(std::move(t));
+        }
+        doNotOptimize(page);
+    });
+    run(options, results, "decode/transaction_page_50_arena", [&](std::size_t) {
+        {
+            auto rows = bank::readRows(transactions, arena.resource());
+            std::vector<bank::Transaction> page;
+            page.reserve(rows.size());
+            for (const auto& row : rows) {
+                page.push_back(bank::transactionFromRow(row));
+            }
+            doNotOptimize(page);
+        }
+        arena.release();
+    });
+    // Typed columns decoded straight from the result, as PostgresLedgerStore does
+    run(options, results, "decode/transaction_page_50_typed", [&](std::size_t) {
+        std::vector<bank::Transaction> page;
+        page.reserve(static_cast<std::size_t>(transactions.rows()));
+        bank::ledger::kScanHistory.decode(transactions, [&](int id, int accountId, bank::TransactionType type,
+                                                            double amount, double balanceAfter,
+                                                            std::string description,
+                                                            std::optional<int> related,
+                                                            bank::Timestamp createdAt) {
+            bank::Transaction t;
+            t.setTransactionId(id);
+            t.setAccountId(accountId);
+            t.setType(type);
+            t.setAmount(amount);
+            t.setBalanceAfter(balanceAfter);
+            t.setDescription(std::move(description));
+            t.setRelatedAccountId(related.value_or(-1));
+            t.setCreatedAt(createdAt);
+            page.push_back(std::move(t));
+        });
+        doNotOptimize(page);
+    });
+
+    // Bulk history of 10k transactions, as objects and as columns; bytes/iter is the footprint
+    const char* descriptions[] = {"Initial deposit", "ATM withdrawal", "Rent for the month of March",
+                                  "Transfer to ACC0123456789"};
+    std::vector<bank::Transaction> sampleHistory;
+    for (int i = 0; i < 10000; ++i) {
+        bank::Transaction t(i + 1, 4711, static_cast<bank::TransactionType>(i & 3), 25.0 + i % 100,
+                            1000.0 + i, descriptions[i & 3], (i & 3) >= 2 ? 42 : -1);
+        t.setCreatedAt(bank::Timestamp::fromMicros(1709280942123456 + i * 1000000LL));
+        sampleHistory.push_back(std::move(t));
+    }
+    bank::TransactionBatch sampleBatch;
+    for (const auto& t : sampleHistory) {
+        sampleBatch.push_back(t);
+    }
+    run(options, results, "history/load_10k_vector", [&](std::size_t) {
+        std::vector<bank::Transaction> history;
+        history.reserve(sampleHistory.size());
+        for (const auto& t : sampleHistory) {
+            history.push_back(t);
+        }
+        doNotOptimize(history);
+    });
+    run(options, results, "history/load_10k_batch", [&](std::size_t) {
+        bank::TransactionBatch history(sampleBatch.getDescriptions());
+        history.reserve(sampleBatch.size());
+        for (std::size_t i = 0; i < sampleBatch.size(); ++i) {
+            history.push_back(sampleHistory[i], sampleBatch.createdAtMicros(i));
+        }
+        doNotOptimize(history);
+    });
+    run(options, results, "history/sum_10k_vector", [&](std::size_t) {
+        double total = 0.0;
+        for (const auto& t : sampleHistory) {
+            total += t.getAmount();
+        }
+        doNotOptimize(total);
+    });
+    run(options, results, "history/sum_10k_batch", [&](std::size_t) {
+        double total = 0.0;
+        for (std::size_t i = 0; i < sampleBatch.size(); ++i) {
+            total += sampleBatch.amount(i);
+        }
+        doNotOptimize(total);
+    });
+
+    // Activity over a quarter of 10k transactions: stitched rollups against a scan of the history
+    struct BackdatedStore : bank::MemoryLedgerStore {
+        using MemoryLedgerStore::appendTransactionAt;
+    } store;
+    int userId = store.insertUser(bank::User(0, "bench", "", "Bench", "bench@example.org", "")).value_or(0);
+    int accountId = store.insertAccount(bank::Account(0, userId, "ACC0000000001", bank::AccountType::Checking,
+                                                      0.0, 0.0, bank::AccountStatus::Active)).value_or(0);
+    for (std::size_t i = 0; i < sampleHistory.size(); ++i) {
+        bank::Transaction t = sampleHistory[i];
+        t.setAccountId(accountId);
+        store.appendTransactionAt(t, bank::Timestamp::fromMicros(1709280942123456 + i * 800000000LL));
+    }
+    const bank::TimeRange quarter{*bank::Timestamp::parse("2024-03-02 17:45:10"),
+                                  *bank::Timestamp::parse("2024-05-29 08:05:00")};
+    run(options, results, "activity/cover_range", [&](std::size_t) {
+        doNotOptimize(bank::RangeCover::of(quarter));
+    });
+    run(options, results, "activity/quarter_rollups", [&](std::size_t) {
+        doNotOptimize(store.summarizeActivity(accountId, bank::RangeCover::of(quarter)));
+    });
+    run(options, results, "activity/quarter_scan", [&](std::size_t) {
+        bank::RangeCover whole;
+        whole.rest[0] = quarter;
+        doNotOptimize(store.summarizeActivity(accountId, whole));
+    });
+
+    if (options.json) {
+        std::cout << std::fixed << std::setprecision(2) << "[\n";
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const Result& r = results[i];
+            std::cout << "  {\"name\": \"" << r.name << "\", \"ns_per_iter\": " << r.nanosPerIteration
+                      << ", \"allocs_per_iter\": " << r.allocationsPerIteration
+                      << ", \"bytes_per_iter\": " << r.bytesPerIteration << "}"
+                      << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        std::cout << "]\n";
+        return 0;
+    }
+
+    std::cout << std::left << std::setw(34) << "Benchmark" << std::right << std::setw(14) << "ns/iter"
+              << std::setw(14) << "allocs/iter" << std::setw(14) << "bytes/iter" << "\n";
+    std::cout << std::fixed;
+    for (const auto& r : results) {
+        std::cout << std::left << std::setw(34) << r.name << std::right << std::setprecision(1)
+                  << std::setw(14) << r.nanosPerIteration << std::setprecision(2)
+                  << std::setw(14) << r.allocationsPerIteration
+                  << std::setw(14) << r.bytesPerIteration << "\n";
+    }
+    return 0;
+}
@@ -1,15 +1,19 @@
 #ifndef ACCOUNT_HPP
 #define ACCOUNT_HPP
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <ctime>
+#include "EnumNames.hpp"
 
 namespace bank {
 
 /**
  * @brief Account types supported by the system
  */
-enum class AccountType {
+enum class AccountType : std::uint8_t {
     Savings,
     Checking,
     FixedDeposit
@@ -18,26 +22,50 @@ enum class AccountType {
 /**
  * @brief Account status
  */
-enum class AccountStatus {
+enum class AccountStatus : std::uint8_t {
     Active,
     Inactive,
     Frozen
 };
 
+template <>
+struct EnumNames<AccountType> {
+    static constexpr std::string_view names[] = {"savings", "checking", "fixed_deposit"};
+};
+
+template <>
+struct EnumNames<AccountStatus> {
+    static constexpr std::string_view names[] = {"active", "inactive", "frozen"};
+};
+
 /**
  * @brief Represents a bank account
+ *
+ * The account number is stored inline (accounts.account_number is
+ * VARCHAR(20)) and the enums are one byte each, so an Account is 48 bytes
+ * and copying one never allocates.
  */
 class Account {
 public:
+    static constexpr std::size_t kMaxNumberLength = 20;
+
     Account();
-    Account(int accountId, int userId, const std::string& accountNumber,
+
+    /**
+     * @brief Account with the given fields
+     *
+     * The number must fit kMaxNumberLength (asserted); a longer one leaves
+     * the number empty rather than keeping a prefix that may be another
+     * account's number.
+     */
+    Account(int accountId, int userId, std::string_view accountNumber,
             AccountType type, double balance, double interestRate,
             AccountStatus status);
 
     // Getters
     int getAccountId() const { return m_accountId; }
     int getUserId() const { return m_userId; }
-    std::string getAccountNumber() const { return m_accountNumber; }
+    std::string_view getAccountNumber() const { return std::string_view(m_accountNumber, m_numberLength); }
     AccountType getType() const { return m_type; }
     double getBalance() const { return m_balance; }
     double getInterestRate() const { return m_interestRate; }
@@ -46,7 +74,11 @@ public:
     // Setters
     void setAccountId(int id) { m_accountId = id; }
     void setUserId(int id) { m_userId = id; }
-    void setAccountNumber(const std::string& number) { m_accountNumber = number; }
+    /**
+     * @brief Set the number, unless it is longer than kMaxNumberLength
+     * @return false, leaving the number unchanged, if it does not fit
+     */
+    bool setAccountNumber(std::string_view number);
     void setType(AccountType type) { m_type = type; }
     void setBalance(double balance) { m_balance = balance; }
     void setInterestRate(double rate) { m_interestRate = rate; }
@@ -58,20 +90,22 @@ public:
     bool transfer(Account& toAccount, double amount);
 
     // Utility functions
-    static std::string typeToString(AccountType type);
-    static AccountType stringToType(const std::string& typeStr);
-    static std::string statusToString(AccountStatus status);
-    static AccountStatus stringToStatus(const std::string& statusStr);
+    static std::string typeToString(AccountType type) { return std::string(enumName(type)); }
+    static constexpr AccountType stringToType(std::string_view typeStr) { return enumFromName<AccountType>(typeStr); }
+    static std::string statusToString(AccountStatus status) { return std::string(enumName(status)); }
+    static constexpr AccountStatus stringToStatus(std::string_view statusStr) { return enumFromName<AccountStatus>(statusStr); }
     static std::string generateAccountNumber();
 
 private:
+    // Widest members first, so there is no padding before the number
+    double m_balance;
+    double m_interestRate;
     int m_accountId;
     int m_userId;
-    std::string m_accountNumber;
     AccountType m_type;
-    double m_balance;
-    double m_interestRate;
     AccountStatus m_status;
+    std::uint8_t m_numberLength;
+    char m_accountNumber[kMaxNumberLength];     // Not terminated
 };
 
 } // namespace bank
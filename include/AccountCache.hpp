@@ -0,0 +1,134 @@
+#ifndef ACCOUNT_CACHE_HPP
+#define ACCOUNT_CACHE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include "Account.hpp"
+#include "MappedFile.hpp"
+#include "PostgresLedgerStore.hpp"
+
+namespace bank {
+
+/**
+ * @brief Hit and size counters of an AccountCache
+ */
+struct AccountCacheStats {
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::size_t snapshotAccounts = 0;   // Records in the mapped snapshot
+    std::size_t overlayAccounts = 0;    // Accounts cached or invalidated since it was written
+};
+
+/**
+ * @brief Process-wide account cache that survives restarts
+ *
+ * Accounts are served from a memory-mapped snapshot file plus an overlay
+ * of accounts fetched or invalidated since the snapshot was written. The
+ * snapshot is used as-is: mapping it at startup makes every account it
+ * holds available immediately, without parsing or a query.
+ *
+ * Snapshot layout (host byte order, versioned by the header):
+ *   header   64 bytes: magic, version, record size, byte order mark,
+ *            record count, index slots, database watermark
+ *   records  48 bytes each, fixed width, sorted by account id
+ *            (binary searched, so they double as the id index)
+ *   index    u32 per slot: open-addressing hash of the account number
+ *            to record number + 1, 0 for an empty slot
+ *
+ * The cache only speeds up reads that tolerate slight staleness (account
+ * lookups). Balance changes still go through the database, which locks
+ * and validates them. Changes made through this process invalidate the
+ * cached account; changes made elsewhere are picked up by reconcile(),
+ * which fetches the accounts whose updated_at is newer than the watermark.
+ * Accounts deleted by other processes stay visible to lookups until a
+ * write to them fails, which invalidates them.
+ *
+ * Thread safe.
+ */
+class AccountCache {
+public:
+    explicit AccountCache(std::string snapshotPath);
+
+    /**
+     * @brief Map the snapshot file written by an earlier run
+     * @return true if a valid snapshot was mapped
+     */
+    bool load();
+
+    std::optional<Account> findById(int accountId);
+    std::optional<Account> findByNumber(const std::string& accountNumber);
+
+    /**
+     * @brief Take a ticket before reading an account from the database
+     *
+     * Pass it to put() with the account read, so a read that raced with
+     * an invalidation does not cache what it saw before the change.
+     */
+    std::uint64_t readTicket() const;
+
+    /**
+     * @brief Cache a committed account read from the database
+     * @param ticket readTicket() taken before the read; the put is dropped
+     *        if the account was invalidated or cached again since
+     * @return true if the account was cached
+     */
+    bool put(const Account& account, std::uint64_t ticket);
+
+    /**
+     * @brief Forget an account until it is read or reconciled again
+     */
+    void invalidate(int accountId);
+
+    /**
+     * @brief Apply the accounts changed in the database since the last reconcile
+     *
+     * The first reconcile after load() catches up from the snapshot's
+     * watermark; without a snapshot it only records the current time.
+     *
+     * @param slackSeconds How long a transaction may run and still be seen
+     * @return Number of accounts refreshed, or nullopt on a database error
+     */
+    std::optional<std::size_t> reconcile(PostgresLedgerStore& store, int slackSeconds = 60);
+
+    /**
+     * @brief Write the cached accounts to a new snapshot and map it
+     */
+    bool writeSnapshot();
+
+    AccountCacheStats getStats() const;
+    std::string getLastError() const;
+
+private:
+    struct Overlay {
+        std::optional<Account> account;     // nullopt: invalidated, ask the database
+        std::uint64_t version;
+    };
+
+    std::optional<Account> snapshotFind(int accountId) const;
+    std::optional<Account> snapshotFindNumber(const std::string& accountNumber) const;
+    Account recordAt(std::size_t index) const;
+    void setOverlay(int accountId, std::optional<Account> account);
+
+    std::string m_path;
+    mutable std::shared_mutex m_mutex;
+    MappedFile m_snapshot;
+    std::size_t m_count;
+    std::size_t m_indexSlots;
+    std::string m_watermark;
+    std::unordered_map<int, Overlay> m_overlay;
+    std::unordered_map<std::string, int> m_overlayNumbers;
+    std::uint64_t m_version;
+    std::uint64_t m_droppedVersion;         // Newest invalidation forgotten by writeSnapshot
+    std::atomic<std::uint64_t> m_hits;
+    std::atomic<std::uint64_t> m_misses;
+    std::string m_lastError;
+};
+
+} // namespace bank
+
+#endif // ACCOUNT_CACHE_HPP
@@ -0,0 +1,69 @@
+#ifndef ALLOCATION_TRACKER_HPP
+#define ALLOCATION_TRACKER_HPP
+
+#include <cstdint>
+
+namespace bank {
+
+/**
+ * @brief Per-thread heap allocation counts, for attributing allocations to operations
+ *
+ * Configured with -DBANK_ALLOC_TRACKING=ON, the process replaces every
+ * form of the global operator new and delete. Every allocation then bumps
+ * two plain thread-local counters, with no atomics or locks, and every
+ * delete goes to free(). A Scope reads the counters when it starts
+ * and again when asked, so it reports what the calling thread allocated
+ * in between. Nested scopes each see their own share.
+ *
+ * BankService wraps every outermost call in a scope and adds the result
+ * to its operation's metrics. bank_bench reports allocations per
+ * operation type.
+ *
+ * Without the option nothing is replaced, kEnabled is false and a Scope
+ * always reports zero.
+ */
+namespace alloc {
+
+struct Counts {
+    std::uint64_t allocations;
+    std::uint64_t bytes;
+};
+
+#ifdef BANK_ALLOC_TRACKING
+constexpr bool kEnabled = true;
+
+/**
+ * @brief Allocations made by the calling thread since it started
+ */
+Counts threadCounts();
+#else
+constexpr bool kEnabled = false;
+
+inline Counts threadCounts() {
+    return {0, 0};
+}
+#endif
+
+/**
+ * @brief Counts the calling thread's allocations from its construction on
+ *
+ * Must be read on the thread that created it.
+ */
+class Scope {
+public:
+    Scope() : m_start(threadCounts()) {}
+
+    Counts elapsed() const {
+        Counts now = threadCounts();
+        return {now.allocations - m_start.allocations, now.bytes - m_start.bytes};
+    }
+
+private:
+    Counts m_start;
+};
+
+} // namespace alloc
+
+} // namespace bank
+
+#endif // ALLOCATION_TRACKER_HPP
@@ -0,0 +1,130 @@
+#ifndef ASYNC_BANK_SERVICE_HPP
+#define ASYNC_BANK_SERVICE_HPP
+
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "BankService.hpp"
+#include "WorkStealingPool.hpp"
+
+namespace bank {
+
+/**
+ * @brief Settings for an AsyncBankService
+ */
+struct AsyncServiceOptions {
+    std::size_t workers = 0;            // 0: one per hardware thread
+    std::size_t queueCapacity = 1024;   // Calls queued per worker before callers block
+};
+
+/**
+ * @brief Non-blocking front end for BankService
+ *
+ * Every banking operation returns a future and runs on a
+ * WorkStealingPool. Each worker owns one BankService (and so one
+ * connection), created by the factory when the service opens. Calls are
+ * queued by the account or user they concern, so calls about the same
+ * account normally run one after another on the same connection; idle
+ * workers steal queued calls when their own queue is empty.
+ *
+ * Results are those of BankService. Callers wait on the futures, or keep
+ * many outstanding to overlap database round trips without a thread per
+ * request. Thread safe.
+ */
+class AsyncBankService {
+public:
+    /**
+     * @brief Creates one worker's service, or returns nullptr if it cannot
+     */
+    using ServiceFactory = std::function<std::unique_ptr<BankService>()>;
+
+    explicit AsyncBankService(ServiceFactory factory, AsyncServiceOptions options = {});
+
+    /**
+     * @brief Create the workers' services and start the pool
+     */
+    bool open();
+
+    // User operations
+    std::future<std::optional<User>> createUser(std::string username, std::string password,
+                                                std::string fullName, std::string email, std::string phone);
+    std::future<std::optional<User>> authenticateUser(std::string username, std::string password);
+    std::future<std::optional<int>> verifyCredentials(std::string username, std::string password);
+    std::future<std::optional<DashboardData>> loadDashboard(int userId, int historyLimit = 50);
+    std::future<std::optional<User>> getUserById(int userId);
+    std::future<std::optional<User>> getUserByUsername(std::string username);
+    std::future<bool> updateUser(User user);
+    std::future<bool> deleteUser(int userId);
+
+    // Account operations
+    std::future<std::optional<Account>> createAccount(int userId, AccountType type, double initialDeposit = 0.0);
+    std::future<std::optional<Account>> getAccountById(int accountId);
+    std::future<std::optional<Account>> getAccountByNumber(std::string accountNumber);
+    std::future<std::vector<Account>> getAccountsByUserId(int userId);
+    std::future<bool> updateAccountStatus(int accountId, AccountStatus status);
+    std::future<bool> deleteAccount(int accountId);
+
+    // Transaction operations
+    std::future<bool> deposit(int accountId, double amount, std::string description = "Deposit");
+    std::future<bool> withdraw(int accountId, double amount, std::string description = "Withdrawal");
+    std::future<bool> transfer(int fromAccountId, int toAccountId, double amount,
+                               std::string description = "Transfer");
+    std::future<std::vector<Transaction>> getTransactionHistory(int accountId, int limit = 50);
+    std::future<std::optional<Transaction>> getTransactionById(int transactionId);
+    std::future<std::vector<BalancePoint>> getBalanceHistory(int accountId,
+                                                             int maxPoints = BankApi::kBalanceHistoryPoints);
+    std::future<std::vector<Transaction>> getTransactionsBetween(int accountId, Timestamp from, Timestamp to,
+                                                                 int limit = BankApi::kRangeLimit);
+    std::future<std::vector<ActivityTotal>> getDailyTotals(int accountId, TimeRange range);
+    std::future<std::vector<ActivityTotal>> getActivity(int accountId, TimeUnit unit, TimeRange range);
+    std::future<ActivityTotal> getActivitySummary(int accountId, TimeRange range);
+
+    // Utility operations
+    std::future<double> getTotalBalance(int userId);
+    std::future<bool> accountExists(std::string accountNumber);
+
+    std::size_t getWorkerCount() const { return m_services.size(); }
+    PoolStats getPoolStats() const;
+    const std::string& getLastError() const { return m_lastError; }
+
+private:
+    /**
+     * @brief Queue a call on the worker for affinity and return its future
+     *
+     * Calls made before open() or after the pool stopped fail with
+     * std::future_error (broken promise).
+     */
+    template <typename Call>
+    auto call(std::size_t affinity, Call operation)
+        -> std::future<decltype(operation(std::declval<BankService&>()))>;
+
+    static std::size_t keyOf(const std::string& key);
+
+    ServiceFactory m_factory;
+    AsyncServiceOptions m_options;
+    std::vector<std::unique_ptr<BankService>> m_services;   // One per worker
+    std::unique_ptr<WorkStealingPool> m_pool;               // Destroyed (drained) before m_services
+    std::string m_lastError;
+};
+
+template <typename Call>
+auto AsyncBankService::call(std::size_t affinity, Call operation)
+    -> std::future<decltype(operation(std::declval<BankService&>()))>
+{
+    using Result = decltype(operation(std::declval<BankService&>()));
+    auto task = std::make_shared<std::packaged_task<Result(BankService&)>>(std::move(operation));
+    auto future = task->get_future();
+    if (m_pool) {
+        m_pool->submit(affinity, [this, task](std::size_t worker) { (*task)(*m_services[worker]); });
+    }
+    return future;
+}
+
+} // namespace bank
+
+#endif // ASYNC_BANK_SERVICE_HPP
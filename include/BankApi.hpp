@@ -0,0 +1,175 @@
+#ifndef BANK_API_HPP
+#define BANK_API_HPP
+
+#include <cstddef>
+#include <deque>
+#include <optional>
+#include <string>
+#include <vector>
+#include "User.hpp"
+#include "Account.hpp"
+#include "Transaction.hpp"
+#include "Timestamp.hpp"
+
+namespace bank {
+
+/**
+ * @brief Timing of a single banking operation
+ */
+struct ServiceCall {
+    const char* operation;
+    double millis;          // Wall time of the whole call
+    double dbMillis;        // Time spent waiting on the database (server time when remote)
+    int roundTrips;         // Statements sent to the database (requests when remote)
+    int rows;               // Rows returned or affected
+};
+
+/**
+ * @brief Everything the dashboard shows right after login
+ */
+struct DashboardData {
+    User user;
+    std::vector<Account> accounts;
+    double totalBalance = 0.0;
+    int defaultAccountId = -1;              // First account, or -1 if none
+    std::vector<Transaction> history;       // First page for the default account
+    std::vector<BalancePoint> balanceHistory;
+};
+
+/**
+ * @brief Banking operations used by the front ends
+ *
+ * Implemented by BankService, which talks to the database directly, and
+ * by RemoteBankService, which forwards every call to a bank_server.
+ * Neither implementation is thread safe.
+ */
+class BankApi {
+public:
+    virtual ~BankApi() = default;
+
+    // User operations
+    virtual std::optional<User> createUser(const std::string& username, const std::string& password,
+                                           const std::string& fullName, const std::string& email,
+                                           const std::string& phone) = 0;
+    virtual std::optional<User> authenticateUser(const std::string& username, 
+                                                 const std::string& password) = 0;
+
+    /**
+     * @brief Check credentials without loading the full user record
+     * @return User id if the username exists and the password matches
+     */
+    virtual std::optional<int> verifyCredentials(const std::string& username, 
+                                                 const std::string& password) = 0;
+
+    /**
+     * @brief Load the user, accounts, total balance and first history page in one round trip
+     *
+     * The default account is the user's oldest account, which is the one
+     * the dashboard selects initially.
+     *
+     * @param userId User to load
+     * @param historyLimit Size of the first transaction history page
+     * @return Dashboard data, or nullopt if the user does not exist
+     */
+    virtual std::optional<DashboardData> loadDashboard(int userId, int historyLimit = 50) = 0;
+
+    /**
+     * @brief verifyCredentials() and loadDashboard() in the round trip of loadDashboard() alone
+     * @return Dashboard data, or nullopt if the username or password is wrong
+     */
+    virtual std::optional<DashboardData> login(const std::string& username, const std::string& password,
+                                               int historyLimit = 50) = 0;
+    virtual std::optional<User> getUserById(int userId) = 0;
+    virtual std::optional<User> getUserByUsername(const std::string& username) = 0;
+    virtual bool updateUser(const User& user) = 0;
+    virtual bool deleteUser(int userId) = 0;
+
+    // Account operations
+    virtual std::optional<Account> createAccount(int userId, AccountType type, 
+                                                 double initialDeposit = 0.0) = 0;
+    virtual std::optional<Account> getAccountById(int accountId) = 0;
+    virtual std::optional<Account> getAccountByNumber(const std::string& accountNumber) = 0;
+    virtual std::vector<Account> getAccountsByUserId(int userId) = 0;
+    virtual bool updateAccountStatus(int accountId, AccountStatus status) = 0;
+    virtual bool deleteAccount(int accountId) = 0;
+
+    // Transaction operations
+    virtual bool deposit(int accountId, double amount, const std::string& description = "Deposit") = 0;
+    virtual bool withdraw(int accountId, double amount, 
+                          const std::string& description = "Withdrawal") = 0;
+    virtual bool transfer(int fromAccountId, int toAccountId, double amount, 
+                          const std::string& description = "Transfer") = 0;
+    virtual std::vector<Transaction> getTransactionHistory(int accountId, int limit = 50) = 0;
+    virtual std::optional<Transaction> getTransactionById(int transactionId) = 0;
+
+    /**
+     * @brief Get the balance of an account over time
+     *
+     * Long histories are bucketed in the database so that at most
+     * maxPoints samples (each bucket's closing balance) are transferred.
+     *
+     * @param accountId Account to chart
+     * @param maxPoints Upper bound on the number of returned samples
+     * @return Samples ordered by time, oldest first
+     */
+    virtual std::vector<BalancePoint> getBalanceHistory(int accountId, 
+                                                        int maxPoints = kBalanceHistoryPoints) = 0;
+
+    static constexpr int kBalanceHistoryPoints = 2000;
+
+    /**
+     * @brief Get an account's transactions created in [from, to), oldest first
+     * @param limit Upper bound on the number of returned transactions
+     */
+    virtual std::vector<Transaction> getTransactionsBetween(int accountId, Timestamp from, Timestamp to,
+                                                            int limit = kRangeLimit) = 0;
+
+    /**
+     * @brief Get the credits, debits, count and closing balance of each day with transactions
+     *
+     * Days are local calendar days; the totals are computed by the store,
+     * so only one row per day is transferred.
+     *
+     * @return Totals ordered by day, oldest first
+     */
+    virtual std::vector<ActivityTotal> getDailyTotals(int accountId, const TimeRange& range) = 0;
+
+    /**
+     * @brief Get the totals of each local hour, day or month starting in range
+     *
+     * Read from rollups kept up to date as transactions are recorded, so
+     * a year of monthly summaries is twelve rows whatever the volume.
+     *
+     * @return Periods with at least one transaction, oldest first
+     */
+    virtual std::vector<ActivityTotal> getActivity(int accountId, TimeUnit unit, const TimeRange& range) = 0;
+
+    /**
+     * @brief Get the credits, debits, count and closing balance of an account's transactions in range
+     *
+     * The range is split into the fewest whole months, days and hours
+     * (RangeCover); those come from the rollups and only the parts shorter
+     * than an hour at either end are read transaction by transaction.
+     *
+     * @return Totals starting at range.from; closingBalance is meaningful only if count > 0
+     */
+    virtual ActivityTotal getActivitySummary(int accountId, const TimeRange& range) = 0;
+
+    static constexpr int kRangeLimit = 1000;
+
+    // Utility operations
+    virtual double getTotalBalance(int userId) = 0;
+    virtual bool accountExists(const std::string& accountNumber) = 0;
+
+    /**
+     * @brief Get the most recent calls, newest last
+     * @return Up to kRecentCallLimit records
+     */
+    virtual const std::deque<ServiceCall>& getRecentCalls() const = 0;
+
+    static constexpr std::size_t kRecentCallLimit = 16;
+};
+
+} // namespace bank
+
+#endif // BANK_API_HPP
@@ -0,0 +1,135 @@
+#ifndef BANK_SERVER_HPP
+#define BANK_SERVER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "ConnectionPool.hpp"
+
+namespace bank {
+
+/**
+ * @brief Listening endpoints and thread counts of a bank_server
+ */
+struct ServerOptions {
+    std::string host = "0.0.0.0";   // Empty disables the TCP listener
+    int port = 7878;
+    std::string unixPath;           // Empty disables the Unix socket listener
+    int workers = 4;                // Threads executing requests
+};
+
+/**
+ * @brief Serves BankService operations over the protocol in Protocol.hpp
+ *
+ * One reactor thread owns every socket: it accepts clients, reads
+ * requests into per-connection buffers and writes responses back, all
+ * non-blocking on a single epoll set. Complete request frames are queued
+ * to a small worker pool, which executes them on connections leased from
+ * the ConnectionPool and hands the encoded responses back to the reactor
+ * through an eventfd. An idle client therefore costs a socket and two
+ * empty buffers, not a thread.
+ *
+ * Clients may pipeline requests; responses carry the request id and may
+ * arrive out of order. A client with too many requests in flight is not
+ * read from until some of them complete.
+ */
+class BankServer {
+public:
+    BankServer(ConnectionPool& pool, ServerOptions options);
+    ~BankServer();
+
+    BankServer(const BankServer&) = delete;
+    BankServer& operator=(const BankServer&) = delete;
+
+    /**
+     * @brief Open the listeners and start the workers
+     * @return true on success, otherwise see getLastError()
+     */
+    bool start();
+
+    /**
+     * @brief Run the event loop until stop() is called
+     */
+    void run();
+
+    /**
+     * @brief Make run() return; safe to call from a signal handler
+     */
+    void stop();
+
+    const std::string& getLastError() const { return m_lastError; }
+
+    static constexpr std::size_t kMaxInFlight = 64;
+
+private:
+    struct Connection {
+        int fd;
+        std::uint64_t id;
+        std::string input;
+        std::size_t inputOffset = 0;
+        std::string output;
+        std::size_t outputOffset = 0;
+        std::size_t inFlight = 0;
+        bool readClosed = false;
+        std::uint32_t events = 0;
+    };
+
+    struct Job {
+        int fd;
+        std::uint64_t connectionId;
+        std::string body;
+    };
+
+    struct Completion {
+        int fd;
+        std::uint64_t connectionId;
+        std::string frame;
+    };
+
+    bool listenTcp();
+    bool listenUnix();
+    bool watch(int fd);
+    void acceptClients(int listenFd);
+    void readFrom(Connection& connection);
+    void writeTo(Connection& connection);
+    void updateEvents(Connection& connection);
+    void close(Connection& connection);
+    void drainCompletions();
+    void workerLoop();
+    void wake();
+
+    ConnectionPool& m_pool;
+    ServerOptions m_options;
+    std::string m_lastError;
+
+    int m_epollFd;
+    int m_wakeFd;
+    int m_tcpFd;
+    int m_unixFd;
+    std::atomic<bool> m_running;
+
+    // Reactor thread only
+    std::unordered_map<int, std::unique_ptr<Connection>> m_connections;
+    std::uint64_t m_nextConnectionId;
+
+    // Shared between reactor and workers
+    std::mutex m_jobMutex;
+    std::condition_variable m_jobReady;
+    std::deque<Job> m_jobs;
+    bool m_stopping;
+    std::mutex m_completionMutex;
+    std::vector<Completion> m_completions;
+    std::vector<std::thread> m_workers;
+};
+
+} // namespace bank
+
+#endif // BANK_SERVER_HPP
@@ -3,57 +3,136 @@
 
 #include <memory>
 #include <vector>
+#include <deque>
+#include <chrono>
 #include <optional>
+#include "BankApi.hpp"
 #include "Database.hpp"
+#include "LedgerStore.hpp"
 #include "User.hpp"
 #include "Account.hpp"
+#include "AllocationTracker.hpp"
+#include "RequestArena.hpp"
 #include "Transaction.hpp"
 
 namespace bank {
 
+class Logger;
+class MetricsRegistry;
+
 /**
- * @brief Service class that handles all banking operations
+ * @brief Service class that handles all banking operations against a LedgerStore
  */
-class BankService {
+class BankService : public BankApi {
 public:
     /**
-     * @brief Construct a new Bank Service object
+     * @brief Construct a new Bank Service object on PostgreSQL
      * @param db Shared pointer to database connection
      */
     explicit BankService(std::shared_ptr<Database> db);
 
+    /**
+     * @brief Construct a new Bank Service object on any storage backend
+     * @param store Shared pointer to the store; shared stores must be thread safe
+     */
+    explicit BankService(std::shared_ptr<LedgerStore> store);
+
     // User operations
     std::optional<User> createUser(const std::string& username, const std::string& password,
-                                    const std::string& fullName, const std::string& email,
-                                    const std::string& phone);
-    std::optional<User> authenticateUser(const std::string& username, const std::string& password);
-    std::optional<User> getUserById(int userId);
-    std::optional<User> getUserByUsername(const std::string& username);
-    bool updateUser(const User& user);
-    bool deleteUser(int userId);
+                                   const std::string& fullName, const std::string& email,
+                                   const std::string& phone) override;
+    std::optional<User> authenticateUser(const std::string& username, const std::string& password) override;
+    std::optional<int> verifyCredentials(const std::string& username, const std::string& password) override;
+    std::optional<DashboardData> loadDashboard(int userId, int historyLimit = 50) override;
+    std::optional<DashboardData> login(const std::string& username, const std::string& password,
+                                       int historyLimit = 50) override;
+    std::optional<User> getUserById(int userId) override;
+    std::optional<User> getUserByUsername(const std::string& username) override;
+    bool updateUser(const User& user) override;
+    bool deleteUser(int userId) override;
 
     // Account operations
-    std::optional<Account> createAccount(int userId, AccountType type, double initialDeposit = 0.0);
-    std::optional<Account> getAccountById(int accountId);
-    std::optional<Account> getAccountByNumber(const std::string& accountNumber);
-    std::vector<Account> getAccountsByUserId(int userId);
-    bool updateAccountStatus(int accountId, AccountStatus status);
-    bool deleteAccount(int accountId);
+    std::optional<Account> createAccount(int userId, AccountType type, double initialDeposit = 0.0) override;
+    std::optional<Account> getAccountById(int accountId) override;
+    std::optional<Account> getAccountByNumber(const std::string& accountNumber) override;
+    std::vector<Account> getAccountsByUserId(int userId) override;
+    bool updateAccountStatus(int accountId, AccountStatus status) override;
+    bool deleteAccount(int accountId) override;
 
     // Transaction operations
-    bool deposit(int accountId, double amount, const std::string& description = "Deposit");
-    bool withdraw(int accountId, double amount, const std::string& description = "Withdrawal");
+    bool deposit(int accountId, double amount, const std::string& description = "Deposit") override;
+    bool withdraw(int accountId, double amount, const std::string& description = "Withdrawal") override;
     bool transfer(int fromAccountId, int toAccountId, double amount, 
-                  const std::string& description = "Transfer");
-    std::vector<Transaction> getTransactionHistory(int accountId, int limit = 50);
-    std::optional<Transaction> getTransactionById(int transactionId);
+                  const std::string& description = "Transfer") override;
+    std::vector<Transaction> getTransactionHistory(int accountId, int limit = 50) override;
+    std::optional<Transaction> getTransactionById(int transactionId) override;
+    std::vector<BalancePoint> getBalanceHistory(int accountId, int maxPoints = kBalanceHistoryPoints) override;
+    std::vector<Transaction> getTransactionsBetween(int accountId, Timestamp from, Timestamp to,
+                                                    int limit = kRangeLimit) override;
+    std::vector<ActivityTotal> getDailyTotals(int accountId, const TimeRange& range) override;
+    std::vector<ActivityTotal> getActivity(int accountId, TimeUnit unit, const TimeRange& range) override;
+    ActivityTotal getActivitySummary(int accountId, const TimeRange& range) override;
 
     // Utility operations
-    double getTotalBalance(int userId);
-    bool accountExists(const std::string& accountNumber);
+    double getTotalBalance(int userId) override;
+    bool accountExists(const std::string& accountNumber) override;
+    const std::deque<ServiceCall>& getRecentCalls() const override { return m_recentCalls; }
+
+    /**
+     * @brief Also record every outermost call in a process-wide registry
+     * @param metrics Registry shared with other services, or nullptr to stop
+     */
+    void setMetrics(std::shared_ptr<MetricsRegistry> metrics) { m_metrics = std::move(metrics); }
+
+    /**
+     * @brief Write an audit record for every change and login, and call timings at debug level
+     * @param logger Logger shared with other services, or nullptr to stop
+     */
+    void setLogger(std::shared_ptr<Logger> logger) { m_logger = std::move(logger); }
 
 private:
-    std::shared_ptr<Database> m_db;
+    /**
+     * @brief Records latency, database usage and allocations of the outermost service call
+     *
+     * While tracing, every call, nested or not, is also a trace span. The
+     * outermost call also makes m_arena the thread's request arena and
+     * releases it on return.
+     */
+    class CallScope {
+    public:
+        CallScope(BankService& service, const char* operation);
+        ~CallScope();
+
+        /**
+         * @brief Record whether the operation succeeded
+         *
+         * Set before returning by operations that can fail; a missing
+         * result counts as a failure. Lists and totals stay succeeded.
+         */
+        void setOk(bool ok) { m_ok = ok; }
+
+    private:
+        BankService& m_service;
+        const char* m_operation;
+        std::chrono::steady_clock::time_point m_start;
+        StoreStats m_storeStart;
+        bool m_ok;
+        alloc::Scope m_allocations;
+        RequestArena::Scope m_arenaScope;
+    };
+
+    std::shared_ptr<LedgerStore> m_store;
+    std::deque<ServiceCall> m_recentCalls;
+    std::shared_ptr<MetricsRegistry> m_metrics;
+    std::shared_ptr<Logger> m_logger;
+    int m_callDepth;
+    RequestArena m_arena;       // Statement parameters and rows of the running call
+
+    // Bodies of the audited operations
+    std::optional<Account> applyCreateAccount(int userId, AccountType type, double initialDeposit);
+    bool applyDeposit(int accountId, double amount, const std::string& description);
+    bool applyWithdrawal(int accountId, double amount, const std::string& description);
+    bool applyTransfer(int fromAccountId, int toAccountId, double amount, const std::string& description);
 
     // Helper methods
     bool recordTransaction(int accountId, TransactionType type, double amount,
@@ -0,0 +1,82 @@
+#ifndef BATCH_RUNNER_HPP
+#define BATCH_RUNNER_HPP
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include "Database.hpp"
+
+namespace bank {
+
+/**
+ * @brief Settings for a headless batch run
+ */
+struct BatchOptions {
+    std::string inputPath;
+    std::string outputPath;     // Empty writes results to stdout
+    int jobs = 1;               // Worker threads, each with its own connection
+    int batchSize = 1;          // Operations committed together
+};
+
+/**
+ * @brief Throughput and latency of a finished batch run
+ */
+struct BatchSummary {
+    std::size_t total = 0;
+    std::size_t succeeded = 0;
+    std::size_t failed = 0;
+    double seconds = 0.0;
+    double p50Millis = 0.0;
+    double p95Millis = 0.0;
+    double p99Millis = 0.0;
+    double maxMillis = 0.0;
+};
+
+/**
+ * @brief Executes a file of banking operations through BankService without a GUI
+ *
+ * The input is one operation per line, comma separated; blank lines and
+ * lines starting with '#' are skipped. Accounts may be given by id or by
+ * account number:
+ *
+ *   deposit,<account>,<amount>[,<description>]
+ *   withdraw,<account>,<amount>[,<description>]
+ *   transfer,<from account>,<to account>,<amount>[,<description>]
+ *   status,<account>,<active|inactive|frozen>
+ *   create_account,<user id>,<savings|checking|fixed_deposit>[,<initial deposit>]
+ *
+ * Operations are routed to workers by their (source) account, so the
+ * operations on one account run in file order. Each worker commits up to
+ * batchSize operations in one database transaction; a failing operation
+ * only rolls back its own savepoint. Results stream to the output as
+ * "<line>,<op>,<ok|failed|error>,<latency us>[,<detail>]".
+ */
+class BatchRunner {
+public:
+    using ConnectionFactory = std::function<std::shared_ptr<Database>()>;
+
+    BatchRunner(ConnectionFactory connect, BatchOptions options);
+
+    /**
+     * @brief Run the whole input file
+     * @return Summary, or nullopt if the input, output or a connection could not be opened
+     */
+    std::optional<BatchSummary> run();
+
+    /**
+     * @brief Get the reason run() returned nullopt
+     */
+    const std::string& getLastError() const { return m_lastError; }
+
+private:
+    ConnectionFactory m_connect;
+    BatchOptions m_options;
+    std::string m_lastError;
+};
+
+} // namespace bank
+
+#endif // BATCH_RUNNER_HPP
@@ -0,0 +1,71 @@
+#ifndef CACHING_LEDGER_STORE_HPP
+#define CACHING_LEDGER_STORE_HPP
+
+#include <memory>
+#include "AccountCache.hpp"
+#include "LedgerStore.hpp"
+
+namespace bank {
+
+/**
+ * @brief LedgerStore that answers account lookups from a shared AccountCache
+ *
+ * Everything else is forwarded to the wrapped store. Inside a scope reads
+ * bypass the cache, since they may see uncommitted changes; writes to an
+ * account invalidate its cache entry whether or not they succeed, and
+ * again when the scope commits.
+ */
+class CachingLedgerStore : public LedgerStore {
+public:
+    CachingLedgerStore(std::shared_ptr<LedgerStore> store, std::shared_ptr<AccountCache> cache);
+
+    bool begin() override;
+    bool commit() override;
+    bool rollback() override;
+
+    std::optional<int> insertUser(const User& user) override;
+    std::optional<User> findUserById(int userId) override;
+    std::optional<User> findUserByUsername(const std::string& username) override;
+    std::optional<std::pair<int, std::string>> findCredentials(const std::string& username) override;
+    bool updateUser(const User& user) override;
+    bool deleteUser(int userId) override;
+
+    std::optional<int> insertAccount(const Account& account) override;
+    std::optional<Account> findAccountById(int accountId) override;
+    std::optional<Account> findAccountByNumber(const std::string& accountNumber) override;
+    bool accountNumberExists(const std::string& accountNumber) override;
+    std::vector<Account> findAccountsByUser(int userId) override;
+    bool setAccountStatus(int accountId, AccountStatus status) override;
+    bool deleteAccount(int accountId) override;
+    std::vector<Account> lockAccounts(std::vector<int> accountIds) override;
+    std::optional<double> adjustBalance(int accountId, double delta) override;
+    double totalBalance(int userId) override;
+
+    bool appendTransaction(const Transaction& transaction) override;
+    std::vector<Transaction> scanHistory(int accountId, int limit) override;
+    std::optional<Transaction> findTransaction(int transactionId) override;
+    std::vector<Transaction> scanHistoryBetween(int accountId, const TimeRange& range, int limit) override;
+    std::vector<ActivityTotal> dailyTotals(int accountId, const TimeRange& range) override;
+    std::vector<ActivityTotal> rollups(int accountId, TimeUnit unit, const TimeRange& range) override;
+    ActivityTotal summarizeActivity(int accountId, const RangeCover& cover) override;
+    std::vector<BalancePoint> balanceHistory(int accountId, int maxPoints) override;
+
+    std::optional<DashboardData> loadDashboard(int userId, int historyLimit, int balancePoints) override;
+    std::optional<DashboardData> loadDashboardForLogin(const std::string& username, const std::string& passwordHash,
+                                                       int historyLimit, int balancePoints) override;
+
+    StoreStats getStats() const override { return m_store->getStats(); }
+    std::string getLastError() const override { return m_store->getLastError(); }
+
+private:
+    void touch(int accountId);
+
+    std::shared_ptr<LedgerStore> m_store;
+    std::shared_ptr<AccountCache> m_cache;
+    int m_scopeDepth;
+    std::vector<int> m_touched;     // Accounts written in the open scope
+};
+
+} // namespace bank
+
+#endif // CACHING_LEDGER_STORE_HPP
@@ -0,0 +1,104 @@
+#ifndef CONNECTION_POOL_HPP
+#define CONNECTION_POOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "AccountCache.hpp"
+#include "BankService.hpp"
+#include "Database.hpp"
+#include "Logger.hpp"
+#include "Metrics.hpp"
+
+namespace bank {
+
+/**
+ * @brief Fixed set of database connections shared by server workers
+ *
+ * Each connection comes with its own BankService, since neither class is
+ * thread safe. A worker leases one for the duration of a request; when
+ * all are leased, acquire() blocks until one is returned.
+ */
+class ConnectionPool {
+public:
+    using ConnectionFactory = std::function<std::shared_ptr<Database>()>;
+
+    class Lease;
+
+    /**
+     * @brief Create a pool
+     * @param connect Creates one unconnected database connection
+     * @param size Number of connections to keep open
+     * @param cache Account cache shared by all connections, or nullptr
+     * @param metrics Registry recording every connection's statements and calls, or nullptr
+     * @param logger Logger for every connection's audit records, or nullptr
+     */
+    ConnectionPool(ConnectionFactory connect, std::size_t size, 
+                   std::shared_ptr<AccountCache> cache = nullptr,
+                   std::shared_ptr<MetricsRegistry> metrics = nullptr,
+                   std::shared_ptr<Logger> logger = nullptr);
+
+    /**
+     * @brief Open every connection
+     * @return true if all connections were established
+     */
+    bool open();
+
+    /**
+     * @brief Lease a connection, waiting for one to become free
+     *
+     * A connection that was lost is re-established before it is handed out.
+     */
+    Lease acquire();
+
+    std::size_t size() const { return m_slots.size(); }
+    const std::string& getLastError() const { return m_lastError; }
+
+private:
+    struct Slot {
+        std::shared_ptr<Database> db;
+        std::unique_ptr<BankService> service;
+    };
+
+    void release(Slot* slot);
+
+    ConnectionFactory m_connect;
+    std::size_t m_size;
+    std::shared_ptr<AccountCache> m_cache;
+    std::shared_ptr<MetricsRegistry> m_metrics;
+    std::shared_ptr<Logger> m_logger;
+    std::vector<std::unique_ptr<Slot>> m_slots;
+    std::vector<Slot*> m_idle;
+    std::mutex m_mutex;
+    std::condition_variable m_available;
+    std::string m_lastError;
+};
+
+/**
+ * @brief A connection leased from a ConnectionPool, returned on destruction
+ */
+class ConnectionPool::Lease {
+public:
+    Lease(Lease&& other) noexcept;
+    Lease& operator=(Lease&&) = delete;
+    Lease(const Lease&) = delete;
+    Lease& operator=(const Lease&) = delete;
+    ~Lease();
+
+    BankService& service() { return *m_slot->service; }
+
+private:
+    friend class ConnectionPool;
+    Lease(ConnectionPool& pool, Slot* slot);
+
+    ConnectionPool& m_pool;
+    Slot* m_slot;
+};
+
+} // namespace bank
+
+#endif // CONNECTION_POOL_HPP
@@ -0,0 +1,150 @@
+#ifndef CORO_BANK_SERVICE_HPP
+#define CORO_BANK_SERVICE_HPP
+
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include "Account.hpp"
+#include "CoroDatabase.hpp"
+#include "CoroTask.hpp"
+#include "EventLoop.hpp"
+#include "Transaction.hpp"
+
+namespace bank {
+
+/**
+ * @brief Banking operations as coroutines over a set of CoroDatabase connections
+ *
+ * The coroutine counterpart of BankService on PostgreSQL, for callers
+ * that run on an EventLoop: each operation leases a connection, awaits
+ * its statements and returns it, so one thread can keep as many
+ * operations in flight as there are connections. Operations started
+ * while every connection is leased wait in line for the next one.
+ *
+ * Statements and results are those of BankService with a
+ * PostgresLedgerStore: money movements are one transaction each,
+ * balance checks happen in the database, and transfers lock both
+ * accounts in id order. Arguments are taken by value because they must
+ * outlive the caller's suspension. Use from the loop's thread only.
+ */
+class CoroBankService {
+public:
+    /**
+     * @brief Creates one unconnected connection on the given loop
+     */
+    using ConnectionFactory = std::function<std::unique_ptr<CoroDatabase>(EventLoop&)>;
+
+    class Lease;
+
+    CoroBankService(EventLoop& loop, ConnectionFactory connect, std::size_t connections);
+
+    /**
+     * @brief Open every connection
+     * @return true if all connections were established
+     */
+    Task<bool> open();
+
+    // User operations
+    Task<std::optional<int>> verifyCredentials(std::string username, std::string password);
+
+    // Account operations
+    Task<std::optional<Account>> getAccountById(int accountId);
+    Task<std::vector<Account>> getAccountsByUserId(int userId);
+
+    // Transaction operations
+    Task<bool> deposit(int accountId, double amount, std::string description = "Deposit");
+    Task<bool> withdraw(int accountId, double amount, std::string description = "Withdrawal");
+    Task<bool> transfer(int fromAccountId, int toAccountId, double amount,
+                        std::string description = "Transfer");
+    Task<std::vector<Transaction>> getTransactionHistory(int accountId, int limit = 50);
+
+    // Utility operations
+    Task<double> getTotalBalance(int userId);
+
+    std::size_t getConnectionCount() const { return m_connections.size(); }
+    std::size_t getWaitingCount() const { return m_waiters.size(); }
+    const std::string& getLastError() const { return m_lastError; }
+
+private:
+    /**
+     * @brief Lease a connection, waiting for one to become free
+     *
+     * A connection that was lost is re-established before it is handed
+     * out; the lease is empty if that fails.
+     */
+    Task<Lease> acquire();
+
+    /**
+     * @brief Awaitable taking an idle connection or queueing for one
+     */
+    struct IdleAwaiter {
+        CoroBankService& service;
+        CoroDatabase* db = nullptr;
+
+        bool await_ready();
+        void await_suspend(std::coroutine_handle<> handle);
+        CoroDatabase* await_resume() const noexcept { return db; }
+    };
+
+    struct Waiter {
+        std::coroutine_handle<> handle;
+        CoroDatabase** slot;        // Where the released connection is handed over
+    };
+
+    void release(CoroDatabase* db);
+
+    /**
+     * @brief Run a statement, keeping its error as the last error
+     *
+     * Callers build params in a named vector (see Task on GCC 12).
+     */
+    Task<QueryResult> run(CoroDatabase& db, std::string sql, std::vector<std::string> params = {});
+
+    Task<bool> begin(CoroDatabase& db);
+
+    /**
+     * @brief Commit if everything succeeded, otherwise roll back
+     */
+    Task<bool> finish(CoroDatabase& db, bool succeeded);
+
+    Task<std::optional<double>> adjustBalance(CoroDatabase& db, int accountId, double delta);
+    Task<bool> recordTransaction(CoroDatabase& db, int accountId, TransactionType type, double amount,
+                                 double balanceAfter, std::string description, int relatedAccountId = -1);
+
+    EventLoop& m_loop;
+    ConnectionFactory m_connect;
+    std::size_t m_size;
+    std::vector<std::unique_ptr<CoroDatabase>> m_connections;
+    std::vector<CoroDatabase*> m_idle;
+    std::deque<Waiter> m_waiters;
+    std::string m_lastError;
+};
+
+/**
+ * @brief A connection leased from a CoroBankService, returned on destruction
+ */
+class CoroBankService::Lease {
+public:
+    Lease(CoroBankService* service, CoroDatabase* db) : m_service(service), m_db(db) {}
+    Lease(Lease&& other) noexcept;
+    Lease& operator=(Lease&&) = delete;
+    Lease(const Lease&) = delete;
+    Lease& operator=(const Lease&) = delete;
+    ~Lease();
+
+    explicit operator bool() const { return m_db != nullptr; }
+    CoroDatabase& operator*() const { return *m_db; }
+
+private:
+    CoroBankService* m_service;
+    CoroDatabase* m_db;
+};
+
+} // namespace bank
+
+#endif // CORO_BANK_SERVICE_HPP
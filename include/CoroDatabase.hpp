@@ -0,0 +1,84 @@
+#ifndef CORO_DATABASE_HPP
+#define CORO_DATABASE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <libpq-fe.h>
+#include "CoroTask.hpp"
+#include "EventLoop.hpp"
+
+namespace bank {
+
+/**
+ * @brief Outcome of one statement sent by CoroDatabase
+ */
+struct QueryResult {
+    bool ok = false;
+    std::vector<std::vector<std::string>> rows;
+    int affected = 0;           // Rows affected (or returned)
+    std::string error;
+};
+
+/**
+ * @brief PostgreSQL connection driven by coroutines instead of blocking calls
+ *
+ * The counterpart of Database for an EventLoop: connect() and query()
+ * are awaited, and while the server works the loop runs other coroutines,
+ * so one thread can keep queries in flight on many connections. The
+ * socket is non-blocking; sending, flushing and reading results suspend
+ * on socket readiness rather than blocking in libpq.
+ *
+ * A connection runs one statement at a time; await each query before
+ * sending the next. Transactions are plain BEGIN/COMMIT/ROLLBACK queries.
+ */
+class CoroDatabase {
+public:
+    CoroDatabase(EventLoop& loop,
+                 const std::string& host,
+                 const std::string& port,
+                 const std::string& dbname,
+                 const std::string& user,
+                 const std::string& password);
+    ~CoroDatabase();
+
+    CoroDatabase(const CoroDatabase&) = delete;
+    CoroDatabase& operator=(const CoroDatabase&) = delete;
+
+    Task<bool> connect();
+    void disconnect();
+    bool isConnected() const;
+
+    /**
+     * @brief Send a parameterized statement and collect its result
+     */
+    Task<QueryResult> query(std::string sql, std::vector<std::string> params = {});
+
+    std::string getLastError() const { return m_lastError; }
+    std::uint64_t getStatementCount() const { return m_statements; }
+
+private:
+    /**
+     * @brief Wait until everything queued in libpq has been sent
+     */
+    Task<bool> flush();
+
+    /**
+     * @brief Wait until a result can be fetched without blocking
+     */
+    Task<bool> awaitResult();
+
+    bool fail(const std::string& message);
+
+    EventLoop& m_loop;
+    std::string m_conninfo;
+    PGconn* m_connection;
+    int m_socket;                   // Watched socket, forgotten on disconnect
+    bool m_busy;
+    std::uint64_t m_statements;
+    std::string m_lastError;
+};
+
+} // namespace bank
+
+#endif // CORO_DATABASE_HPP
@@ -4,10 +4,48 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <deque>
+#include <chrono>
+#include <functional>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstdint>
 #include <libpq-fe.h>
+#include "RequestArena.hpp"
 
 namespace bank {
 
+class MetricsRegistry;
+class SlowQueryLog;
+
+/**
+ * @brief Timing of a single statement sent to the server
+ */
+struct QueryRecord {
+    std::string_view statement;     // Short tag such as "SELECT accounts", owned by the Database
+    double millis;
+    int rows;
+    bool ok;
+};
+
+/**
+ * @brief A parameterized statement to send as part of a pipeline
+ */
+struct PipelinedQuery {
+    std::string query;
+    std::vector<std::string> params;
+};
+
+/**
+ * @brief Cumulative counters over every statement sent on a connection
+ */
+struct QueryStats {
+    std::uint64_t statements = 0;
+    std::uint64_t rows = 0;
+    double millis = 0.0;
+};
+
 /**
  * @brief Database connection wrapper for PostgreSQL
  */
@@ -68,6 +106,13 @@ public:
      */
     bool executeParams(const std::string& query, const std::vector<std::string>& params);
 
+    /**
+     * @brief Execute a query with parameters built in a request arena
+     *
+     * The libpq value array comes from the parameters' arena as well.
+     */
+    bool executeParams(const std::string& query, const ArenaParams& params);
+
     /**
      * @brief Execute a query and return results
      * @param query SQL query to execute
@@ -84,6 +129,59 @@ public:
     std::vector<std::vector<std::string>> queryParams(const std::string& query, 
                                                        const std::vector<std::string>& params);
 
+    /**
+     * @brief Execute a parameterized query, reading the rows into an arena
+     *
+     * For results that are decoded before the request ends, so neither the
+     * rows nor the libpq value array touch the heap while the arena lasts.
+     *
+     * @param arena Memory for the rows, usually requestArena()
+     */
+    ArenaRows queryParams(const std::string& query, const ArenaParams& params,
+                          std::pmr::memory_resource* arena);
+
+    /**
+     * @brief Execute a named prepared statement, preparing it on first use
+     *
+     * Each connection prepares a name once; later calls only send the
+     * parameters. Names must be string literals (they are kept by
+     * pointer) and always name the same query text.
+     *
+     * @param name Statement name, unique per query text
+     * @param query SQL with $1, $2, etc. placeholders
+     * @param values Text of each parameter
+     * @param read Called with the result when the statement succeeds
+     * @return true if successful
+     */
+    bool executePrepared(const char* name, const char* query, const char* const* values, int count,
+                         const std::function<void(const PGresult*)>& read = nullptr);
+
+    /**
+     * @brief Execute several parameterized queries in a single round trip
+     *
+     * Uses libpq pipeline mode where available, so all statements are sent
+     * before any result is read. Falls back to sequential execution with
+     * older client libraries.
+     *
+     * @param queries Statements to send, in order
+     * @return One result set per statement, or an empty vector if any failed
+     */
+    std::vector<std::vector<std::vector<std::string>>> queryPipelined(
+        const std::vector<PipelinedQuery>& queries);
+
+    /**
+     * @brief Bulk load rows with COPY FROM STDIN
+     *
+     * Much faster than individual INSERTs for seeding large tables.
+     *
+     * @param table Target table
+     * @param columns Comma separated column list
+     * @param data Rows in COPY text format: tab separated, newline terminated,
+     *             with backslash, tab and newline in values escaped
+     * @return true if every row was loaded
+     */
+    bool copyIn(const std::string& table, const std::string& columns, const std::string& data);
+
     /**
      * @brief Get the last error message
      * @return Error message string
@@ -92,23 +190,70 @@ public:
 
     /**
      * @brief Begin a transaction
+     *
+     * Calls may nest: inner levels are savepoints, so an inner rollback
+     * only undoes its own work and only the outermost commit is durable.
+     *
      * @return true if successful
      */
     bool beginTransaction();
 
     /**
-     * @brief Commit a transaction
+     * @brief Commit a transaction (or release the innermost savepoint)
      * @return true if successful
      */
     bool commitTransaction();
 
     /**
-     * @brief Rollback a transaction
+     * @brief Rollback a transaction (or roll back to the innermost savepoint)
      * @return true if successful
      */
     bool rollbackTransaction();
 
+    /**
+     * @brief Get the current transaction nesting depth
+     * @return 0 outside a transaction
+     */
+    int getTransactionDepth() const { return m_transactionDepth; }
+
+    /**
+     * @brief Get cumulative statement counters for this connection
+     * @return Statement count, rows returned and time spent waiting on the server
+     */
+    const QueryStats& getQueryStats() const { return m_queryStats; }
+
+    /**
+     * @brief Get the most recent statements, newest last
+     * @return Up to kRecentQueryLimit records
+     */
+    const std::deque<QueryRecord>& getRecentQueries() const { return m_recentQueries; }
+
+    static constexpr std::size_t kRecentQueryLimit = 32;
+
+    /**
+     * @brief Also record every statement in a process-wide registry
+     * @param metrics Registry shared with other connections, or nullptr to stop
+     */
+    void setMetrics(std::shared_ptr<MetricsRegistry> metrics) { m_metrics = std::move(metrics); }
+
+    /**
+     * @brief Report statements slower than the log's threshold to it
+     * @param log Log shared with other connections, or nullptr to stop
+     */
+    void setSlowQueryLog(std::shared_ptr<SlowQueryLog> log) { m_slowQueries = std::move(log); }
+
 private:
+    bool executeValues(const std::string& query, const char* const* values, int count);
+
+    template <typename Read>
+    void queryValues(const std::string& query, const char* const* values, int count, Read&& read);
+
+    bool prepare(const char* name, const char* query, int count);
+    const std::string& internTag(std::string_view query);
+    void recordQuery(std::string_view query, const std::string& tag,
+                     std::chrono::steady_clock::time_point start, int rows, bool ok,
+                     const char* const* values = nullptr, int count = 0);
+
     std::string m_host;
     std::string m_port;
     std::string m_dbname;
@@ -116,6 +261,13 @@ private:
     std::string m_password;
     PGconn* m_connection;
     std::string m_lastError;
+    int m_transactionDepth;
+    QueryStats m_queryStats;
+    std::deque<QueryRecord> m_recentQueries;
+    std::shared_ptr<MetricsRegistry> m_metrics;
+    std::shared_ptr<SlowQueryLog> m_slowQueries;
+    std::unordered_map<std::string_view, const std::string*> m_prepared;  // Prepared names to their tag
+    std::unordered_set<std::string> m_tags;             // Every statement tag seen; records point into it
 };
 
 } // namespace bank
@@ -0,0 +1,26 @@
+#ifndef DOWNSAMPLE_HPP
+#define DOWNSAMPLE_HPP
+
+#include <cstddef>
+#include <vector>
+#include "Transaction.hpp"
+
+namespace bank {
+
+/**
+ * @brief Reduce a time series with the Largest-Triangle-Three-Buckets algorithm
+ *
+ * Keeps the first and last points and, for every bucket in between, the point
+ * forming the largest triangle with its neighbours, which preserves the visual
+ * shape of the series far better than averaging or striding.
+ *
+ * @param points Samples ordered by timestamp
+ * @param threshold Maximum number of points to return
+ * @return Downsampled series (the input unchanged if already small enough)
+ */
+std::vector<BalancePoint> downsampleLTTB(const std::vector<BalancePoint>& points,
+                                         std::size_t threshold);
+
+} // namespace bank
+
+#endif // DOWNSAMPLE_HPP
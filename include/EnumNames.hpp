@@ -0,0 +1,50 @@
+#ifndef ENUM_NAMES_HPP
+#define ENUM_NAMES_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <string_view>
+
+namespace bank {
+
+/**
+ * @brief Spelling of every enumerator, as stored in the database
+ *
+ * Specializations provide `static constexpr std::string_view names[]`,
+ * indexed by the enumerator's value, so enumerators must be numbered from
+ * zero without gaps. The first name doubles as the fallback for unknown
+ * text, which is what the old if/else parsers returned.
+ */
+template <typename E>
+struct EnumNames;
+
+template <typename E>
+constexpr std::string_view enumName(E value) {
+    const auto& names = EnumNames<E>::names;
+    auto index = static_cast<std::size_t>(value);
+    return index < std::size(names) ? names[index] : names[0];
+}
+
+/**
+ * @brief Enumerator spelled name, or nullopt for unknown text
+ */
+template <typename E>
+constexpr std::optional<E> findEnum(std::string_view name) {
+    const auto& names = EnumNames<E>::names;
+    for (std::size_t i = 0; i < std::size(names); ++i) {
+        if (names[i] == name) {
+            return static_cast<E>(i);
+        }
+    }
+    return std::nullopt;
+}
+
+template <typename E>
+constexpr E enumFromName(std::string_view name) {
+    return findEnum<E>(name).value_or(static_cast<E>(0));
+}
+
+} // namespace bank
+
+#endif // ENUM_NAMES_HPP
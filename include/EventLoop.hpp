@@ -0,0 +1,117 @@
+#ifndef EVENT_LOOP_HPP
+#define EVENT_LOOP_HPP
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include "CoroTask.hpp"
+
+namespace bank {
+
+/**
+ * @brief Single-threaded epoll loop that resumes coroutines on socket readiness
+ *
+ * Coroutines suspend with co_await readable(fd) / writable(fd) and are
+ * resumed by run() once the socket is ready. Only one coroutine may wait
+ * on a given socket at a time, which is the case for a connection used
+ * by one query at a time. Not thread safe: create, spawn and run on one
+ * thread.
+ */
+class EventLoop {
+public:
+    EventLoop();
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    bool isValid() const { return m_epoll >= 0; }
+
+    /**
+     * @brief Start a task; the loop owns it until it finishes
+     *
+     * The task runs up to its first suspension before spawn() returns.
+     * Exceptions escaping a spawned task terminate the program.
+     */
+    void spawn(Task<void> task);
+
+    /**
+     * @brief Resume coroutines until every spawned task has finished
+     * @return false if a task is stuck (nothing to wait for) or epoll failed
+     */
+    bool run();
+
+    /**
+     * @brief Awaitable resuming the coroutine when the socket is ready
+     */
+    class ReadinessAwaiter {
+    public:
+        ReadinessAwaiter(EventLoop& loop, int fd, std::uint32_t events)
+            : m_loop(loop)
+            , m_fd(fd)
+            , m_events(events)
+            , m_ok(true)
+        {
+        }
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> handle);
+
+        /**
+         * @return false if the socket could not be watched
+         */
+        bool await_resume() const noexcept { return m_ok; }
+
+    private:
+        EventLoop& m_loop;
+        int m_fd;
+        std::uint32_t m_events;
+        bool m_ok;
+    };
+
+    ReadinessAwaiter readable(int fd);
+    ReadinessAwaiter writable(int fd);
+    ReadinessAwaiter readableOrWritable(int fd);
+
+    /**
+     * @brief Awaitable that lets the other ready coroutines run first
+     */
+    struct YieldAwaiter {
+        EventLoop& loop;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) { loop.post(handle); }
+        void await_resume() const noexcept {}
+    };
+
+    YieldAwaiter yield() { return YieldAwaiter{*this}; }
+
+    /**
+     * @brief Resume a suspended coroutine from run(), after the current one suspends
+     */
+    void post(std::coroutine_handle<> handle);
+
+    /**
+     * @brief Stop watching a socket that is about to be closed
+     */
+    void forget(int fd);
+
+    std::size_t getWaitingCount() const { return m_waiting; }
+    const std::string& getLastError() const { return m_lastError; }
+
+private:
+    bool watch(int fd, std::uint32_t events, std::coroutine_handle<> handle);
+
+    int m_epoll;
+    std::unordered_map<int, std::coroutine_handle<>> m_waiters;     // By socket
+    std::deque<std::coroutine_handle<>> m_ready;
+    std::size_t m_waiting;
+    std::size_t m_running;                                          // Spawned tasks not finished
+    std::string m_lastError;
+};
+
+} // namespace bank
+
+#endif // EVENT_LOOP_HPP
@@ -2,11 +2,20 @@
 #define GUI_HPP
 
 #include <SFML/Graphics.hpp>
+#include <array>
 #include <memory>
 #include <string>
 #include <vector>
 #include <functional>
-#include "BankService.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include "BankApi.hpp"
+#include "InputRecorder.hpp"
+#include "MappedFile.hpp"
+#include "PerfStats.hpp"
 #include "User.hpp"
 #include "Account.hpp"
 
@@ -27,6 +36,39 @@ enum class AppState {
     Settings
 };
 
+/**
+ * @brief Text input fields, created the first time a screen needs them
+ */
+enum class InputField {
+    Username,
+    Password,
+    ConfirmPassword,
+    FullName,
+    Email,
+    Phone,
+    Amount,
+    TargetAccount,
+    Description,
+    Count
+};
+
+/**
+ * @brief Get a display name for a screen
+ */
+const char* appStateName(AppState state);
+
+/**
+ * @brief Frame time distribution of one screen during a replay
+ */
+struct ScreenFrameStats {
+    AppState screen;
+    size_t frames;
+    double p50;
+    double p95;
+    double p99;
+    double max;
+};
+
 /**
  * @brief Simple button class for SFML GUI
  */
@@ -35,7 +77,7 @@ public:
     Button(float x, float y, float width, float height, 
            const std::string& text, const sf::Font& font);
 
-    void render(sf::RenderWindow& window);
+    void render(sf::RenderTarget& target);
     bool isClicked(const sf::Vector2i& mousePos);
     void setEnabled(bool enabled) { m_enabled = enabled; }
     bool isEnabled() const { return m_enabled; }
@@ -55,7 +97,7 @@ public:
               const std::string& placeholder, const sf::Font& font,
               bool isPassword = false);
 
-    void render(sf::RenderWindow& window);
+    void render(sf::RenderTarget& target);
     void handleEvent(const sf::Event& event);
     std::string getText() const { return m_text; }
     void setText(const std::string& text) { m_text = text; }
@@ -75,6 +117,68 @@ private:
     sf::Clock m_cursorClock;
 };
 
+/**
+ * @brief Line chart of an account balance over time
+ *
+ * The history is fetched and downsampled to the chart width on a worker
+ * thread and drawn as a single vertex array, so drawing costs one draw
+ * call no matter how long the account history is. Each load is tagged
+ * with its account, and a result that arrives after the chart moved on
+ * to another account (or was cleared) is dropped.
+ */
+class BalanceChart {
+public:
+    using Fetch = std::function<std::vector<BalancePoint>()>;
+
+    BalanceChart(float x, float y, float width, float height);
+    ~BalanceChart();
+
+    BalanceChart(const BalanceChart&) = delete;
+    BalanceChart& operator=(const BalanceChart&) = delete;
+
+    /**
+     * @brief Show a history that is already loaded
+     */
+    void setSeries(int accountId, std::vector<BalancePoint> points);
+
+    /**
+     * @brief Fetch and show the history of an account on the worker thread
+     * @param fetch Called on the worker; must be safe to run off the UI thread
+     */
+    void load(int accountId, Fetch fetch);
+
+    void clear();
+    void render(sf::RenderTarget& target);
+
+private:
+    struct Request {
+        int accountId;
+        std::uint64_t generation;
+        Fetch fetch;
+    };
+
+    struct Result {
+        int accountId;
+        std::uint64_t generation;
+        std::vector<BalancePoint> points;
+    };
+
+    void work();
+    void rebuildVertices(const std::vector<BalancePoint>& points);
+
+    sf::FloatRect m_bounds;
+    sf::VertexArray m_vertices;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::optional<Request> m_request;       // Latest load not yet picked up by the worker
+    std::optional<Result> m_result;         // Latest finished load not yet drawn
+    std::uint64_t m_generation;             // Bumped by every load and clear
+    int m_accountId;                        // Account of the latest load, -1 when cleared
+    bool m_stopping;
+    std::thread m_worker;                   // Started last, after the state it uses
+};
+
 /**
  * @brief Main GUI application class
  */
@@ -83,33 +187,102 @@ public:
     /**
      * @brief Construct a new Bank GUI object
      * @param service Shared pointer to bank service
+     * @param headless Render into an off-screen texture instead of a window
      */
-    explicit BankGUI(std::shared_ptr<BankService> service);
+    explicit BankGUI(std::shared_ptr<BankApi> service, bool headless = false);
 
     /**
      * @brief Run the GUI application
      */
     void run();
 
+    /**
+     * @brief Record every input event of the interactive session to a file
+     * @param path Session file to write
+     * @return true if the file could be opened
+     */
+    bool startRecording(const std::string& path);
+
+    /**
+     * @brief Let F4 write the trace recorded so far to a file
+     * @param path Chrome trace file, overwritten on every F4
+     */
+    void setTraceFile(const std::string& path) { m_tracePath = path; }
+
+    /**
+     * @brief Load balance charts through a service of their own
+     *
+     * The chart worker thread then fetches histories while the UI keeps
+     * using the main service, each on its own connection. Without one,
+     * histories are fetched on the UI thread and only downsampled on the
+     * worker.
+     *
+     * @param service Connected service not used by anything else
+     */
+    void setChartService(std::shared_ptr<BankApi> service) { m_chartService = std::move(service); }
+
+    /**
+     * @brief Replay a recorded session as fast as possible
+     *
+     * Each recorded frame is reproduced: its events are handled and the
+     * current screen is rendered, timing the frame against that screen.
+     *
+     * @param session Session loaded with InputSession::load
+     * @return Frame time distribution per screen visited
+     */
+    std::vector<ScreenFrameStats> replay(const InputSession& session);
+
+    /**
+     * @brief Time spent creating the window and loading the font
+     */
+    double getWindowMillis() const { return m_windowMillis; }
+    double getFontMillis() const { return m_fontMillis; }
+
 private:
     // Window and rendering
     sf::RenderWindow m_window;
+    sf::RenderTexture m_offscreen;
+    sf::RenderTarget* m_target;
+    bool m_headless;
+    MappedFile m_fontFile;
     sf::Font m_font;
-    std::shared_ptr<BankService> m_service;
+    double m_windowMillis;
+    double m_fontMillis;
+    std::shared_ptr<BankApi> m_service;
+    std::shared_ptr<BankApi> m_chartService;    // Used only by the balance chart worker
 
     // Application state
     AppState m_currentState;
     std::optional<User> m_currentUser;
     std::vector<Account> m_userAccounts;
+    double m_totalBalance;
     int m_selectedAccountIndex;
     std::string m_statusMessage;
     sf::Color m_statusColor;
 
     // Screen-specific data
     std::vector<Transaction> m_transactions;
+    int m_transactionsAccountId;
+    BalanceChart m_balanceChart;
+    int m_chartAccountId;
+
+    // Performance HUD (toggled with F3)
+    bool m_showPerfHud;
+    sf::Clock m_frameClock;
+    SampleWindow m_frameTimes;
+    unsigned int m_drawCalls;
+    unsigned int m_lastFrameDrawCalls;
+
+    // Input recording
+    InputRecorder m_recorder;
+    std::uint64_t m_frameNumber;
+
+    // Trace written with F4
+    std::string m_tracePath;
 
     // Event handling
     void handleEvents();
+    void processEvent(const sf::Event& event);
     void handleLoginEvents(const sf::Event& event);
     void handleRegisterEvents(const sf::Event& event);
     void handleDashboardEvents(const sf::Event& event);
@@ -129,25 +302,28 @@ private:
     void renderWithdraw();
     void renderTransfer();
     void renderTransactionHistory();
+    void renderPerfHud();
+
+    // Drawing helpers that keep the per-frame draw call count
+    void draw(const sf::Drawable& drawable);
+    void draw(Button& button);
+    void draw(TextInput& input);
+    void draw(BalanceChart& chart);
 
     // Helper methods
+    void loadFont();
+    TextInput& input(InputField field);
     void showStatus(const std::string& message, bool isError = false);
     void clearInputs();
     void refreshAccounts();
+    void applyDashboard(DashboardData dashboard);
+    void refreshBalanceChart();
     void logout();
     void drawCenteredText(const std::string& text, float y, unsigned int size, 
                           sf::Color color = sf::Color::White);
 
-    // Input fields for different screens
-    std::unique_ptr<TextInput> m_usernameInput;
-    std::unique_ptr<TextInput> m_passwordInput;
-    std::unique_ptr<TextInput> m_confirmPasswordInput;
-    std::unique_ptr<TextInput> m_fullNameInput;
-    std::unique_ptr<TextInput> m_emailInput;
-    std::unique_ptr<TextInput> m_phoneInput;
-    std::unique_ptr<TextInput> m_amountInput;
-    std::unique_ptr<TextInput> m_targetAccountInput;
-    std::unique_ptr<TextInput> m_descriptionInput;
+    // Input fields for different screens, indexed by InputField
+    std::array<std::unique_ptr<TextInput>, static_cast<size_t>(InputField::Count)> m_inputs;
 
     // Current focused input
     TextInput* m_focusedInput;
@@ -0,0 +1,76 @@
+#ifndef INPUT_RECORDER_HPP
+#define INPUT_RECORDER_HPP
+
+#include <SFML/Window.hpp>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace bank {
+
+class BankApi;
+
+/**
+ * @brief An input event captured during a GUI session
+ */
+struct RecordedEvent {
+    std::uint64_t frame;    // Frame in which the event was handled
+    double millis;          // Time since recording started
+    sf::Event event;
+};
+
+/**
+ * @brief A recorded GUI session that can be replayed frame by frame
+ */
+struct InputSession {
+    std::vector<RecordedEvent> events;
+    std::uint64_t frameCount = 0;
+
+    /**
+     * @brief Load a session written by InputRecorder
+     * @param path Session file
+     * @return Session, or nullopt if the file is missing or malformed
+     */
+    static std::optional<InputSession> load(const std::string& path);
+};
+
+/**
+ * @brief Serializes input events with frame numbers and timestamps
+ *
+ * The file is line oriented text: a header, one line per event
+ * ("<frame> <ms> <type> <fields...>") and a trailing "end <frames>".
+ */
+class InputRecorder {
+public:
+    InputRecorder() = default;
+    ~InputRecorder();
+
+    bool open(const std::string& path);
+    bool isRecording() const { return m_out.is_open(); }
+
+    void record(const sf::Event& event, std::uint64_t frame);
+    void finish(std::uint64_t frameCount);
+
+private:
+    std::ofstream m_out;
+    std::uint64_t m_lastFrame = 0;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+/**
+ * @brief Populate a throwaway database with the deterministic replay fixture
+ *
+ * Creates user "replay" (password "replay123") with a savings and a checking
+ * account and a fixed, seeded sequence of transactions. Does nothing if the
+ * user already exists, so recordings and replays see the same data.
+ *
+ * @return true if the fixture is present afterwards
+ */
+bool seedReplayFixture(BankApi& service);
+
+} // namespace bank
+
+#endif // INPUT_RECORDER_HPP
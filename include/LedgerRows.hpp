@@ -0,0 +1,38 @@
+#ifndef LEDGER_ROWS_HPP
+#define LEDGER_ROWS_HPP
+
+#include <string>
+#include <vector>
+#include "User.hpp"
+#include "Account.hpp"
+#include "Transaction.hpp"
+#include "RequestArena.hpp"
+
+namespace bank {
+
+// Column lists shared by every query that decodes the corresponding model
+inline constexpr char kUserColumns[] =
+    "user_id, username, password_hash, full_name, email, phone";
+inline constexpr char kAccountColumns[] =
+    "account_id, user_id, account_number, account_type, balance, interest_rate, status";
+inline constexpr char kTransactionColumns[] =
+    "transaction_id, account_id, transaction_type, amount, balance_after, "
+    "description, related_account_id, created_at";
+
+/**
+ * @brief Decode a row selected with the matching column list
+ */
+User userFromRow(const std::vector<std::string>& row);
+Account accountFromRow(const std::vector<std::string>& row);
+Transaction transactionFromRow(const std::vector<std::string>& row);
+
+/**
+ * @brief Decode a row read into a request arena; the models own their strings
+ */
+User userFromRow(const ArenaRow& row);
+Account accountFromRow(const ArenaRow& row);
+Transaction transactionFromRow(const ArenaRow& row);
+
+} // namespace bank
+
+#endif // LEDGER_ROWS_HPP
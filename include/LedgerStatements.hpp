@@ -0,0 +1,241 @@
+#ifndef LEDGER_STATEMENTS_HPP
+#define LEDGER_STATEMENTS_HPP
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include "Account.hpp"
+#include "LedgerRows.hpp"
+#include "Statement.hpp"
+#include "Timestamp.hpp"
+#include "Transaction.hpp"
+
+namespace bank {
+
+/**
+ * @brief The fixed statements of PostgresLedgerStore
+ *
+ * Each declaration is checked at compile time against its Params and
+ * Columns. Queries whose text depends on the request (lockAccounts' IN
+ * list) build their SQL at run time from the same column lists.
+ */
+namespace ledger {
+
+using UserColumns = sql::Columns<int, std::string, std::string, std::string, std::string, std::string>;
+using AccountColumns = sql::Columns<int, int, std::string_view, AccountType, double, double, AccountStatus>;
+using TransactionColumns = sql::Columns<int, int, TransactionType, double, double, std::string,
+                                        std::optional<int>, Timestamp>;
+
+// Bucketed balance history around the SQL expression selecting the account
+// id. NTILE yields one row per transaction when the history is shorter than
+// the bucket count ($2), otherwise each bucket is reduced to its closing balance.
+inline constexpr char kBalanceHistoryHead[] =
+    "SELECT MAX(t), (ARRAY_AGG(balance_after ORDER BY t DESC, transaction_id DESC))[1] "
+    "FROM (SELECT EXTRACT(EPOCH FROM created_at) AS t, balance_after, transaction_id, "
+    "NTILE($2) OVER (ORDER BY created_at, transaction_id) AS bucket "
+    "FROM transactions WHERE account_id = ";
+inline constexpr char kBalanceHistoryTail[] =
+    ") buckets GROUP BY bucket ORDER BY bucket";
+
+// Users
+
+inline constexpr auto kInsertUser = sql::statement<
+    sql::Params<std::string, std::string, std::string, std::string, std::string>, sql::Columns<int>>(
+    "insert_user",
+    "INSERT INTO users (username, password_hash, full_name, email, phone) "
+    "VALUES ($1, $2, $3, $4, $5) RETURNING user_id");
+
+inline constexpr auto kFindUserById = sql::statement<sql::Params<int>, UserColumns>(
+    "find_user_by_id", "SELECT ", kUserColumns, " FROM users WHERE user_id = $1");
+
+inline constexpr auto kFindUserByUsername = sql::statement<sql::Params<std::string>, UserColumns>(
+    "find_user_by_username", "SELECT ", kUserColumns, " FROM users WHERE username = $1");
+
+inline constexpr auto kFindCredentials = sql::statement<sql::Params<std::string>, sql::Columns<int, std::string>>(
+    "find_credentials", "SELECT user_id, password_hash FROM users WHERE username = $1");
+
+inline constexpr auto kUpdateUser = sql::statement<
+    sql::Params<std::string, std::string, std::string, std::string, int>, sql::Columns<>>(
+    "update_user",
+    "UPDATE users SET username = $1, full_name = $2, email = $3, phone = $4 "
+    "WHERE user_id = $5");
+
+inline constexpr auto kDeleteUser = sql::statement<sql::Params<int>, sql::Columns<>>(
+    "delete_user", "DELETE FROM users WHERE user_id = $1");
+
+// Accounts
+
+inline constexpr auto kInsertAccount = sql::statement<
+    sql::Params<int, std::string, AccountType, double, double>, sql::Columns<int>>(
+    "insert_account",
+    "INSERT INTO accounts (user_id, account_number, account_type, balance, interest_rate) "
+    "VALUES ($1, $2, $3, $4, $5) RETURNING account_id");
+
+inline constexpr auto kFindAccountById = sql::statement<sql::Params<int>, AccountColumns>(
+    "find_account_by_id", "SELECT ", kAccountColumns, " FROM accounts WHERE account_id = $1");
+
+inline constexpr auto kFindAccountByNumber = sql::statement<sql::Params<std::string>, AccountColumns>(
+    "find_account_by_number", "SELECT ", kAccountColumns, " FROM accounts WHERE account_number = $1");
+
+inline constexpr auto kAccountNumberExists = sql::statement<sql::Params<std::string>, sql::Columns<int>>(
+    "account_number_exists", "SELECT 1 FROM accounts WHERE account_number = $1");
+
+inline constexpr auto kFindAccountsByUser = sql::statement<sql::Params<int>, AccountColumns>(
+    "find_accounts_by_user",
+    "SELECT ", kAccountColumns, " FROM accounts WHERE user_id = $1 ORDER BY created_at");
+
+inline constexpr auto kSetAccountStatus = sql::statement<sql::Params<AccountStatus, int>, sql::Columns<>>(
+    "set_account_status", "UPDATE accounts SET status = $1 WHERE account_id = $2");
+
+inline constexpr auto kDeleteAccount = sql::statement<sql::Params<int>, sql::Columns<>>(
+    "delete_account", "DELETE FROM accounts WHERE account_id = $1");
+
+// Applied in the database so concurrent clients cannot lose updates; for
+// debits the balance check is part of the update so it holds as well
+inline constexpr auto kCreditBalance = sql::statement<sql::Params<double, int>, sql::Columns<double>>(
+    "credit_balance",
+    "UPDATE accounts SET balance = balance + $1 "
+    "WHERE account_id = $2 AND status = 'active' RETURNING balance");
+
+inline constexpr auto kDebitBalance = sql::statement<sql::Params<double, int>, sql::Columns<double>>(
+    "debit_balance",
+    "UPDATE accounts SET balance = balance - $1 "
+    "WHERE account_id = $2 AND status = 'active' AND balance >= $1 RETURNING balance");
+
+inline constexpr auto kTotalBalance = sql::statement<sql::Params<int>, sql::Columns<double>>(
+    "total_balance", "SELECT COALESCE(SUM(balance), 0) FROM accounts WHERE user_id = $1");
+
+// The account cache's delta refresh; timestamps stay text, as the cache stores them
+inline constexpr auto kLocalTimestamp = sql::statement<sql::Params<>, sql::Columns<std::string>>(
+    "local_timestamp", "SELECT LOCALTIMESTAMP::text");
+
+inline constexpr auto kFindAccountsUpdatedSince = sql::statement<sql::Params<std::string, int>, AccountColumns>(
+    "find_accounts_updated_since",
+    "SELECT ", kAccountColumns, " FROM accounts "
+    "WHERE updated_at >= $1::timestamp - make_interval(secs => $2)");
+
+// Transactions
+
+// Separate statements so a missing related account is stored as NULL
+inline constexpr auto kInsertTransaction = sql::statement<
+    sql::Params<int, TransactionType, double, double, std::string>, sql::Columns<>>(
+    "insert_transaction",
+    "INSERT INTO transactions (account_id, transaction_type, amount, "
+    "balance_after, description) VALUES ($1, $2, $3, $4, $5)");
+
+inline constexpr auto kInsertRelatedTransaction = sql::statement<
+    sql::Params<int, TransactionType, double, double, std::string, int>, sql::Columns<>>(
+    "insert_related_transaction",
+    "INSERT INTO transactions (account_id, transaction_type, amount, "
+    "balance_after, description, related_account_id) "
+    "VALUES ($1, $2, $3, $4, $5, $6)");
+
+inline constexpr auto kScanHistory = sql::statement<sql::Params<int, int>, TransactionColumns>(
+    "scan_history",
+    "SELECT ", kTransactionColumns, " FROM transactions WHERE account_id = $1 "
+    "ORDER BY created_at DESC LIMIT $2");
+
+inline constexpr auto kFindTransaction = sql::statement<sql::Params<int>, TransactionColumns>(
+    "find_transaction",
+    "SELECT ", kTransactionColumns, " FROM transactions WHERE transaction_id = $1");
+
+// Both use idx_transactions_account_created; the totals are an index-only scan
+inline constexpr auto kScanHistoryBetween = sql::statement<
+    sql::Params<int, Timestamp, Timestamp, int>, TransactionColumns>(
+    "scan_history_between",
+    "SELECT ", kTransactionColumns, " FROM transactions "
+    "WHERE account_id = $1 AND created_at >= $2 AND created_at < $3 "
+    "ORDER BY created_at, transaction_id LIMIT $4");
+
+inline constexpr auto kDailyTotals = sql::statement<
+    sql::Params<int, Timestamp, Timestamp>, sql::Columns<Timestamp, double, double, int, double>>(
+    "daily_totals",
+    "SELECT date_trunc('day', created_at), "
+    "COALESCE(SUM(amount) FILTER (WHERE transaction_type IN ('deposit', 'transfer_in')), 0), "
+    "COALESCE(SUM(amount) FILTER (WHERE transaction_type IN ('withdrawal', 'transfer_out')), 0), "
+    "COUNT(*), (ARRAY_AGG(balance_after ORDER BY created_at DESC, transaction_id DESC))[1] "
+    "FROM transactions WHERE account_id = $1 AND created_at >= $2 AND created_at < $3 "
+    "GROUP BY 1 ORDER BY 1");
+
+// account_rollups is kept up to date by a trigger on transactions (see sql/schema.sql)
+inline constexpr auto kRollups = sql::statement<
+    sql::Params<int, TimeUnit, Timestamp, Timestamp>, sql::Columns<Timestamp, double, double, int, double>>(
+    "rollups",
+    "SELECT bucket_start, credits, debits, transaction_count, closing_balance FROM account_rollups "
+    "WHERE account_id = $1 AND time_unit = $2 AND bucket_start >= $3 AND bucket_start < $4 "
+    "ORDER BY bucket_start");
+
+// The pieces of a RangeCover in one round trip: months, days, hours from the
+// rollups, the sub-hour ends from the transactions. The piece with the
+// latest (created_at, transaction_id) carries the closing balance; for a
+// rollup that is the last_at and last_id of its closing transaction.
+inline constexpr auto kSummarizeActivity = sql::statement<
+    sql::Params<int, Timestamp, Timestamp, Timestamp, Timestamp, Timestamp, Timestamp, Timestamp, Timestamp,
+                Timestamp, Timestamp, Timestamp, Timestamp, Timestamp, Timestamp>,
+    sql::Columns<double, double, int, std::optional<double>>>(
+    "summarize_activity",
+    "SELECT COALESCE(SUM(credits), 0), COALESCE(SUM(debits), 0), COALESCE(SUM(n), 0), "
+    "(ARRAY_AGG(closing_balance ORDER BY t DESC, id DESC))[1] "
+    "FROM (SELECT last_at AS t, last_id AS id, transaction_count AS n, credits, debits, closing_balance "
+    "FROM account_rollups WHERE account_id = $1 AND ("
+    "time_unit = 'month' AND bucket_start >= $2 AND bucket_start < $3 "
+    "OR time_unit = 'day' AND (bucket_start >= $4 AND bucket_start < $5 "
+    "OR bucket_start >= $6 AND bucket_start < $7) "
+    "OR time_unit = 'hour' AND (bucket_start >= $8 AND bucket_start < $9 "
+    "OR bucket_start >= $10 AND bucket_start < $11)) "
+    "UNION ALL SELECT created_at, transaction_id, 1, "
+    "CASE WHEN transaction_type IN ('deposit', 'transfer_in') THEN amount ELSE 0 END, "
+    "CASE WHEN transaction_type IN ('withdrawal', 'transfer_out') THEN amount ELSE 0 END, balance_after "
+    "FROM transactions WHERE account_id = $1 AND (created_at >= $12 AND created_at < $13 "
+    "OR created_at >= $14 AND created_at < $15)) pieces");
+
+inline constexpr auto kBalanceHistory = sql::statement<sql::Params<int, int>, sql::Columns<double, double>>(
+    "balance_history", kBalanceHistoryHead, "$1", kBalanceHistoryTail);
+
+// Dashboard: the user, their accounts, and the first history page and balance
+// chart of their oldest account, pipelined in one round trip. The Login
+// variants name the user by username and password hash ($1 and the last
+// parameter) and return no rows for wrong credentials, so logging in costs
+// no extra round trip.
+inline constexpr char kDefaultAccountHead[] =
+    "(SELECT account_id FROM accounts WHERE user_id = ";
+inline constexpr char kDefaultAccountTail[] = " ORDER BY created_at LIMIT 1)";
+inline constexpr char kLoginUserId2[] =
+    "(SELECT user_id FROM users WHERE username = $1 AND password_hash = $2)";
+inline constexpr char kLoginUserId3[] =
+    "(SELECT user_id FROM users WHERE username = $1 AND password_hash = $3)";
+
+inline constexpr auto kDashboardHistory = sql::statement<sql::Params<int, int>, TransactionColumns>(
+    "dashboard_history",
+    "SELECT ", kTransactionColumns, " FROM transactions WHERE account_id = ",
+    kDefaultAccountHead, "$1", kDefaultAccountTail, " ORDER BY created_at DESC LIMIT $2");
+
+inline constexpr auto kDashboardBalanceHistory = sql::statement<
+    sql::Params<int, int>, sql::Columns<double, double>>(
+    "dashboard_balance_history",
+    kBalanceHistoryHead, kDefaultAccountHead, "$1", kDefaultAccountTail, kBalanceHistoryTail);
+
+inline constexpr auto kLoginUser = sql::statement<sql::Params<std::string, std::string>, UserColumns>(
+    "login_user",
+    "SELECT ", kUserColumns, " FROM users WHERE username = $1 AND password_hash = $2");
+
+inline constexpr auto kLoginAccounts = sql::statement<sql::Params<std::string, std::string>, AccountColumns>(
+    "login_accounts",
+    "SELECT ", kAccountColumns, " FROM accounts WHERE user_id = ", kLoginUserId2, " ORDER BY created_at");
+
+inline constexpr auto kLoginHistory = sql::statement<
+    sql::Params<std::string, int, std::string>, TransactionColumns>(
+    "login_history",
+    "SELECT ", kTransactionColumns, " FROM transactions WHERE account_id = ",
+    kDefaultAccountHead, kLoginUserId3, kDefaultAccountTail, " ORDER BY created_at DESC LIMIT $2");
+
+inline constexpr auto kLoginBalanceHistory = sql::statement<
+    sql::Params<std::string, int, std::string>, sql::Columns<double, double>>(
+    "login_balance_history",
+    kBalanceHistoryHead, kDefaultAccountHead, kLoginUserId3, kDefaultAccountTail, kBalanceHistoryTail);
+
+} // namespace ledger
+
+} // namespace bank
+
+#endif // LEDGER_STATEMENTS_HPP
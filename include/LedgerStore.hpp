@@ -0,0 +1,218 @@
+#ifndef LEDGER_STORE_HPP
+#define LEDGER_STORE_HPP
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "BankApi.hpp"
+#include "User.hpp"
+#include "Account.hpp"
+#include "Transaction.hpp"
+#include "Timestamp.hpp"
+
+namespace bank {
+
+/**
+ * @brief Cumulative work done by a store, used for per-call accounting
+ */
+struct StoreStats {
+    std::uint64_t operations = 0;   // Statements or store calls executed
+    std::uint64_t rows = 0;         // Rows returned or affected
+    double millis = 0.0;            // Time spent waiting on storage (0 if not measured)
+};
+
+/**
+ * @brief Storage backend behind BankService
+ *
+ * Stores provide persistence and indexing only; validation, interest
+ * rates, transfer descriptions and the composition of operations stay in
+ * BankService. Every write happens inside a transaction scope opened with
+ * begin(); scopes nest, and rolling back an inner scope only undoes its
+ * own changes. Calls outside a scope are applied immediately.
+ */
+class LedgerStore {
+public:
+    virtual ~LedgerStore() = default;
+
+    // Transaction scope
+    virtual bool begin() = 0;
+    virtual bool commit() = 0;
+    virtual bool rollback() = 0;
+
+    // Users
+    /**
+     * @brief Insert a user; the id of the argument is ignored
+     * @return New user id, or nullopt if the username or email is taken
+     */
+    virtual std::optional<int> insertUser(const User& user) = 0;
+    virtual std::optional<User> findUserById(int userId) = 0;
+    virtual std::optional<User> findUserByUsername(const std::string& username) = 0;
+
+    /**
+     * @brief Look up only what is needed to check a password
+     * @return User id and password hash
+     */
+    virtual std::optional<std::pair<int, std::string>> findCredentials(const std::string& username) = 0;
+
+    /**
+     * @brief Update username, full name, email and phone
+     */
+    virtual bool updateUser(const User& user) = 0;
+
+    /**
+     * @brief Delete a user with their accounts and transactions
+     */
+    virtual bool deleteUser(int userId) = 0;
+
+    // Accounts
+    /**
+     * @brief Insert an account; the id of the argument is ignored
+     * @return New account id, or nullopt if the number is taken or the user is unknown
+     */
+    virtual std::optional<int> insertAccount(const Account& account) = 0;
+    virtual std::optional<Account> findAccountById(int accountId) = 0;
+    virtual std::optional<Account> findAccountByNumber(const std::string& accountNumber) = 0;
+    virtual bool accountNumberExists(const std::string& accountNumber) = 0;
+
+    /**
+     * @brief Get a user's accounts, oldest first
+     */
+    virtual std::vector<Account> findAccountsByUser(int userId) = 0;
+    virtual bool setAccountStatus(int accountId, AccountStatus status) = 0;
+
+    /**
+     * @brief Delete an account with its transactions
+     */
+    virtual bool deleteAccount(int accountId) = 0;
+
+    /**
+     * @brief Lock accounts until the enclosing scope ends
+     *
+     * Locks are taken in account id order so that concurrent scopes locking
+     * the same accounts cannot deadlock.
+     *
+     * @return The accounts that exist, ordered by id
+     */
+    virtual std::vector<Account> lockAccounts(std::vector<int> accountIds) = 0;
+
+    /**
+     * @brief Atomically add delta to an active account's balance
+     * @return New balance, or nullopt if the account is missing, not
+     *         active, or the balance would become negative
+     */
+    virtual std::optional<double> adjustBalance(int accountId, double delta) = 0;
+    virtual double totalBalance(int userId) = 0;
+
+    // Transactions
+    /**
+     * @brief Append a transaction; id and creation time are assigned by the store
+     */
+    virtual bool appendTransaction(const Transaction& transaction) = 0;
+
+    /**
+     * @brief Get an account's most recent transactions, newest first
+     */
+    virtual std::vector<Transaction> scanHistory(int accountId, int limit) = 0;
+    virtual std::optional<Transaction> findTransaction(int transactionId) = 0;
+
+    /**
+     * @brief Get at most limit of an account's transactions created in range, oldest first
+     */
+    virtual std::vector<Transaction> scanHistoryBetween(int accountId, const TimeRange& range, int limit) = 0;
+
+    /**
+     * @brief Total an account's transactions in range per local calendar day
+     * @return Days with at least one transaction, oldest first
+     */
+    virtual std::vector<ActivityTotal> dailyTotals(int accountId, const TimeRange& range) = 0;
+
+    /**
+     * @brief Get the pre-aggregated totals of an account's local hours, days or months starting in range
+     *
+     * Rollups are updated with every appended transaction, so reading one
+     * costs the same however many transactions it sums.
+     *
+     * @return Periods with at least one transaction, oldest first
+     */
+    virtual std::vector<ActivityTotal> rollups(int accountId, TimeUnit unit, const TimeRange& range) = 0;
+
+    /**
+     * @brief Total an account's activity over the pieces of a cover
+     *
+     * Whole months, days and hours are read from the rollups and only the
+     * remainders shorter than an hour from the transactions.
+     *
+     * @return Totals starting at the beginning of the covered range
+     */
+    virtual ActivityTotal summarizeActivity(int accountId, const RangeCover& cover) = 0;
+
+    /**
+     * @brief Closing balances of at most maxPoints equal-count buckets of the history
+     *
+     * Bucket i holds the transactions NTILE(maxPoints) would assign to it,
+     * ordered by time; each sample is the bucket's last timestamp and balance.
+     */
+    virtual std::vector<BalancePoint> balanceHistory(int accountId, int maxPoints) = 0;
+
+    /**
+     * @brief Load everything the dashboard shows after login
+     *
+     * The default composes the calls above; stores with a cheaper way to
+     * fetch it all at once override this.
+     */
+    virtual std::optional<DashboardData> loadDashboard(int userId, int historyLimit, int balancePoints);
+
+    /**
+     * @brief loadDashboard() for the user with these credentials
+     *
+     * The default checks findCredentials() first; stores that can check
+     * them in the same round trip as the dashboard override this.
+     *
+     * @return Dashboard data, or nullopt if there is no such username or
+     *         the password hash does not match
+     */
+    virtual std::optional<DashboardData> loadDashboardForLogin(const std::string& username,
+                                                               const std::string& passwordHash,
+                                                               int historyLimit, int balancePoints);
+
+    virtual StoreStats getStats() const = 0;
+    virtual std::string getLastError() const = 0;
+};
+
+/**
+ * @brief Opens a store transaction scope and rolls it back unless committed
+ */
+class TransactionScope {
+public:
+    explicit TransactionScope(LedgerStore& store)
+        : m_store(store)
+        , m_open(store.begin())
+    {
+    }
+
+    ~TransactionScope() {
+        if (m_open) {
+            m_store.rollback();
+        }
+    }
+
+    TransactionScope(const TransactionScope&) = delete;
+    TransactionScope& operator=(const TransactionScope&) = delete;
+
+    bool isOpen() const { return m_open; }
+
+    bool commit() {
+        m_open = false;
+        return m_store.commit();
+    }
+
+private:
+    LedgerStore& m_store;
+    bool m_open;
+};
+
+} // namespace bank
+
+#endif // LEDGER_STORE_HPP
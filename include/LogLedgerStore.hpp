@@ -0,0 +1,171 @@
+#ifndef LOG_LEDGER_STORE_HPP
+#define LOG_LEDGER_STORE_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "MemoryLedgerStore.hpp"
+#include "Protocol.hpp"
+
+namespace bank {
+
+/**
+ * @brief Settings for an embedded LogLedgerStore
+ */
+struct LogStoreOptions {
+    std::string directory;                      // Created if missing
+    std::uint64_t snapshotBytes = 64ull << 20;  // Log growth that triggers a snapshot
+    bool sync = true;                           // fsync every commit group
+};
+
+/**
+ * @brief Embedded, crash-safe LedgerStore for deployments without PostgreSQL
+ *
+ * The tables are those of MemoryLedgerStore. Every committed change is
+ * also appended as a redo record to a write-ahead log, and commit()
+ * returns once the log is on disk. Records of one scope form a single
+ * checksummed frame, so a scope is replayed entirely or not at all.
+ *
+ * A flusher thread writes and syncs the log. Scopes committing while a
+ * sync is in flight are written together by the next one (group commit),
+ * so the sync cost is shared by all concurrent writers. The store lock is
+ * released before waiting for the sync; other scopes may read a change a
+ * little before it is durable, but its own commit() never returns early.
+ *
+ * When the log has grown by snapshotBytes a checkpointer thread writes the
+ * whole state to a new snapshot and deletes older logs. It holds the store
+ * lock only to copy the tables; encoding and writing happen outside it.
+ * Files in the directory:
+ *
+ *   snapshot.bin  - state as of the start of log generation G
+ *   wal-<n>.log   - changes since, in generations G, G+1, ...
+ *
+ * open() recovers by loading the snapshot and replaying the logs; a torn
+ * frame at the end of the newest log (a crash mid-write) is truncated.
+ * Only one process can open a directory at a time.
+ */
+class LogLedgerStore : public MemoryLedgerStore {
+public:
+    explicit LogLedgerStore(LogStoreOptions options);
+    ~LogLedgerStore() override;
+
+    LogLedgerStore(const LogLedgerStore&) = delete;
+    LogLedgerStore& operator=(const LogLedgerStore&) = delete;
+
+    /**
+     * @brief Recover the state from the directory and start logging
+     */
+    bool open();
+
+    /**
+     * @brief Write a snapshot now and drop the logs it covers
+     *
+     * Fails if called inside a scope.
+     */
+    bool checkpoint();
+
+    bool begin() override;
+    bool commit() override;
+    bool rollback() override;
+
+    std::optional<int> insertUser(const User& user) override;
+    bool updateUser(const User& user) override;
+    bool deleteUser(int userId) override;
+
+    std::optional<int> insertAccount(const Account& account) override;
+    bool setAccountStatus(int accountId, AccountStatus status) override;
+    bool deleteAccount(int accountId) override;
+    std::optional<double> adjustBalance(int accountId, double delta) override;
+
+    bool appendTransaction(const Transaction& transaction) override;
+
+private:
+    enum class Record : std::uint8_t {
+        InsertUser = 1,
+        UpdateUser,
+        DeleteUser,
+        InsertAccount,
+        SetAccountStatus,
+        DeleteAccount,
+        SetBalance,
+        AppendTransaction,
+        SnapshotBegin,
+        SnapshotEnd
+    };
+
+    /**
+     * @brief Apply a change and log it if it succeeded
+     *
+     * Outside a scope the change is its own commit and this waits for it
+     * to be durable; inside a scope the record waits for commit().
+     */
+    /**
+     * @brief The tables a snapshot records, copied out of the store
+     */
+    struct SnapshotState {
+        std::vector<User> users;                                    // By id
+        std::vector<std::pair<Account, TransactionBatch>> accounts; // By id
+        std::vector<std::string_view> descriptions;                 // Pool strings, by id
+        int nextUserId = 1;
+        int nextAccountId = 1;
+        int nextTransactionId = 1;
+    };
+
+    template <typename Apply, typename Encode>
+    auto logged(Apply apply, Encode encode) -> decltype(apply());
+
+    SnapshotState copyState() const;
+    static std::string snapshotData(SnapshotState state, std::uint32_t generation);
+    std::uint64_t appendFrame(const std::string& records);
+    bool waitDurable(std::uint64_t position);
+    void flushLoop();
+
+    bool loadSnapshot(const std::string& path, std::uint32_t& generation);
+    bool replayLog(const std::string& path, bool newest);
+    bool applyRecord(protocol::MessageReader& reader, Record record);
+    bool openLog(std::uint32_t generation);
+    bool writeSnapshot(const std::string& data, std::uint32_t generation);
+    void maybeCheckpoint();
+    void checkpointLoop();
+
+    std::string logPath(std::uint32_t generation) const;
+
+    LogStoreOptions m_options;
+    bool m_open;
+
+    // Protected by the store lock
+    std::string m_pending;                  // Records of the open scope
+    std::vector<std::size_t> m_pendingMarks;
+    bool m_failed;                          // The log could not be written; no more changes
+
+    // Protected by m_logMutex
+    std::mutex m_logMutex;
+    std::condition_variable m_logReady;
+    std::condition_variable m_logDurable;
+    std::string m_logBuffer;                // Frames not yet written
+    std::uint64_t m_appended;               // Bytes ever appended
+    std::uint64_t m_durable;                // Bytes written and synced
+    std::uint32_t m_generation;             // Current log file
+    std::uint64_t m_generationStart;        // m_appended when it was opened
+    std::FILE* m_log;
+    bool m_logFailed;
+    bool m_stopping;
+    bool m_checkpointing;                   // Due or running on the checkpointer
+    std::condition_variable m_checkpointDue;
+    std::string m_logError;
+
+    std::mutex m_checkpointMutex;           // Held for a whole checkpoint
+    int m_lockFd;                           // Exclusive lock on the directory
+    std::thread m_flusher;
+    std::thread m_checkpointer;
+};
+
+} // namespace bank
+
+#endif // LOG_LEDGER_STORE_HPP
@@ -0,0 +1,292 @@
+#ifndef LOGGER_HPP
+#define LOGGER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+// Levels below this are compiled out: 0 debug, 1 info, 2 warn, 3 error, 4 off
+#ifndef BANK_LOG_LEVEL
+#define BANK_LOG_LEVEL 0
+#endif
+
+namespace bank {
+
+enum class LogLevel : std::uint8_t {
+    Debug,
+    Info,
+    Warn,
+    Error,
+    Off
+};
+
+constexpr LogLevel kCompiledLogLevel = static_cast<LogLevel>(BANK_LOG_LEVEL);
+constexpr std::size_t kMaxLogFields = 8;
+constexpr std::size_t kMaxLogText = 224;    // String field bytes per record; longer values are cut
+
+const char* logLevelName(LogLevel level);
+
+/**
+ * @brief Parse "debug", "info", "warn", "error" or "off"
+ */
+std::optional<LogLevel> parseLogLevel(const std::string& name);
+
+/**
+ * @brief One key/value pair of a queued record, still unformatted
+ */
+struct LogField {
+    enum class Kind : std::uint8_t { Int, Uint, Double, Bool, Text };
+
+    const char* key;
+    Kind kind;
+    std::uint16_t textOffset;
+    std::uint16_t textLength;
+    union {
+        std::int64_t i;
+        std::uint64_t u;
+        double d;
+        bool b;
+    } value;
+};
+
+/**
+ * @brief A record as queued; it is only turned into text on the logging thread
+ */
+struct LogRecord {
+    std::int64_t time;          // System clock, nanoseconds since the epoch
+    const char* event;
+    LogLevel level;
+    std::uint8_t fieldCount;
+    std::uint16_t textUsed;
+    std::uint32_t thread;
+    LogField fields[kMaxLogFields];
+    char text[kMaxLogText];
+};
+
+/**
+ * @brief Where records go and how much may be buffered on the way
+ */
+struct LoggerOptions {
+    std::string path;                               // Empty writes to stderr
+    LogLevel level = LogLevel::Info;                // Runtime minimum on top of BANK_LOG_LEVEL
+    std::size_t queueCapacity = 8192;               // Records, rounded up to a power of two
+    std::uint64_t maxFileBytes = 64 * 1024 * 1024;  // Rotate past this size; 0 never rotates
+    int maxFiles = 5;                               // Rotated files kept as path.1 ... path.N
+};
+
+namespace detail {
+
+std::uint32_t logThreadNumber();
+
+inline void addLogText(LogRecord& record, LogField& field, std::string_view text) {
+    std::size_t length = std::min(text.size(), kMaxLogText - record.textUsed);
+    field.kind = LogField::Kind::Text;
+    field.textOffset = record.textUsed;
+    field.textLength = static_cast<std::uint16_t>(length);
+    std::memcpy(record.text + record.textUsed, text.data(), length);
+    record.textUsed = static_cast<std::uint16_t>(record.textUsed + length);
+}
+
+inline void addLogValue(LogRecord& record, LogField& field, std::string_view value) {
+    addLogText(record, field, value);
+}
+
+inline void addLogValue(LogRecord& record, LogField& field, const char* value) {
+    addLogText(record, field, value != nullptr ? std::string_view(value) : std::string_view());
+}
+
+inline void addLogValue(LogRecord&, LogField& field, bool value) {
+    field.kind = LogField::Kind::Bool;
+    field.value.b = value;
+}
+
+inline void addLogValue(LogRecord&, LogField& field, double value) {
+    field.kind = LogField::Kind::Double;
+    field.value.d = value;
+}
+
+template <typename T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, int> = 0>
+void addLogValue(LogRecord&, LogField& field, T value) {
+    if constexpr (std::is_signed_v<T>) {
+        field.kind = LogField::Kind::Int;
+        field.value.i = value;
+    } else {
+        field.kind = LogField::Kind::Uint;
+        field.value.u = value;
+    }
+}
+
+inline void addLogFields(LogRecord&) {
+}
+
+template <typename Value, typename... Rest>
+void addLogFields(LogRecord& record, const char* key, const Value& value, const Rest&... rest) {
+    LogField& field = record.fields[record.fieldCount++];
+    field.key = key;
+    addLogValue(record, field, value);
+    addLogFields(record, rest...);
+}
+
+} // namespace detail
+
+/**
+ * @brief Asynchronous structured logger writing JSON lines
+ *
+ * A call such as
+ *
+ *     logger.info("transfer", "from", fromId, "to", toId, "amount", amount);
+ *
+ * copies the event name, the keys and the raw values into a slot of a
+ * bounded lock-free queue and returns; it never formats, allocates, locks
+ * or touches a file. A background thread turns records into one JSON
+ * object per line and writes them in batches, rotating the file when it
+ * grows past maxFileBytes.
+ *
+ * Calls below BANK_LOG_LEVEL compile to nothing; calls below the runtime
+ * level cost one comparison. When the queue is full the record is dropped
+ * and counted rather than making the caller wait, and the next line
+ * written says how many were lost.
+ *
+ * Event names and keys must be string literals (or otherwise outlive the
+ * logger); string values are copied, up to kMaxLogText bytes per record.
+ * One logger may be shared by any number of threads.
+ */
+class Logger {
+public:
+    explicit Logger(LoggerOptions options = {});
+
+    /**
+     * @brief Write everything still queued and stop the logging thread
+     */
+    ~Logger();
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    /**
+     * @brief Open the log file and start the logging thread
+     * @return false if the file could not be opened, see getLastError()
+     */
+    bool open();
+
+    /**
+     * @brief Block until every record queued before the call is written
+     */
+    void flush();
+
+    bool isEnabled(LogLevel level) const {
+        return level >= kCompiledLogLevel && level >= m_options.level && level != LogLevel::Off;
+    }
+
+    /**
+     * @brief Queue a record
+     * @param fields Alternating keys and values: integers, doubles, bools and strings
+     */
+    template <LogLevel Level, typename... Fields>
+    void log(const char* event, const Fields&... fields) {
+        static_assert(sizeof...(Fields) % 2 == 0, "fields are key/value pairs");
+        static_assert(sizeof...(Fields) / 2 <= kMaxLogFields, "too many fields for one record");
+        if constexpr (Level >= kCompiledLogLevel && Level != LogLevel::Off) {
+            if (Level < m_options.level) {
+                return;
+            }
+            std::size_t position;
+            Cell* cell = claim(position);
+            if (cell == nullptr) {
+                return;
+            }
+            LogRecord& record = cell->record;
+            record.time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            record.event = event;
+            record.level = Level;
+            record.fieldCount = 0;
+            record.textUsed = 0;
+            record.thread = detail::logThreadNumber();
+            detail::addLogFields(record, fields...);
+            publish(cell, position);
+        }
+    }
+
+    template <typename... Fields>
+    void debug(const char* event, const Fields&... fields) { log<LogLevel::Debug>(event, fields...); }
+
+    template <typename... Fields>
+    void info(const char* event, const Fields&... fields) { log<LogLevel::Info>(event, fields...); }
+
+    template <typename... Fields>
+    void warn(const char* event, const Fields&... fields) { log<LogLevel::Warn>(event, fields...); }
+
+    template <typename... Fields>
+    void error(const char* event, const Fields&... fields) { log<LogLevel::Error>(event, fields...); }
+
+    std::uint64_t getWritten() const { return m_written.load(std::memory_order_relaxed); }
+    std::uint64_t getDropped() const { return m_dropped.load(std::memory_order_relaxed); }
+    const std::string& getLastError() const { return m_lastError; }
+
+private:
+    struct alignas(64) Cell {
+        std::atomic<std::size_t> sequence;
+        LogRecord record;
+    };
+
+    /**
+     * @brief Reserve the next free cell, or count a drop if there is none
+     */
+    Cell* claim(std::size_t& position);
+
+    /**
+     * @brief Hand a filled cell to the logging thread, waking it if idle
+     */
+    void publish(Cell* cell, std::size_t position);
+
+    bool hasPending() const;
+    void run();
+    void format(const LogRecord& record, std::string& out);
+    void append(const std::string& line);
+    void writePending();
+    void rotate();
+
+    LoggerOptions m_options;
+    std::string m_lastError;
+
+    // Queue: a bounded multi-producer ring with a sequence number per cell
+    std::unique_ptr<Cell[]> m_cells;
+    std::size_t m_mask;
+    alignas(64) std::atomic<std::size_t> m_enqueue;
+    alignas(64) std::size_t m_dequeue;        // Logging thread only
+    std::atomic<std::uint64_t> m_dropped;
+    std::atomic<std::uint64_t> m_written;
+    std::atomic<bool> m_sleeping;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_flushed;
+    std::size_t m_writtenPosition;            // Queue position written up to, under m_mutex
+    bool m_stopping;
+    std::thread m_thread;
+
+    // Logging thread only
+    std::ofstream m_file;
+    std::uint64_t m_fileBytes;
+    std::string m_pending;
+    std::uint64_t m_droppedReported;
+    std::int64_t m_stampSecond;
+    char m_stamp[32];
+};
+
+} // namespace bank
+
+#endif // LOGGER_HPP
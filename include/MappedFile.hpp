@@ -0,0 +1,47 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace bank {
+
+/**
+ * @brief Read-only memory mapping of a whole file
+ *
+ * Pages are loaded on first access instead of being copied up front. On
+ * platforms without mmap the file is read into an owned buffer instead.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    /**
+     * @brief Map a file, replacing any previous mapping
+     * @param path File to map
+     * @return true if the file exists, is not empty and could be mapped
+     */
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return m_data != nullptr; }
+    const void* data() const { return m_data; }
+    std::size_t size() const { return m_size; }
+
+private:
+    const void* m_data = nullptr;
+    std::size_t m_size = 0;
+    bool m_mapped = false;
+    std::vector<char> m_buffer;
+};
+
+} // namespace bank
+
+#endif // MAPPED_FILE_HPP
@@ -0,0 +1,115 @@
+#ifndef MEMORY_LEDGER_STORE_HPP
+#define MEMORY_LEDGER_STORE_HPP
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "LedgerStore.hpp"
+#include "TransactionBatch.hpp"
+
+namespace bank {
+
+/**
+ * @brief Volatile LedgerStore held entirely in memory
+ *
+ * Users and accounts live in hash tables with hash indexes on username,
+ * email and account number; each account owns an append-only
+ * TransactionBatch of its transactions, so history scans are a reverse
+ * walk of one batch and time ranges a binary search of it. The batches
+ * share one pool of descriptions. Every append also adds the transaction
+ * to its account's hour, day and month rollups, sorted vectors that
+ * activity queries binary search. Nothing is persisted. Used to measure
+ * the service layer without a database and to run large simulations
+ * quickly.
+ *
+ * The store is thread safe: a scope holds the store lock from begin()
+ * until the outermost commit() or rollback(), which makes scopes fully
+ * serializable. Rollback replays an undo log of the scope's changes.
+ */
+class MemoryLedgerStore : public LedgerStore {
+public:
+    MemoryLedgerStore();
+
+    bool begin() override;
+    bool commit() override;
+    bool rollback() override;
+
+    std::optional<int> insertUser(const User& user) override;
+    std::optional<User> findUserById(int userId) override;
+    std::optional<User> findUserByUsername(const std::string& username) override;
+    std::optional<std::pair<int, std::string>> findCredentials(const std::string& username) override;
+    bool updateUser(const User& user) override;
+    bool deleteUser(int userId) override;
+
+    std::optional<int> insertAccount(const Account& account) override;
+    std::optional<Account> findAccountById(int accountId) override;
+    std::optional<Account> findAccountByNumber(const std::string& accountNumber) override;
+    bool accountNumberExists(const std::string& accountNumber) override;
+    std::vector<Account> findAccountsByUser(int userId) override;
+    bool setAccountStatus(int accountId, AccountStatus status) override;
+    bool deleteAccount(int accountId) override;
+    std::vector<Account> lockAccounts(std::vector<int> accountIds) override;
+    std::optional<double> adjustBalance(int accountId, double delta) override;
+    double totalBalance(int userId) override;
+
+    bool appendTransaction(const Transaction& transaction) override;
+    std::vector<Transaction> scanHistory(int accountId, int limit) override;
+    std::optional<Transaction> findTransaction(int transactionId) override;
+    std::vector<Transaction> scanHistoryBetween(int accountId, const TimeRange& range, int limit) override;
+    std::vector<ActivityTotal> dailyTotals(int accountId, const TimeRange& range) override;
+    std::vector<ActivityTotal> rollups(int accountId, TimeUnit unit, const TimeRange& range) override;
+    ActivityTotal summarizeActivity(int accountId, const RangeCover& cover) override;
+    std::vector<BalancePoint> balanceHistory(int accountId, int maxPoints) override;
+
+    StoreStats getStats() const override;
+    std::string getLastError() const override;
+
+protected:
+    // Durable subclasses replay and snapshot the tables directly
+    struct AccountEntry {
+        Account account;
+        TransactionBatch history;           // Oldest first
+        std::array<std::vector<ActivityTotal>, std::size(EnumNames<TimeUnit>::names)> rollups;  // By TimeUnit
+    };
+
+    using Lock = std::lock_guard<std::recursive_mutex>;
+
+    void onUndo(std::function<void()> undo);
+    bool fail(const std::string& error);
+    void count(std::size_t rows);
+    bool removeAccount(int accountId);
+
+    /**
+     * @brief Append a transaction created at a given time, or just after the account's last one
+     */
+    bool appendTransactionAt(const Transaction& transaction, Timestamp createdAt);
+
+    mutable std::recursive_mutex m_mutex;
+    std::vector<std::function<void()>> m_undoLog;
+    std::vector<std::size_t> m_scopeMarks;  // Undo log size at each open scope
+
+    std::unordered_map<int, User> m_users;
+    std::unordered_map<std::string, int> m_usernames;
+    std::unordered_map<std::string, int> m_emails;
+    std::unordered_map<int, std::vector<int>> m_userAccounts;  // Creation order
+    std::unordered_map<int, AccountEntry> m_accounts;
+    std::unordered_map<std::string, int> m_accountNumbers;
+    std::unordered_map<int, std::pair<int, std::size_t>> m_transactions;  // Id -> account, index
+    std::shared_ptr<StringPool> m_descriptions;
+
+    int m_nextUserId;
+    int m_nextAccountId;
+    int m_nextTransactionId;
+    StoreStats m_stats;
+    std::string m_lastError;
+};
+
+} // namespace bank
+
+#endif // MEMORY_LEDGER_STORE_HPP
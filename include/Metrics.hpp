@@ -0,0 +1,146 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bank {
+
+/**
+ * @brief Copy of a LatencyHistogram at one point in time
+ */
+struct HistogramSnapshot {
+    std::vector<std::uint64_t> counts;  // Per bucket, see LatencyHistogram
+    std::uint64_t count = 0;
+    std::uint64_t sumNanos = 0;
+    std::uint64_t maxNanos = 0;
+
+    /**
+     * @brief Smallest recorded value (to bucket precision) with q of the samples at or below it
+     * @param q Fraction in [0, 1], e.g. 0.99
+     */
+    std::uint64_t percentile(double q) const;
+
+    /**
+     * @brief Samples whose bucket lies entirely at or below nanos
+     */
+    std::uint64_t countAtOrBelow(std::uint64_t nanos) const;
+};
+
+/**
+ * @brief Latency histogram with HDR-style log-linear buckets
+ *
+ * Values below 32 ns get a bucket each; above that every power of two is
+ * split into 32 buckets, so any value is known to within about 3% from
+ * 1 ns up to ~68 s (larger values land in the last bucket). Recording is
+ * a few relaxed atomic increments, safe from any number of threads.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 5;
+    static constexpr std::uint64_t kSubBuckets = 1u << kSubBucketBits;
+    static constexpr int kMaxMagnitude = 36;    // Values up to 2^36 ns
+    static constexpr std::size_t kBuckets = kSubBuckets * (kMaxMagnitude - kSubBucketBits + 1);
+
+    LatencyHistogram();
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void record(std::uint64_t nanos);
+
+    HistogramSnapshot snapshot() const;
+
+    static std::size_t bucketOf(std::uint64_t nanos);
+    static std::uint64_t bucketLowest(std::size_t bucket);
+    static std::uint64_t bucketHighest(std::size_t bucket);
+
+private:
+    std::array<std::atomic<std::uint64_t>, kBuckets> m_counts;
+    std::atomic<std::uint64_t> m_sumNanos;
+    std::atomic<std::uint64_t> m_maxNanos;
+};
+
+/**
+ * @brief Counters and latency of one statement or operation
+ */
+struct MetricSeries {
+    explicit MetricSeries(std::string label) : label(std::move(label)) {}
+
+    void record(std::uint64_t nanos, std::uint64_t rowCount, bool ok);
+    void recordRoundTrips(std::uint64_t count);
+    void recordAllocations(std::uint64_t count, std::uint64_t bytes);
+
+    const std::string label;
+    std::atomic<std::uint64_t> calls{0};
+    std::atomic<std::uint64_t> errors{0};
+    std::atomic<std::uint64_t> rows{0};             // Rows returned or affected
+    std::atomic<std::uint64_t> roundTrips{0};       // Operations only
+    std::atomic<std::uint64_t> allocations{0};      // Operations, with BANK_ALLOC_TRACKING only
+    std::atomic<std::uint64_t> allocatedBytes{0};
+    LatencyHistogram latency;
+};
+
+/**
+ * @brief Process-wide latency and count metrics, exported as Prometheus text
+ *
+ * Database records every statement under its tag (e.g. "UPDATE
+ * accounts") and BankService every outermost call under its operation
+ * name, once each is given the registry. Finding a series and recording
+ * into it never takes a lock, so any number of connections and workers
+ * can share one registry.
+ *
+ * Each family holds up to kMaxSeries labels; further labels are counted
+ * under "other".
+ */
+class MetricsRegistry {
+public:
+    static constexpr std::size_t kMaxSeries = 256;
+
+    MetricsRegistry();
+    ~MetricsRegistry();
+
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    MetricSeries& statement(const std::string& tag) { return m_statements.find(tag); }
+    MetricSeries& operation(const std::string& name) { return m_operations.find(name); }
+
+    /**
+     * @brief Every series in the Prometheus text exposition format (0.0.4)
+     */
+    std::string renderPrometheus() const;
+
+    /**
+     * @brief Write renderPrometheus() to path, replacing it atomically
+     */
+    bool writeFile(const std::string& path) const;
+
+private:
+    /**
+     * @brief Open-addressing table of series whose slots are claimed by CAS
+     */
+    class Family {
+    public:
+        Family();
+        ~Family();
+
+        MetricSeries& find(const std::string& label);
+        std::vector<const MetricSeries*> list() const;
+
+    private:
+        std::array<std::atomic<MetricSeries*>, kMaxSeries> m_slots;
+        MetricSeries m_other;
+    };
+
+    Family m_statements;
+    Family m_operations;
+};
+
+} // namespace bank
+
+#endif // METRICS_HPP
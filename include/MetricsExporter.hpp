@@ -0,0 +1,69 @@
+#ifndef METRICS_EXPORTER_HPP
+#define METRICS_EXPORTER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include "Metrics.hpp"
+
+namespace bank {
+
+/**
+ * @brief Where and how often a MetricsExporter publishes
+ */
+struct MetricsExporterOptions {
+    std::string path;               // File rewritten every interval; empty disables it
+    std::string host = "127.0.0.1"; // Address of the scrape endpoint
+    int port = 0;                   // Port serving GET /metrics; 0 disables it
+    std::chrono::seconds interval{10};
+};
+
+/**
+ * @brief Publishes a MetricsRegistry in the Prometheus text format
+ *
+ * A background thread rewrites the metrics file every interval, for the
+ * node exporter's textfile collector or anything else that tails it, and
+ * answers GET /metrics on a local HTTP port. Scrapes are served one at a
+ * time and render the registry afresh, so they never block recording.
+ */
+class MetricsExporter {
+public:
+    MetricsExporter(std::shared_ptr<const MetricsRegistry> metrics, MetricsExporterOptions options);
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    /**
+     * @brief Open the endpoint and start publishing
+     * @return true on success, otherwise see getLastError()
+     */
+    bool start();
+
+    /**
+     * @brief Stop publishing, writing the file one last time
+     */
+    void stop();
+
+    const std::string& getLastError() const { return m_lastError; }
+
+private:
+    bool listenTcp();
+    void run();
+    void serve(int fd);
+    void writeFile();
+
+    std::shared_ptr<const MetricsRegistry> m_metrics;
+    MetricsExporterOptions m_options;
+    std::string m_lastError;
+    int m_listenFd;
+    int m_wakeFd;
+    std::atomic<bool> m_running;
+    std::thread m_thread;
+};
+
+} // namespace bank
+
+#endif // METRICS_EXPORTER_HPP
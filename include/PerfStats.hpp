@@ -0,0 +1,37 @@
+#ifndef PERF_STATS_HPP
+#define PERF_STATS_HPP
+
+#include <cstddef>
+#include <vector>
+
+namespace bank {
+
+/**
+ * @brief Fixed-size window of the most recent samples with percentile queries
+ */
+class SampleWindow {
+public:
+    explicit SampleWindow(std::size_t capacity = 256);
+
+    void add(double value);
+    void clear();
+    std::size_t size() const { return m_count; }
+    bool empty() const { return m_count == 0; }
+
+    /**
+     * @brief Get a percentile of the samples currently in the window
+     * @param p Percentile in the range [0, 100]
+     * @return Sample value at that rank, or 0 when empty
+     */
+    double percentile(double p) const;
+    double max() const;
+
+private:
+    std::vector<double> m_samples;
+    std::size_t m_next;
+    std::size_t m_count;
+};
+
+} // namespace bank
+
+#endif // PERF_STATS_HPP
@@ -0,0 +1,26 @@
+#ifndef PG_RESULT_ROWS_HPP
+#define PG_RESULT_ROWS_HPP
+
+#include <libpq-fe.h>
+
+namespace bank {
+
+/**
+ * @brief Presents a PGresult to readRows()
+ */
+class PgResultRows {
+public:
+    explicit PgResultRows(const PGresult* result) : m_result(result) {}
+
+    int rows() const { return PQntuples(m_result); }
+    int columns() const { return PQnfields(m_result); }
+    const char* value(int row, int column) const { return PQgetvalue(m_result, row, column); }
+    int length(int row, int column) const { return PQgetlength(m_result, row, column); }
+
+private:
+    const PGresult* m_result;
+};
+
+} // namespace bank
+
+#endif // PG_RESULT_ROWS_HPP
@@ -0,0 +1,90 @@
+#ifndef POSTGRES_LEDGER_STORE_HPP
+#define POSTGRES_LEDGER_STORE_HPP
+
+#include <memory>
+#include "Database.hpp"
+#include "LedgerStore.hpp"
+
+namespace bank {
+
+/**
+ * @brief LedgerStore on the PostgreSQL schema in sql/schema.sql
+ *
+ * Scopes map to transactions and savepoints on the shared Database, so a
+ * caller may also open transactions on the Database directly around
+ * service calls (as the batch runner does).
+ */
+class PostgresLedgerStore : public LedgerStore {
+public:
+    explicit PostgresLedgerStore(std::shared_ptr<Database> db);
+
+    bool begin() override;
+    bool commit() override;
+    bool rollback() override;
+
+    std::optional<int> insertUser(const User& user) override;
+    std::optional<User> findUserById(int userId) override;
+    std::optional<User> findUserByUsername(const std::string& username) override;
+    std::optional<std::pair<int, std::string>> findCredentials(const std::string& username) override;
+    bool updateUser(const User& user) override;
+    bool deleteUser(int userId) override;
+
+    std::optional<int> insertAccount(const Account& account) override;
+    std::optional<Account> findAccountById(int accountId) override;
+    std::optional<Account> findAccountByNumber(const std::string& accountNumber) override;
+    bool accountNumberExists(const std::string& accountNumber) override;
+    std::vector<Account> findAccountsByUser(int userId) override;
+    bool setAccountStatus(int accountId, AccountStatus status) override;
+    bool deleteAccount(int accountId) override;
+    std::vector<Account> lockAccounts(std::vector<int> accountIds) override;
+    std::optional<double> adjustBalance(int accountId, double delta) override;
+    double totalBalance(int userId) override;
+
+    bool appendTransaction(const Transaction& transaction) override;
+    std::vector<Transaction> scanHistory(int accountId, int limit) override;
+    std::optional<Transaction> findTransaction(int transactionId) override;
+    std::vector<Transaction> scanHistoryBetween(int accountId, const TimeRange& range, int limit) override;
+    std::vector<ActivityTotal> dailyTotals(int accountId, const TimeRange& range) override;
+    std::vector<ActivityTotal> rollups(int accountId, TimeUnit unit, const TimeRange& range) override;
+    ActivityTotal summarizeActivity(int accountId, const RangeCover& cover) override;
+    std::vector<BalancePoint> balanceHistory(int accountId, int maxPoints) override;
+
+    /**
+     * @brief Fetch user, accounts, first history page and chart in one pipelined round trip
+     */
+    std::optional<DashboardData> loadDashboard(int userId, int historyLimit, int balancePoints) override;
+
+    /**
+     * @brief loadDashboard() with the credentials checked by the same round trip
+     */
+    std::optional<DashboardData> loadDashboardForLogin(const std::string& username, const std::string& passwordHash,
+                                                       int historyLimit, int balancePoints) override;
+
+    /**
+     * @brief Get the accounts updated since a database time, for cache reconciliation
+     *
+     * Rows updated up to slackSeconds before since are included too, so a
+     * transaction that started before since but committed after it is not
+     * missed. An empty since only reads the current time.
+     *
+     * @param watermark Receives the database time to pass as since next time
+     * @return Changed accounts, or nullopt on a database error
+     */
+    std::optional<std::vector<Account>> findAccountsUpdatedSince(const std::string& since, int slackSeconds,
+                                                                 std::string& watermark);
+
+    StoreStats getStats() const override;
+    std::string getLastError() const override { return m_db->getLastError(); }
+
+private:
+    /**
+     * @brief Send the four dashboard queries in one pipeline and decode them
+     */
+    std::optional<DashboardData> pipelineDashboard(const std::vector<PipelinedQuery>& queries);
+
+    std::shared_ptr<Database> m_db;
+};
+
+} // namespace bank
+
+#endif // POSTGRES_LEDGER_STORE_HPP
@@ -0,0 +1,163 @@
+#ifndef PROTOCOL_HPP
+#define PROTOCOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "User.hpp"
+#include "Account.hpp"
+#include "Transaction.hpp"
+#include "Timestamp.hpp"
+#include "BankApi.hpp"
+
+namespace bank {
+
+/**
+ * @brief Binary protocol spoken between bank_server and RemoteBankService
+ *
+ * Every message is a frame: a big-endian u32 length of the rest of the
+ * frame followed by the body. Request bodies are
+ *   u8 opcode, u32 request id, arguments...
+ * and response bodies are
+ *   u32 request id, u8 status, u32 database microseconds,
+ *   u32 database round trips, u32 rows, result...
+ * where the database figures describe the server side of the call.
+ * Integers are big-endian, doubles are IEEE-754 bit patterns in a u64,
+ * timestamps are i64 microseconds since the Unix epoch and strings are a
+ * u32 length followed by the bytes. Optional results are a u8 presence
+ * flag followed by the value; lists are a u32 count.
+ */
+namespace protocol {
+
+constexpr std::uint32_t kMaxFrameSize = 1 << 20;
+constexpr std::size_t kLengthPrefix = 4;
+constexpr std::size_t kRequestHeader = 5;
+constexpr std::size_t kResponseHeader = 17;
+
+enum class Opcode : std::uint8_t {
+    CreateUser = 1,
+    AuthenticateUser,
+    VerifyCredentials,
+    LoadDashboard,
+    GetUserById,
+    GetUserByUsername,
+    UpdateUser,
+    DeleteUser,
+    CreateAccount,
+    GetAccountById,
+    GetAccountByNumber,
+    GetAccountsByUserId,
+    UpdateAccountStatus,
+    DeleteAccount,
+    Deposit,
+    Withdraw,
+    Transfer,
+    GetTransactionHistory,
+    GetTransactionById,
+    GetBalanceHistory,
+    GetTotalBalance,
+    AccountExists,
+    GetTransactionsBetween,
+    GetDailyTotals,
+    GetActivity,
+    GetActivitySummary,
+    Login
+};
+
+enum class Status : std::uint8_t {
+    Ok = 0,
+    BadRequest = 1,
+    ServerError = 2
+};
+
+/**
+ * @brief Appends encoded values to a frame
+ */
+class MessageWriter {
+public:
+    /**
+     * @brief Start a frame; the length prefix is filled in by finish()
+     */
+    MessageWriter();
+
+    void putU8(std::uint8_t value);
+    void putU32(std::uint32_t value);
+    void putI32(std::int32_t value);
+    void putI64(std::int64_t value);
+    void putF64(double value);
+    void putBool(bool value) { putU8(value ? 1 : 0); }
+    void putString(std::string_view value);
+    void putTimestamp(Timestamp value) { putI64(value.micros()); }
+
+    /**
+     * @brief Reserve a u32 to be filled in later with setU32()
+     * @return Position of the reserved value
+     */
+    std::size_t reserveU32();
+    void setU32(std::size_t position, std::uint32_t value);
+
+    void putUser(const User& user);
+    void putAccount(const Account& account);
+    void putTransaction(const Transaction& transaction);
+    void putActivityTotal(const ActivityTotal& total);
+    void putDashboard(const DashboardData& dashboard);
+
+    /**
+     * @brief Complete the frame
+     * @return Encoded frame including the length prefix
+     */
+    std::string finish();
+
+private:
+    std::string m_buffer;
+};
+
+/**
+ * @brief Decodes values from a frame body
+ *
+ * Reads past the end yield zero values and mark the reader as failed, so
+ * a whole message can be decoded before checking ok() once.
+ */
+class MessageReader {
+public:
+    MessageReader(const char* data, std::size_t size);
+
+    std::uint8_t getU8();
+    std::uint32_t getU32();
+    std::int32_t getI32();
+    std::int64_t getI64();
+    double getF64();
+    bool getBool() { return getU8() != 0; }
+    std::string getString();
+    Timestamp getTimestamp() { return Timestamp::fromMicros(getI64()); }
+
+    User getUser();
+    Account getAccount();
+    Transaction getTransaction();
+    ActivityTotal getActivityTotal();
+    DashboardData getDashboard();
+
+    bool ok() const { return m_ok; }
+    bool atEnd() const { return m_pos == m_size; }
+
+private:
+    bool need(std::size_t bytes);
+
+    const char* m_data;
+    std::size_t m_size;
+    std::size_t m_pos;
+    bool m_ok;
+};
+
+/**
+ * @brief Read the big-endian u32 length prefix at the start of a buffer
+ */
+std::uint32_t readLength(const char* data);
+
+} // namespace protocol
+
+} // namespace bank
+
+#endif // PROTOCOL_HPP
@@ -0,0 +1,108 @@
+#ifndef REMOTE_BANK_SERVICE_HPP
+#define REMOTE_BANK_SERVICE_HPP
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+#include "BankApi.hpp"
+#include "Protocol.hpp"
+
+namespace bank {
+
+/**
+ * @brief Client for bank_server implementing the same API as BankService
+ *
+ * Each call is one blocking request/response exchange on a single socket.
+ * Failures (server unreachable, malformed reply) are reported like a
+ * failed database call: the method returns nullopt, false or an empty
+ * result and getLastError() explains why. A lost connection is
+ * re-established on the next call.
+ *
+ * Recent calls record the client-side wall time as millis and the
+ * server's database time as dbMillis, so the difference is network and
+ * server overhead.
+ */
+class RemoteBankService : public BankApi {
+public:
+    /**
+     * @brief Create a client; no connection is made until connect()
+     * @param address "host:port" for TCP or "unix:/path" for a Unix socket
+     */
+    explicit RemoteBankService(std::string address);
+    ~RemoteBankService() override;
+
+    RemoteBankService(const RemoteBankService&) = delete;
+    RemoteBankService& operator=(const RemoteBankService&) = delete;
+
+    bool connect();
+    void disconnect();
+    bool isConnected() const { return m_fd >= 0; }
+    const std::string& getAddress() const { return m_address; }
+    const std::string& getLastError() const { return m_lastError; }
+
+    // User operations
+    std::optional<User> createUser(const std::string& username, const std::string& password,
+                                   const std::string& fullName, const std::string& email,
+                                   const std::string& phone) override;
+    std::optional<User> authenticateUser(const std::string& username, const std::string& password) override;
+    std::optional<int> verifyCredentials(const std::string& username, const std::string& password) override;
+    std::optional<DashboardData> loadDashboard(int userId, int historyLimit = 50) override;
+    std::optional<DashboardData> login(const std::string& username, const std::string& password,
+                                       int historyLimit = 50) override;
+    std::optional<User> getUserById(int userId) override;
+    std::optional<User> getUserByUsername(const std::string& username) override;
+    bool updateUser(const User& user) override;
+    bool deleteUser(int userId) override;
+
+    // Account operations
+    std::optional<Account> createAccount(int userId, AccountType type, double initialDeposit = 0.0) override;
+    std::optional<Account> getAccountById(int accountId) override;
+    std::optional<Account> getAccountByNumber(const std::string& accountNumber) override;
+    std::vector<Account> getAccountsByUserId(int userId) override;
+    bool updateAccountStatus(int accountId, AccountStatus status) override;
+    bool deleteAccount(int accountId) override;
+
+    // Transaction operations
+    bool deposit(int accountId, double amount, const std::string& description = "Deposit") override;
+    bool withdraw(int accountId, double amount, const std::string& description = "Withdrawal") override;
+    bool transfer(int fromAccountId, int toAccountId, double amount, 
+                  const std::string& description = "Transfer") override;
+    std::vector<Transaction> getTransactionHistory(int accountId, int limit = 50) override;
+    std::optional<Transaction> getTransactionById(int transactionId) override;
+    std::vector<BalancePoint> getBalanceHistory(int accountId, int maxPoints = kBalanceHistoryPoints) override;
+    std::vector<Transaction> getTransactionsBetween(int accountId, Timestamp from, Timestamp to,
+                                                    int limit = kRangeLimit) override;
+    std::vector<ActivityTotal> getDailyTotals(int accountId, const TimeRange& range) override;
+    std::vector<ActivityTotal> getActivity(int accountId, TimeUnit unit, const TimeRange& range) override;
+    ActivityTotal getActivitySummary(int accountId, const TimeRange& range) override;
+
+    // Utility operations
+    double getTotalBalance(int userId) override;
+    bool accountExists(const std::string& accountNumber) override;
+    const std::deque<ServiceCall>& getRecentCalls() const override { return m_recentCalls; }
+
+private:
+    protocol::MessageWriter beginRequest(protocol::Opcode opcode);
+
+    /**
+     * @brief Send a request and wait for its response
+     * @return Reader positioned at the result, valid until the next call
+     */
+    std::optional<protocol::MessageReader> call(const char* operation, protocol::MessageWriter& request);
+
+    bool sendAll(const std::string& data);
+    bool receiveAll(char* data, std::size_t size);
+    bool checkDecoded(const protocol::MessageReader& reader);
+
+    std::string m_address;
+    int m_fd;
+    std::uint32_t m_nextRequestId;
+    std::string m_response;
+    std::string m_lastError;
+    std::deque<ServiceCall> m_recentCalls;
+};
+
+} // namespace bank
+
+#endif // REMOTE_BANK_SERVICE_HPP
@@ -0,0 +1,75 @@
+#ifndef REQUEST_ARENA_HPP
+#define REQUEST_ARENA_HPP
+
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+namespace bank {
+
+// Statement parameters and result rows allocated from a request's arena
+using ArenaParams = std::pmr::vector<std::pmr::string>;
+using ArenaRow = std::pmr::vector<std::pmr::string>;
+using ArenaRows = std::pmr::vector<ArenaRow>;
+
+/**
+ * @brief Monotonic memory for the temporaries of one request
+ *
+ * Allocations are carved out of an inline buffer, then out of chunks
+ * taken from the heap when that runs out; deallocation does nothing.
+ * release() gives back everything at once and starts over at the inline
+ * buffer, so a request whose temporaries fit never touches the heap.
+ *
+ * Only the thread running the request may use it. Whatever is allocated
+ * here must be gone when the request ends: results handed to callers
+ * (Account, Transaction, ...) use the default allocator.
+ */
+class RequestArena {
+public:
+    // Holds the rows of a default 50-transaction history page
+    static constexpr std::size_t kInlineBytes = 32 * 1024;
+
+    RequestArena();
+
+    RequestArena(const RequestArena&) = delete;
+    RequestArena& operator=(const RequestArena&) = delete;
+
+    std::pmr::memory_resource* resource() { return &m_resource; }
+
+    /**
+     * @brief Free everything allocated since the last release
+     */
+    void release() { m_resource.release(); }
+
+    /**
+     * @brief Makes an arena the calling thread's requestArena() until destroyed
+     *
+     * Only the outermost scope on a thread takes effect, and it releases
+     * the arena when it ends, so nested calls share their caller's arena.
+     */
+    class Scope {
+    public:
+        explicit Scope(RequestArena& arena);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        RequestArena* m_arena;      // nullptr for nested scopes
+    };
+
+private:
+    alignas(std::max_align_t) std::byte m_buffer[kInlineBytes];
+    std::pmr::monotonic_buffer_resource m_resource;
+};
+
+/**
+ * @brief The arena of the request running on this thread, or the default resource outside one
+ */
+std::pmr::memory_resource* requestArena();
+
+} // namespace bank
+
+#endif // REQUEST_ARENA_HPP
@@ -0,0 +1,77 @@
+#ifndef ROW_READER_HPP
+#define ROW_READER_HPP
+
+#include "RequestArena.hpp"
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bank {
+
+/**
+ * @brief Copy every row of a result into owned strings
+ *
+ * Source is anything shaped like a PGresult: rows(), columns(), and
+ * value(row, column) / length(row, column) for the text of each field.
+ * Database adapts PGresult; the microbenchmarks use in-memory results so
+ * this loop can be measured without a server.
+ */
+template <typename Source>
+std::vector<std::vector<std::string>> readRows(const Source& source) {
+    std::vector<std::vector<std::string>> rows;
+
+    int numRows = source.rows();
+    int numCols = source.columns();
+    rows.reserve(static_cast<std::size_t>(numRows));
+
+    for (int i = 0; i < numRows; ++i) {
+        std::vector<std::string> row;
+        row.reserve(static_cast<std::size_t>(numCols));
+        for (int j = 0; j < numCols; ++j) {
+            const char* value = source.value(i, j);
+            if (value) {
+                row.emplace_back(value, static_cast<std::size_t>(source.length(i, j)));
+            } else {
+                row.emplace_back();
+            }
+        }
+        rows.push_back(std::move(row));
+    }
+
+    return rows;
+}
+
+/**
+ * @brief Copy every row of a result into strings allocated from an arena
+ *
+ * Same as readRows(source), for rows that are decoded and dropped before
+ * the request ends.
+ */
+template <typename Source>
+ArenaRows readRows(const Source& source, std::pmr::memory_resource* arena) {
+    ArenaRows rows(arena);
+
+    int numRows = source.rows();
+    int numCols = source.columns();
+    rows.reserve(static_cast<std::size_t>(numRows));
+
+    for (int i = 0; i < numRows; ++i) {
+        ArenaRow& row = rows.emplace_back();
+        row.reserve(static_cast<std::size_t>(numCols));
+        for (int j = 0; j < numCols; ++j) {
+            const char* value = source.value(i, j);
+            if (value) {
+                row.emplace_back(value, static_cast<std::size_t>(source.length(i, j)));
+            } else {
+                row.emplace_back();
+            }
+        }
+    }
+
+    return rows;
+}
+
+} // namespace bank
+
+#endif // ROW_READER_HPP
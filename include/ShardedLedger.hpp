@@ -0,0 +1,228 @@
+#ifndef SHARDED_LEDGER_HPP
+#define SHARDED_LEDGER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "LedgerStore.hpp"
+
+namespace bank {
+
+/**
+ * @brief Settings for a ShardedLedger
+ */
+struct ShardedLedgerOptions {
+    std::size_t shards = 0;             // 0: one per hardware thread
+    std::size_t maxBatch = 1024;        // Commands a shard applies before handing off a batch
+};
+
+/**
+ * @brief Counters of a ShardedLedger since it started
+ */
+struct ShardedLedgerStats {
+    std::vector<std::uint64_t> shardCommands;   // Commands applied by each shard
+    std::uint64_t rejected = 0;                 // Failed validation (funds, status, unknown account)
+    std::uint64_t crossShardTransfers = 0;
+    std::uint64_t refunds = 0;                  // Cross-shard transfers undone by the credit side
+    std::uint64_t batches = 0;                  // Batches handed to the store
+    std::uint64_t storeScopes = 0;              // Store transaction scopes committed
+    std::uint64_t records = 0;                  // Transactions appended to the store
+};
+
+/**
+ * @brief Single-writer, in-memory engine for deposits, withdrawals and transfers
+ *
+ * Accounts are partitioned by id over N shards. Each shard is owned by
+ * one thread, which is the only writer of its accounts' balances: commands
+ * are pushed onto the shard's lock-free queue by any thread and applied in
+ * order, without locks or database round trips. An account is loaded from
+ * the store the first time its shard needs it.
+ *
+ * A transfer between shards takes two steps. The debit shard checks and
+ * debits the source, then forwards the command to the credit shard, which
+ * credits the target, or sends it back to be refunded if the target cannot
+ * accept it. Both halves are persisted together by the credit shard, so
+ * the store never sees one without the other. The price is ordering: the
+ * source's TransferOut record can land after records of changes the
+ * source made while the credit was on its way.
+ *
+ * Shards hand their changes to a persister thread in batches: a batch is
+ * sealed whenever the shard's queue runs dry or maxBatch commands were
+ * applied. The persister writes every batch waiting for it in one store
+ * scope, merging the balance changes per account, and only then completes
+ * the commands in it. A completion therefore means the change is durable.
+ *
+ * While the engine runs it owns the balances of the accounts it has
+ * loaded; they must not be changed, frozen or deleted through the store
+ * by anyone else. If the store rejects a batch the engine stops: every
+ * pending and later command fails, and getLastError() says why.
+ *
+ * Thread safe. Completions run on the engine's threads and must not block.
+ */
+class ShardedLedger {
+public:
+    /**
+     * @brief Receives the outcome of a command
+     * @param ok Whether the command was applied and persisted
+     * @param balance Balance of the (source) account afterwards
+     */
+    using Completion = std::function<void(bool ok, double balance)>;
+
+    explicit ShardedLedger(std::shared_ptr<LedgerStore> store, ShardedLedgerOptions options = {});
+
+    /**
+     * @brief Completes all accepted commands, then stops the threads
+     */
+    ~ShardedLedger();
+
+    ShardedLedger(const ShardedLedger&) = delete;
+    ShardedLedger& operator=(const ShardedLedger&) = delete;
+
+    void deposit(int accountId, double amount, std::string description, Completion done);
+    void withdraw(int accountId, double amount, std::string description, Completion done);
+    void transfer(int fromAccountId, int toAccountId, double amount, std::string description,
+                  Completion done);
+
+    /**
+     * @brief Read a balance through the owning shard
+     *
+     * Includes changes that are applied but not yet persisted.
+     */
+    void inquire(int accountId, Completion done);
+
+    /**
+     * @brief Wait until every command accepted so far has completed
+     */
+    void drain();
+
+    std::size_t getShardCount() const { return m_shards.size(); }
+    ShardedLedgerStats getStats() const;
+    std::string getLastError() const;
+
+private:
+    enum class Step : std::uint8_t {
+        Deposit,
+        Withdraw,
+        Transfer,   // On the debit shard
+        Credit,     // On the credit shard
+        Refund,     // Back on the debit shard
+        Inquire
+    };
+
+    struct Command {
+        std::atomic<Command*> next{nullptr};
+        Step step;
+        int accountId;
+        int otherAccountId;
+        long long cents;
+        long long balance;          // Source balance after the command, in cents
+        std::string description;
+        std::string fromNumber;     // Set by the debit shard of a transfer
+        Completion done;
+    };
+
+    /**
+     * @brief Intrusive multi-producer, single-consumer queue (Vyukov)
+     *
+     * push() is wait-free. pop() may briefly see nothing while a push is
+     * half done; empty() tells that apart from a really empty queue.
+     */
+    class CommandQueue {
+    public:
+        CommandQueue();
+        void push(Command* command);
+        Command* pop();
+        bool empty() const;
+
+    private:
+        alignas(64) std::atomic<Command*> m_head;   // Producers
+        alignas(64) Command* m_tail;                // Consumer
+        Command m_stub;
+    };
+
+    // Amounts are kept in cents, so balances match the stores' two decimals exactly
+    struct Holding {
+        long long balance;
+        AccountStatus status;
+        std::string number;
+    };
+
+    struct Batch {
+        std::unordered_map<int, long long> deltas;  // Net balance change per account, in cents
+        std::vector<Transaction> records;
+        std::vector<Command*> commands;             // Completed once persisted
+    };
+
+    struct Shard {
+        CommandQueue queue;
+        std::unordered_map<int, Holding> accounts;  // Owned by the shard thread
+        std::unique_ptr<Batch> batch;
+        std::size_t batched = 0;
+        std::atomic<std::uint64_t> commands{0};
+        std::atomic<bool> sleeping{false};
+        std::mutex wakeMutex;
+        std::condition_variable wake;
+        std::thread thread;
+    };
+
+    void submit(Step step, int accountId, int otherAccountId, double amount, std::string description,
+                Completion done);
+    void route(Command* command, int accountId);
+    std::size_t shardOf(int accountId) const;
+
+    void shardLoop(std::size_t index);
+    void apply(Shard& shard, Command* command);
+    Holding* holding(Shard& shard, int accountId);
+    void record(Batch& batch, int accountId, TransactionType type, long long cents, long long balanceAfter,
+                const std::string& description, int relatedAccountId = -1);
+    void seal(Shard& shard);
+
+    void persistLoop();
+    bool persist(const std::vector<std::unique_ptr<Batch>>& batches);
+
+    /**
+     * @brief Run a command's completion and free it
+     */
+    void finish(Command* command, bool ok);
+
+    std::shared_ptr<LedgerStore> m_store;
+    std::mutex m_storeMutex;                    // The store is used by shards (loads) and the persister
+    ShardedLedgerOptions m_options;
+    std::vector<std::unique_ptr<Shard>> m_shards;
+
+    std::atomic<bool> m_accepting;
+    std::atomic<bool> m_halting;                // Shards exit once their queues are empty
+    std::atomic<bool> m_failed;
+    std::atomic<std::uint64_t> m_rejected;
+    std::atomic<std::uint64_t> m_crossShard;
+    std::atomic<std::uint64_t> m_refunds;
+
+    // Protected by m_persistMutex
+    mutable std::mutex m_persistMutex;
+    std::condition_variable m_persistReady;
+    std::deque<std::unique_ptr<Batch>> m_sealed;
+    bool m_stopping;
+    std::uint64_t m_batches;
+    std::uint64_t m_storeScopes;
+    std::uint64_t m_records;
+    std::string m_lastError;
+    std::thread m_persister;
+
+    // Commands accepted but not completed
+    std::atomic<std::uint64_t> m_inFlight;
+    std::mutex m_drainMutex;
+    std::condition_variable m_drained;
+};
+
+} // namespace bank
+
+#endif // SHARDED_LEDGER_HPP
@@ -0,0 +1,139 @@
+#ifndef SLOW_QUERY_LOG_HPP
+#define SLOW_QUERY_LOG_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include "Database.hpp"
+
+namespace bank {
+
+/**
+ * @brief What counts as slow and where it is reported
+ */
+struct SlowQueryOptions {
+    double thresholdMillis = 500.0;
+    std::string path;               // Appended to; empty logs to stderr
+    bool explain = true;            // Capture a plan for the first slow run of each shape
+};
+
+/**
+ * @brief Plan captured for a slow statement shape
+ */
+struct SlowQueryPlan {
+    std::string shape;
+    double millis;                  // Duration of the run that triggered the capture
+    std::string plan;               // EXPLAIN output, or why it could not be captured
+};
+
+/**
+ * @brief Log of statements slower than a threshold, with their plans
+ *
+ * Every Database given the log reports statements that took at least
+ * the threshold. Each report is one line with the statement's shape (the
+ * SQL with literals replaced by ?), its row count and duration, and the
+ * length of each parameter; parameter values are never written.
+ *
+ * The first slow run of each SELECT, INSERT, UPDATE, DELETE or WITH shape
+ * is also run again under EXPLAIN (ANALYZE, BUFFERS), with the original
+ * parameters, on a side connection of its own. That happens inside a
+ * transaction that is always rolled back, with short lock and statement
+ * timeouts, on a background thread, so the reporting connection is not
+ * held up. Writes are undone, but sequences still advance.
+ *
+ * One log may be shared by any number of connections.
+ */
+class SlowQueryLog {
+public:
+    using ConnectionFactory = std::function<std::shared_ptr<Database>()>;
+
+    /**
+     * @param options Threshold and destination
+     * @param connect Creates the side connection for EXPLAIN; must not
+     *                attach this log. Without it no plans are captured.
+     */
+    SlowQueryLog(SlowQueryOptions options, ConnectionFactory connect = nullptr);
+    ~SlowQueryLog();
+
+    SlowQueryLog(const SlowQueryLog&) = delete;
+    SlowQueryLog& operator=(const SlowQueryLog&) = delete;
+
+    /**
+     * @brief Open the log file
+     * @return false if it could not be opened, see getLastError()
+     */
+    bool open();
+
+    double getThresholdMillis() const { return m_options.thresholdMillis; }
+
+    /**
+     * @brief Record a statement that took at least the threshold
+     * @param values Its parameters, or nullptr for plain SQL; copied only
+     *               when the statement is queued for EXPLAIN
+     */
+    void report(std::string_view query, const char* const* values, int count,
+                int rows, double millis, bool ok);
+
+    /**
+     * @brief Plans captured so far, oldest first
+     */
+    std::vector<SlowQueryPlan> getPlans() const;
+
+    std::uint64_t getSlowCount() const { return m_slowCount.load(std::memory_order_relaxed); }
+    const std::string& getLastError() const { return m_lastError; }
+
+    /**
+     * @brief Collapse whitespace and replace string and number literals by ?
+     */
+    static std::string shapeOf(const std::string& query);
+
+    static constexpr std::size_t kMaxShapes = 1024;     // Shapes remembered for EXPLAIN
+    static constexpr std::size_t kMaxPendingPlans = 16; // Further captures are skipped
+
+private:
+    struct PlanJob {
+        std::string shape;
+        std::string query;
+        std::vector<std::string> params;
+        bool hasParams;
+        double millis;
+    };
+
+    void explainLoop();
+    std::string explain(const PlanJob& job);
+    void write(const std::string& text);
+
+    SlowQueryOptions m_options;
+    ConnectionFactory m_connect;
+    std::string m_lastError;
+    std::atomic<std::uint64_t> m_slowCount;
+
+    std::mutex m_writeMutex;
+    std::ofstream m_file;
+
+    // Shared with the EXPLAIN thread
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::unordered_set<std::string> m_seenShapes;
+    std::deque<PlanJob> m_jobs;
+    std::vector<SlowQueryPlan> m_plans;
+    bool m_stopping;
+    std::thread m_thread;
+
+    // EXPLAIN thread only
+    std::shared_ptr<Database> m_side;
+};
+
+} // namespace bank
+
+#endif // SLOW_QUERY_LOG_HPP
@@ -0,0 +1,414 @@
+#ifndef STATEMENT_HPP
+#define STATEMENT_HPP
+
+#include <charconv>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Database.hpp"
+#include "EnumNames.hpp"
+#include "PgResultRows.hpp"
+#include "Timestamp.hpp"
+
+namespace bank {
+
+/**
+ * @brief Statements whose parameter and column types are part of their type
+ *
+ * A statement is declared once, as a constexpr object:
+ *
+ *     inline constexpr auto kFindAccountById = sql::statement<
+ *         sql::Params<int>, sql::Columns<int, std::string_view, double>>(
+ *         "find_account_by_id", "SELECT account_id, account_number, balance ",
+ *         "FROM accounts WHERE account_id = $1");
+ *
+ * The SQL is assembled and checked at compile time: a placeholder count
+ * that differs from Params, or a SELECT list or RETURNING clause that
+ * differs from Columns, makes the declaration fail to compile.
+ *
+ * sql::query() encodes the parameters with Field<T> into stack buffers,
+ * runs the statement through Database::executePrepared(), which prepares
+ * it on first use per connection, and hands each row to a callback as
+ * typed values decoded straight from the result. std::string_view
+ * columns point into the result and are only valid during the callback.
+ * A field that does not parse as its column type fails the statement
+ * rather than reaching the callback as a default value.
+ */
+namespace sql {
+
+template <typename... T>
+struct Params {};
+
+template <typename... T>
+struct Columns {};
+
+/**
+ * @brief NUL-terminated SQL text built at compile time
+ */
+template <std::size_t N>
+struct Text {
+    char chars[N];
+};
+
+template <std::size_t... N>
+constexpr Text<(N + ...) - sizeof...(N) + 1> concat(const char (&... parts)[N]) {
+    Text<(N + ...) - sizeof...(N) + 1> text{};
+    std::size_t length = 0;
+    auto append = [&text, &length](const char* part, std::size_t size) {
+        for (std::size_t i = 0; i + 1 < size; ++i) {
+            text.chars[length++] = part[i];
+        }
+    };
+    (append(parts, N), ...);
+    text.chars[length] = '\0';
+    return text;
+}
+
+namespace detail {
+
+constexpr bool matchesAt(const char* text, std::size_t pos, const char* word) {
+    for (std::size_t i = 0; word[i] != '\0'; ++i) {
+        if (text[pos + i] != word[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Highest $N placeholder in the statement
+ */
+constexpr std::size_t countParameters(const char* sql) {
+    std::size_t highest = 0;
+    for (std::size_t i = 0; sql[i] != '\0'; ++i) {
+        if (sql[i] != '$') {
+            continue;
+        }
+        std::size_t number = 0;
+        while (sql[i + 1] >= '0' && sql[i + 1] <= '9') {
+            number = number * 10 + static_cast<std::size_t>(sql[++i] - '0');
+        }
+        highest = number > highest ? number : highest;
+    }
+    return highest;
+}
+
+/**
+ * @brief Items in the SELECT list or RETURNING clause, 0 for neither
+ *
+ * Commas inside parentheses or quotes do not separate items.
+ */
+constexpr std::size_t countColumns(const char* sql) {
+    std::size_t pos = 0;
+    while (sql[pos] == ' ' || sql[pos] == '\n') {
+        ++pos;
+    }
+    bool select = matchesAt(sql, pos, "SELECT ");
+    int depth = 0;
+    bool quoted = false;
+    if (!select) {
+        // Find a top-level RETURNING
+        for (; sql[pos] != '\0'; ++pos) {
+            if (sql[pos] == '\'') {
+                quoted = !quoted;
+            } else if (!quoted && sql[pos] == '(') {
+                ++depth;
+            } else if (!quoted && sql[pos] == ')') {
+                --depth;
+            } else if (!quoted && depth == 0 && matchesAt(sql, pos, " RETURNING ")) {
+                break;
+            }
+        }
+        if (sql[pos] == '\0') {
+            return 0;
+        }
+    }
+
+    std::size_t items = 1;
+    for (pos += select ? 7 : 11; sql[pos] != '\0' && sql[pos] != ';'; ++pos) {
+        if (sql[pos] == '\'') {
+            quoted = !quoted;
+        } else if (quoted) {
+            continue;
+        } else if (sql[pos] == '(') {
+            ++depth;
+        } else if (sql[pos] == ')') {
+            --depth;
+        } else if (depth == 0 && sql[pos] == ',') {
+            ++items;
+        } else if (depth == 0 && select && matchesAt(sql, pos, " FROM ")) {
+            break;
+        }
+    }
+    return items;
+}
+
+/**
+ * @brief Parse a whole field as a number; trailing text or overflow fails
+ */
+template <typename T>
+std::optional<T> parseNumber(const char* text, int length) {
+    T value{};
+    auto [end, error] = std::from_chars(text, text + length, value);
+    if (error != std::errc() || end != text + length) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+} // namespace detail
+
+constexpr std::size_t kScratchBytes = 32;   // Longest encoded number or timestamp, with its terminator
+
+/**
+ * @brief Text encoding of a parameter and decoding of a column of type T
+ *
+ * encode() returns NUL-terminated text, written to scratch when it is
+ * not already stored somewhere. decode() parses one field of a text-format
+ * result, or returns nullopt if the text is not a valid T.
+ */
+template <typename T, typename Enable = void>
+struct Field;
+
+template <>
+struct Field<int> {
+    static const char* encode(int value, char* scratch) {
+        *std::to_chars(scratch, scratch + kScratchBytes - 1, value).ptr = '\0';
+        return scratch;
+    }
+    static std::optional<int> decode(const char* text, int length) {
+        return detail::parseNumber<int>(text, length);
+    }
+};
+
+template <>
+struct Field<double> {
+    static const char* encode(double value, char* scratch) {
+        *std::to_chars(scratch, scratch + kScratchBytes - 1, value).ptr = '\0';
+        return scratch;
+    }
+    static std::optional<double> decode(const char* text, int length) {
+        return detail::parseNumber<double>(text, length);
+    }
+};
+
+template <>
+struct Field<std::string> {
+    static const char* encode(const std::string& value, char*) { return value.c_str(); }
+    static std::optional<std::string> decode(const char* text, int length) {
+        return std::string(text, static_cast<std::size_t>(length));
+    }
+};
+
+// Column only: parameters must be NUL terminated
+template <>
+struct Field<std::string_view> {
+    static std::optional<std::string_view> decode(const char* text, int length) {
+        return std::string_view(text, static_cast<std::size_t>(length));
+    }
+};
+
+// Column only: NULL (empty text) decodes to an empty optional
+template <typename T>
+struct Field<std::optional<T>> {
+    static std::optional<std::optional<T>> decode(const char* text, int length) {
+        if (length == 0) {
+            return std::optional<std::optional<T>>(std::in_place);
+        }
+        auto value = Field<T>::decode(text, length);
+        if (!value.has_value()) {
+            return std::nullopt;
+        }
+        return std::optional<std::optional<T>>(std::in_place, std::move(*value));
+    }
+};
+
+// Local time, as TIMESTAMP columns hold it
+template <>
+struct Field<Timestamp> {
+    static const char* encode(Timestamp value, char* scratch) {
+        value.format(scratch);
+        scratch[Timestamp::kTextLength] = '\0';
+        return scratch;
+    }
+    static std::optional<Timestamp> decode(const char* text, int length) {
+        return Timestamp::parse(std::string_view(text, static_cast<std::size_t>(length)));
+    }
+};
+
+template <typename E>
+struct Field<E, std::enable_if_t<std::is_enum_v<E>>> {
+    static const char* encode(E value, char*) { return enumName(value).data(); }
+    static std::optional<E> decode(const char* text, int length) {
+        return findEnum<E>(std::string_view(text, static_cast<std::size_t>(length)));
+    }
+};
+
+template <typename ParamList, typename ColumnList, std::size_t N>
+class Statement;
+
+template <typename... P, typename... C, std::size_t N>
+class Statement<Params<P...>, Columns<C...>, N> {
+public:
+    static constexpr std::size_t kParams = sizeof...(P);
+    static constexpr std::size_t kColumns = sizeof...(C);
+
+    // Throwing during constant evaluation is what turns a mismatch into a compile error
+    constexpr Statement(const char* name, Text<N> text)
+        : m_name(name)
+        , m_text(text)
+    {
+        if (detail::countParameters(m_text.chars) != kParams) {
+            throw std::logic_error("Statement placeholders do not match its Params");
+        }
+        if (detail::countColumns(m_text.chars) != kColumns) {
+            throw std::logic_error("Statement columns do not match its Columns");
+        }
+    }
+
+    constexpr const char* name() const { return m_name; }
+    constexpr const char* sql() const { return m_text.chars; }
+
+    /**
+     * @brief Call onRow with the typed columns of every row of a result
+     *
+     * Source is shaped like a PGresult, as for readRows().
+     *
+     * @return false if the result does not have this statement's columns,
+     *         or at the first row with a field that does not parse
+     */
+    template <typename Source, typename Fn>
+    bool decode(const Source& source, Fn&& onRow) const {
+        if (source.columns() != static_cast<int>(kColumns)) {
+            return false;
+        }
+        for (int row = 0, rows = source.rows(); row < rows; ++row) {
+            if (!decodeRow(source, row, onRow, std::index_sequence_for<C...>{})) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    template <typename Source, typename Fn, std::size_t... I>
+    static bool decodeRow([[maybe_unused]] const Source& source, [[maybe_unused]] int row, Fn& onRow,
+                          std::index_sequence<I...>)
+    {
+        [[maybe_unused]] std::tuple<std::optional<C>...> fields(
+            Field<C>::decode(source.value(row, static_cast<int>(I)),
+                             source.length(row, static_cast<int>(I)))...);
+        if (!(std::get<I>(fields).has_value() && ...)) {
+            return false;
+        }
+        onRow(std::move(*std::get<I>(fields))...);
+        return true;
+    }
+
+    const char* m_name;
+    Text<N> m_text;
+};
+
+/**
+ * @brief Declare a statement from SQL fragments, e.g. a shared column list
+ */
+template <typename ParamList, typename ColumnList, std::size_t... N>
+constexpr auto statement(const char* name, const char (&... parts)[N]) {
+    constexpr std::size_t size = (N + ...) - sizeof...(N) + 1;
+    return Statement<ParamList, ColumnList, size>(name, concat(parts...));
+}
+
+template <typename T>
+struct Identity {
+    using type = T;
+};
+
+/**
+ * @brief Run a statement and call onRow(columns...) for every row it returns
+ * @return false if the statement failed (see Database::getLastError()) or
+ *         a row of its result could not be decoded
+ */
+template <typename... P, typename... C, std::size_t N, typename Fn>
+bool query(Database& db, const Statement<Params<P...>, Columns<C...>, N>& statement, Fn&& onRow,
+           const typename Identity<P>::type&... params)
+{
+    [[maybe_unused]] char scratch[sizeof...(P) + 1][kScratchBytes];  // Unused without parameters
+    const char* values[sizeof...(P) + 1] = {};
+    std::size_t i = 0;
+    ((values[i] = Field<P>::encode(params, scratch[i]), ++i), ...);
+
+    bool decoded = true;
+    auto read = [&](const PGresult* result) {
+        decoded = statement.decode(PgResultRows(result), onRow);
+    };
+    // std::ref keeps std::function from allocating for the captures
+    bool ok = db.executePrepared(statement.name(), statement.sql(), values, static_cast<int>(sizeof...(P)),
+                                 std::ref(read));
+    return ok && decoded;
+}
+
+/**
+ * @brief A statement's text and encoded parameters, for Database::queryPipelined()
+ *
+ * The text is sent unprepared; decode the result with Statement::decode()
+ * over StringRows.
+ */
+template <typename... P, typename... C, std::size_t N>
+PipelinedQuery pipelined(const Statement<Params<P...>, Columns<C...>, N>& statement,
+                         const typename Identity<P>::type&... params)
+{
+    PipelinedQuery query{statement.sql(), {}};
+    query.params.reserve(sizeof...(P));
+    [[maybe_unused]] char scratch[kScratchBytes];
+    (query.params.emplace_back(Field<P>::encode(params, scratch)), ...);
+    return query;
+}
+
+/**
+ * @brief Presents rows already copied into strings to Statement::decode()
+ *
+ * For the results of Database::queryPipelined(), where NULL reads as an
+ * empty field as it does from a PGresult. Rows do not record the width of
+ * an empty result, so the caller supplies it.
+ */
+class StringRows {
+public:
+    StringRows(const std::vector<std::vector<std::string>>& rows, int columns)
+        : m_rows(rows)
+        , m_columns(columns)
+    {
+    }
+
+    int rows() const { return static_cast<int>(m_rows.size()); }
+    int columns() const { return m_rows.empty() ? m_columns : static_cast<int>(m_rows[0].size()); }
+    const char* value(int row, int column) const { return m_rows[row][column].c_str(); }
+    int length(int row, int column) const { return static_cast<int>(m_rows[row][column].size()); }
+
+private:
+    const std::vector<std::vector<std::string>>& m_rows;
+    int m_columns;
+};
+
+/**
+ * @brief Run a statement that returns no rows
+ */
+template <typename... P, std::size_t N>
+bool execute(Database& db, const Statement<Params<P...>, Columns<>, N>& statement,
+             const typename Identity<P>::type&... params)
+{
+    return query(db, statement, [] {}, params...);
+}
+
+} // namespace sql
+
+} // namespace bank
+
+#endif // STATEMENT_HPP
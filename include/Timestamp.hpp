@@ -0,0 +1,123 @@
+#ifndef TIMESTAMP_HPP
+#define TIMESTAMP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include "EnumNames.hpp"
+
+namespace bank {
+
+/**
+ * @brief Calendar periods of local time that activity is rolled up into
+ */
+enum class TimeUnit : std::uint8_t {
+    Hour,
+    Day,
+    Month
+};
+
+// Also the date_trunc() field names
+template <>
+struct EnumNames<TimeUnit> {
+    static constexpr std::string_view names[] = {"hour", "day", "month"};
+};
+
+/**
+ * @brief A point in time, as microseconds since the Unix epoch
+ *
+ * TIMESTAMP columns hold local wall-clock time without a zone, so text
+ * without an offset is read as local time and format() writes local time,
+ * both in PostgreSQL's "YYYY-MM-DD HH:MM:SS.ffffff" layout. Conversions
+ * neither allocate nor lock: each thread caches the span between the
+ * local zone's offset changes it last looked at. A wall time repeated when
+ * clocks go back reads as its earlier instant. The default value is the
+ * epoch and stands for "not set".
+ */
+class Timestamp {
+public:
+    static constexpr std::size_t kTextLength = 26;  // "YYYY-MM-DD HH:MM:SS.ffffff"
+
+    constexpr Timestamp() : m_micros(0) {}
+
+    static constexpr Timestamp fromMicros(std::int64_t micros) { return Timestamp(micros); }
+    static Timestamp now();
+
+    /**
+     * @brief Read ISO-8601 or PostgreSQL timestamp text
+     *
+     * Accepts "YYYY-MM-DD", optionally followed by 'T' or ' ' and
+     * "HH:MM[:SS[.fraction]]", optionally followed by 'Z' or an offset
+     * "+HH[[:]MM]"; fractions beyond microseconds are truncated.
+     *
+     * @return The timestamp, or nullopt if the text is anything else
+     */
+    static std::optional<Timestamp> parse(std::string_view text);
+
+    /**
+     * @brief Write local time as kTextLength characters, without a terminator
+     *
+     * Years outside 0-9999 are clamped to that range.
+     */
+    void format(char* out) const;
+    std::string toString() const;
+
+    /**
+     * @brief Start of the local hour, day or month containing this timestamp
+     */
+    Timestamp startOf(TimeUnit unit) const;
+
+    /**
+     * @brief Start of the local hour, day or month after the one containing this timestamp
+     */
+    Timestamp startOfNext(TimeUnit unit) const;
+
+    constexpr std::int64_t micros() const { return m_micros; }
+    constexpr double seconds() const { return static_cast<double>(m_micros) / 1e6; }
+
+    constexpr bool operator==(Timestamp other) const { return m_micros == other.m_micros; }
+    constexpr bool operator!=(Timestamp other) const { return m_micros != other.m_micros; }
+    constexpr bool operator<(Timestamp other) const { return m_micros < other.m_micros; }
+    constexpr bool operator<=(Timestamp other) const { return m_micros <= other.m_micros; }
+    constexpr bool operator>(Timestamp other) const { return m_micros > other.m_micros; }
+    constexpr bool operator>=(Timestamp other) const { return m_micros >= other.m_micros; }
+
+private:
+    explicit constexpr Timestamp(std::int64_t micros) : m_micros(micros) {}
+
+    std::int64_t m_micros;
+};
+
+/**
+ * @brief The half-open interval [from, to)
+ */
+struct TimeRange {
+    Timestamp from;
+    Timestamp to;
+
+    constexpr bool contains(Timestamp t) const { return from <= t && t < to; }
+    constexpr bool empty() const { return to <= from; }
+};
+
+/**
+ * @brief A range split into the fewest whole local months, days and hours
+ *
+ * The months lie in the middle, flanked by days, then hours, then the
+ * parts shorter than an hour at either end; any piece may be empty. In
+ * time order the pieces are rest[0], hours[0], days[0], months, days[1],
+ * hours[1], rest[1].
+ */
+struct RangeCover {
+    TimeRange months;
+    TimeRange days[2];      // Before and after the months
+    TimeRange hours[2];     // Before and after the days
+    TimeRange rest[2];      // Before and after the hours
+
+    static RangeCover of(const TimeRange& range);
+};
+
+} // namespace bank
+
+#endif // TIMESTAMP_HPP
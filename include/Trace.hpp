@@ -0,0 +1,119 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace bank {
+
+/**
+ * @brief Scoped timing spans, kept per thread and written as Chrome trace JSON
+ *
+ * A Span records when it was created and destroyed. While tracing is
+ * started, every thread appends its finished spans to a ring buffer of
+ * its own, so the newest events per thread are always kept and older
+ * ones are overwritten. writeChromeTrace() copies all buffers into a file
+ * for chrome://tracing or ui.perfetto.dev, where nested spans show as a
+ * flame graph per thread.
+ *
+ * While tracing is stopped a Span costs one relaxed load of the flag and
+ * a branch on it; nothing is timed, locked or allocated.
+ */
+namespace trace {
+
+constexpr std::size_t kDefaultEventsPerThread = 1 << 16;
+constexpr std::size_t kMaxDetail = 47;     // Longer details are truncated
+
+namespace detail {
+extern std::atomic<bool> g_enabled;
+} // namespace detail
+
+inline bool isEnabled() {
+    return detail::g_enabled.load(std::memory_order_relaxed);
+}
+
+inline std::uint64_t toNanos(std::chrono::steady_clock::time_point time) {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count());
+}
+
+inline std::uint64_t now() {
+    return toNanos(std::chrono::steady_clock::now());
+}
+
+/**
+ * @brief Start recording, discarding the events of an earlier run
+ * @param eventsPerThread Ring buffer size of each thread
+ */
+void start(std::size_t eventsPerThread = kDefaultEventsPerThread);
+
+/**
+ * @brief Stop recording; the events recorded so far can still be written
+ */
+void stop();
+
+/**
+ * @brief Write every thread's events in the Chrome trace event format
+ * @return false if the file could not be written
+ */
+bool writeChromeTrace(const std::string& path);
+
+/**
+ * @brief Name the calling thread in written traces
+ */
+void setThreadName(const std::string& name);
+
+/**
+ * @brief Record a finished span on the calling thread
+ *
+ * For code that already has its start time, e.g. Database timing a
+ * statement; everything else uses Span.
+ *
+ * @param category Static string, e.g. "db"
+ * @param name Static string, e.g. "query"
+ * @param detail Copied, e.g. the statement tag
+ */
+void record(const char* category, const char* name, std::string_view detail,
+            std::uint64_t startNanos, std::uint64_t endNanos);
+
+/**
+ * @brief Records the time from its construction to its destruction
+ *
+ * category and name must be string literals (or otherwise outlive the
+ * trace), and detail must outlive the span.
+ */
+class Span {
+public:
+    Span(const char* category, const char* name, std::string_view detail = {})
+        : m_start(isEnabled() ? now() : 0)
+        , m_category(category)
+        , m_name(name)
+        , m_detail(detail)
+    {
+    }
+
+    ~Span() {
+        if (m_start != 0) {
+            record(m_category, m_name, m_detail, m_start, now());
+        }
+    }
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+private:
+    std::uint64_t m_start;      // 0 when tracing was stopped
+    const char* m_category;
+    const char* m_name;
+    std::string_view m_detail;
+};
+
+} // namespace trace
+
+} // namespace bank
+
+#endif // TRACE_HPP
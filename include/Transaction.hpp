@@ -1,21 +1,49 @@
 #ifndef TRANSACTION_HPP
 #define TRANSACTION_HPP
 
+#include <cstdint>
 #include <string>
-#include <ctime>
+#include <string_view>
+#include <utility>
+#include "EnumNames.hpp"
+#include "Timestamp.hpp"
 
 namespace bank {
 
 /**
  * @brief Transaction types
  */
-enum class TransactionType {
+enum class TransactionType : std::uint8_t {
     Deposit,
     Withdrawal,
     TransferIn,
     TransferOut
 };
 
+template <>
+struct EnumNames<TransactionType> {
+    static constexpr std::string_view names[] = {"deposit", "withdrawal", "transfer_in", "transfer_out"};
+};
+
+/**
+ * @brief A single sample of an account balance over time
+ */
+struct BalancePoint {
+    double timestamp;   // Seconds since the Unix epoch
+    double balance;
+};
+
+/**
+ * @brief An account's activity over a period, such as a local calendar day
+ */
+struct ActivityTotal {
+    Timestamp start;                // Start of the period
+    double credits = 0.0;           // Deposits and incoming transfers
+    double debits = 0.0;            // Withdrawals and outgoing transfers
+    int count = 0;                  // Transactions in the period
+    double closingBalance = 0.0;    // Balance after the period's last transaction, if count > 0
+};
+
 /**
  * @brief Represents a bank transaction
  */
@@ -32,9 +60,9 @@ public:
     TransactionType getType() const { return m_type; }
     double getAmount() const { return m_amount; }
     double getBalanceAfter() const { return m_balanceAfter; }
-    std::string getDescription() const { return m_description; }
+    const std::string& getDescription() const { return m_description; }
     int getRelatedAccountId() const { return m_relatedAccountId; }
-    std::string getCreatedAt() const { return m_createdAt; }
+    Timestamp getCreatedAt() const { return m_createdAt; }
 
     // Setters
     void setTransactionId(int id) { m_transactionId = id; }
@@ -42,23 +70,23 @@ public:
     void setType(TransactionType type) { m_type = type; }
     void setAmount(double amount) { m_amount = amount; }
     void setBalanceAfter(double balance) { m_balanceAfter = balance; }
-    void setDescription(const std::string& desc) { m_description = desc; }
+    void setDescription(std::string desc) { m_description = std::move(desc); }
     void setRelatedAccountId(int id) { m_relatedAccountId = id; }
-    void setCreatedAt(const std::string& timestamp) { m_createdAt = timestamp; }
+    void setCreatedAt(Timestamp timestamp) { m_createdAt = timestamp; }
 
     // Utility functions
-    static std::string typeToString(TransactionType type);
-    static TransactionType stringToType(const std::string& typeStr);
+    static std::string typeToString(TransactionType type) { return std::string(enumName(type)); }
+    static constexpr TransactionType stringToType(std::string_view typeStr) { return enumFromName<TransactionType>(typeStr); }
 
 private:
     int m_transactionId;
     int m_accountId;
+    int m_relatedAccountId;
     TransactionType m_type;
     double m_amount;
     double m_balanceAfter;
+    Timestamp m_createdAt;
     std::string m_description;
-    int m_relatedAccountId;
-    std::string m_createdAt;
 };
 
 } // namespace bank
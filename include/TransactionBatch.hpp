@@ -0,0 +1,128 @@
+#ifndef TRANSACTION_BATCH_HPP
+#define TRANSACTION_BATCH_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Transaction.hpp"
+
+namespace bank {
+
+/**
+ * @brief Each distinct string stored once, referred to by a 32-bit id
+ *
+ * Transaction descriptions repeat a lot ("Deposit", "ATM withdrawal",
+ * ...), so a history keeps ids into a pool instead of a string per row.
+ * The strings interned most recently are remembered in a small table
+ * indexed by length and end characters, so loading rows that repeat a
+ * few descriptions compares strings instead of hashing them. Strings are
+ * never removed. Not thread safe.
+ */
+class StringPool {
+public:
+    /**
+     * @brief Id of the text, adding it if it is new
+     */
+    std::uint32_t intern(std::string_view text);
+
+    std::string_view get(std::uint32_t id) const { return m_strings[id]; }
+    std::size_t size() const { return m_strings.size(); }
+
+private:
+    static constexpr std::size_t kRecentSlots = 64;
+
+    struct Recent {
+        std::string_view text;              // Into m_strings; null for an empty slot
+        std::uint32_t id = 0;
+    };
+
+    static std::size_t recentSlot(std::string_view text);
+
+    std::deque<std::string> m_strings;      // Element addresses never change
+    std::unordered_map<std::string_view, std::uint32_t> m_ids;
+    std::array<Recent, kRecentSlots> m_recent;
+};
+
+/**
+ * @brief Transactions stored column by column
+ *
+ * The struct-of-arrays counterpart of std::vector<Transaction> for bulk
+ * history: each field is its own vector, descriptions are ids into a
+ * StringPool, creation times are epoch microseconds and the type is one
+ * byte. A row takes 41 bytes, against over 100 for a Transaction plus
+ * the heap blocks of its two strings, and scanning one column (balances
+ * for a chart, amounts for a sum) reads only that column.
+ *
+ * Accessors return views into the batch; at() materializes a Transaction
+ * for callers that need one. Several batches can share one pool, as the
+ * per-account histories of MemoryLedgerStore do.
+ */
+class TransactionBatch {
+public:
+    TransactionBatch();
+    explicit TransactionBatch(std::shared_ptr<StringPool> descriptions);
+
+    std::size_t size() const { return m_transactionIds.size(); }
+    bool empty() const { return m_transactionIds.empty(); }
+    void reserve(std::size_t count);
+    void clear();
+
+    /**
+     * @brief Append a transaction, reading its creation time from getCreatedAt()
+     */
+    void push_back(const Transaction& transaction);
+
+    /**
+     * @brief Append a transaction created at the given time; getCreatedAt() is ignored
+     */
+    void push_back(const Transaction& transaction, std::int64_t createdAtMicros);
+
+    void pop_back();
+
+    int transactionId(std::size_t i) const { return m_transactionIds[i]; }
+    int accountId(std::size_t i) const { return m_accountIds[i]; }
+    TransactionType type(std::size_t i) const { return m_types[i]; }
+    double amount(std::size_t i) const { return m_amounts[i]; }
+    double balanceAfter(std::size_t i) const { return m_balancesAfter[i]; }
+    std::string_view description(std::size_t i) const { return m_descriptions->get(m_descriptionIds[i]); }
+    int relatedAccountId(std::size_t i) const { return m_relatedAccountIds[i]; }
+    std::int64_t createdAtMicros(std::size_t i) const { return m_createdAt[i]; }
+
+    /**
+     * @brief Copy of row i as a Transaction
+     */
+    Transaction at(std::size_t i) const;
+
+    const std::shared_ptr<StringPool>& getDescriptions() const { return m_descriptions; }
+
+    /**
+     * @brief Read descriptions from another pool whose ids name the same strings
+     */
+    void setDescriptions(std::shared_ptr<StringPool> descriptions) { m_descriptions = std::move(descriptions); }
+
+    /**
+     * @brief Heap bytes held by the columns, not counting the shared pool
+     */
+    std::size_t memoryBytes() const;
+
+private:
+    std::shared_ptr<StringPool> m_descriptions;
+    std::vector<std::int32_t> m_transactionIds;
+    std::vector<std::int32_t> m_accountIds;
+    std::vector<std::int32_t> m_relatedAccountIds;
+    std::vector<TransactionType> m_types;
+    std::vector<std::uint32_t> m_descriptionIds;
+    std::vector<double> m_amounts;
+    std::vector<double> m_balancesAfter;
+    std::vector<std::int64_t> m_createdAt;
+};
+
+} // namespace bank
+
+#endif // TRANSACTION_BATCH_HPP
@@ -0,0 +1,92 @@
+#ifndef WORK_STEALING_POOL_HPP
+#define WORK_STEALING_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bank {
+
+/**
+ * @brief Counters of a WorkStealingPool since it started
+ */
+struct PoolStats {
+    std::uint64_t executed = 0;
+    std::uint64_t stolen = 0;       // Run by a worker other than the one they were queued on
+    std::uint64_t blocked = 0;      // Submissions that waited for queue space
+};
+
+/**
+ * @brief Fixed set of worker threads, each with a bounded task queue
+ *
+ * A task is queued on the worker chosen by its affinity key, so tasks
+ * with the same key run on the same worker (and whatever that worker
+ * owns, such as a connection) unless another worker is idle: idle workers
+ * steal from the far end of busy workers' queues. A full queue blocks the
+ * submitter until the worker catches up, which pushes back on callers
+ * instead of growing without bound.
+ *
+ * Tasks receive the index of the worker running them.
+ */
+class WorkStealingPool {
+public:
+    using Task = std::function<void(std::size_t worker)>;
+
+    /**
+     * @param workers Number of threads; 0 for one per hardware thread
+     * @param queueCapacity Tasks each worker's queue holds before submit() blocks
+     */
+    explicit WorkStealingPool(std::size_t workers = 0, std::size_t queueCapacity = 1024);
+
+    /**
+     * @brief Run the queued tasks, then stop the workers
+     */
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /**
+     * @brief Queue a task on worker (affinity % size())
+     * @return false if the pool is stopping and the task was dropped
+     */
+    bool submit(std::size_t affinity, Task task);
+
+    std::size_t size() const { return m_workers.size(); }
+    PoolStats getStats() const;
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::condition_variable notFull;
+        std::deque<Task> tasks;
+        std::thread thread;
+    };
+
+    void run(std::size_t index);
+    bool takeLocal(std::size_t index, Task& task);
+    bool steal(std::size_t index, Task& task);
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::size_t m_capacity;
+
+    std::atomic<std::size_t> m_queued;
+    std::mutex m_idleMutex;
+    std::condition_variable m_workReady;
+    std::atomic<bool> m_stopping;
+
+    std::atomic<std::uint64_t> m_executed;
+    std::atomic<std::uint64_t> m_stolen;
+    std::atomic<std::uint64_t> m_blocked;
+};
+
+} // namespace bank
+
+#endif // WORK_STEALING_POOL_HPP
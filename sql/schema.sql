@@ -2,6 +2,7 @@
 -- PostgreSQL
 
 -- Drop tables if they exist (for clean setup)
+DROP TABLE IF EXISTS account_rollups CASCADE;
 DROP TABLE IF EXISTS transactions CASCADE;
 DROP TABLE IF EXISTS accounts CASCADE;
 DROP TABLE IF EXISTS users CASCADE;
@@ -43,9 +44,28 @@ CREATE TABLE transactions (
     created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
 );
 
+-- Per account totals of each local hour, day and month with transactions,
+-- maintained by the roll_up_transactions trigger below
+CREATE TABLE account_rollups (
+    account_id INTEGER NOT NULL REFERENCES accounts(account_id) ON DELETE CASCADE,
+    time_unit VARCHAR(5) NOT NULL CHECK (time_unit IN ('hour', 'day', 'month')),
+    bucket_start TIMESTAMP NOT NULL,
+    transaction_count INTEGER NOT NULL,
+    credits DECIMAL(15, 2) NOT NULL,
+    debits DECIMAL(15, 2) NOT NULL,
+    closing_balance DECIMAL(15, 2) NOT NULL,
+    last_at TIMESTAMP NOT NULL,             -- (created_at, transaction_id) of the transaction
+    last_id INTEGER NOT NULL,               -- whose balance_after is closing_balance
+    PRIMARY KEY (account_id, time_unit, bucket_start)
+);
+
 -- Create indexes for better performance
 CREATE INDEX idx_accounts_user_id ON accounts(user_id);
-CREATE INDEX idx_transactions_account_id ON transactions(account_id);
+CREATE INDEX idx_accounts_updated_at ON accounts(updated_at);
+-- History pages and time ranges of one account; the included columns let
+-- daily totals be computed from the index alone
+CREATE INDEX idx_transactions_account_created ON transactions(account_id, created_at)
+    INCLUDE (transaction_id, transaction_type, amount, balance_after);
 CREATE INDEX idx_transactions_created_at ON transactions(created_at);
 
 -- Create a function to update the updated_at timestamp
@@ -67,3 +87,64 @@ CREATE TRIGGER update_accounts_updated_at
     BEFORE UPDATE ON accounts
     FOR EACH ROW
     EXECUTE FUNCTION update_updated_at_column();
+
+-- Fold each INSERT into transactions into the rollups, in the same
+-- transaction. Once per statement, so bulk loads aggregate their rows
+-- before the upsert. created_at is when the writing transaction started,
+-- so rows do not arrive in created_at order: a transaction that started
+-- earlier can commit later. The closing balance therefore only moves to
+-- the inserted rows when their latest (created_at, transaction_id) is
+-- newer than the one the bucket holds.
+CREATE OR REPLACE FUNCTION roll_up_transactions()
+RETURNS TRIGGER AS $$
+BEGIN
+    INSERT INTO account_rollups AS r (account_id, time_unit, bucket_start, transaction_count,
+                                      credits, debits, closing_balance, last_at, last_id)
+    SELECT t.account_id, u.time_unit, date_trunc(u.time_unit, t.created_at), COUNT(*),
+           COALESCE(SUM(t.amount) FILTER (WHERE t.transaction_type IN ('deposit', 'transfer_in')), 0),
+           COALESCE(SUM(t.amount) FILTER (WHERE t.transaction_type IN ('withdrawal', 'transfer_out')), 0),
+           (ARRAY_AGG(t.balance_after ORDER BY t.created_at DESC, t.transaction_id DESC))[1],
+           MAX(t.created_at),
+           (ARRAY_AGG(t.transaction_id ORDER BY t.created_at DESC, t.transaction_id DESC))[1]
+    FROM inserted t CROSS JOIN (VALUES ('hour'), ('day'), ('month')) AS u(time_unit)
+    GROUP BY 1, 2, 3
+    ON CONFLICT (account_id, time_unit, bucket_start) DO UPDATE SET
+        transaction_count = r.transaction_count + EXCLUDED.transaction_count,
+        credits = r.credits + EXCLUDED.credits,
+        debits = r.debits + EXCLUDED.debits,
+        closing_balance = CASE WHEN (EXCLUDED.last_at, EXCLUDED.last_id) > (r.last_at, r.last_id)
+                               THEN EXCLUDED.closing_balance ELSE r.closing_balance END,
+        last_at = CASE WHEN (EXCLUDED.last_at, EXCLUDED.last_id) > (r.last_at, r.last_id)
+                       THEN EXCLUDED.last_at ELSE r.last_at END,
+        last_id = CASE WHEN (EXCLUDED.last_at, EXCLUDED.last_id) > (r.last_at, r.last_id)
+                       THEN EXCLUDED.last_id ELSE r.last_id END;
+    RETURN NULL;
+END;
+$$ language 'plpgsql';
+
+CREATE TRIGGER roll_up_transactions
+    AFTER INSERT ON transactions
+    REFERENCING NEW TABLE AS inserted
+    FOR EACH STATEMENT
+    EXECUTE FUNCTION roll_up_transactions();
+
+-- Rebuild the rollups from the transactions already stored, for a database
+-- that had transactions before account_rollups existed. Run it after the
+-- trigger above is in place; the SHARE lock holds off writers until the
+-- rebuild commits, so no row is counted both here and by the trigger.
+-- Safe to rerun: it replaces whatever the rollups held.
+BEGIN;
+LOCK TABLE transactions IN SHARE MODE;
+DELETE FROM account_rollups;
+INSERT INTO account_rollups (account_id, time_unit, bucket_start, transaction_count,
+                             credits, debits, closing_balance, last_at, last_id)
+SELECT t.account_id, u.time_unit, date_trunc(u.time_unit, t.created_at), COUNT(*),
+       COALESCE(SUM(t.amount) FILTER (WHERE t.transaction_type IN ('deposit', 'transfer_in')), 0),
+       COALESCE(SUM(t.amount) FILTER (WHERE t.transaction_type IN ('withdrawal', 'transfer_out')), 0),
+       (ARRAY_AGG(t.balance_after ORDER BY t.created_at DESC, t.transaction_id DESC))[1],
+       MAX(t.created_at),
+       (ARRAY_AGG(t.transaction_id ORDER BY t.created_at DESC, t.transaction_id DESC))[1]
+FROM transactions t CROSS JOIN (VALUES ('hour'), ('day'), ('month')) AS u(time_unit)
+WHERE t.created_at IS NOT NULL
+GROUP BY 1, 2, 3;
+COMMIT;
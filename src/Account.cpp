@@ -2,31 +2,49 @@
 #include <random>
 #include <sstream>
 #include <iomanip>
+#include <cassert>
+#include <cstring>
 
 namespace bank {
 
 Account::Account()
-    : m_accountId(0)
+    : m_balance(0.0)
+    , m_interestRate(0.0)
+    , m_accountId(0)
     , m_userId(0)
-    , m_accountNumber("")
     , m_type(AccountType::Savings)
-    , m_balance(0.0)
-    , m_interestRate(0.0)
     , m_status(AccountStatus::Active)
+    , m_numberLength(0)
+    , m_accountNumber{}
 {
 }
 
-Account::Account(int accountId, int userId, const std::string& accountNumber,
+Account::Account(int accountId, int userId, std::string_view accountNumber,
                  AccountType type, double balance, double interestRate,
                  AccountStatus status)
-    : m_accountId(accountId)
+    : m_balance(balance)
+    , m_interestRate(interestRate)
+    , m_accountId(accountId)
     , m_userId(userId)
-    , m_accountNumber(accountNumber)
     , m_type(type)
-    , m_balance(balance)
-    , m_interestRate(interestRate)
     , m_status(status)
+    , m_numberLength(0)
+    , m_accountNumber{}
 {
+    bool fits = setAccountNumber(accountNumber);
+    assert(fits && "account numbers are at most kMaxNumberLength characters");
+    (void)fits;
+}
+
+bool Account::setAccountNumber(std::string_view number) {
+    if (number.size() > kMaxNumberLength) {
+        return false;
+    }
+    if (!number.empty()) {
+        std::memcpy(m_accountNumber, number.data(), number.size());
+    }
+    m_numberLength = static_cast<std::uint8_t>(number.size());
+    return true;
 }
 
 bool Account::deposit(double amount) {
@@ -66,50 +84,6 @@ bool Account::transfer(Account& toAccount, double amount) {
     return true;
 }
 
-std::string Account::typeToString(AccountType type) {
-    switch (type) {
-        case AccountType::Savings:
-            return "savings";
-        case AccountType::Checking:
-            return "checking";
-        case AccountType::FixedDeposit:
-            return "fixed_deposit";
-        default:
-            return "savings";
-    }
-}
-
-AccountType Account::stringToType(const std::string& typeStr) {
-    if (typeStr == "checking") {
-        return AccountType::Checking;
-    } else if (typeStr == "fixed_deposit") {
-        return AccountType::FixedDeposit;
-    }
-    return AccountType::Savings;
-}
-
-std::string Account::statusToString(AccountStatus status) {
-    switch (status) {
-        case AccountStatus::Active:
-            return "active";
-        case AccountStatus::Inactive:
-            return "inactive";
-        case AccountStatus::Frozen:
-            return "frozen";
-        default:
-            return "active";
-    }
-}
-
-AccountStatus Account::stringToStatus(const std::string& statusStr) {
-    if (statusStr == "inactive") {
-        return AccountStatus::Inactive;
-    } else if (statusStr == "frozen") {
-        return AccountStatus::Frozen;
-    }
-    return AccountStatus::Active;
-}
-
 std::string Account::generateAccountNumber() {
     std::random_device rd;
     std::mt19937 gen(rd());
@@ -0,0 +1,368 @@
+#include "AccountCache.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+namespace bank {
+
+namespace {
+
+constexpr char kMagic[4] = {'B', 'K', 'A', 'C'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::uint32_t kByteOrderMark = 0x01020304;
+constexpr std::size_t kNumberLength = 20;   // accounts.account_number is VARCHAR(20)
+
+struct SnapshotHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t recordSize;
+    std::uint32_t byteOrder;
+    std::uint64_t count;
+    std::uint64_t indexSlots;
+    char watermark[32];
+};
+
+struct AccountRecord {
+    std::int32_t accountId;
+    std::int32_t userId;
+    char accountNumber[kNumberLength];      // Not terminated when 20 characters long
+    std::uint8_t type;
+    std::uint8_t status;
+    std::uint8_t reserved[2];
+    double balance;
+    double interestRate;
+};
+
+static_assert(sizeof(SnapshotHeader) == 64, "snapshot header must stay 64 bytes");
+static_assert(sizeof(AccountRecord) == 48, "snapshot records must stay 48 bytes");
+
+std::uint32_t hashNumber(const char* data, std::size_t size) {
+    // FNV-1a
+    std::uint32_t hash = 2166136261u;
+    for (std::size_t i = 0; i < size; ++i) {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * 16777619u;
+    }
+    return hash;
+}
+
+std::string fixedString(const char* data, std::size_t size) {
+    return std::string(data, std::find(data, data + size, '\0'));
+}
+
+std::size_t indexSlotsFor(std::size_t count) {
+    std::size_t slots = 16;
+    while (slots < count * 2) {
+        slots *= 2;
+    }
+    return slots;
+}
+
+} // namespace
+
+AccountCache::AccountCache(std::string snapshotPath)
+    : m_path(std::move(snapshotPath))
+    , m_count(0)
+    , m_indexSlots(0)
+    , m_version(0)
+    , m_droppedVersion(0)
+    , m_hits(0)
+    , m_misses(0)
+{
+}
+
+bool AccountCache::load() {
+    MappedFile file;
+    if (!file.open(m_path)) {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        m_lastError = "No snapshot at " + m_path;
+        return false;
+    }
+
+    SnapshotHeader header;
+    bool valid = file.size() >= sizeof(header);
+    if (valid) {
+        std::memcpy(&header, file.data(), sizeof(header));
+        valid = std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 && header.version == kVersion &&
+                header.recordSize == sizeof(AccountRecord) && header.byteOrder == kByteOrderMark &&
+                header.indexSlots == indexSlotsFor(header.count) &&
+                file.size() == sizeof(header) + header.count * sizeof(AccountRecord) + 
+                               header.indexSlots * sizeof(std::uint32_t);
+    }
+
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    if (!valid) {
+        m_lastError = "Unsupported or damaged snapshot " + m_path;
+        return false;
+    }
+    m_snapshot = std::move(file);
+    m_count = header.count;
+    m_indexSlots = header.indexSlots;
+    m_watermark = fixedString(header.watermark, sizeof(header.watermark));
+    m_overlay.clear();
+    m_overlayNumbers.clear();
+    return true;
+}
+
+// Lookups
+
+Account AccountCache::recordAt(std::size_t index) const {
+    AccountRecord record;
+    std::memcpy(&record, static_cast<const char*>(m_snapshot.data()) + sizeof(SnapshotHeader) + 
+                index * sizeof(AccountRecord), sizeof(record));
+    return Account(record.accountId, record.userId, fixedString(record.accountNumber, kNumberLength),
+                   static_cast<AccountType>(record.type), record.balance, record.interestRate,
+                   static_cast<AccountStatus>(record.status));
+}
+
+std::optional<Account> AccountCache::snapshotFind(int accountId) const {
+    const char* records = static_cast<const char*>(m_snapshot.data()) + sizeof(SnapshotHeader);
+    std::size_t low = 0;
+    std::size_t high = m_count;
+    while (low < high) {
+        std::size_t mid = low + (high - low) / 2;
+        std::int32_t id;
+        std::memcpy(&id, records + mid * sizeof(AccountRecord), sizeof(id));
+        if (id == accountId) {
+            return recordAt(mid);
+        }
+        if (id < accountId) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<Account> AccountCache::snapshotFindNumber(const std::string& accountNumber) const {
+    if (m_indexSlots == 0 || accountNumber.size() > kNumberLength) {
+        return std::nullopt;
+    }
+
+    const char* index = static_cast<const char*>(m_snapshot.data()) + sizeof(SnapshotHeader) + 
+                        m_count * sizeof(AccountRecord);
+    std::size_t mask = m_indexSlots - 1;
+    for (std::size_t slot = hashNumber(accountNumber.data(), accountNumber.size()) & mask; ; 
+         slot = (slot + 1) & mask) 
+    {
+        std::uint32_t entry;
+        std::memcpy(&entry, index + slot * sizeof(entry), sizeof(entry));
+        if (entry == 0 || entry > m_count) {
+            return std::nullopt;
+        }
+        Account account = recordAt(entry - 1);
+        if (account.getAccountNumber() == accountNumber) {
+            return account;
+        }
+    }
+}
+
+std::optional<Account> AccountCache::findById(int accountId) {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    std::optional<Account> account;
+    auto it = m_overlay.find(accountId);
+    if (it != m_overlay.end()) {
+        account = it->second.account;
+    } else if (m_snapshot.isOpen()) {
+        account = snapshotFind(accountId);
+    }
+    ++(account.has_value() ? m_hits : m_misses);
+    return account;
+}
+
+std::optional<Account> AccountCache::findByNumber(const std::string& accountNumber) {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    std::optional<Account> account;
+    auto number = m_overlayNumbers.find(accountNumber);
+    if (number != m_overlayNumbers.end()) {
+        account = m_overlay.at(number->second).account;
+    } else if (m_snapshot.isOpen()) {
+        // The overlay entry wins if the account changed since the snapshot
+        account = snapshotFindNumber(accountNumber);
+        if (account.has_value()) {
+            auto it = m_overlay.find(account->getAccountId());
+            if (it != m_overlay.end()) {
+                account = it->second.account;
+            }
+        }
+    }
+    ++(account.has_value() ? m_hits : m_misses);
+    return account;
+}
+
+// Updates
+
+void AccountCache::setOverlay(int accountId, std::optional<Account> account) {
+    auto it = m_overlay.find(accountId);
+    if (it != m_overlay.end() && it->second.account.has_value()) {
+        m_overlayNumbers.erase(std::string(it->second.account->getAccountNumber()));
+    }
+    if (account.has_value()) {
+        m_overlayNumbers[std::string(account->getAccountNumber())] = accountId;
+    }
+    m_overlay[accountId] = Overlay{std::move(account), ++m_version};
+}
+
+std::uint64_t AccountCache::readTicket() const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return m_version;
+}
+
+bool AccountCache::put(const Account& account, std::uint64_t ticket) {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    // Anything newer than the ticket saw a state at least as recent as this read
+    auto it = m_overlay.find(account.getAccountId());
+    if ((it != m_overlay.end() && it->second.version > ticket) || m_droppedVersion > ticket) {
+        return false;
+    }
+    setOverlay(account.getAccountId(), account);
+    return true;
+}
+
+void AccountCache::invalidate(int accountId) {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    setOverlay(accountId, std::nullopt);
+}
+
+std::optional<std::size_t> AccountCache::reconcile(PostgresLedgerStore& store, int slackSeconds) {
+    std::string since;
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        since = m_watermark;
+    }
+
+    std::string watermark;
+    auto changed = store.findAccountsUpdatedSince(since, slackSeconds, watermark);
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    if (!changed.has_value()) {
+        m_lastError = store.getLastError();
+        return std::nullopt;
+    }
+
+    for (const auto& account : *changed) {
+        setOverlay(account.getAccountId(), account);
+    }
+    m_watermark = watermark;
+    return changed->size();
+}
+
+bool AccountCache::writeSnapshot() {
+    // Merge snapshot and overlay; invalidated accounts are left out
+    std::vector<Account> accounts;
+    std::string watermark;
+    std::uint64_t version;
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        accounts.reserve(m_count + m_overlay.size());
+        for (std::size_t i = 0; i < m_count; ++i) {
+            Account account = recordAt(i);
+            if (m_overlay.count(account.getAccountId()) == 0) {
+                accounts.push_back(account);
+            }
+        }
+        for (const auto& entry : m_overlay) {
+            if (entry.second.account.has_value()) {
+                accounts.push_back(*entry.second.account);
+            }
+        }
+        watermark = m_watermark;
+        version = m_version;
+    }
+    std::sort(accounts.begin(), accounts.end(), [](const Account& a, const Account& b) {
+        return a.getAccountId() < b.getAccountId();
+    });
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.recordSize = sizeof(AccountRecord);
+    header.byteOrder = kByteOrderMark;
+    header.count = accounts.size();
+    header.indexSlots = indexSlotsFor(accounts.size());
+    std::memcpy(header.watermark, watermark.data(), std::min(watermark.size(), sizeof(header.watermark) - 1));
+
+    std::vector<AccountRecord> records(accounts.size());
+    std::vector<std::uint32_t> index(header.indexSlots, 0);
+    std::size_t mask = header.indexSlots - 1;
+    for (std::size_t i = 0; i < accounts.size(); ++i) {
+        const Account& account = accounts[i];
+        std::string_view number = account.getAccountNumber().substr(0, kNumberLength);
+        AccountRecord& record = records[i];
+        record.accountId = account.getAccountId();
+        record.userId = account.getUserId();
+        std::memcpy(record.accountNumber, number.data(), number.size());
+        record.type = static_cast<std::uint8_t>(account.getType());
+        record.status = static_cast<std::uint8_t>(account.getStatus());
+        record.balance = account.getBalance();
+        record.interestRate = account.getInterestRate();
+
+        std::size_t slot = hashNumber(number.data(), number.size()) & mask;
+        while (index[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        index[slot] = static_cast<std::uint32_t>(i + 1);
+    }
+
+    // Readers of the old file keep their mapping; the rename swaps it atomically
+    std::string temporary = m_path + ".tmp";
+    std::FILE* file = std::fopen(temporary.c_str(), "wb");
+    bool ok = file &&
+        std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+        std::fwrite(records.data(), sizeof(AccountRecord), records.size(), file) == records.size() &&
+        std::fwrite(index.data(), sizeof(std::uint32_t), index.size(), file) == index.size();
+    if (file) {
+        ok = std::fclose(file) == 0 && ok;
+    }
+    if (!ok || std::rename(temporary.c_str(), m_path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        m_lastError = "Could not write " + m_path;
+        return false;
+    }
+
+    MappedFile mapped;
+    if (!mapped.open(m_path)) {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        m_lastError = "Could not map " + m_path;
+        return false;
+    }
+
+    // Overlay entries written to the snapshot are dropped; later ones stay
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_snapshot = std::move(mapped);
+    m_count = header.count;
+    m_indexSlots = header.indexSlots;
+    for (auto it = m_overlay.begin(); it != m_overlay.end(); ) {
+        if (it->second.version <= version) {
+            if (it->second.account.has_value()) {
+                m_overlayNumbers.erase(std::string(it->second.account->getAccountNumber()));
+            } else {
+                // Reads that started before this invalidation can no longer be checked against it
+                m_droppedVersion = std::max(m_droppedVersion, it->second.version);
+            }
+            it = m_overlay.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return true;
+}
+
+AccountCacheStats AccountCache::getStats() const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    AccountCacheStats stats;
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    stats.snapshotAccounts = m_count;
+    stats.overlayAccounts = m_overlay.size();
+    return stats;
+}
+
+std::string AccountCache::getLastError() const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return m_lastError;
+}
+
+} // namespace bank
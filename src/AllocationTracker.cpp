@@ -0,0 +1,147 @@
+#include "AllocationTracker.hpp"
+
+#ifdef BANK_ALLOC_TRACKING
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace bank {
+
+namespace alloc {
+
+namespace {
+
+// Constant-initialized, so touching it from operator new never runs a TLS constructor
+thread_local Counts t_counts;
+
+void* tryAllocate(std::size_t size, std::size_t align) {
+    void* p;
+    if (align <= alignof(std::max_align_t)) {
+        p = std::malloc(size == 0 ? 1 : size);
+    } else {
+        // aligned_alloc wants a multiple of the alignment
+        std::size_t rounded = (std::max<std::size_t>(size, 1) + align - 1) / align * align;
+        p = std::aligned_alloc(align, rounded);
+    }
+    if (p) {
+        ++t_counts.allocations;
+        t_counts.bytes += size;
+    }
+    return p;
+}
+
+void* allocate(std::size_t size, std::size_t align = alignof(std::max_align_t)) {
+    // Like the library's operator new, give the new-handler a chance to free memory
+    while (true) {
+        if (void* p = tryAllocate(size, align)) {
+            return p;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void* allocateNothrow(std::size_t size, std::size_t align = alignof(std::max_align_t)) noexcept {
+    try {
+        return allocate(size, align);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+} // namespace
+
+Counts threadCounts() {
+    return t_counts;
+}
+
+} // namespace alloc
+
+} // namespace bank
+
+void* operator new(std::size_t size) {
+    return bank::alloc::allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return bank::alloc::allocate(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return bank::alloc::allocateNothrow(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return bank::alloc::allocateNothrow(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return bank::alloc::allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return bank::alloc::allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return bank::alloc::allocateNothrow(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return bank::alloc::allocateNothrow(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+#endif // BANK_ALLOC_TRACKING
@@ -0,0 +1,193 @@
+#include "AsyncBankService.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace bank {
+
+AsyncBankService::AsyncBankService(ServiceFactory factory, AsyncServiceOptions options)
+    : m_factory(std::move(factory))
+    , m_options(options)
+{
+}
+
+bool AsyncBankService::open() {
+    if (m_pool) {
+        return true;
+    }
+
+    std::size_t workers = m_options.workers;
+    if (workers == 0) {
+        workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    m_services.clear();
+    for (std::size_t i = 0; i < workers; ++i) {
+        auto service = m_factory();
+        if (!service) {
+            m_lastError = "Could not create the service for worker " + std::to_string(i);
+            m_services.clear();
+            return false;
+        }
+        m_services.push_back(std::move(service));
+    }
+
+    m_pool = std::make_unique<WorkStealingPool>(workers, m_options.queueCapacity);
+    return true;
+}
+
+PoolStats AsyncBankService::getPoolStats() const {
+    return m_pool ? m_pool->getStats() : PoolStats{};
+}
+
+std::size_t AsyncBankService::keyOf(const std::string& key) {
+    return std::hash<std::string>{}(key);
+}
+
+// User operations
+
+std::future<std::optional<User>> AsyncBankService::createUser(std::string username, std::string password,
+                                                              std::string fullName, std::string email,
+                                                              std::string phone)
+{
+    std::size_t affinity = keyOf(username);
+    return call(affinity, [=](BankService& service) {
+        return service.createUser(username, password, fullName, email, phone);
+    });
+}
+
+std::future<std::optional<User>> AsyncBankService::authenticateUser(std::string username, std::string password) {
+    std::size_t affinity = keyOf(username);
+    return call(affinity, [=](BankService& service) {
+        return service.authenticateUser(username, password);
+    });
+}
+
+std::future<std::optional<int>> AsyncBankService::verifyCredentials(std::string username, std::string password) {
+    std::size_t affinity = keyOf(username);
+    return call(affinity, [=](BankService& service) {
+        return service.verifyCredentials(username, password);
+    });
+}
+
+std::future<std::optional<DashboardData>> AsyncBankService::loadDashboard(int userId, int historyLimit) {
+    return call(userId, [=](BankService& service) { return service.loadDashboard(userId, historyLimit); });
+}
+
+std::future<std::optional<User>> AsyncBankService::getUserById(int userId) {
+    return call(userId, [=](BankService& service) { return service.getUserById(userId); });
+}
+
+std::future<std::optional<User>> AsyncBankService::getUserByUsername(std::string username) {
+    std::size_t affinity = keyOf(username);
+    return call(affinity, [=](BankService& service) { return service.getUserByUsername(username); });
+}
+
+std::future<bool> AsyncBankService::updateUser(User user) {
+    std::size_t affinity = static_cast<std::size_t>(user.getUserId());
+    return call(affinity, [=](BankService& service) { return service.updateUser(user); });
+}
+
+std::future<bool> AsyncBankService::deleteUser(int userId) {
+    return call(userId, [=](BankService& service) { return service.deleteUser(userId); });
+}
+
+// Account operations
+
+std::future<std::optional<Account>> AsyncBankService::createAccount(int userId, AccountType type,
+                                                                    double initialDeposit)
+{
+    return call(userId, [=](BankService& service) {
+        return service.createAccount(userId, type, initialDeposit);
+    });
+}
+
+std::future<std::optional<Account>> AsyncBankService::getAccountById(int accountId) {
+    return call(accountId, [=](BankService& service) { return service.getAccountById(accountId); });
+}
+
+std::future<std::optional<Account>> AsyncBankService::getAccountByNumber(std::string accountNumber) {
+    std::size_t affinity = keyOf(accountNumber);
+    return call(affinity, [=](BankService& service) { return service.getAccountByNumber(accountNumber); });
+}
+
+std::future<std::vector<Account>> AsyncBankService::getAccountsByUserId(int userId) {
+    return call(userId, [=](BankService& service) { return service.getAccountsByUserId(userId); });
+}
+
+std::future<bool> AsyncBankService::updateAccountStatus(int accountId, AccountStatus status) {
+    return call(accountId, [=](BankService& service) {
+        return service.updateAccountStatus(accountId, status);
+    });
+}
+
+std::future<bool> AsyncBankService::deleteAccount(int accountId) {
+    return call(accountId, [=](BankService& service) { return service.deleteAccount(accountId); });
+}
+
+// Transaction operations
+
+std::future<bool> AsyncBankService::deposit(int accountId, double amount, std::string description) {
+    return call(accountId, [=](BankService& service) {
+        return service.deposit(accountId, amount, description);
+    });
+}
+
+std::future<bool> AsyncBankService::withdraw(int accountId, double amount, std::string description) {
+    return call(accountId, [=](BankService& service) {
+        return service.withdraw(accountId, amount, description);
+    });
+}
+
+std::future<bool> AsyncBankService::transfer(int fromAccountId, int toAccountId, double amount,
+                                             std::string description)
+{
+    return call(fromAccountId, [=](BankService& service) {
+        return service.transfer(fromAccountId, toAccountId, amount, description);
+    });
+}
+
+std::future<std::vector<Transaction>> AsyncBankService::getTransactionHistory(int accountId, int limit) {
+    return call(accountId, [=](BankService& service) { return service.getTransactionHistory(accountId, limit); });
+}
+
+std::future<std::optional<Transaction>> AsyncBankService::getTransactionById(int transactionId) {
+    return call(transactionId, [=](BankService& service) { return service.getTransactionById(transactionId); });
+}
+
+std::future<std::vector<BalancePoint>> AsyncBankService::getBalanceHistory(int accountId, int maxPoints) {
+    return call(accountId, [=](BankService& service) { return service.getBalanceHistory(accountId, maxPoints); });
+}
+
+std::future<std::vector<Transaction>> AsyncBankService::getTransactionsBetween(int accountId, Timestamp from,
+                                                                               Timestamp to, int limit)
+{
+    return call(accountId, [=](BankService& service) {
+        return service.getTransactionsBetween(accountId, from, to, limit);
+    });
+}
+
+std::future<std::vector<ActivityTotal>> AsyncBankService::getDailyTotals(int accountId, TimeRange range) {
+    return call(accountId, [=](BankService& service) { return service.getDailyTotals(accountId, range); });
+}
+
+std::future<std::vector<ActivityTotal>> AsyncBankService::getActivity(int accountId, TimeUnit unit,
+                                                                      TimeRange range)
+{
+    return call(accountId, [=](BankService& service) { return service.getActivity(accountId, unit, range); });
+}
+
+std::future<ActivityTotal> AsyncBankService::getActivitySummary(int accountId, TimeRange range) {
+    return call(accountId, [=](BankService& service) { return service.getActivitySummary(accountId, range); });
+}
+
+// Utility operations
+
+std::future<double> AsyncBankService::getTotalBalance(int userId) {
+    return call(userId, [=](BankService& service) { return service.getTotalBalance(userId); });
+}
+
+std::future<bool> AsyncBankService::accountExists(std::string accountNumber) {
+    std::size_t affinity = keyOf(accountNumber);
+    return call(affinity, [=](BankService& service) { return service.accountExists(accountNumber); });
+}
+
+} // namespace bank
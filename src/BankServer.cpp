@@ -0,0 +1,707 @@
+#include "BankServer.hpp"
+#include "Protocol.hpp"
+#include "Trace.hpp"
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace bank {
+
+namespace {
+
+using protocol::MessageReader;
+using protocol::MessageWriter;
+using protocol::Opcode;
+using protocol::Status;
+
+constexpr std::size_t kReadChunk = 64 * 1024;
+constexpr int kMaxEvents = 256;
+
+template <typename T, typename Put>
+void putOptional(MessageWriter& out, const std::optional<T>& value, Put put) {
+    out.putBool(value.has_value());
+    if (value.has_value()) {
+        put(*value);
+    }
+}
+
+/**
+ * @brief Decode the arguments of one request, run it and encode the result
+ * @return false if the request is malformed
+ */
+bool dispatch(BankService& service, Opcode opcode, MessageReader& in, MessageWriter& out) {
+    auto valid = [&in]() { return in.ok() && in.atEnd(); };
+    auto putUser = [&out](const User& user) { out.putUser(user); };
+    auto putAccount = [&out](const Account& account) { out.putAccount(account); };
+
+    switch (opcode) {
+        case Opcode::CreateUser: {
+            std::string username = in.getString();
+            std::string password = in.getString();
+            std::string fullName = in.getString();
+            std::string email = in.getString();
+            std::string phone = in.getString();
+            if (!valid()) return false;
+            putOptional(out, service.createUser(username, password, fullName, email, phone), putUser);
+            return true;
+        }
+        case Opcode::AuthenticateUser: {
+            std::string username = in.getString();
+            std::string password = in.getString();
+            if (!valid()) return false;
+            putOptional(out, service.authenticateUser(username, password), putUser);
+            return true;
+        }
+        case Opcode::VerifyCredentials: {
+            std::string username = in.getString();
+            std::string password = in.getString();
+            if (!valid()) return false;
+            putOptional(out, service.verifyCredentials(username, password), 
+                        [&out](int userId) { out.putI32(userId); });
+            return true;
+        }
+        case Opcode::LoadDashboard: {
+            int userId = in.getI32();
+            int historyLimit = in.getI32();
+            if (!valid()) return false;
+            putOptional(out, service.loadDashboard(userId, historyLimit),
+                        [&out](const DashboardData& dashboard) { out.putDashboard(dashboard); });
+            return true;
+        }
+        case Opcode::Login: {
+            std::string username = in.getString();
+            std::string password = in.getString();
+            int historyLimit = in.getI32();
+            if (!valid()) return false;
+            putOptional(out, service.login(username, password, historyLimit),
+                        [&out](const DashboardData& dashboard) { out.putDashboard(dashboard); });
+            return true;
+        }
+        case Opcode::GetUserById: {
+            int userId = in.getI32();
+            if (!valid()) return false;
+            putOptional(out, service.getUserById(userId), putUser);
+            return true;
+        }
+        case Opcode::GetUserByUsername: {
+            std::string username = in.getString();
+            if (!valid()) return false;
+            putOptional(out, service.getUserByUsername(username), putUser);
+            return true;
+        }
+        case Opcode::UpdateUser: {
+            User user = in.getUser();
+            if (!valid()) return false;
+            out.putBool(service.updateUser(user));
+            return true;
+        }
+        case Opcode::DeleteUser: {
+            int userId = in.getI32();
+            if (!valid()) return false;
+            out.putBool(service.deleteUser(userId));
+            return true;
+        }
+        case Opcode::CreateAccount: {
+            int userId = in.getI32();
+            std::uint8_t type = in.getU8();
+            double initialDeposit = in.getF64();
+            if (!valid() || type > static_cast<std::uint8_t>(AccountType::FixedDeposit)) return false;
+            putOptional(out, service.createAccount(userId, static_cast<AccountType>(type), initialDeposit),
+                        putAccount);
+            return true;
+        }
+        case Opcode::GetAccountById: {
+            int accountId = in.getI32();
+            if (!valid()) return false;
+            putOptional(out, service.getAccountById(accountId), putAccount);
+            return true;
+        }
+        case Opcode::GetAccountByNumber: {
+            std::string accountNumber = in.getString();
+            if (!valid()) return false;
+            putOptional(out, service.getAccountByNumber(accountNumber), putAccount);
+            return true;
+        }
+        case Opcode::GetAccountsByUserId: {
+            int userId = in.getI32();
+            if (!valid()) return false;
+            auto accounts = service.getAccountsByUserId(userId);
+            out.putU32(static_cast<std::uint32_t>(accounts.size()));
+            for (const auto& account : accounts) {
+                out.putAccount(account);
+            }
+            return true;
+        }
+        case Opcode::UpdateAccountStatus: {
+            int accountId = in.getI32();
+            std::uint8_t status = in.getU8();
+            if (!valid() || status > static_cast<std::uint8_t>(AccountStatus::Frozen)) return false;
+            out.putBool(service.updateAccountStatus(accountId, static_cast<AccountStatus>(status)));
+            return true;
+        }
+        case Opcode::DeleteAccount: {
+            int accountId = in.getI32();
+            if (!valid()) return false;
+            out.putBool(service.deleteAccount(accountId));
+            return true;
+        }
+        case Opcode::Deposit:
+        case Opcode::Withdraw: {
+            int accountId = in.getI32();
+            double amount = in.getF64();
+            std::string description = in.getString();
+            if (!valid()) return false;
+            out.putBool(opcode == Opcode::Deposit 
+                ? service.deposit(accountId, amount, description)
+                : service.withdraw(accountId, amount, description));
+            return true;
+        }
+        case Opcode::Transfer: {
+            int fromAccountId = in.getI32();
+            int toAccountId = in.getI32();
+            double amount = in.getF64();
+            std::string description = in.getString();
+            if (!valid()) return false;
+            out.putBool(service.transfer(fromAccountId, toAccountId, amount, description));
+            return true;
+        }
+        case Opcode::GetTransactionHistory: {
+            int accountId = in.getI32();
+            int limit = in.getI32();
+            if (!valid()) return false;
+            auto history = service.getTransactionHistory(accountId, limit);
+            out.putU32(static_cast<std::uint32_t>(history.size()));
+            for (const auto& transaction : history) {
+                out.putTransaction(transaction);
+            }
+            return true;
+        }
+        case Opcode::GetTransactionById: {
+            int transactionId = in.getI32();
+            if (!valid()) return false;
+            putOptional(out, service.getTransactionById(transactionId),
+                        [&out](const Transaction& transaction) { out.putTransaction(transaction); });
+            return true;
+        }
+        case Opcode::GetBalanceHistory: {
+            int accountId = in.getI32();
+            int maxPoints = in.getI32();
+            if (!valid()) return false;
+            auto points = service.getBalanceHistory(accountId, maxPoints);
+            out.putU32(static_cast<std::uint32_t>(points.size()));
+            for (const auto& point : points) {
+                out.putF64(point.timestamp);
+                out.putF64(point.balance);
+            }
+            return true;
+        }
+        case Opcode::GetTransactionsBetween: {
+            int accountId = in.getI32();
+            Timestamp from = in.getTimestamp();
+            Timestamp to = in.getTimestamp();
+            int limit = in.getI32();
+            if (!valid()) return false;
+            auto transactions = service.getTransactionsBetween(accountId, from, to, limit);
+            out.putU32(static_cast<std::uint32_t>(transactions.size()));
+            for (const auto& transaction : transactions) {
+                out.putTransaction(transaction);
+            }
+            return true;
+        }
+        case Opcode::GetDailyTotals: {
+            int accountId = in.getI32();
+            TimeRange range;
+            range.from = in.getTimestamp();
+            range.to = in.getTimestamp();
+            if (!valid()) return false;
+            auto totals = service.getDailyTotals(accountId, range);
+            out.putU32(static_cast<std::uint32_t>(totals.size()));
+            for (const auto& total : totals) {
+                out.putActivityTotal(total);
+            }
+            return true;
+        }
+        case Opcode::GetActivity: {
+            int accountId = in.getI32();
+            std::uint8_t unit = in.getU8();
+            TimeRange range;
+            range.from = in.getTimestamp();
+            range.to = in.getTimestamp();
+            // Stores index their rollups by unit
+            if (!valid() || unit > static_cast<std::uint8_t>(TimeUnit::Month)) return false;
+            auto totals = service.getActivity(accountId, static_cast<TimeUnit>(unit), range);
+            out.putU32(static_cast<std::uint32_t>(totals.size()));
+            for (const auto& total : totals) {
+                out.putActivityTotal(total);
+            }
+            return true;
+        }
+        case Opcode::GetActivitySummary: {
+            int accountId = in.getI32();
+            TimeRange range;
+            range.from = in.getTimestamp();
+            range.to = in.getTimestamp();
+            if (!valid()) return false;
+            out.putActivityTotal(service.getActivitySummary(accountId, range));
+            return true;
+        }
+        case Opcode::GetTotalBalance: {
+            int userId = in.getI32();
+            if (!valid()) return false;
+            out.putF64(service.getTotalBalance(userId));
+            return true;
+        }
+        case Opcode::AccountExists: {
+            std::string accountNumber = in.getString();
+            if (!valid()) return false;
+            out.putBool(service.accountExists(accountNumber));
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string errorResponse(std::uint32_t requestId, Status status) {
+    MessageWriter out;
+    out.putU32(requestId);
+    out.putU8(static_cast<std::uint8_t>(status));
+    out.putU32(0);
+    out.putU32(0);
+    out.putU32(0);
+    return out.finish();
+}
+
+/**
+ * @brief Execute one request body and encode the response frame
+ */
+std::string handleRequest(BankService& service, const std::string& body) {
+    MessageReader in(body.data(), body.size());
+    auto opcode = static_cast<Opcode>(in.getU8());
+    std::uint32_t requestId = in.getU32();
+
+    MessageWriter out;
+    out.putU32(requestId);
+    out.putU8(static_cast<std::uint8_t>(Status::Ok));
+    std::size_t dbMicros = out.reserveU32();
+    std::size_t roundTrips = out.reserveU32();
+    std::size_t rows = out.reserveU32();
+
+    try {
+        if (!in.ok() || !dispatch(service, opcode, in, out)) {
+            return errorResponse(requestId, Status::BadRequest);
+        }
+    } catch (const std::exception&) {
+        return errorResponse(requestId, Status::ServerError);
+    }
+
+    const auto& calls = service.getRecentCalls();
+    if (!calls.empty()) {
+        const ServiceCall& call = calls.back();
+        out.setU32(dbMicros, static_cast<std::uint32_t>(call.dbMillis * 1000.0));
+        out.setU32(roundTrips, static_cast<std::uint32_t>(call.roundTrips));
+        out.setU32(rows, static_cast<std::uint32_t>(call.rows));
+    }
+    return out.finish();
+}
+
+} // namespace
+
+BankServer::BankServer(ConnectionPool& pool, ServerOptions options)
+    : m_pool(pool)
+    , m_options(std::move(options))
+    , m_epollFd(-1)
+    , m_wakeFd(-1)
+    , m_tcpFd(-1)
+    , m_unixFd(-1)
+    , m_running(false)
+    , m_nextConnectionId(1)
+    , m_stopping(false)
+{
+}
+
+BankServer::~BankServer() {
+    {
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        m_stopping = true;
+    }
+    m_jobReady.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+
+    for (auto& entry : m_connections) {
+        ::close(entry.first);
+    }
+    for (int fd : {m_tcpFd, m_unixFd, m_wakeFd, m_epollFd}) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+    if (m_unixFd >= 0) {
+        ::unlink(m_options.unixPath.c_str());
+    }
+}
+
+bool BankServer::start() {
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_epollFd < 0 || m_wakeFd < 0 || !watch(m_wakeFd)) {
+        m_lastError = std::string("Could not create event loop: ") + std::strerror(errno);
+        return false;
+    }
+
+    if (!m_options.host.empty() && !listenTcp()) {
+        return false;
+    }
+    if (!m_options.unixPath.empty() && !listenUnix()) {
+        return false;
+    }
+    if (m_tcpFd < 0 && m_unixFd < 0) {
+        m_lastError = "No listener configured";
+        return false;
+    }
+
+    for (int i = 0; i < m_options.workers; ++i) {
+        m_workers.emplace_back(&BankServer::workerLoop, this);
+    }
+    m_running = true;
+    return true;
+}
+
+bool BankServer::listenTcp() {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    addrinfo* addresses = nullptr;
+    std::string port = std::to_string(m_options.port);
+    int rc = getaddrinfo(m_options.host.c_str(), port.c_str(), &hints, &addresses);
+    if (rc != 0) {
+        m_lastError = "Could not resolve " + m_options.host + ": " + gai_strerror(rc);
+        return false;
+    }
+
+    for (addrinfo* address = addresses; address != nullptr; address = address->ai_next) {
+        int fd = socket(address->ai_family, address->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            continue;
+        }
+        int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        if (bind(fd, address->ai_addr, address->ai_addrlen) == 0 && listen(fd, SOMAXCONN) == 0) {
+            m_tcpFd = fd;
+            break;
+        }
+        m_lastError = std::strerror(errno);
+        ::close(fd);
+    }
+    freeaddrinfo(addresses);
+
+    if (m_tcpFd < 0) {
+        m_lastError = "Could not listen on " + m_options.host + ":" + port + ": " + m_lastError;
+        return false;
+    }
+    return watch(m_tcpFd);
+}
+
+bool BankServer::listenUnix() {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (m_options.unixPath.size() >= sizeof(address.sun_path)) {
+        m_lastError = "Socket path too long: " + m_options.unixPath;
+        return false;
+    }
+    std::strcpy(address.sun_path, m_options.unixPath.c_str());
+    ::unlink(address.sun_path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(fd, SOMAXCONN) != 0) 
+    {
+        m_lastError = "Could not listen on " + m_options.unixPath + ": " + std::strerror(errno);
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return false;
+    }
+    m_unixFd = fd;
+    return watch(m_unixFd);
+}
+
+bool BankServer::watch(int fd) {
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+        m_lastError = std::string("epoll_ctl failed: ") + std::strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+void BankServer::run() {
+    epoll_event events[kMaxEvents];
+
+    while (m_running) {
+        int count = epoll_wait(m_epollFd, events, kMaxEvents, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            m_lastError = std::string("epoll_wait failed: ") + std::strerror(errno);
+            break;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == m_wakeFd) {
+                std::uint64_t value;
+                while (::read(m_wakeFd, &value, sizeof(value)) > 0) {
+                }
+                drainCompletions();
+                continue;
+            }
+            if (fd == m_tcpFd || fd == m_unixFd) {
+                acceptClients(fd);
+                continue;
+            }
+
+            auto it = m_connections.find(fd);
+            if (it == m_connections.end()) {
+                continue;
+            }
+            Connection& connection = *it->second;
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                close(connection);
+                continue;
+            }
+            if (events[i].events & EPOLLOUT) {
+                writeTo(connection);
+            }
+            // writeTo may have closed the connection
+            if ((events[i].events & (EPOLLIN | EPOLLRDHUP)) && m_connections.count(fd) != 0) {
+                readFrom(connection);
+            }
+        }
+    }
+}
+
+void BankServer::stop() {
+    m_running = false;
+    wake();
+}
+
+void BankServer::wake() {
+    std::uint64_t one = 1;
+    ssize_t written = ::write(m_wakeFd, &one, sizeof(one));
+    (void)written;  // A full counter already guarantees a wakeup
+}
+
+void BankServer::acceptClients(int listenFd) {
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            // EAGAIN ends the backlog; anything else (e.g. EMFILE) is retried on the next wakeup
+            return;
+        }
+        if (listenFd == m_tcpFd) {
+            int on = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        }
+
+        auto connection = std::make_unique<Connection>();
+        connection->fd = fd;
+        connection->id = m_nextConnectionId++;
+        connection->events = EPOLLIN | EPOLLRDHUP;
+
+        epoll_event event{};
+        event.events = connection->events;
+        event.data.fd = fd;
+        if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            ::close(fd);
+            continue;
+        }
+        m_connections[fd] = std::move(connection);
+    }
+}
+
+void BankServer::readFrom(Connection& connection) {
+    char buffer[kReadChunk];
+    while (connection.inFlight < kMaxInFlight) {
+        ssize_t received = ::read(connection.fd, buffer, sizeof(buffer));
+        if (received > 0) {
+            connection.input.append(buffer, static_cast<std::size_t>(received));
+        } else if (received == 0) {
+            connection.readClosed = true;
+            break;
+        } else if (errno == EINTR) {
+            continue;
+        } else {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                close(connection);
+                return;
+            }
+            break;
+        }
+
+        // Split off complete frames
+        std::vector<Job> jobs;
+        while (connection.input.size() - connection.inputOffset >= protocol::kLengthPrefix) {
+            const char* frame = connection.input.data() + connection.inputOffset;
+            std::uint32_t length = protocol::readLength(frame);
+            if (length < protocol::kRequestHeader || length > protocol::kMaxFrameSize) {
+                close(connection);
+                return;
+            }
+            if (connection.input.size() - connection.inputOffset < protocol::kLengthPrefix + length) {
+                break;
+            }
+            jobs.push_back(Job{connection.fd, connection.id, 
+                               std::string(frame + protocol::kLengthPrefix, length)});
+            connection.inputOffset += protocol::kLengthPrefix + length;
+        }
+        connection.input.erase(0, connection.inputOffset);
+        connection.inputOffset = 0;
+
+        if (!jobs.empty()) {
+            connection.inFlight += jobs.size();
+            {
+                std::lock_guard<std::mutex> lock(m_jobMutex);
+                for (auto& job : jobs) {
+                    m_jobs.push_back(std::move(job));
+                }
+            }
+            m_jobReady.notify_all();
+        }
+    }
+
+    if (connection.readClosed && connection.inFlight == 0 && connection.output.empty()) {
+        close(connection);
+        return;
+    }
+    updateEvents(connection);
+}
+
+void BankServer::writeTo(Connection& connection) {
+    while (connection.outputOffset < connection.output.size()) {
+        ssize_t sent = ::send(connection.fd, connection.output.data() + connection.outputOffset,
+                              connection.output.size() - connection.outputOffset, MSG_NOSIGNAL);
+        if (sent > 0) {
+            connection.outputOffset += static_cast<std::size_t>(sent);
+        } else if (sent < 0 && errno == EINTR) {
+            continue;
+        } else if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else {
+            close(connection);
+            return;
+        }
+    }
+
+    if (connection.outputOffset == connection.output.size()) {
+        connection.output.clear();
+        connection.outputOffset = 0;
+        if (connection.readClosed && connection.inFlight == 0) {
+            close(connection);
+            return;
+        }
+    }
+    updateEvents(connection);
+}
+
+void BankServer::updateEvents(Connection& connection) {
+    std::uint32_t events = 0;
+    if (!connection.readClosed && connection.inFlight < kMaxInFlight) {
+        events |= EPOLLIN | EPOLLRDHUP;
+    }
+    if (!connection.output.empty()) {
+        events |= EPOLLOUT;
+    }
+    if (events == connection.events) {
+        return;
+    }
+
+    epoll_event event{};
+    event.events = events;
+    event.data.fd = connection.fd;
+    epoll_ctl(m_epollFd, EPOLL_CTL_MOD, connection.fd, &event);
+    connection.events = events;
+}
+
+void BankServer::close(Connection& connection) {
+    // Responses still being computed are dropped when they arrive
+    int fd = connection.fd;
+    epoll_ctl(m_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    m_connections.erase(fd);
+}
+
+void BankServer::drainCompletions() {
+    std::vector<Completion> completions;
+    {
+        std::lock_guard<std::mutex> lock(m_completionMutex);
+        completions.swap(m_completions);
+    }
+
+    std::vector<int> touched;
+    for (auto& completion : completions) {
+        auto it = m_connections.find(completion.fd);
+        if (it == m_connections.end() || it->second->id != completion.connectionId) {
+            continue;  // The client went away and the descriptor may have been reused
+        }
+        Connection& connection = *it->second;
+        --connection.inFlight;
+        connection.output += completion.frame;
+        touched.push_back(completion.fd);
+    }
+
+    // One write per connection, however many of its responses completed
+    for (int fd : touched) {
+        auto it = m_connections.find(fd);
+        if (it != m_connections.end() && !it->second->output.empty()) {
+            writeTo(*it->second);
+        }
+    }
+}
+
+void BankServer::workerLoop() {
+    trace::setThreadName("worker");
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_jobMutex);
+            m_jobReady.wait(lock, [this] { return m_stopping || !m_jobs.empty(); });
+            if (m_stopping) {
+                return;
+            }
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+
+        std::string frame;
+        {
+            // Includes waiting for a connection, which the service span inside does not
+            trace::Span span("server", "request");
+            auto lease = m_pool.acquire();
+            frame = handleRequest(lease.service(), job.body);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_completionMutex);
+            m_completions.push_back(Completion{job.fd, job.connectionId, std::move(frame)});
+        }
+        wake();
+    }
+}
+
+} // namespace bank
@@ -1,13 +1,74 @@
 #include "BankService.hpp"
-#include <sstream>
+#include "Logger.hpp"
+#include "Metrics.hpp"
+#include "Trace.hpp"
+#include "PostgresLedgerStore.hpp"
 
 namespace bank {
 
 BankService::BankService(std::shared_ptr<Database> db)
-    : m_db(db)
+    : BankService(std::make_shared<PostgresLedgerStore>(db))
 {
 }
 
+BankService::BankService(std::shared_ptr<LedgerStore> store)
+    : m_store(store)
+    , m_callDepth(0)
+{
+}
+
+BankService::CallScope::CallScope(BankService& service, const char* operation)
+    : m_service(service)
+    , m_operation(operation)
+    , m_start(std::chrono::steady_clock::now())
+    , m_storeStart(service.m_store->getStats())
+    , m_ok(true)
+    , m_arenaScope(service.m_arena)
+{
+    ++m_service.m_callDepth;
+}
+
+BankService::CallScope::~CallScope() {
+    if (trace::isEnabled()) {
+        trace::record("service", m_operation, {}, trace::toNanos(m_start), trace::now());
+    }
+
+    // Nested calls (e.g. transfer looking up accounts) belong to the outer one
+    if (--m_service.m_callDepth > 0) {
+        return;
+    }
+
+    auto elapsed = std::chrono::steady_clock::now() - m_start;
+    alloc::Counts allocated = m_allocations.elapsed();
+    StoreStats storeNow = m_service.m_store->getStats();
+    ServiceCall call;
+    call.operation = m_operation;
+    call.millis = std::chrono::duration<double, std::milli>(elapsed).count();
+    call.dbMillis = storeNow.millis - m_storeStart.millis;
+    call.roundTrips = static_cast<int>(storeNow.operations - m_storeStart.operations);
+    call.rows = static_cast<int>(storeNow.rows - m_storeStart.rows);
+
+    if (m_service.m_logger) {
+        m_service.m_logger->debug("call", "operation", m_operation, "ms", call.millis, "db_ms", call.dbMillis,
+                                  "round_trips", call.roundTrips, "rows", call.rows, "ok", m_ok);
+    }
+    if (m_service.m_metrics) {
+        auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        MetricSeries& series = m_service.m_metrics->operation(m_operation);
+        series.record(static_cast<std::uint64_t>(nanos), static_cast<std::uint64_t>(call.rows), m_ok);
+        series.recordRoundTrips(static_cast<std::uint64_t>(call.roundTrips));
+        if (alloc::kEnabled) {
+            series.recordAllocations(allocated.allocations, allocated.bytes);
+        }
+    }
+
+    auto& calls = m_service.m_recentCalls;
+    if (calls.size() >= kRecentCallLimit) {
+        calls.pop_front();
+    }
+    calls.push_back(call);
+}
+
 // User operations
 
 std::optional<User> BankService::createUser(const std::string& username, 
@@ -16,87 +77,107 @@ std::optional<User> BankService::createUser(const std::string& username,
                                              const std::string& email,
                                              const std::string& phone) 
 {
+    CallScope scope(*this, "createUser");
     std::string passwordHash = User::hashPassword(password);
     
-    std::string query = 
-        "INSERT INTO users (username, password_hash, full_name, email, phone) "
-        "VALUES ($1, $2, $3, $4, $5) RETURNING user_id";
-    
-    std::vector<std::string> params = {username, passwordHash, fullName, email, phone};
-    auto results = m_db->queryParams(query, params);
-    
-    if (results.empty()) {
+    auto userId = m_store->insertUser(User(-1, username, passwordHash, fullName, email, phone));
+    scope.setOk(userId.has_value());
+    if (m_logger) {
+        m_logger->info("createUser", "user", userId.value_or(-1), "username", username, "ok", userId.has_value());
+    }
+    if (!userId.has_value()) {
         return std::nullopt;
     }
     
-    int userId = std::stoi(results[0][0]);
-    return User(userId, username, passwordHash, fullName, email, phone);
+    return User(*userId, username, passwordHash, fullName, email, phone);
 }
 
 std::optional<User> BankService::authenticateUser(const std::string& username, 
                                                    const std::string& password) 
 {
+    CallScope scope(*this, "authenticateUser");
     auto user = getUserByUsername(username);
-    if (!user.has_value()) {
-        return std::nullopt;
+    bool ok = user.has_value() && user->verifyPassword(password);
+    scope.setOk(ok);
+    if (m_logger) {
+        m_logger->info("login", "username", username, "ok", ok);
     }
-    
-    if (!user->verifyPassword(password)) {
+    if (!ok) {
         return std::nullopt;
     }
     
     return user;
 }
 
-std::optional<User> BankService::getUserById(int userId) {
-    std::string query = 
-        "SELECT user_id, username, password_hash, full_name, email, phone "
-        "FROM users WHERE user_id = $1";
-    
-    auto results = m_db->queryParams(query, {std::to_string(userId)});
-    
-    if (results.empty()) {
+std::optional<int> BankService::verifyCredentials(const std::string& username, 
+                                                  const std::string& password) 
+{
+    CallScope scope(*this, "verifyCredentials");
+    auto credentials = m_store->findCredentials(username);
+    bool ok = credentials.has_value() && credentials->second == User::hashPassword(password);
+    scope.setOk(ok);
+    if (m_logger) {
+        m_logger->info("login", "username", username, "ok", ok);
+    }
+    if (!ok) {
         return std::nullopt;
     }
     
-    const auto& row = results[0];
-    return User(std::stoi(row[0]), row[1], row[2], row[3], row[4], row[5]);
+    return credentials->first;
+}
+
+std::optional<DashboardData> BankService::loadDashboard(int userId, int historyLimit) {
+    CallScope scope(*this, "loadDashboard");
+    auto dashboard = m_store->loadDashboard(userId, historyLimit, kBalanceHistoryPoints);
+    scope.setOk(dashboard.has_value());
+    return dashboard;
+}
+
+std::optional<DashboardData> BankService::login(const std::string& username, const std::string& password,
+                                                int historyLimit)
+{
+    CallScope scope(*this, "login");
+    auto dashboard = m_store->loadDashboardForLogin(username, User::hashPassword(password), historyLimit,
+                                                    kBalanceHistoryPoints);
+    scope.setOk(dashboard.has_value());
+    if (m_logger) {
+        m_logger->info("login", "username", username, "ok", dashboard.has_value());
+    }
+    return dashboard;
+}
+
+std::optional<User> BankService::getUserById(int userId) {
+    CallScope scope(*this, "getUserById");
+    auto user = m_store->findUserById(userId);
+    scope.setOk(user.has_value());
+    return user;
 }
 
 std::optional<User> BankService::getUserByUsername(const std::string& username) {
-    std::string query = 
-        "SELECT user_id, username, password_hash, full_name, email, phone "
-        "FROM users WHERE username = $1";
-    
-    auto results = m_db->queryParams(query, {username});
-    
-    if (results.empty()) {
-        return std::nullopt;
-    }
-    
-    const auto& row = results[0];
-    return User(std::stoi(row[0]), row[1], row[2], row[3], row[4], row[5]);
+    CallScope scope(*this, "getUserByUsername");
+    auto user = m_store->findUserByUsername(username);
+    scope.setOk(user.has_value());
+    return user;
 }
 
 bool BankService::updateUser(const User& user) {
-    std::string query = 
-        "UPDATE users SET username = $1, full_name = $2, email = $3, phone = $4 "
-        "WHERE user_id = $5";
-    
-    std::vector<std::string> params = {
-        user.getUsername(),
-        user.getFullName(),
-        user.getEmail(),
-        user.getPhone(),
-        std::to_string(user.getUserId())
-    };
-    
-    return m_db->executeParams(query, params);
+    CallScope scope(*this, "updateUser");
+    bool ok = m_store->updateUser(user);
+    scope.setOk(ok);
+    if (m_logger) {
+        m_logger->info("updateUser", "user", user.getUserId(), "ok", ok);
+    }
+    return ok;
 }
 
 bool BankService::deleteUser(int userId) {
-    std::string query = "DELETE FROM users WHERE user_id = $1";
-    return m_db->executeParams(query, {std::to_string(userId)});
+    CallScope scope(*this, "deleteUser");
+    bool ok = m_store->deleteUser(userId);
+    scope.setOk(ok);
+    if (m_logger) {
+        m_logger->info("deleteUser", "user", userId, "ok", ok);
+    }
+    return ok;
 }
 
 // Account operations
@@ -104,8 +185,19 @@ bool BankService::deleteUser(int userId) {
 std::optional<Account> BankService::createAccount(int userId, AccountType type, 
                                                    double initialDeposit) 
 {
+    CallScope scope(*this, "createAccount");
+    auto account = applyCreateAccount(userId, type, initialDeposit);
+    scope.setOk(account.has_value());
+    if (m_logger) {
+        m_logger->info("createAccount", "user", userId, "account", account ? account->getAccountId() : -1,
+                       "type", Account::typeToString(type), "initial_deposit", initialDeposit,
+                       "ok", account.has_value());
+    }
+    return account;
+}
+
+std::optional<Account> BankService::applyCreateAccount(int userId, AccountType type, double initialDeposit) {
     std::string accountNumber = Account::generateAccountNumber();
-    std::string typeStr = Account::typeToString(type);
     
     // Default interest rates based on account type
     double interestRate = 0.0;
@@ -121,324 +213,242 @@ std::optional<Account> BankService::createAccount(int userId, AccountType type,
             break;
     }
     
-    std::string query = 
-        "INSERT INTO accounts (user_id, account_number, account_type, balance, interest_rate) "
-        "VALUES ($1, $2, $3, $4, $5) RETURNING account_id";
+    Account account(-1, userId, accountNumber, type, initialDeposit, 
+                    interestRate, AccountStatus::Active);
     
-    std::vector<std::string> params = {
-        std::to_string(userId),
-        accountNumber,
-        typeStr,
-        std::to_string(initialDeposit),
-        std::to_string(interestRate)
-    };
-    
-    auto results = m_db->queryParams(query, params);
-    
-    if (results.empty()) {
+    TransactionScope transaction(*m_store);
+    if (!transaction.isOpen()) {
         return std::nullopt;
     }
     
-    int accountId = std::stoi(results[0][0]);
+    auto accountId = m_store->insertAccount(account);
+    if (!accountId.has_value()) {
+        return std::nullopt;
+    }
+    account.setAccountId(*accountId);
     
     // Record initial deposit transaction if applicable
-    if (initialDeposit > 0) {
-        recordTransaction(accountId, TransactionType::Deposit, initialDeposit, 
-                          initialDeposit, "Initial deposit");
+    if (initialDeposit > 0 &&
+        !recordTransaction(*accountId, TransactionType::Deposit, initialDeposit, 
+                           initialDeposit, "Initial deposit")) {
+        return std::nullopt;
     }
     
-    return Account(accountId, userId, accountNumber, type, initialDeposit, 
-                   interestRate, AccountStatus::Active);
+    if (!transaction.commit()) {
+        return std::nullopt;
+    }
+    return account;
 }
 
 std::optional<Account> BankService::getAccountById(int accountId) {
-    std::string query = 
-        "SELECT account_id, user_id, account_number, account_type, balance, "
-        "interest_rate, status FROM accounts WHERE account_id = $1";
-    
-    auto results = m_db->queryParams(query, {std::to_string(accountId)});
-    
-    if (results.empty()) {
-        return std::nullopt;
-    }
-    
-    const auto& row = results[0];
-    return Account(
-        std::stoi(row[0]),
-        std::stoi(row[1]),
-        row[2],
-        Account::stringToType(row[3]),
-        std::stod(row[4]),
-        std::stod(row[5]),
-        Account::stringToStatus(row[6])
-    );
+    CallScope scope(*this, "getAccountById");
+    auto account = m_store->findAccountById(accountId);
+    scope.setOk(account.has_value());
+    return account;
 }
 
 std::optional<Account> BankService::getAccountByNumber(const std::string& accountNumber) {
-    std::string query = 
-        "SELECT account_id, user_id, account_number, account_type, balance, "
-        "interest_rate, status FROM accounts WHERE account_number = $1";
-    
-    auto results = m_db->queryParams(query, {accountNumber});
-    
-    if (results.empty()) {
-        return std::nullopt;
-    }
-    
-    const auto& row = results[0];
-    return Account(
-        std::stoi(row[0]),
-        std::stoi(row[1]),
-        row[2],
-        Account::stringToType(row[3]),
-        std::stod(row[4]),
-        std::stod(row[5]),
-        Account::stringToStatus(row[6])
-    );
+    CallScope scope(*this, "getAccountByNumber");
+    auto account = m_store->findAccountByNumber(accountNumber);
+    scope.setOk(account.has_value());
+    return account;
 }
 
 std::vector<Account> BankService::getAccountsByUserId(int userId) {
-    std::vector<Account> accounts;
-    
-    std::string query = 
-        "SELECT account_id, user_id, account_number, account_type, balance, "
-        "interest_rate, status FROM accounts WHERE user_id = $1 ORDER BY created_at";
-    
-    auto results = m_db->queryParams(query, {std::to_string(userId)});
-    
-    for (const auto& row : results) {
-        accounts.emplace_back(
-            std::stoi(row[0]),
-            std::stoi(row[1]),
-            row[2],
-            Account::stringToType(row[3]),
-            std::stod(row[4]),
-            std::stod(row[5]),
-            Account::stringToStatus(row[6])
-        );
-    }
-    
-    return accounts;
+    CallScope scope(*this, "getAccountsByUserId");
+    return m_store->findAccountsByUser(userId);
 }
 
 bool BankService::updateAccountStatus(int accountId, AccountStatus status) {
-    std::string query = "UPDATE accounts SET status = $1 WHERE account_id = $2";
-    return m_db->executeParams(query, {
-        Account::statusToString(status),
-        std::to_string(accountId)
-    });
+    CallScope scope(*this, "updateAccountStatus");
+    bool ok = m_store->setAccountStatus(accountId, status);
+    scope.setOk(ok);
+    if (m_logger) {
+        m_logger->info("updateAccountStatus", "account", accountId, "status", Account::statusToString(status),
+                       "ok", ok);
+    }
+    return ok;
 }
 
 bool BankService::deleteAccount(int accountId) {
-    std::string query = "DELETE FROM accounts WHERE account_id = $1";
-    return m_db->executeParams(query, {std::to_string(accountId)});
+    CallScope scope(*this, "deleteAccount");
+    bool ok = m_store->deleteAccount(accountId);
+    scope.setOk(ok);
+    if (m_logger) {
+        m_logger->info("deleteAccount", "account", accountId, "ok", ok);
+    }
+    return ok;
 }
 
 // Transaction operations
 
 bool BankService::deposit(int accountId, double amount, const std::string& description) {
-    if (amount <= 0) {
-        return false;
+    CallScope scope(*this, "deposit");
+    bool ok = applyDeposit(accountId, amount, description);
+    scope.setOk(ok);
+    if (m_logger) {
+        m_logger->info("deposit", "account", accountId, "amount", amount, "description", description, "ok", ok);
     }
-    
-    auto account = getAccountById(accountId);
-    if (!account.has_value()) {
-        return false;
-    }
-    
-    if (account->getStatus() != AccountStatus::Active) {
+    return ok;
+}
+
+bool BankService::applyDeposit(int accountId, double amount, const std::string& description) {
+    if (amount <= 0) {
         return false;
     }
     
-    double newBalance = account->getBalance() + amount;
-    
-    m_db->beginTransaction();
-    
-    std::string query = "UPDATE accounts SET balance = $1 WHERE account_id = $2";
-    if (!m_db->executeParams(query, {std::to_string(newBalance), std::to_string(accountId)})) {
-        m_db->rollbackTransaction();
+    TransactionScope transaction(*m_store);
+    if (!transaction.isOpen()) {
         return false;
     }
     
-    if (!recordTransaction(accountId, TransactionType::Deposit, amount, newBalance, description)) {
-        m_db->rollbackTransaction();
+    auto newBalance = m_store->adjustBalance(accountId, amount);
+    if (!newBalance.has_value() ||
+        !recordTransaction(accountId, TransactionType::Deposit, amount, *newBalance, description)) {
         return false;
     }
     
-    m_db->commitTransaction();
-    return true;
+    return transaction.commit();
 }
 
 bool BankService::withdraw(int accountId, double amount, const std::string& description) {
-    if (amount <= 0) {
-        return false;
+    CallScope scope(*this, "withdraw");
+    bool ok = applyWithdrawal(accountId, amount, description);
+    scope.setOk(ok);
+    if (m_logger) {
+        m_logger->info("withdraw", "account", accountId, "amount", amount, "description", description, "ok", ok);
     }
-    
-    auto account = getAccountById(accountId);
-    if (!account.has_value()) {
-        return false;
-    }
-    
-    if (account->getStatus() != AccountStatus::Active) {
-        return false;
-    }
-    
-    if (account->getBalance() < amount) {
+    return ok;
+}
+
+bool BankService::applyWithdrawal(int accountId, double amount, const std::string& description) {
+    if (amount <= 0) {
         return false;
     }
     
-    double newBalance = account->getBalance() - amount;
-    
-    m_db->beginTransaction();
-    
-    std::string query = "UPDATE accounts SET balance = $1 WHERE account_id = $2";
-    if (!m_db->executeParams(query, {std::to_string(newBalance), std::to_string(accountId)})) {
-        m_db->rollbackTransaction();
+    TransactionScope transaction(*m_store);
+    if (!transaction.isOpen()) {
         return false;
     }
     
-    if (!recordTransaction(accountId, TransactionType::Withdrawal, amount, newBalance, description)) {
-        m_db->rollbackTransaction();
+    // The store rejects the debit if it would overdraw the account
+    auto newBalance = m_store->adjustBalance(accountId, -amount);
+    if (!newBalance.has_value() ||
+        !recordTransaction(accountId, TransactionType::Withdrawal, amount, *newBalance, description)) {
         return false;
     }
     
-    m_db->commitTransaction();
-    return true;
+    return transaction.commit();
 }
 
 bool BankService::transfer(int fromAccountId, int toAccountId, double amount,
                             const std::string& description) 
 {
-    if (amount <= 0) {
-        return false;
-    }
-    
-    auto fromAccount = getAccountById(fromAccountId);
-    auto toAccount = getAccountById(toAccountId);
-    
-    if (!fromAccount.has_value() || !toAccount.has_value()) {
+    CallScope scope(*this, "transfer");
+    bool ok = applyTransfer(fromAccountId, toAccountId, amount, description);
+    scope.setOk(ok);
+    if (m_logger) {
+        m_logger->info("transfer", "from", fromAccountId, "to", toAccountId, "amount", amount,
+                       "description", description, "ok", ok);
+    }
+    return ok;
+}
+
+bool BankService::applyTransfer(int fromAccountId, int toAccountId, double amount,
+                                const std::string& description)
+{
+    if (amount <= 0 || fromAccountId == toAccountId) {
         return false;
     }
     
-    if (fromAccount->getStatus() != AccountStatus::Active || 
-        toAccount->getStatus() != AccountStatus::Active) {
+    TransactionScope transaction(*m_store);
+    if (!transaction.isOpen()) {
         return false;
     }
     
-    if (fromAccount->getBalance() < amount) {
+    auto locked = m_store->lockAccounts({fromAccountId, toAccountId});
+    if (locked.size() != 2 || locked[0].getStatus() != AccountStatus::Active || 
+        locked[1].getStatus() != AccountStatus::Active) {
         return false;
     }
     
-    double fromNewBalance = fromAccount->getBalance() - amount;
-    double toNewBalance = toAccount->getBalance() + amount;
+    bool fromFirst = locked[0].getAccountId() == fromAccountId;
+    std::string fromNumber(locked[fromFirst ? 0 : 1].getAccountNumber());
+    std::string toNumber(locked[fromFirst ? 1 : 0].getAccountNumber());
     
-    m_db->beginTransaction();
-    
-    // Update from account
-    std::string query = "UPDATE accounts SET balance = $1 WHERE account_id = $2";
-    if (!m_db->executeParams(query, {std::to_string(fromNewBalance), std::to_string(fromAccountId)})) {
-        m_db->rollbackTransaction();
+    auto fromNewBalance = m_store->adjustBalance(fromAccountId, -amount);
+    if (!fromNewBalance.has_value()) {
         return false;
     }
     
-    // Update to account
-    if (!m_db->executeParams(query, {std::to_string(toNewBalance), std::to_string(toAccountId)})) {
-        m_db->rollbackTransaction();
+    auto toNewBalance = m_store->adjustBalance(toAccountId, amount);
+    if (!toNewBalance.has_value()) {
         return false;
     }
     
     // Record transactions
-    std::string transferDesc = description + " to " + toAccount->getAccountNumber();
     if (!recordTransaction(fromAccountId, TransactionType::TransferOut, amount, 
-                           fromNewBalance, transferDesc, toAccountId)) {
-        m_db->rollbackTransaction();
+                           *fromNewBalance, description + " to " + toNumber, toAccountId)) {
         return false;
     }
     
-    transferDesc = description + " from " + fromAccount->getAccountNumber();
     if (!recordTransaction(toAccountId, TransactionType::TransferIn, amount, 
-                           toNewBalance, transferDesc, fromAccountId)) {
-        m_db->rollbackTransaction();
+                           *toNewBalance, description + " from " + fromNumber, fromAccountId)) {
         return false;
     }
     
-    m_db->commitTransaction();
-    return true;
+    return transaction.commit();
 }
 
 std::vector<Transaction> BankService::getTransactionHistory(int accountId, int limit) {
-    std::vector<Transaction> transactions;
-    
-    std::string query = 
-        "SELECT transaction_id, account_id, transaction_type, amount, balance_after, "
-        "description, related_account_id, created_at "
-        "FROM transactions WHERE account_id = $1 "
-        "ORDER BY created_at DESC LIMIT $2";
-    
-    auto results = m_db->queryParams(query, {
-        std::to_string(accountId),
-        std::to_string(limit)
-    });
-    
-    for (const auto& row : results) {
-        Transaction t;
-        t.setTransactionId(std::stoi(row[0]));
-        t.setAccountId(std::stoi(row[1]));
-        t.setType(Transaction::stringToType(row[2]));
-        t.setAmount(std::stod(row[3]));
-        t.setBalanceAfter(std::stod(row[4]));
-        t.setDescription(row[5]);
-        t.setRelatedAccountId(row[6].empty() ? -1 : std::stoi(row[6]));
-        t.setCreatedAt(row[7]);
-        transactions.push_back(t);
-    }
-    
-    return transactions;
+    CallScope scope(*this, "getTransactionHistory");
+    return m_store->scanHistory(accountId, limit);
 }
 
 std::optional<Transaction> BankService::getTransactionById(int transactionId) {
-    std::string query = 
-        "SELECT transaction_id, account_id, transaction_type, amount, balance_after, "
-        "description, related_account_id, created_at "
-        "FROM transactions WHERE transaction_id = $1";
-    
-    auto results = m_db->queryParams(query, {std::to_string(transactionId)});
-    
-    if (results.empty()) {
-        return std::nullopt;
-    }
-    
-    const auto& row = results[0];
-    Transaction t;
-    t.setTransactionId(std::stoi(row[0]));
-    t.setAccountId(std::stoi(row[1]));
-    t.setType(Transaction::stringToType(row[2]));
-    t.setAmount(std::stod(row[3]));
-    t.setBalanceAfter(std::stod(row[4]));
-    t.setDescription(row[5]);
-    t.setRelatedAccountId(row[6].empty() ? -1 : std::stoi(row[6]));
-    t.setCreatedAt(row[7]);
-    
-    return t;
+    CallScope scope(*this, "getTransactionById");
+    auto transaction = m_store->findTransaction(transactionId);
+    scope.setOk(transaction.has_value());
+    return transaction;
+}
+
+std::vector<BalancePoint> BankService::getBalanceHistory(int accountId, int maxPoints) {
+    CallScope scope(*this, "getBalanceHistory");
+    return m_store->balanceHistory(accountId, maxPoints);
+}
+
+std::vector<Transaction> BankService::getTransactionsBetween(int accountId, Timestamp from, Timestamp to,
+                                                             int limit)
+{
+    CallScope scope(*this, "getTransactionsBetween");
+    return m_store->scanHistoryBetween(accountId, TimeRange{from, to}, limit);
+}
+
+std::vector<ActivityTotal> BankService::getDailyTotals(int accountId, const TimeRange& range) {
+    CallScope scope(*this, "getDailyTotals");
+    return m_store->dailyTotals(accountId, range);
+}
+
+std::vector<ActivityTotal> BankService::getActivity(int accountId, TimeUnit unit, const TimeRange& range) {
+    CallScope scope(*this, "getActivity");
+    return m_store->rollups(accountId, unit, range);
+}
+
+ActivityTotal BankService::getActivitySummary(int accountId, const TimeRange& range) {
+    CallScope scope(*this, "getActivitySummary");
+    return m_store->summarizeActivity(accountId, RangeCover::of(range));
 }
 
 // Utility operations
 
 double BankService::getTotalBalance(int userId) {
-    std::string query = "SELECT COALESCE(SUM(balance), 0) FROM accounts WHERE user_id = $1";
-    auto results = m_db->queryParams(query, {std::to_string(userId)});
-    
-    if (results.empty() || results[0].empty()) {
-        return 0.0;
-    }
-    
-    return std::stod(results[0][0]);
+    CallScope scope(*this, "getTotalBalance");
+    return m_store->totalBalance(userId);
 }
 
 bool BankService::accountExists(const std::string& accountNumber) {
-    std::string query = "SELECT 1 FROM accounts WHERE account_number = $1";
-    auto results = m_db->queryParams(query, {accountNumber});
-    return !results.empty();
+    CallScope scope(*this, "accountExists");
+    return m_store->accountNumberExists(accountNumber);
 }
 
 // Helper methods
@@ -447,32 +457,14 @@ bool BankService::recordTransaction(int accountId, TransactionType type, double
                                      double balanceAfter, const std::string& description,
                                      int relatedAccountId) 
 {
-    // Build query with optional related_account_id parameter
-    // Using NULL for optional related_account_id when not provided
-    std::string query = 
-        "INSERT INTO transactions (account_id, transaction_type, amount, "
-        "balance_after, description, related_account_id) "
-        "VALUES ($1, $2, $3, $4, $5, $6)";
-    
-    std::vector<std::string> params = {
-        std::to_string(accountId),
-        Transaction::typeToString(type),
-        std::to_string(amount),
-        std::to_string(balanceAfter),
-        description
-    };
-    
-    // Handle optional related_account_id - PostgreSQL accepts empty string as NULL
-    // for integer columns when using parameterized queries
-    if (relatedAccountId >= 0) {
-        params.push_back(std::to_string(relatedAccountId));
-    } else {
-        // Use a separate query without related_account_id to properly set NULL
-        query = "INSERT INTO transactions (account_id, transaction_type, amount, "
-                "balance_after, description) VALUES ($1, $2, $3, $4, $5)";
-    }
-    
-    return m_db->executeParams(query, params);
+    Transaction transaction;
+    transaction.setAccountId(accountId);
+    transaction.setType(type);
+    transaction.setAmount(amount);
+    transaction.setBalanceAfter(balanceAfter);
+    transaction.setDescription(description);
+    transaction.setRelatedAccountId(relatedAccountId);
+    return m_store->appendTransaction(transaction);
 }
 
 } // namespace bank
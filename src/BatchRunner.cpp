@@ -0,0 +1,330 @@
+#include "BatchRunner.hpp"
+#include "BankService.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace bank {
+
+namespace {
+
+struct BatchOp {
+    std::size_t line;
+    std::vector<std::string> fields;
+};
+
+struct OpResult {
+    bool ok;
+    bool error;             // Malformed input rather than a rejected operation
+    std::string detail;
+};
+
+/**
+ * @brief Bounded queue feeding one worker, so reading never runs far ahead
+ */
+class OpQueue {
+public:
+    explicit OpQueue(std::size_t capacity) : m_capacity(capacity) {}
+
+    void push(BatchOp op) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notFull.wait(lock, [this] { return m_ops.size() < m_capacity; });
+        m_ops.push_back(std::move(op));
+        m_notEmpty.notify_one();
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = true;
+        m_notEmpty.notify_all();
+    }
+
+    /**
+     * @brief Take up to maxOps queued operations
+     * @return false once the queue is closed and drained
+     */
+    bool popUpTo(std::size_t maxOps, std::vector<BatchOp>& out) {
+        out.clear();
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notEmpty.wait(lock, [this] { return !m_ops.empty() || m_closed; });
+        while (!m_ops.empty() && out.size() < maxOps) {
+            out.push_back(std::move(m_ops.front()));
+            m_ops.pop_front();
+        }
+        m_notFull.notify_all();
+        return !out.empty();
+    }
+
+private:
+    std::size_t m_capacity;
+    std::deque<BatchOp> m_ops;
+    bool m_closed = false;
+    std::mutex m_mutex;
+    std::condition_variable m_notEmpty;
+    std::condition_variable m_notFull;
+};
+
+std::vector<std::string> splitFields(const std::string& line) {
+    std::vector<std::string> fields;
+    std::stringstream ss(line);
+    std::string field;
+    while (std::getline(ss, field, ',')) {
+        auto begin = field.find_first_not_of(" \t\r");
+        auto end = field.find_last_not_of(" \t\r");
+        fields.push_back(begin == std::string::npos ? "" : field.substr(begin, end - begin + 1));
+    }
+    return fields;
+}
+
+/**
+ * @brief Get the trailing description field, which may itself contain commas
+ */
+std::string joinFrom(const std::vector<std::string>& fields, std::size_t first, 
+                     const std::string& fallback) 
+{
+    if (fields.size() <= first) {
+        return fallback;
+    }
+    std::string joined = fields[first];
+    for (std::size_t i = first + 1; i < fields.size(); ++i) {
+        joined += "," + fields[i];
+    }
+    return joined;
+}
+
+std::optional<int> resolveAccount(BankService& service, const std::string& token) {
+    if (token.rfind("ACC", 0) == 0) {
+        auto account = service.getAccountByNumber(token);
+        if (!account.has_value()) {
+            return std::nullopt;
+        }
+        return account->getAccountId();
+    }
+    return std::stoi(token);
+}
+
+OpResult execute(BankService& service, const BatchOp& op) {
+    const auto& f = op.fields;
+    const std::string& name = f[0];
+
+    try {
+        if ((name == "deposit" || name == "withdraw") && f.size() >= 3) {
+            auto account = resolveAccount(service, f[1]);
+            if (!account.has_value()) {
+                return {false, false, "unknown account"};
+            }
+            double amount = std::stod(f[2]);
+            bool ok = name == "deposit"
+                ? service.deposit(*account, amount, joinFrom(f, 3, "Deposit"))
+                : service.withdraw(*account, amount, joinFrom(f, 3, "Withdrawal"));
+            return {ok, false, ""};
+        }
+
+        if (name == "transfer" && f.size() >= 4) {
+            auto from = resolveAccount(service, f[1]);
+            auto to = resolveAccount(service, f[2]);
+            if (!from.has_value() || !to.has_value()) {
+                return {false, false, "unknown account"};
+            }
+            bool ok = service.transfer(*from, *to, std::stod(f[3]), joinFrom(f, 4, "Transfer"));
+            return {ok, false, ""};
+        }
+
+        if (name == "status" && f.size() == 3) {
+            if (f[2] != "active" && f[2] != "inactive" && f[2] != "frozen") {
+                return {false, true, "invalid status"};
+            }
+            auto account = resolveAccount(service, f[1]);
+            if (!account.has_value()) {
+                return {false, false, "unknown account"};
+            }
+            return {service.updateAccountStatus(*account, Account::stringToStatus(f[2])), false, ""};
+        }
+
+        if (name == "create_account" && (f.size() == 3 || f.size() == 4)) {
+            if (f[2] != "savings" && f[2] != "checking" && f[2] != "fixed_deposit") {
+                return {false, true, "invalid account type"};
+            }
+            double initialDeposit = f.size() == 4 ? std::stod(f[3]) : 0.0;
+            auto account = service.createAccount(std::stoi(f[1]), Account::stringToType(f[2]), 
+                                                 initialDeposit);
+            if (!account.has_value()) {
+                return {false, false, ""};
+            }
+            return {true, false, std::string(account->getAccountNumber())};
+        }
+    } catch (const std::exception&) {
+        return {false, true, "invalid number"};
+    }
+
+    return {false, true, "unknown operation or wrong field count"};
+}
+
+double percentileOf(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    std::size_t rank = static_cast<std::size_t>(std::ceil(p / 100.0 * static_cast<double>(sorted.size())));
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+} // namespace
+
+BatchRunner::BatchRunner(ConnectionFactory connect, BatchOptions options)
+    : m_connect(std::move(connect))
+    , m_options(std::move(options))
+{
+    m_options.jobs = std::max(1, m_options.jobs);
+    m_options.batchSize = std::max(1, m_options.batchSize);
+}
+
+std::optional<BatchSummary> BatchRunner::run() {
+    std::ifstream input(m_options.inputPath);
+    if (!input) {
+        m_lastError = "Could not open " + m_options.inputPath;
+        return std::nullopt;
+    }
+
+    std::ofstream outputFile;
+    if (!m_options.outputPath.empty()) {
+        outputFile.open(m_options.outputPath, std::ios::trunc);
+        if (!outputFile) {
+            m_lastError = "Could not open " + m_options.outputPath;
+            return std::nullopt;
+        }
+    }
+    std::ostream& output = m_options.outputPath.empty() ? std::cout : outputFile;
+
+    // One connection per worker; BankService and Database are single threaded
+    std::size_t jobs = static_cast<std::size_t>(m_options.jobs);
+    std::size_t batchSize = static_cast<std::size_t>(m_options.batchSize);
+    std::vector<std::shared_ptr<Database>> connections;
+    for (std::size_t i = 0; i < jobs; ++i) {
+        auto db = m_connect();
+        if (!db || !db->isConnected()) {
+            m_lastError = "Worker connection failed" + 
+                          (db ? ": " + db->getLastError() : std::string());
+            return std::nullopt;
+        }
+        connections.push_back(db);
+    }
+
+    std::vector<std::unique_ptr<OpQueue>> queues;
+    for (std::size_t i = 0; i < jobs; ++i) {
+        queues.push_back(std::make_unique<OpQueue>(batchSize * 4 + 64));
+    }
+
+    std::mutex outputMutex;
+    std::atomic<std::size_t> succeeded{0};
+    std::atomic<std::size_t> failed{0};
+    std::vector<std::vector<double>> latencies(jobs);
+
+    auto worker = [&](std::size_t index) {
+        auto db = connections[index];
+        BankService service(db);
+        std::vector<BatchOp> chunk;
+        std::vector<OpResult> results;
+
+        while (queues[index]->popUpTo(batchSize, chunk)) {
+            bool inTransaction = batchSize > 1 && db->beginTransaction();
+            results.clear();
+
+            std::string lines;
+            for (const auto& op : chunk) {
+                auto start = std::chrono::steady_clock::now();
+                results.push_back(execute(service, op));
+                double millis = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start).count();
+                latencies[index].push_back(millis);
+
+                const OpResult& result = results.back();
+                lines += std::to_string(op.line) + "," + op.fields[0] + "," +
+                         (result.error ? "error" : result.ok ? "ok" : "failed") + "," +
+                         std::to_string(static_cast<long long>(millis * 1000.0));
+                if (!result.detail.empty()) {
+                    lines += "," + result.detail;
+                }
+                lines += "\n";
+            }
+
+            bool committed = !inTransaction || db->commitTransaction();
+            std::size_t chunkOk = 0;
+            for (const auto& result : results) {
+                if (result.ok && committed) {
+                    ++chunkOk;
+                }
+            }
+            if (!committed) {
+                lines.clear();
+                for (const auto& op : chunk) {
+                    lines += std::to_string(op.line) + "," + op.fields[0] + 
+                             ",error,0,batch commit failed\n";
+                }
+            }
+            succeeded += chunkOk;
+            failed += chunk.size() - chunkOk;
+
+            std::lock_guard<std::mutex> lock(outputMutex);
+            output << lines;
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < jobs; ++i) {
+        threads.emplace_back(worker, i);
+    }
+
+    // Route by the (source) account so each account's operations stay in order
+    std::string line;
+    std::size_t lineNumber = 0;
+    std::hash<std::string> hasher;
+    while (std::getline(input, line)) {
+        ++lineNumber;
+        auto first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') {
+            continue;
+        }
+
+        BatchOp op{lineNumber, splitFields(line)};
+        std::size_t route = op.fields.size() > 1 ? hasher(op.fields[1]) % jobs : 0;
+        queues[route]->push(std::move(op));
+    }
+
+    for (auto& queue : queues) {
+        queue->close();
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    BatchSummary summary;
+    summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    summary.succeeded = succeeded;
+    summary.failed = failed;
+    summary.total = summary.succeeded + summary.failed;
+
+    std::vector<double> all;
+    for (const auto& samples : latencies) {
+        all.insert(all.end(), samples.begin(), samples.end());
+    }
+    std::sort(all.begin(), all.end());
+    summary.p50Millis = percentileOf(all, 50);
+    summary.p95Millis = percentileOf(all, 95);
+    summary.p99Millis = percentileOf(all, 99);
+    summary.maxMillis = all.empty() ? 0.0 : all.back();
+
+    output.flush();
+    return summary;
+}
+
+} // namespace bank
@@ -0,0 +1,206 @@
+#include "CachingLedgerStore.hpp"
+
+namespace bank {
+
+CachingLedgerStore::CachingLedgerStore(std::shared_ptr<LedgerStore> store, 
+                                       std::shared_ptr<AccountCache> cache)
+    : m_store(store)
+    , m_cache(cache)
+    , m_scopeDepth(0)
+{
+}
+
+// Transaction scope
+
+bool CachingLedgerStore::begin() {
+    if (!m_store->begin()) {
+        return false;
+    }
+    ++m_scopeDepth;
+    return true;
+}
+
+bool CachingLedgerStore::commit() {
+    bool committed = m_store->commit();
+    if (--m_scopeDepth == 0) {
+        // A reader outside the scope may have cached the old row meanwhile
+        for (int accountId : m_touched) {
+            m_cache->invalidate(accountId);
+        }
+        m_touched.clear();
+    }
+    return committed;
+}
+
+bool CachingLedgerStore::rollback() {
+    if (--m_scopeDepth == 0) {
+        m_touched.clear();
+    }
+    return m_store->rollback();
+}
+
+void CachingLedgerStore::touch(int accountId) {
+    m_cache->invalidate(accountId);
+    if (m_scopeDepth > 0) {
+        m_touched.push_back(accountId);
+    }
+}
+
+// Users
+
+std::optional<int> CachingLedgerStore::insertUser(const User& user) {
+    return m_store->insertUser(user);
+}
+
+std::optional<User> CachingLedgerStore::findUserById(int userId) {
+    return m_store->findUserById(userId);
+}
+
+std::optional<User> CachingLedgerStore::findUserByUsername(const std::string& username) {
+    return m_store->findUserByUsername(username);
+}
+
+std::optional<std::pair<int, std::string>> CachingLedgerStore::findCredentials(const std::string& username) {
+    return m_store->findCredentials(username);
+}
+
+bool CachingLedgerStore::updateUser(const User& user) {
+    return m_store->updateUser(user);
+}
+
+bool CachingLedgerStore::deleteUser(int userId) {
+    // The user's accounts are deleted with them
+    auto accounts = m_store->findAccountsByUser(userId);
+    bool deleted = m_store->deleteUser(userId);
+    for (const auto& account : accounts) {
+        touch(account.getAccountId());
+    }
+    return deleted;
+}
+
+// Accounts
+
+std::optional<int> CachingLedgerStore::insertAccount(const Account& account) {
+    return m_store->insertAccount(account);
+}
+
+std::optional<Account> CachingLedgerStore::findAccountById(int accountId) {
+    if (m_scopeDepth > 0) {
+        return m_store->findAccountById(accountId);
+    }
+
+    auto account = m_cache->findById(accountId);
+    if (!account.has_value()) {
+        std::uint64_t ticket = m_cache->readTicket();
+        account = m_store->findAccountById(accountId);
+        if (account.has_value()) {
+            m_cache->put(*account, ticket);
+        }
+    }
+    return account;
+}
+
+std::optional<Account> CachingLedgerStore::findAccountByNumber(const std::string& accountNumber) {
+    if (m_scopeDepth > 0) {
+        return m_store->findAccountByNumber(accountNumber);
+    }
+
+    auto account = m_cache->findByNumber(accountNumber);
+    if (!account.has_value()) {
+        std::uint64_t ticket = m_cache->readTicket();
+        account = m_store->findAccountByNumber(accountNumber);
+        if (account.has_value()) {
+            m_cache->put(*account, ticket);
+        }
+    }
+    return account;
+}
+
+bool CachingLedgerStore::accountNumberExists(const std::string& accountNumber) {
+    // Only a hit is trusted: the number may have been taken since the cache saw it
+    if (m_scopeDepth == 0 && m_cache->findByNumber(accountNumber).has_value()) {
+        return true;
+    }
+    return m_store->accountNumberExists(accountNumber);
+}
+
+std::vector<Account> CachingLedgerStore::findAccountsByUser(int userId) {
+    return m_store->findAccountsByUser(userId);
+}
+
+bool CachingLedgerStore::setAccountStatus(int accountId, AccountStatus status) {
+    bool updated = m_store->setAccountStatus(accountId, status);
+    touch(accountId);
+    return updated;
+}
+
+bool CachingLedgerStore::deleteAccount(int accountId) {
+    bool deleted = m_store->deleteAccount(accountId);
+    touch(accountId);
+    return deleted;
+}
+
+std::vector<Account> CachingLedgerStore::lockAccounts(std::vector<int> accountIds) {
+    return m_store->lockAccounts(std::move(accountIds));
+}
+
+std::optional<double> CachingLedgerStore::adjustBalance(int accountId, double delta) {
+    auto balance = m_store->adjustBalance(accountId, delta);
+    touch(accountId);
+    return balance;
+}
+
+double CachingLedgerStore::totalBalance(int userId) {
+    return m_store->totalBalance(userId);
+}
+
+// Transactions
+
+bool CachingLedgerStore::appendTransaction(const Transaction& transaction) {
+    return m_store->appendTransaction(transaction);
+}
+
+std::vector<Transaction> CachingLedgerStore::scanHistory(int accountId, int limit) {
+    return m_store->scanHistory(accountId, limit);
+}
+
+std::optional<Transaction> CachingLedgerStore::findTransaction(int transactionId) {
+    return m_store->findTransaction(transactionId);
+}
+
+std::vector<Transaction> CachingLedgerStore::scanHistoryBetween(int accountId, const TimeRange& range,
+                                                                int limit)
+{
+    return m_store->scanHistoryBetween(accountId, range, limit);
+}
+
+std::vector<ActivityTotal> CachingLedgerStore::dailyTotals(int accountId, const TimeRange& range) {
+    return m_store->dailyTotals(accountId, range);
+}
+
+std::vector<ActivityTotal> CachingLedgerStore::rollups(int accountId, TimeUnit unit, const TimeRange& range) {
+    return m_store->rollups(accountId, unit, range);
+}
+
+ActivityTotal CachingLedgerStore::summarizeActivity(int accountId, const RangeCover& cover) {
+    return m_store->summarizeActivity(accountId, cover);
+}
+
+std::vector<BalancePoint> CachingLedgerStore::balanceHistory(int accountId, int maxPoints) {
+    return m_store->balanceHistory(accountId, maxPoints);
+}
+
+std::optional<DashboardData> CachingLedgerStore::loadDashboard(int userId, int historyLimit, 
+                                                               int balancePoints) 
+{
+    return m_store->loadDashboard(userId, historyLimit, balancePoints);
+}
+
+std::optional<DashboardData> CachingLedgerStore::loadDashboardForLogin(const std::string& username,
+                                                                       const std::string& passwordHash,
+                                                                       int historyLimit, int balancePoints)
+{
+    return m_store->loadDashboardForLogin(username, passwordHash, historyLimit, balancePoints);
+}
+
+} // namespace bank
@@ -0,0 +1,90 @@
+#include "ConnectionPool.hpp"
+#include "CachingLedgerStore.hpp"
+#include "PostgresLedgerStore.hpp"
+
+namespace bank {
+
+ConnectionPool::ConnectionPool(ConnectionFactory connect, std::size_t size, 
+                               std::shared_ptr<AccountCache> cache,
+                               std::shared_ptr<MetricsRegistry> metrics,
+                               std::shared_ptr<Logger> logger)
+    : m_connect(std::move(connect))
+    , m_size(size)
+    , m_cache(std::move(cache))
+    , m_metrics(std::move(metrics))
+    , m_logger(std::move(logger))
+{
+}
+
+bool ConnectionPool::open() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_idle.clear();
+    m_slots.clear();
+
+    for (std::size_t i = 0; i < m_size; ++i) {
+        auto slot = std::make_unique<Slot>();
+        slot->db = m_connect();
+        if (!slot->db || !slot->db->connect()) {
+            m_lastError = "Connection " + std::to_string(i + 1) + " of " + std::to_string(m_size) +
+                          " failed" + (slot->db ? ": " + slot->db->getLastError() : std::string());
+            return false;
+        }
+        slot->db->setMetrics(m_metrics);
+        std::shared_ptr<LedgerStore> store = std::make_shared<PostgresLedgerStore>(slot->db);
+        if (m_cache) {
+            store = std::make_shared<CachingLedgerStore>(store, m_cache);
+        }
+        slot->service = std::make_unique<BankService>(store);
+        slot->service->setMetrics(m_metrics);
+        slot->service->setLogger(m_logger);
+        m_idle.push_back(slot.get());
+        m_slots.push_back(std::move(slot));
+    }
+    return true;
+}
+
+ConnectionPool::Lease ConnectionPool::acquire() {
+    Slot* slot;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_available.wait(lock, [this] { return !m_idle.empty(); });
+        slot = m_idle.back();
+        m_idle.pop_back();
+    }
+
+    // Reconnect outside the lock so other workers are not held up
+    if (!slot->db->isConnected()) {
+        slot->db->disconnect();
+        slot->db->connect();
+    }
+    return Lease(*this, slot);
+}
+
+void ConnectionPool::release(Slot* slot) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_idle.push_back(slot);
+    }
+    m_available.notify_one();
+}
+
+ConnectionPool::Lease::Lease(ConnectionPool& pool, Slot* slot)
+    : m_pool(pool)
+    , m_slot(slot)
+{
+}
+
+ConnectionPool::Lease::Lease(Lease&& other) noexcept
+    : m_pool(other.m_pool)
+    , m_slot(other.m_slot)
+{
+    other.m_slot = nullptr;
+}
+
+ConnectionPool::Lease::~Lease() {
+    if (m_slot != nullptr) {
+        m_pool.release(m_slot);
+    }
+}
+
+} // namespace bank
@@ -0,0 +1,351 @@
+#include "CoroBankService.hpp"
+#include "LedgerRows.hpp"
+#include "User.hpp"
+#include <utility>
+
+namespace bank {
+
+CoroBankService::CoroBankService(EventLoop& loop, ConnectionFactory connect, std::size_t connections)
+    : m_loop(loop)
+    , m_connect(std::move(connect))
+    , m_size(connections)
+{
+}
+
+Task<bool> CoroBankService::open() {
+    for (std::size_t i = m_connections.size(); i < m_size; ++i) {
+        auto db = m_connect(m_loop);
+        if (!db) {
+            m_lastError = "Could not create a connection";
+            co_return false;
+        }
+        bool connected = co_await db->connect();
+        if (!connected) {
+            m_lastError = db->getLastError();
+            co_return false;
+        }
+        m_idle.push_back(db.get());
+        m_connections.push_back(std::move(db));
+    }
+    co_return true;
+}
+
+// Connections
+
+bool CoroBankService::IdleAwaiter::await_ready() {
+    if (service.m_idle.empty()) {
+        return false;
+    }
+    db = service.m_idle.back();
+    service.m_idle.pop_back();
+    return true;
+}
+
+void CoroBankService::IdleAwaiter::await_suspend(std::coroutine_handle<> handle) {
+    service.m_waiters.push_back({handle, &db});
+}
+
+Task<CoroBankService::Lease> CoroBankService::acquire() {
+    CoroDatabase* db = co_await IdleAwaiter{*this};
+
+    if (!db->isConnected()) {
+        db->disconnect();
+        bool connected = co_await db->connect();
+        if (!connected) {
+            m_lastError = db->getLastError();
+            release(db);
+            co_return Lease(this, nullptr);
+        }
+    }
+    co_return Lease(this, db);
+}
+
+void CoroBankService::release(CoroDatabase* db) {
+    if (m_waiters.empty()) {
+        m_idle.push_back(db);
+        return;
+    }
+
+    // Hand over directly; the waiter resumes once the releasing coroutine suspends
+    Waiter waiter = m_waiters.front();
+    m_waiters.pop_front();
+    *waiter.slot = db;
+    m_loop.post(waiter.handle);
+}
+
+CoroBankService::Lease::Lease(Lease&& other) noexcept
+    : m_service(other.m_service)
+    , m_db(std::exchange(other.m_db, nullptr))
+{
+}
+
+CoroBankService::Lease::~Lease() {
+    if (m_db != nullptr) {
+        m_service->release(m_db);
+    }
+}
+
+// User operations
+
+Task<std::optional<int>> CoroBankService::verifyCredentials(std::string username, std::string password) {
+    auto lease = co_await acquire();
+    if (!lease) {
+        co_return std::nullopt;
+    }
+
+    std::vector<std::string> params = {username};
+    auto result = co_await run(*lease, "SELECT user_id, password_hash FROM users WHERE username = $1",
+                               std::move(params));
+    if (result.rows.empty() || result.rows[0][1] != User::hashPassword(password)) {
+        co_return std::nullopt;
+    }
+    co_return std::stoi(result.rows[0][0]);
+}
+
+// Account operations
+
+Task<std::optional<Account>> CoroBankService::getAccountById(int accountId) {
+    auto lease = co_await acquire();
+    if (!lease) {
+        co_return std::nullopt;
+    }
+
+    std::vector<std::string> params = {std::to_string(accountId)};
+    auto result = co_await run(*lease,
+        std::string("SELECT ") + kAccountColumns + " FROM accounts WHERE account_id = $1",
+        std::move(params));
+    if (result.rows.empty()) {
+        co_return std::nullopt;
+    }
+    co_return accountFromRow(result.rows[0]);
+}
+
+Task<std::vector<Account>> CoroBankService::getAccountsByUserId(int userId) {
+    std::vector<Account> accounts;
+    auto lease = co_await acquire();
+    if (!lease) {
+        co_return accounts;
+    }
+
+    std::vector<std::string> params = {std::to_string(userId)};
+    auto result = co_await run(*lease,
+        std::string("SELECT ") + kAccountColumns + " FROM accounts WHERE user_id = $1 ORDER BY created_at",
+        std::move(params));
+    accounts.reserve(result.rows.size());
+    for (const auto& row : result.rows) {
+        accounts.push_back(accountFromRow(row));
+    }
+    co_return accounts;
+}
+
+// Transaction operations
+
+Task<bool> CoroBankService::deposit(int accountId, double amount, std::string description) {
+    if (amount <= 0) {
+        co_return false;
+    }
+    auto lease = co_await acquire();
+    if (!lease) {
+        co_return false;
+    }
+    bool begun = co_await begin(*lease);
+    if (!begun) {
+        co_return false;
+    }
+
+    bool succeeded = false;
+    auto newBalance = co_await adjustBalance(*lease, accountId, amount);
+    if (newBalance.has_value()) {
+        succeeded = co_await recordTransaction(*lease, accountId, TransactionType::Deposit, amount,
+                                               *newBalance, std::move(description));
+    }
+    co_return co_await finish(*lease, succeeded);
+}
+
+Task<bool> CoroBankService::withdraw(int accountId, double amount, std::string description) {
+    if (amount <= 0) {
+        co_return false;
+    }
+    auto lease = co_await acquire();
+    if (!lease) {
+        co_return false;
+    }
+    bool begun = co_await begin(*lease);
+    if (!begun) {
+        co_return false;
+    }
+
+    // The debit is rejected in the database if it would overdraw the account
+    bool succeeded = false;
+    auto newBalance = co_await adjustBalance(*lease, accountId, -amount);
+    if (newBalance.has_value()) {
+        succeeded = co_await recordTransaction(*lease, accountId, TransactionType::Withdrawal, amount,
+                                               *newBalance, std::move(description));
+    }
+    co_return co_await finish(*lease, succeeded);
+}
+
+Task<bool> CoroBankService::transfer(int fromAccountId, int toAccountId, double amount,
+                                     std::string description)
+{
+    if (amount <= 0 || fromAccountId == toAccountId) {
+        co_return false;
+    }
+    auto lease = co_await acquire();
+    if (!lease) {
+        co_return false;
+    }
+    bool begun = co_await begin(*lease);
+    if (!begun) {
+        co_return false;
+    }
+    CoroDatabase& db = *lease;
+
+    // Row locks are taken in scan order, so order by id to avoid deadlocks
+    std::vector<std::string> params = {std::to_string(fromAccountId), std::to_string(toAccountId)};
+    auto locked = co_await run(db,
+        std::string("SELECT ") + kAccountColumns + " FROM accounts "
+        "WHERE account_id IN ($1, $2) ORDER BY account_id FOR UPDATE",
+        std::move(params));
+    if (locked.rows.size() != 2) {
+        co_return co_await finish(db, false);
+    }
+    Account first = accountFromRow(locked.rows[0]);
+    Account second = accountFromRow(locked.rows[1]);
+    if (first.getStatus() != AccountStatus::Active || second.getStatus() != AccountStatus::Active) {
+        co_return co_await finish(db, false);
+    }
+
+    bool fromFirst = first.getAccountId() == fromAccountId;
+    std::string fromNumber((fromFirst ? first : second).getAccountNumber());
+    std::string toNumber((fromFirst ? second : first).getAccountNumber());
+
+    auto fromNewBalance = co_await adjustBalance(db, fromAccountId, -amount);
+    if (!fromNewBalance.has_value()) {
+        co_return co_await finish(db, false);
+    }
+    auto toNewBalance = co_await adjustBalance(db, toAccountId, amount);
+    if (!toNewBalance.has_value()) {
+        co_return co_await finish(db, false);
+    }
+
+    bool succeeded = co_await recordTransaction(db, fromAccountId, TransactionType::TransferOut, amount,
+                                                *fromNewBalance, description + " to " + toNumber,
+                                                toAccountId);
+    if (!succeeded) {
+        co_return co_await finish(db, false);
+    }
+    succeeded = co_await recordTransaction(db, toAccountId, TransactionType::TransferIn, amount,
+                                                *toNewBalance, description + " from " + fromNumber,
+                                                fromAccountId);
+    co_return co_await finish(db, succeeded);
+}
+
+Task<std::vector<Transaction>> CoroBankService::getTransactionHistory(int accountId, int limit) {
+    std::vector<Transaction> transactions;
+    auto lease = co_await acquire();
+    if (!lease) {
+        co_return transactions;
+    }
+
+    std::vector<std::string> params = {std::to_string(accountId), std::to_string(limit)};
+    auto result = co_await run(*lease,
+        std::string("SELECT ") + kTransactionColumns + " FROM transactions WHERE account_id = $1 "
+        "ORDER BY created_at DESC LIMIT $2",
+        std::move(params));
+    transactions.reserve(result.rows.size());
+    for (const auto& row : result.rows) {
+        transactions.push_back(transactionFromRow(row));
+    }
+    co_return transactions;
+}
+
+// Utility operations
+
+Task<double> CoroBankService::getTotalBalance(int userId) {
+    auto lease = co_await acquire();
+    if (!lease) {
+        co_return 0.0;
+    }
+
+    std::vector<std::string> params = {std::to_string(userId)};
+    auto result = co_await run(*lease, "SELECT COALESCE(SUM(balance), 0) FROM accounts WHERE user_id = $1",
+                               std::move(params));
+    if (result.rows.empty() || result.rows[0].empty()) {
+        co_return 0.0;
+    }
+    co_return std::stod(result.rows[0][0]);
+}
+
+// Helper methods
+
+Task<QueryResult> CoroBankService::run(CoroDatabase& db, std::string sql, std::vector<std::string> params) {
+    auto result = co_await db.query(std::move(sql), std::move(params));
+    if (!result.ok) {
+        m_lastError = result.error;
+    }
+    co_return result;
+}
+
+Task<bool> CoroBankService::begin(CoroDatabase& db) {
+    auto result = co_await run(db, "BEGIN");
+    co_return result.ok;
+}
+
+Task<bool> CoroBankService::finish(CoroDatabase& db, bool succeeded) {
+    if (!succeeded) {
+        co_await run(db, "ROLLBACK");
+        co_return false;
+    }
+    auto result = co_await run(db, "COMMIT");
+    co_return result.ok;
+}
+
+Task<std::optional<double>> CoroBankService::adjustBalance(CoroDatabase& db, int accountId, double delta) {
+    // Same statements as PostgresLedgerStore::adjustBalance
+    std::string sql = delta >= 0
+        ? "UPDATE accounts SET balance = balance + $1 "
+          "WHERE account_id = $2 AND status = 'active' RETURNING balance"
+        : "UPDATE accounts SET balance = balance - $1 "
+          "WHERE account_id = $2 AND status = 'active' AND balance >= $1 RETURNING balance";
+
+    std::vector<std::string> params = {
+        std::to_string(delta >= 0 ? delta : -delta),
+        std::to_string(accountId)
+    };
+    auto result = co_await run(db, std::move(sql), std::move(params));
+    if (result.rows.empty()) {
+        co_return std::nullopt;
+    }
+    co_return std::stod(result.rows[0][0]);
+}
+
+Task<bool> CoroBankService::recordTransaction(CoroDatabase& db, int accountId, TransactionType type,
+                                              double amount, double balanceAfter, std::string description,
+                                              int relatedAccountId)
+{
+    std::vector<std::string> params = {
+        std::to_string(accountId),
+        Transaction::typeToString(type),
+        std::to_string(amount),
+        std::to_string(balanceAfter),
+        std::move(description)
+    };
+
+    // Separate statements so a missing related account is stored as NULL
+    std::string sql;
+    if (relatedAccountId >= 0) {
+        sql = "INSERT INTO transactions (account_id, transaction_type, amount, "
+              "balance_after, description, related_account_id) "
+              "VALUES ($1, $2, $3, $4, $5, $6)";
+        params.push_back(std::to_string(relatedAccountId));
+    } else {
+        sql = "INSERT INTO transactions (account_id, transaction_type, amount, "
+              "balance_after, description) VALUES ($1, $2, $3, $4, $5)";
+    }
+
+    auto result = co_await run(db, std::move(sql), std::move(params));
+    co_return result.ok;
+}
+
+} // namespace bank
@@ -0,0 +1,202 @@
+#include "CoroDatabase.hpp"
+#include "PgResultRows.hpp"
+#include "RowReader.hpp"
+#include <cstdlib>
+
+namespace bank {
+
+CoroDatabase::CoroDatabase(EventLoop& loop,
+                           const std::string& host,
+                           const std::string& port,
+                           const std::string& dbname,
+                           const std::string& user,
+                           const std::string& password)
+    : m_loop(loop)
+    , m_conninfo("host=" + host + " port=" + port + " dbname=" + dbname + " user=" + user)
+    , m_connection(nullptr)
+    , m_socket(-1)
+    , m_busy(false)
+    , m_statements(0)
+{
+    if (!password.empty()) {
+        m_conninfo += " password=" + password;
+    }
+}
+
+CoroDatabase::~CoroDatabase() {
+    disconnect();
+}
+
+Task<bool> CoroDatabase::connect() {
+    if (m_connection != nullptr) {
+        co_return true; // Already connected
+    }
+
+    // Host names are still resolved synchronously here; use an address to avoid it
+    m_connection = PQconnectStart(m_conninfo.c_str());
+    if (m_connection == nullptr) {
+        co_return fail("Out of memory starting a connection");
+    }
+    if (PQstatus(m_connection) == CONNECTION_BAD) {
+        std::string message = PQerrorMessage(m_connection);
+        disconnect();
+        co_return fail(message);
+    }
+
+    // libpq asks for the readiness it needs next; start as if it asked to write
+    PostgresPollingStatusType poll = PGRES_POLLING_WRITING;
+    while (poll != PGRES_POLLING_OK) {
+        if (poll == PGRES_POLLING_FAILED) {
+            std::string message = PQerrorMessage(m_connection);
+            disconnect();
+            co_return fail(message);
+        }
+
+        // The socket can change between polls (e.g. another host is tried)
+        int socket = PQsocket(m_connection);
+        bool ready = false;
+        if (poll == PGRES_POLLING_READING) {
+            ready = co_await m_loop.readable(socket);
+        } else {
+            ready = co_await m_loop.writable(socket);
+        }
+        if (!ready) {
+            disconnect();
+            co_return fail(m_loop.getLastError());
+        }
+        poll = PQconnectPoll(m_connection);
+    }
+
+    if (PQsetnonblocking(m_connection, 1) != 0) {
+        std::string message = PQerrorMessage(m_connection);
+        disconnect();
+        co_return fail(message);
+    }
+    m_socket = PQsocket(m_connection);
+    co_return true;
+}
+
+void CoroDatabase::disconnect() {
+    if (m_connection != nullptr) {
+        if (m_socket >= 0) {
+            m_loop.forget(m_socket);
+        }
+        PQfinish(m_connection);
+        m_connection = nullptr;
+    }
+    m_socket = -1;
+    m_busy = false;
+}
+
+bool CoroDatabase::isConnected() const {
+    return m_connection != nullptr && m_socket >= 0 && PQstatus(m_connection) == CONNECTION_OK;
+}
+
+Task<QueryResult> CoroDatabase::query(std::string sql, std::vector<std::string> params) {
+    QueryResult result;
+
+    if (!isConnected()) {
+        result.error = m_lastError = "Not connected to database";
+        co_return result;
+    }
+    if (m_busy) {
+        result.error = m_lastError = "A query is already in progress on this connection";
+        co_return result;
+    }
+    m_busy = true;
+    ++m_statements;
+
+    std::vector<const char*> paramValues;
+    paramValues.reserve(params.size());
+    for (const auto& param : params) {
+        paramValues.push_back(param.c_str());
+    }
+
+    bool sent = PQsendQueryParams(m_connection, sql.c_str(),
+                                  static_cast<int>(params.size()),
+                                  nullptr, paramValues.data(),
+                                  nullptr, nullptr, 0) != 0;
+    if (!sent) {
+        fail(PQerrorMessage(m_connection));
+    } else {
+        sent = co_await flush();
+    }
+
+    // Every result must be read, even after an error, before the next statement
+    bool first = true;
+    while (sent) {
+        bool ready = co_await awaitResult();
+        if (!ready) {
+            break;
+        }
+        PGresult* pgResult = PQgetResult(m_connection);
+        if (pgResult == nullptr) {
+            break;
+        }
+        if (first) {
+            ExecStatusType status = PQresultStatus(pgResult);
+            if (status == PGRES_TUPLES_OK) {
+                result.rows = readRows(PgResultRows(pgResult));
+                result.affected = PQntuples(pgResult);
+                result.ok = true;
+            } else if (status == PGRES_COMMAND_OK) {
+                result.affected = std::atoi(PQcmdTuples(pgResult));
+                result.ok = true;
+            } else {
+                fail(PQresultErrorMessage(pgResult));
+            }
+            first = false;
+        }
+        PQclear(pgResult);
+    }
+
+    if (!result.ok) {
+        result.error = m_lastError;
+    }
+    m_busy = false;
+    co_return result;
+}
+
+Task<bool> CoroDatabase::flush() {
+    while (true) {
+        int pending = PQflush(m_connection);
+        if (pending == 0) {
+            co_return true;
+        }
+        if (pending < 0) {
+            co_return fail(PQerrorMessage(m_connection));
+        }
+
+        // The server may stop reading until we read its replies, so take those too
+        bool ready = co_await m_loop.readableOrWritable(m_socket);
+        if (!ready) {
+            co_return fail(m_loop.getLastError());
+        }
+        if (PQconsumeInput(m_connection) == 0) {
+            co_return fail(PQerrorMessage(m_connection));
+        }
+    }
+}
+
+Task<bool> CoroDatabase::awaitResult() {
+    if (PQconsumeInput(m_connection) == 0) {
+        co_return fail(PQerrorMessage(m_connection));
+    }
+    while (PQisBusy(m_connection)) {
+        bool ready = co_await m_loop.readable(m_socket);
+        if (!ready) {
+            co_return fail(m_loop.getLastError());
+        }
+        if (PQconsumeInput(m_connection) == 0) {
+            co_return fail(PQerrorMessage(m_connection));
+        }
+    }
+    co_return true;
+}
+
+bool CoroDatabase::fail(const std::string& message) {
+    m_lastError = message;
+    return false;
+}
+
+} // namespace bank
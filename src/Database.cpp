@@ -1,9 +1,57 @@
 #include "Database.hpp"
+#include "Metrics.hpp"
+#include "Trace.hpp"
+#include "PgResultRows.hpp"
+#include "RowReader.hpp"
+#include "SlowQueryLog.hpp"
 #include <iostream>
 #include <cstring>
+#include <cctype>
+#include <cstdlib>
+#include <algorithm>
 
 namespace bank {
 
+namespace {
+
+/**
+ * @brief Reduce a statement to its verb and target table, e.g. "UPDATE accounts"
+ */
+std::string statementTag(std::string_view query) {
+    auto wordAt = [&query](std::size_t pos) {
+        while (pos < query.size() && std::isspace(static_cast<unsigned char>(query[pos]))) {
+            ++pos;
+        }
+        std::size_t end = pos;
+        while (end < query.size() && !std::isspace(static_cast<unsigned char>(query[end])) &&
+               query[end] != '(' && query[end] != ';') {
+            ++end;
+        }
+        return query.substr(pos, end - pos);
+    };
+
+    std::string_view verb = wordAt(0);
+    std::size_t targetPos = std::string_view::npos;
+    if (verb == "SELECT" || verb == "DELETE" || verb == "WITH") {
+        targetPos = query.find(" FROM ");
+        if (targetPos != std::string_view::npos) targetPos += 6;
+    } else if (verb == "INSERT") {
+        targetPos = query.find(" INTO ");
+        if (targetPos != std::string_view::npos) targetPos += 6;
+    } else if (verb == "UPDATE" || verb == "COPY") {
+        targetPos = verb.size();
+    }
+
+    std::string tag(verb);
+    if (targetPos != std::string_view::npos) {
+        tag += ' ';
+        tag += wordAt(targetPos);
+    }
+    return tag;
+}
+
+} // namespace
+
 Database::Database(const std::string& host,
                    const std::string& port,
                    const std::string& dbname,
@@ -15,6 +63,7 @@ Database::Database(const std::string& host,
     , m_user(user)
     , m_password(password)
     , m_connection(nullptr)
+    , m_transactionDepth(0)
 {
 }
 
@@ -53,6 +102,8 @@ void Database::disconnect() {
         PQfinish(m_connection);
         m_connection = nullptr;
     }
+    m_transactionDepth = 0;
+    m_prepared.clear();
 }
 
 bool Database::isConnected() const {
@@ -65,44 +116,62 @@ bool Database::execute(const std::string& query) {
         return false;
     }
 
+    auto start = std::chrono::steady_clock::now();
     PGresult* result = PQexec(m_connection, query.c_str());
     ExecStatusType status = PQresultStatus(result);
 
     if (status != PGRES_COMMAND_OK && status != PGRES_TUPLES_OK) {
         m_lastError = PQerrorMessage(m_connection);
         PQclear(result);
+        recordQuery(query, internTag(query), start, 0, false);
         return false;
     }
 
+    recordQuery(query, internTag(query), start, PQntuples(result), true);
     PQclear(result);
     return true;
 }
 
 bool Database::executeParams(const std::string& query, const std::vector<std::string>& params) {
-    if (!isConnected()) {
-        m_lastError = "Not connected to database";
-        return false;
+    std::vector<const char*> paramValues;
+    paramValues.reserve(params.size());
+    for (const auto& param : params) {
+        paramValues.push_back(param.c_str());
     }
+    return executeValues(query, paramValues.data(), static_cast<int>(params.size()));
+}
 
-    std::vector<const char*> paramValues;
+bool Database::executeParams(const std::string& query, const ArenaParams& params) {
+    std::pmr::vector<const char*> paramValues(params.get_allocator());
     paramValues.reserve(params.size());
     for (const auto& param : params) {
         paramValues.push_back(param.c_str());
     }
+    return executeValues(query, paramValues.data(), static_cast<int>(params.size()));
+}
 
-    PGresult* result = PQexecParams(m_connection, query.c_str(),
-                                     static_cast<int>(params.size()),
-                                     nullptr, paramValues.data(),
-                                     nullptr, nullptr, 0);
+bool Database::executeValues(const std::string& query, const char* const* values, int count) {
+    if (!isConnected()) {
+        m_lastError = "Not connected to database";
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    PGresult* result = PQexecParams(m_connection, query.c_str(), count,
+                                     nullptr, values, nullptr, nullptr, 0);
 
     ExecStatusType status = PQresultStatus(result);
 
     if (status != PGRES_COMMAND_OK && status != PGRES_TUPLES_OK) {
         m_lastError = PQerrorMessage(m_connection);
         PQclear(result);
+        recordQuery(query, internTag(query), start, 0, false, values, count);
         return false;
     }
 
+    char* affected = PQcmdTuples(result);
+    int rows = (affected && *affected) ? std::atoi(affected) : PQntuples(result);
+    recordQuery(query, internTag(query), start, rows, true, values, count);
     PQclear(result);
     return true;
 }
@@ -115,26 +184,19 @@ std::vector<std::vector<std::string>> Database::query(const std::string& querySt
         return results;
     }
 
+    auto start = std::chrono::steady_clock::now();
     PGresult* result = PQexec(m_connection, queryStr.c_str());
     
     if (PQresultStatus(result) != PGRES_TUPLES_OK) {
         m_lastError = PQerrorMessage(m_connection);
         PQclear(result);
+        recordQuery(queryStr, internTag(queryStr), start, 0, false);
         return results;
     }
 
-    int numRows = PQntuples(result);
-    int numCols = PQnfields(result);
-
-    for (int i = 0; i < numRows; ++i) {
-        std::vector<std::string> row;
-        for (int j = 0; j < numCols; ++j) {
-            char* value = PQgetvalue(result, i, j);
-            row.push_back(value ? value : "");
-        }
-        results.push_back(row);
-    }
+    results = readRows(PgResultRows(result));
 
+    recordQuery(queryStr, internTag(queryStr), start, PQntuples(result), true);
     PQclear(result);
     return results;
 }
@@ -145,58 +207,310 @@ std::vector<std::vector<std::string>> Database::queryParams(
 {
     std::vector<std::vector<std::string>> results;
 
-    if (!isConnected()) {
-        m_lastError = "Not connected to database";
-        return results;
+    std::vector<const char*> paramValues;
+    paramValues.reserve(params.size());
+    for (const auto& param : params) {
+        paramValues.push_back(param.c_str());
     }
 
-    std::vector<const char*> paramValues;
+    queryValues(queryStr, paramValues.data(), static_cast<int>(params.size()), [&](PGresult* result) {
+        results = readRows(PgResultRows(result));
+    });
+    return results;
+}
+
+ArenaRows Database::queryParams(const std::string& queryStr, const ArenaParams& params,
+                                std::pmr::memory_resource* arena)
+{
+    ArenaRows results(arena);
+
+    std::pmr::vector<const char*> paramValues(arena);
     paramValues.reserve(params.size());
     for (const auto& param : params) {
         paramValues.push_back(param.c_str());
     }
 
-    PGresult* result = PQexecParams(m_connection, queryStr.c_str(),
-                                     static_cast<int>(params.size()),
-                                     nullptr, paramValues.data(),
-                                     nullptr, nullptr, 0);
+    queryValues(queryStr, paramValues.data(), static_cast<int>(params.size()), [&](PGresult* result) {
+        results = readRows(PgResultRows(result), arena);
+    });
+    return results;
+}
+
+template <typename Read>
+void Database::queryValues(const std::string& queryStr, const char* const* values, int count, 
+                           Read&& read)
+{
+    if (!isConnected()) {
+        m_lastError = "Not connected to database";
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    PGresult* result = PQexecParams(m_connection, queryStr.c_str(), count,
+                                     nullptr, values, nullptr, nullptr, 0);
 
     if (PQresultStatus(result) != PGRES_TUPLES_OK) {
         m_lastError = PQerrorMessage(m_connection);
         PQclear(result);
-        return results;
+        recordQuery(queryStr, internTag(queryStr), start, 0, false, values, count);
+        return;
     }
 
-    int numRows = PQntuples(result);
-    int numCols = PQnfields(result);
+    read(result);
 
-    for (int i = 0; i < numRows; ++i) {
-        std::vector<std::string> row;
-        for (int j = 0; j < numCols; ++j) {
-            char* value = PQgetvalue(result, i, j);
-            row.push_back(value ? value : "");
+    recordQuery(queryStr, internTag(queryStr), start, PQntuples(result), true, values, count);
+    PQclear(result);
+}
+
+bool Database::executePrepared(const char* name, const char* query, const char* const* values, int count,
+                               const std::function<void(const PGresult*)>& read)
+{
+    if (!isConnected()) {
+        m_lastError = "Not connected to database";
+        return false;
+    }
+    auto prepared = m_prepared.find(name);
+    if (prepared == m_prepared.end()) {
+        if (!prepare(name, query, count)) {
+            return false;
         }
-        results.push_back(row);
+        prepared = m_prepared.find(name);
     }
+    const std::string& tag = *prepared->second;
 
+    auto start = std::chrono::steady_clock::now();
+    PGresult* result = PQexecPrepared(m_connection, name, count, values, nullptr, nullptr, 0);
+    ExecStatusType status = PQresultStatus(result);
+
+    if (status != PGRES_COMMAND_OK && status != PGRES_TUPLES_OK) {
+        m_lastError = PQerrorMessage(m_connection);
+        PQclear(result);
+        recordQuery(query, tag, start, 0, false, values, count);
+        return false;
+    }
+
+    if (read) {
+        read(result);
+    }
+    char* affected = PQcmdTuples(result);
+    int rows = (affected && *affected) ? std::atoi(affected) : PQntuples(result);
+    recordQuery(query, tag, start, rows, true, values, count);
     PQclear(result);
+    return true;
+}
+
+bool Database::prepare(const char* name, const char* query, int count) {
+    PGresult* result = PQprepare(m_connection, name, query, count, nullptr);
+    bool ok = PQresultStatus(result) == PGRES_COMMAND_OK;
+    if (ok) {
+        // The tag is worked out once here instead of on every execution
+        m_prepared.emplace(name, &internTag(query));
+    } else {
+        m_lastError = PQerrorMessage(m_connection);
+    }
+    PQclear(result);
+    return ok;
+}
+
+std::vector<std::vector<std::vector<std::string>>> Database::queryPipelined(
+    const std::vector<PipelinedQuery>& queries)
+{
+    std::vector<std::vector<std::vector<std::string>>> results;
+
+    if (!isConnected()) {
+        m_lastError = "Not connected to database";
+        return results;
+    }
+
+#ifdef LIBPQ_HAS_PIPELINING
+    auto start = std::chrono::steady_clock::now();
+
+    if (PQenterPipelineMode(m_connection) != 1) {
+        m_lastError = PQerrorMessage(m_connection);
+        return results;
+    }
+
+    bool ok = true;
+    for (const auto& q : queries) {
+        std::vector<const char*> paramValues;
+        paramValues.reserve(q.params.size());
+        for (const auto& param : q.params) {
+            paramValues.push_back(param.c_str());
+        }
+
+        if (PQsendQueryParams(m_connection, q.query.c_str(),
+                              static_cast<int>(q.params.size()),
+                              nullptr, paramValues.data(),
+                              nullptr, nullptr, 0) != 1) {
+            m_lastError = PQerrorMessage(m_connection);
+            ok = false;
+            break;
+        }
+    }
+
+    if (PQpipelineSync(m_connection) != 1) {
+        m_lastError = PQerrorMessage(m_connection);
+        ok = false;
+    }
+
+    // Drain every result up to and including the sync point, even after a
+    // failure, so the connection is usable again
+    int totalRows = 0;
+    while (PGresult* result = PQgetResult(m_connection)) {
+        ExecStatusType status = PQresultStatus(result);
+        if (status == PGRES_PIPELINE_SYNC) {
+            PQclear(result);
+            break;
+        }
+        if (status == PGRES_TUPLES_OK || status == PGRES_COMMAND_OK) {
+            totalRows += PQntuples(result);
+            results.push_back(readRows(PgResultRows(result)));
+        } else {
+            if (ok) {
+                m_lastError = PQresultErrorMessage(result);
+            }
+            ok = false;
+        }
+        PQclear(result);
+
+        // Each statement's results are terminated by a null result
+        while (PGresult* extra = PQgetResult(m_connection)) {
+            PQclear(extra);
+        }
+    }
+
+    PQexitPipelineMode(m_connection);
+    std::string label = "PIPELINE " + std::to_string(queries.size());
+    recordQuery(label, internTag(label), start, totalRows, ok);
+
+    if (!ok || results.size() != queries.size()) {
+        results.clear();
+    }
+#else
+    for (const auto& q : queries) {
+        m_lastError.clear();
+        auto rows = queryParams(q.query, q.params);
+        if (rows.empty() && !m_lastError.empty()) {
+            results.clear();
+            return results;
+        }
+        results.push_back(std::move(rows));
+    }
+#endif
+
     return results;
 }
 
+bool Database::copyIn(const std::string& table, const std::string& columns, const std::string& data) {
+    if (!isConnected()) {
+        m_lastError = "Not connected to database";
+        return false;
+    }
+
+    std::string statement = "COPY " + table + " (" + columns + ") FROM STDIN";
+    auto start = std::chrono::steady_clock::now();
+    PGresult* result = PQexec(m_connection, statement.c_str());
+    if (PQresultStatus(result) != PGRES_COPY_IN) {
+        m_lastError = PQerrorMessage(m_connection);
+        PQclear(result);
+        recordQuery(statement, internTag(statement), start, 0, false);
+        return false;
+    }
+    PQclear(result);
+
+    // Send in bounded chunks so libpq never has to buffer the whole load
+    constexpr std::size_t kChunk = 1 << 20;
+    bool sent = true;
+    for (std::size_t offset = 0; offset < data.size() && sent; offset += kChunk) {
+        int length = static_cast<int>(std::min(kChunk, data.size() - offset));
+        sent = PQputCopyData(m_connection, data.data() + offset, length) == 1;
+    }
+    PQputCopyEnd(m_connection, sent ? nullptr : "client failed to send data");
+
+    bool ok = true;
+    int rows = 0;
+    while (PGresult* end = PQgetResult(m_connection)) {
+        if (PQresultStatus(end) != PGRES_COMMAND_OK) {
+            m_lastError = PQresultErrorMessage(end);
+            ok = false;
+        } else {
+            char* affected = PQcmdTuples(end);
+            rows = (affected && *affected) ? std::atoi(affected) : 0;
+        }
+        PQclear(end);
+    }
+
+    recordQuery(statement, internTag(statement), start, rows, ok && sent);
+    return ok && sent;
+}
+
 std::string Database::getLastError() const {
     return m_lastError;
 }
 
 bool Database::beginTransaction() {
-    return execute("BEGIN");
+    bool ok = m_transactionDepth == 0 
+        ? execute("BEGIN")
+        : execute("SAVEPOINT sp_" + std::to_string(m_transactionDepth));
+    if (ok) {
+        ++m_transactionDepth;
+    }
+    return ok;
 }
 
 bool Database::commitTransaction() {
-    return execute("COMMIT");
+    if (m_transactionDepth <= 1) {
+        m_transactionDepth = 0;
+        return execute("COMMIT");
+    }
+    --m_transactionDepth;
+    return execute("RELEASE SAVEPOINT sp_" + std::to_string(m_transactionDepth));
 }
 
 bool Database::rollbackTransaction() {
-    return execute("ROLLBACK");
+    if (m_transactionDepth <= 1) {
+        m_transactionDepth = 0;
+        return execute("ROLLBACK");
+    }
+    --m_transactionDepth;
+    std::string savepoint = "sp_" + std::to_string(m_transactionDepth);
+    return execute("ROLLBACK TO SAVEPOINT " + savepoint) && 
+           execute("RELEASE SAVEPOINT " + savepoint);
+}
+
+const std::string& Database::internTag(std::string_view query) {
+    return *m_tags.insert(statementTag(query)).first;
+}
+
+void Database::recordQuery(std::string_view query, const std::string& tag,
+                           std::chrono::steady_clock::time_point start,
+                           int rows, bool ok, const char* const* values, int count) 
+{
+    auto end = std::chrono::steady_clock::now();
+    auto elapsed = end - start;
+    double millis = std::chrono::duration<double, std::milli>(elapsed).count();
+
+    m_queryStats.statements++;
+    m_queryStats.rows += static_cast<std::uint64_t>(rows);
+    m_queryStats.millis += millis;
+
+    if (m_slowQueries && millis >= m_slowQueries->getThresholdMillis()) {
+        m_slowQueries->report(query, values, count, rows, millis, ok);
+    }
+
+    if (trace::isEnabled()) {
+        trace::record("db", "sql", tag, trace::toNanos(start), trace::toNanos(end));
+    }
+    if (m_metrics) {
+        auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        m_metrics->statement(tag).record(static_cast<std::uint64_t>(nanos),
+                                         static_cast<std::uint64_t>(rows), ok);
+    }
+
+    if (m_recentQueries.size() >= kRecentQueryLimit) {
+        m_recentQueries.pop_front();
+    }
+    m_recentQueries.push_back({tag, millis, rows, ok});
 }
 
 } // namespace bank
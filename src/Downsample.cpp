@@ -0,0 +1,69 @@
+#include "Downsample.hpp"
+#include <cmath>
+
+namespace bank {
+
+std::vector<BalancePoint> downsampleLTTB(const std::vector<BalancePoint>& points,
+                                         std::size_t threshold)
+{
+    if (threshold >= points.size() || threshold < 3) {
+        return points;
+    }
+
+    std::vector<BalancePoint> sampled;
+    sampled.reserve(threshold);
+
+    // Every bucket except the first and last point holds this many samples
+    double bucketSize = static_cast<double>(points.size() - 2) / 
+                        static_cast<double>(threshold - 2);
+
+    std::size_t selected = 0;
+    sampled.push_back(points[0]);
+
+    for (std::size_t bucket = 0; bucket < threshold - 2; ++bucket) {
+        // Average of the next bucket acts as the third triangle vertex
+        std::size_t nextStart = static_cast<std::size_t>((bucket + 1) * bucketSize) + 1;
+        std::size_t nextEnd = static_cast<std::size_t>((bucket + 2) * bucketSize) + 1;
+        if (nextEnd > points.size()) {
+            nextEnd = points.size();
+        }
+
+        double avgTime = 0.0;
+        double avgBalance = 0.0;
+        for (std::size_t i = nextStart; i < nextEnd; ++i) {
+            avgTime += points[i].timestamp;
+            avgBalance += points[i].balance;
+        }
+        double nextCount = static_cast<double>(nextEnd - nextStart);
+        if (nextCount > 0) {
+            avgTime /= nextCount;
+            avgBalance /= nextCount;
+        }
+
+        // Pick the point in the current bucket with the largest triangle area
+        std::size_t start = static_cast<std::size_t>(bucket * bucketSize) + 1;
+        std::size_t end = nextStart;
+
+        const BalancePoint& anchor = points[selected];
+        double maxArea = -1.0;
+        std::size_t maxIndex = start;
+
+        for (std::size_t i = start; i < end; ++i) {
+            double area = std::fabs(
+                (anchor.timestamp - avgTime) * (points[i].balance - anchor.balance) -
+                (anchor.timestamp - points[i].timestamp) * (avgBalance - anchor.balance));
+            if (area > maxArea) {
+                maxArea = area;
+                maxIndex = i;
+            }
+        }
+
+        sampled.push_back(points[maxIndex]);
+        selected = maxIndex;
+    }
+
+    sampled.push_back(points.back());
+    return sampled;
+}
+
+} // namespace bank
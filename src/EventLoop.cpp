@@ -0,0 +1,140 @@
+#include "EventLoop.hpp"
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+namespace bank {
+
+namespace {
+
+/**
+ * @brief Coroutine that runs a spawned task and frees itself when done
+ */
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() const noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+};
+
+Detached runDetached(Task<void> task, std::size_t& running) {
+    co_await std::move(task);
+    --running;
+}
+
+} // namespace
+
+EventLoop::EventLoop()
+    : m_epoll(epoll_create1(EPOLL_CLOEXEC))
+    , m_waiting(0)
+    , m_running(0)
+{
+    if (m_epoll < 0) {
+        m_lastError = std::string("epoll_create1: ") + std::strerror(errno);
+    }
+}
+
+EventLoop::~EventLoop() {
+    if (m_epoll >= 0) {
+        ::close(m_epoll);
+    }
+}
+
+void EventLoop::spawn(Task<void> task) {
+    ++m_running;
+    runDetached(std::move(task), m_running);
+}
+
+bool EventLoop::run() {
+    constexpr int kMaxEvents = 64;
+    epoll_event events[kMaxEvents];
+
+    while (m_running > 0) {
+        while (!m_ready.empty()) {
+            auto handle = m_ready.front();
+            m_ready.pop_front();
+            handle.resume();
+        }
+        if (m_running == 0) {
+            break;
+        }
+        if (m_waiting == 0) {
+            m_lastError = "Tasks are suspended with nothing to wait for";
+            return false;
+        }
+
+        int count = epoll_wait(m_epoll, events, kMaxEvents, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            m_lastError = std::string("epoll_wait: ") + std::strerror(errno);
+            return false;
+        }
+
+        // Queue first, resume after: a resumed coroutine may watch other sockets
+        for (int i = 0; i < count; ++i) {
+            auto it = m_waiters.find(events[i].data.fd);
+            if (it == m_waiters.end()) {
+                continue;
+            }
+            m_ready.push_back(it->second);
+            m_waiters.erase(it);
+            --m_waiting;
+        }
+    }
+    return true;
+}
+
+EventLoop::ReadinessAwaiter EventLoop::readable(int fd) {
+    return ReadinessAwaiter(*this, fd, EPOLLIN);
+}
+
+EventLoop::ReadinessAwaiter EventLoop::writable(int fd) {
+    return ReadinessAwaiter(*this, fd, EPOLLOUT);
+}
+
+EventLoop::ReadinessAwaiter EventLoop::readableOrWritable(int fd) {
+    return ReadinessAwaiter(*this, fd, EPOLLIN | EPOLLOUT);
+}
+
+bool EventLoop::ReadinessAwaiter::await_suspend(std::coroutine_handle<> handle) {
+    m_ok = m_loop.watch(m_fd, m_events, handle);
+    return m_ok;    // Not suspended if the socket cannot be watched
+}
+
+void EventLoop::post(std::coroutine_handle<> handle) {
+    m_ready.push_back(handle);
+}
+
+void EventLoop::forget(int fd) {
+    epoll_ctl(m_epoll, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+bool EventLoop::watch(int fd, std::uint32_t events, std::coroutine_handle<> handle) {
+    if (fd < 0 || m_waiters.count(fd) > 0) {
+        m_lastError = "Socket " + std::to_string(fd) + " is invalid or already watched";
+        return false;
+    }
+
+    // One-shot: a socket stays registered but disarmed between waits
+    epoll_event event{};
+    event.events = events | EPOLLONESHOT;
+    event.data.fd = fd;
+    if (epoll_ctl(m_epoll, EPOLL_CTL_MOD, fd, &event) != 0 &&
+        (errno != ENOENT || epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &event) != 0)) {
+        m_lastError = std::string("epoll_ctl: ") + std::strerror(errno);
+        return false;
+    }
+
+    m_waiters.emplace(fd, handle);
+    ++m_waiting;
+    return true;
+}
+
+} // namespace bank
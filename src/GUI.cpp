@@ -1,7 +1,11 @@
 #include "GUI.hpp"
+#include "Downsample.hpp"
+#include "Trace.hpp"
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
+#include <chrono>
+#include <cstdlib>
 
 namespace bank {
 
@@ -28,14 +32,14 @@ Button::Button(float x, float y, float width, float height,
     m_text.setPosition(x + width / 2.0f, y + height / 2.0f);
 }
 
-void Button::render(sf::RenderWindow& window) {
+void Button::render(sf::RenderTarget& target) {
     if (m_enabled) {
         m_shape.setFillColor(sf::Color(70, 130, 180));
     } else {
         m_shape.setFillColor(sf::Color(100, 100, 100));
     }
-    window.draw(m_shape);
-    window.draw(m_text);
+    target.draw(m_shape);
+    target.draw(m_text);
 }
 
 bool Button::isClicked(const sf::Vector2i& mousePos) {
@@ -70,17 +74,17 @@ TextInput::TextInput(float x, float y, float width, float height,
     m_placeholderText.setPosition(x + 10, y + (height - 20) / 2);
 }
 
-void TextInput::render(sf::RenderWindow& window) {
+void TextInput::render(sf::RenderTarget& target) {
     if (m_focused) {
         m_shape.setOutlineColor(sf::Color(70, 130, 180));
     } else {
         m_shape.setOutlineColor(sf::Color(100, 100, 100));
     }
     
-    window.draw(m_shape);
+    target.draw(m_shape);
     
     if (m_text.empty()) {
-        window.draw(m_placeholderText);
+        target.draw(m_placeholderText);
     } else {
         std::string displayStr = m_isPassword ? std::string(m_text.length(), '*') : m_text;
         
@@ -93,7 +97,7 @@ void TextInput::render(sf::RenderWindow& window) {
         }
         
         m_displayText.setString(displayStr);
-        window.draw(m_displayText);
+        target.draw(m_displayText);
     }
 }
 
@@ -116,18 +120,227 @@ bool TextInput::contains(const sf::Vector2i& mousePos) const {
                                                static_cast<float>(mousePos.y));
 }
 
+// BalanceChart implementation
+BalanceChart::BalanceChart(float x, float y, float width, float height)
+    : m_bounds(x, y, width, height)
+    , m_vertices(sf::Lines)
+    , m_generation(0)
+    , m_accountId(-1)
+    , m_stopping(false)
+    , m_worker(&BalanceChart::work, this)
+{
+    rebuildVertices({});
+}
+
+BalanceChart::~BalanceChart() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_one();
+    m_worker.join();
+}
+
+void BalanceChart::setSeries(int accountId, std::vector<BalancePoint> points) {
+    load(accountId, [points = std::move(points)]() mutable { return std::move(points); });
+}
+
+void BalanceChart::load(int accountId, Fetch fetch) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_accountId = accountId;
+        // A load the worker has not started yet is superseded, not queued
+        m_request = Request{accountId, ++m_generation, std::move(fetch)};
+    }
+    m_wake.notify_one();
+}
+
+void BalanceChart::clear() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_accountId = -1;
+        ++m_generation;
+        m_request.reset();
+        m_result.reset();
+    }
+    rebuildVertices({});
+}
+
+void BalanceChart::render(sf::RenderTarget& target) {
+    std::optional<Result> result;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_result && m_result->generation == m_generation && m_result->accountId == m_accountId) {
+            result = std::move(m_result);
+        }
+        m_result.reset();
+    }
+    if (result) {
+        rebuildVertices(result->points);
+    }
+    target.draw(m_vertices);
+}
+
+void BalanceChart::work() {
+    // One sample per horizontal pixel is all the chart can show
+    std::size_t threshold = static_cast<std::size_t>(m_bounds.width);
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_wake.wait(lock, [this]() { return m_stopping || m_request; });
+        if (m_stopping) {
+            return;
+        }
+        Request request = std::move(*m_request);
+        m_request.reset();
+        
+        lock.unlock();
+        std::vector<BalancePoint> points = downsampleLTTB(request.fetch(), threshold);
+        lock.lock();
+        
+        // Stale results are dropped here and again in render
+        if (request.generation == m_generation) {
+            m_result = Result{request.accountId, request.generation, std::move(points)};
+        }
+    }
+}
+
+void BalanceChart::rebuildVertices(const std::vector<BalancePoint>& points) {
+    const sf::Color frameColor(60, 60, 70);
+    const sf::Color lineColor(70, 180, 110);
+    
+    float left = m_bounds.left;
+    float top = m_bounds.top;
+    float right = m_bounds.left + m_bounds.width;
+    float bottom = m_bounds.top + m_bounds.height;
+    
+    m_vertices.clear();
+    
+    // Frame
+    m_vertices.append(sf::Vertex({left, top}, frameColor));
+    m_vertices.append(sf::Vertex({right, top}, frameColor));
+    m_vertices.append(sf::Vertex({right, top}, frameColor));
+    m_vertices.append(sf::Vertex({right, bottom}, frameColor));
+    m_vertices.append(sf::Vertex({right, bottom}, frameColor));
+    m_vertices.append(sf::Vertex({left, bottom}, frameColor));
+    m_vertices.append(sf::Vertex({left, bottom}, frameColor));
+    m_vertices.append(sf::Vertex({left, top}, frameColor));
+    
+    if (points.empty()) {
+        return;
+    }
+    
+    auto [minIt, maxIt] = std::minmax_element(points.begin(), points.end(),
+        [](const BalancePoint& a, const BalancePoint& b) { return a.balance < b.balance; });
+    double minTime = points.front().timestamp;
+    double timeRange = points.back().timestamp - minTime;
+    double minBalance = minIt->balance;
+    double balanceRange = maxIt->balance - minBalance;
+    
+    // Leave a small margin so the line does not sit on the frame
+    float padding = 6.f;
+    float plotWidth = m_bounds.width - 2 * padding;
+    float plotHeight = m_bounds.height - 2 * padding;
+    
+    auto toScreen = [&](const BalancePoint& p) {
+        double fx = timeRange > 0 ? (p.timestamp - minTime) / timeRange : 0.5;
+        double fy = balanceRange > 0 ? (p.balance - minBalance) / balanceRange : 0.5;
+        return sf::Vector2f(left + padding + static_cast<float>(fx) * plotWidth,
+                            bottom - padding - static_cast<float>(fy) * plotHeight);
+    };
+    
+    if (points.size() == 1) {
+        sf::Vector2f p = toScreen(points[0]);
+        m_vertices.append(sf::Vertex({left + padding, p.y}, lineColor));
+        m_vertices.append(sf::Vertex({right - padding, p.y}, lineColor));
+        return;
+    }
+    
+    for (std::size_t i = 1; i < points.size(); ++i) {
+        m_vertices.append(sf::Vertex(toScreen(points[i - 1]), lineColor));
+        m_vertices.append(sf::Vertex(toScreen(points[i]), lineColor));
+    }
+}
+
+const char* appStateName(AppState state) {
+    switch (state) {
+        case AppState::Login: return "Login";
+        case AppState::Register: return "Register";
+        case AppState::Dashboard: return "Dashboard";
+        case AppState::CreateAccount: return "CreateAccount";
+        case AppState::Deposit: return "Deposit";
+        case AppState::Withdraw: return "Withdraw";
+        case AppState::Transfer: return "Transfer";
+        case AppState::TransactionHistory: return "TransactionHistory";
+        case AppState::Settings: return "Settings";
+        default: return "Unknown";
+    }
+}
+
 // BankGUI implementation
-BankGUI::BankGUI(std::shared_ptr<BankService> service)
-    : m_window(sf::VideoMode(800, 600), "Bank Management System")
+BankGUI::BankGUI(std::shared_ptr<BankApi> service, bool headless)
+    : m_target(nullptr)
+    , m_headless(headless)
+    , m_windowMillis(0.0)
+    , m_fontMillis(0.0)
     , m_service(service)
     , m_currentState(AppState::Login)
+    , m_totalBalance(0.0)
     , m_selectedAccountIndex(-1)
     , m_statusColor(sf::Color::White)
+    , m_transactionsAccountId(-1)
+    , m_balanceChart(400, 330, 350, 180)
+    , m_chartAccountId(-1)
+    , m_showPerfHud(false)
+    , m_frameTimes(240)
+    , m_drawCalls(0)
+    , m_lastFrameDrawCalls(0)
+    , m_frameNumber(0)
     , m_focusedInput(nullptr)
 {
-    // Load font - try common system font paths
-    // For better portability, consider bundling a font in the assets/ directory
-    // or using environment variables to configure font paths
+    auto windowStart = std::chrono::steady_clock::now();
+    if (m_headless) {
+        if (!m_offscreen.create(800, 600)) {
+            throw std::runtime_error("Failed to create off-screen render texture.");
+        }
+        m_target = &m_offscreen;
+    } else {
+        m_window.create(sf::VideoMode(800, 600), "Bank Management System");
+        m_window.setFramerateLimit(60);
+        m_target = &m_window;
+    }
+    m_windowMillis = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - windowStart).count();
+
+    auto fontStart = std::chrono::steady_clock::now();
+    loadFont();
+    m_fontMillis = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - fontStart).count();
+    
+    // Input fields are created lazily by input() when a screen first uses them
+}
+
+void BankGUI::loadFont() {
+    // Prefer the bundled font: mapping it avoids probing system directories
+    // and copying the file into memory before FreeType reads it
+    std::vector<std::string> assetDirs;
+    if (const char* envDir = std::getenv("BANK_ASSETS_DIR")) {
+        assetDirs.push_back(envDir);
+    }
+#ifdef BANK_ASSETS_DIR
+    assetDirs.push_back(BANK_ASSETS_DIR);
+#endif
+    assetDirs.push_back("assets");
+    assetDirs.push_back("../assets");
+    
+    for (const auto& dir : assetDirs) {
+        if (m_fontFile.open(dir + "/fonts/DejaVuSans.ttf") &&
+            m_font.loadFromMemory(m_fontFile.data(), m_fontFile.size())) {
+            return;
+        }
+    }
+    m_fontFile.close();
+    
+    // Fall back to common system font paths
     std::vector<std::string> fontPaths = {
         "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",          // Debian/Ubuntu
         "/usr/share/fonts/truetype/liberation/LiberationSans-Regular.ttf",
@@ -138,124 +351,208 @@ BankGUI::BankGUI(std::shared_ptr<BankService> service)
         "C:\\Windows\\Fonts\\arial.ttf"                               // Windows
     };
     
-    bool fontLoaded = false;
     for (const auto& path : fontPaths) {
         if (m_font.loadFromFile(path)) {
-            fontLoaded = true;
-            break;
+            return;
         }
     }
     
-    if (!fontLoaded) {
-        throw std::runtime_error("Failed to load font. Please install DejaVu or Liberation fonts.");
-    }
+    throw std::runtime_error("Failed to load font. Please install DejaVu or Liberation fonts.");
+}
 
-    m_window.setFramerateLimit(60);
-    
-    // Initialize input fields
-    float centerX = 300;
-    float inputWidth = 200;
-    float inputHeight = 35;
+TextInput& BankGUI::input(InputField field) {
+    struct FieldSpec {
+        float y;
+        const char* placeholder;
+        bool isPassword;
+    };
+    static const FieldSpec specs[] = {
+        {200, "Username", false},
+        {250, "Password", true},
+        {300, "Confirm Password", true},
+        {350, "Full Name", false},
+        {400, "Email", false},
+        {450, "Phone", false},
+        {250, "Amount", false},
+        {300, "Target Account #", false},
+        {350, "Description", false}
+    };
     
-    m_usernameInput = std::make_unique<TextInput>(centerX, 200, inputWidth, inputHeight, 
-                                                   "Username", m_font);
-    m_passwordInput = std::make_unique<TextInput>(centerX, 250, inputWidth, inputHeight, 
-                                                   "Password", m_font, true);
-    m_confirmPasswordInput = std::make_unique<TextInput>(centerX, 300, inputWidth, inputHeight, 
-                                                          "Confirm Password", m_font, true);
-    m_fullNameInput = std::make_unique<TextInput>(centerX, 350, inputWidth, inputHeight, 
-                                                   "Full Name", m_font);
-    m_emailInput = std::make_unique<TextInput>(centerX, 400, inputWidth, inputHeight, 
-                                                "Email", m_font);
-    m_phoneInput = std::make_unique<TextInput>(centerX, 450, inputWidth, inputHeight, 
-                                                "Phone", m_font);
-    m_amountInput = std::make_unique<TextInput>(centerX, 250, inputWidth, inputHeight, 
-                                                 "Amount", m_font);
-    m_targetAccountInput = std::make_unique<TextInput>(centerX, 300, inputWidth, inputHeight, 
-                                                        "Target Account #", m_font);
-    m_descriptionInput = std::make_unique<TextInput>(centerX, 350, inputWidth, inputHeight, 
-                                                      "Description", m_font);
+    auto& slot = m_inputs[static_cast<size_t>(field)];
+    if (!slot) {
+        const FieldSpec& spec = specs[static_cast<size_t>(field)];
+        slot = std::make_unique<TextInput>(300, spec.y, 200, 35, spec.placeholder, 
+                                           m_font, spec.isPassword);
+    }
+    return *slot;
 }
 
 void BankGUI::run() {
     while (m_window.isOpen()) {
+        m_frameClock.restart();
         handleEvents();
         render();
+        ++m_frameNumber;
     }
+    m_recorder.finish(m_frameNumber);
+}
+
+bool BankGUI::startRecording(const std::string& path) {
+    return m_recorder.open(path);
+}
+
+std::vector<ScreenFrameStats> BankGUI::replay(const InputSession& session) {
+    std::vector<std::pair<AppState, SampleWindow>> screens;
+    size_t nextEvent = 0;
+    
+    for (std::uint64_t frame = 0; frame < session.frameCount; ++frame) {
+        m_frameClock.restart();
+        
+        bool closed = false;
+        while (nextEvent < session.events.size() && 
+               session.events[nextEvent].frame <= frame) {
+            const sf::Event& event = session.events[nextEvent++].event;
+            if (event.type == sf::Event::Closed) {
+                closed = true;
+                break;
+            }
+            processEvent(event);
+        }
+        if (closed) {
+            break;
+        }
+        
+        AppState screen = m_currentState;
+        render();
+        double millis = m_frameClock.getElapsedTime().asMicroseconds() / 1000.0;
+        
+        auto it = std::find_if(screens.begin(), screens.end(),
+                               [screen](const auto& entry) { return entry.first == screen; });
+        if (it == screens.end()) {
+            screens.emplace_back(screen, SampleWindow(static_cast<size_t>(session.frameCount)));
+            it = screens.end() - 1;
+        }
+        it->second.add(millis);
+    }
+    
+    std::vector<ScreenFrameStats> report;
+    for (const auto& [screen, samples] : screens) {
+        report.push_back({screen, samples.size(), samples.percentile(50),
+                          samples.percentile(95), samples.percentile(99), samples.max()});
+    }
+    return report;
 }
 
 void BankGUI::handleEvents() {
+    trace::Span span("gui", "handleEvents");
     sf::Event event;
     while (m_window.pollEvent(event)) {
+        m_recorder.record(event, m_frameNumber);
+        
         if (event.type == sf::Event::Closed) {
             m_window.close();
             return;
         }
+        
+        processEvent(event);
+    }
+}
 
-        // Handle mouse clicks for focus
-        if (event.type == sf::Event::MouseButtonPressed) {
-            sf::Vector2i mousePos = sf::Vector2i(event.mouseButton.x, event.mouseButton.y);
-            
-            // Unfocus all inputs first
-            if (m_focusedInput) {
-                m_focusedInput->setFocused(false);
-                m_focusedInput = nullptr;
-            }
-            
-            // Check which input was clicked
-            std::vector<TextInput*> inputs = {
-                m_usernameInput.get(), m_passwordInput.get(), 
-                m_confirmPasswordInput.get(), m_fullNameInput.get(),
-                m_emailInput.get(), m_phoneInput.get(),
-                m_amountInput.get(), m_targetAccountInput.get(),
-                m_descriptionInput.get()
-            };
-            
-            for (auto* input : inputs) {
-                if (input && input->contains(mousePos)) {
-                    input->setFocused(true);
-                    m_focusedInput = input;
-                    break;
-                }
-            }
+void BankGUI::processEvent(const sf::Event& event) {
+    if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F3) {
+        m_showPerfHud = !m_showPerfHud;
+        return;
+    }
+    if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F4) {
+        if (m_tracePath.empty()) {
+            showStatus("Start with --trace <file> to record a trace", true);
+        } else if (trace::writeChromeTrace(m_tracePath)) {
+            showStatus("Trace written to " + m_tracePath);
+        } else {
+            showStatus("Could not write " + m_tracePath, true);
         }
+        return;
+    }
 
-        // Handle text input
-        if (event.type == sf::Event::TextEntered) {
-            if (m_focusedInput) {
-                m_focusedInput->handleEvent(event);
-            }
+    // Handle mouse clicks for focus
+    if (event.type == sf::Event::MouseButtonPressed) {
+        sf::Vector2i mousePos = sf::Vector2i(event.mouseButton.x, event.mouseButton.y);
+        
+        // Unfocus all inputs first
+        if (m_focusedInput) {
+            m_focusedInput->setFocused(false);
+            m_focusedInput = nullptr;
         }
-
-        // Handle screen-specific events
+        
+        // Check which input of the current screen was clicked; fields of
+        // other screens may overlap and must not take focus
+        std::vector<InputField> fields;
         switch (m_currentState) {
             case AppState::Login:
-                handleLoginEvents(event);
+                fields = {InputField::Username, InputField::Password};
                 break;
             case AppState::Register:
-                handleRegisterEvents(event);
-                break;
-            case AppState::Dashboard:
-                handleDashboardEvents(event);
-                break;
-            case AppState::CreateAccount:
-                handleCreateAccountEvents(event);
+                fields = {InputField::Username, InputField::Password, 
+                          InputField::ConfirmPassword, InputField::FullName,
+                          InputField::Email, InputField::Phone};
                 break;
             case AppState::Deposit:
-                handleDepositEvents(event);
-                break;
             case AppState::Withdraw:
-                handleWithdrawEvents(event);
+                fields = {InputField::Amount};
                 break;
             case AppState::Transfer:
-                handleTransferEvents(event);
-                break;
-            case AppState::TransactionHistory:
-                handleTransactionHistoryEvents(event);
+                fields = {InputField::Amount, InputField::TargetAccount, 
+                          InputField::Description};
                 break;
             default:
                 break;
         }
+        
+        for (InputField field : fields) {
+            TextInput& candidate = input(field);
+            if (candidate.contains(mousePos)) {
+                candidate.setFocused(true);
+                m_focusedInput = &candidate;
+                break;
+            }
+        }
+    }
+
+    // Handle text input
+    if (event.type == sf::Event::TextEntered) {
+        if (m_focusedInput) {
+            m_focusedInput->handleEvent(event);
+        }
+    }
+
+    // Handle screen-specific events
+    switch (m_currentState) {
+        case AppState::Login:
+            handleLoginEvents(event);
+            break;
+        case AppState::Register:
+            handleRegisterEvents(event);
+            break;
+        case AppState::Dashboard:
+            handleDashboardEvents(event);
+            break;
+        case AppState::CreateAccount:
+            handleCreateAccountEvents(event);
+            break;
+        case AppState::Deposit:
+            handleDepositEvents(event);
+            break;
+        case AppState::Withdraw:
+            handleWithdrawEvents(event);
+            break;
+        case AppState::Transfer:
+            handleTransferEvents(event);
+            break;
+        case AppState::TransactionHistory:
+            handleTransactionHistoryEvents(event);
+            break;
+        default:
+            break;
     }
 }
 
@@ -266,14 +563,14 @@ void BankGUI::handleLoginEvents(const sf::Event& event) {
         // Login button
         Button loginBtn(300, 310, 200, 40, "Login", m_font);
         if (loginBtn.isClicked(mousePos)) {
-            auto user = m_service->authenticateUser(m_usernameInput->getText(), 
-                                                     m_passwordInput->getText());
-            if (user.has_value()) {
-                m_currentUser = user;
-                refreshAccounts();
+            auto dashboard = m_service->login(input(InputField::Username).getText(),
+                                              input(InputField::Password).getText());
+            if (dashboard.has_value()) {
+                std::string fullName = dashboard->user.getFullName();
+                applyDashboard(std::move(*dashboard));
                 m_currentState = AppState::Dashboard;
                 clearInputs();
-                showStatus("Welcome, " + user->getFullName() + "!");
+                showStatus("Welcome, " + fullName + "!");
             } else {
                 showStatus("Invalid username or password", true);
             }
@@ -295,23 +592,23 @@ void BankGUI::handleRegisterEvents(const sf::Event& event) {
         // Register button
         Button registerBtn(300, 510, 200, 40, "Register", m_font);
         if (registerBtn.isClicked(mousePos)) {
-            if (m_passwordInput->getText() != m_confirmPasswordInput->getText()) {
+            if (input(InputField::Password).getText() != input(InputField::ConfirmPassword).getText()) {
                 showStatus("Passwords do not match", true);
                 return;
             }
             
-            if (m_usernameInput->getText().empty() || m_passwordInput->getText().empty() ||
-                m_fullNameInput->getText().empty() || m_emailInput->getText().empty()) {
+            if (input(InputField::Username).getText().empty() || input(InputField::Password).getText().empty() ||
+                input(InputField::FullName).getText().empty() || input(InputField::Email).getText().empty()) {
                 showStatus("Please fill in all required fields", true);
                 return;
             }
             
             auto user = m_service->createUser(
-                m_usernameInput->getText(),
-                m_passwordInput->getText(),
-                m_fullNameInput->getText(),
-                m_emailInput->getText(),
-                m_phoneInput->getText()
+                input(InputField::Username).getText(),
+                input(InputField::Password).getText(),
+                input(InputField::FullName).getText(),
+                input(InputField::Email).getText(),
+                input(InputField::Phone).getText()
             );
             
             if (user.has_value()) {
@@ -344,6 +641,7 @@ void BankGUI::handleDashboardEvents(const sf::Event& event) {
             if (accountBox.contains({static_cast<float>(mousePos.x), 
                                      static_cast<float>(mousePos.y)})) {
                 m_selectedAccountIndex = static_cast<int>(i);
+                refreshBalanceChart();
             }
         }
         
@@ -370,9 +668,11 @@ void BankGUI::handleDashboardEvents(const sf::Event& event) {
         
         Button historyBtn(560, 250, 150, 40, "History", m_font);
         if (historyBtn.isClicked(mousePos) && m_selectedAccountIndex >= 0) {
-            m_transactions = m_service->getTransactionHistory(
-                m_userAccounts[static_cast<size_t>(m_selectedAccountIndex)].getAccountId()
-            );
+            int accountId = m_userAccounts[static_cast<size_t>(m_selectedAccountIndex)].getAccountId();
+            if (accountId != m_transactionsAccountId) {
+                m_transactions = m_service->getTransactionHistory(accountId);
+                m_transactionsAccountId = accountId;
+            }
             m_currentState = AppState::TransactionHistory;
         }
         
@@ -410,7 +710,7 @@ void BankGUI::handleCreateAccountEvents(const sf::Event& event) {
             auto account = m_service->createAccount(m_currentUser->getUserId(), type, 0);
             if (account.has_value()) {
                 refreshAccounts();
-                showStatus("Account created: " + account->getAccountNumber());
+                showStatus("Account created: " + std::string(account->getAccountNumber()));
                 m_currentState = AppState::Dashboard;
             } else {
                 showStatus("Failed to create account", true);
@@ -431,10 +731,10 @@ void BankGUI::handleDepositEvents(const sf::Event& event) {
         Button depositBtn(300, 310, 200, 40, "Deposit", m_font);
         if (depositBtn.isClicked(mousePos)) {
             try {
-                double amount = std::stod(m_amountInput->getText());
+                double amount = std::stod(input(InputField::Amount).getText());
                 int accountId = m_userAccounts[static_cast<size_t>(m_selectedAccountIndex)].getAccountId();
                 
-                if (m_service->deposit(accountId, amount, m_descriptionInput->getText())) {
+                if (m_service->deposit(accountId, amount, input(InputField::Description).getText())) {
                     refreshAccounts();
                     showStatus("Deposit successful!");
                     clearInputs();
@@ -462,10 +762,10 @@ void BankGUI::handleWithdrawEvents(const sf::Event& event) {
         Button withdrawBtn(300, 310, 200, 40, "Withdraw", m_font);
         if (withdrawBtn.isClicked(mousePos)) {
             try {
-                double amount = std::stod(m_amountInput->getText());
+                double amount = std::stod(input(InputField::Amount).getText());
                 int accountId = m_userAccounts[static_cast<size_t>(m_selectedAccountIndex)].getAccountId();
                 
-                if (m_service->withdraw(accountId, amount, m_descriptionInput->getText())) {
+                if (m_service->withdraw(accountId, amount, input(InputField::Description).getText())) {
                     refreshAccounts();
                     showStatus("Withdrawal successful!");
                     clearInputs();
@@ -493,17 +793,17 @@ void BankGUI::handleTransferEvents(const sf::Event& event) {
         Button transferBtn(300, 410, 200, 40, "Transfer", m_font);
         if (transferBtn.isClicked(mousePos)) {
             try {
-                double amount = std::stod(m_amountInput->getText());
+                double amount = std::stod(input(InputField::Amount).getText());
                 int fromAccountId = m_userAccounts[static_cast<size_t>(m_selectedAccountIndex)].getAccountId();
                 
-                auto toAccount = m_service->getAccountByNumber(m_targetAccountInput->getText());
+                auto toAccount = m_service->getAccountByNumber(input(InputField::TargetAccount).getText());
                 if (!toAccount.has_value()) {
                     showStatus("Target account not found", true);
                     return;
                 }
                 
                 if (m_service->transfer(fromAccountId, toAccount->getAccountId(), amount, 
-                                         m_descriptionInput->getText())) {
+                                         input(InputField::Description).getText())) {
                     refreshAccounts();
                     showStatus("Transfer successful!");
                     clearInputs();
@@ -536,7 +836,8 @@ void BankGUI::handleTransactionHistoryEvents(const sf::Event& event) {
 }
 
 void BankGUI::render() {
-    m_window.clear(sf::Color(30, 30, 40));
+    trace::Span span("gui", "render", appStateName(m_currentState));
+    m_target->clear(sf::Color(30, 30, 40));
     
     switch (m_currentState) {
         case AppState::Login:
@@ -576,10 +877,24 @@ void BankGUI::render() {
         statusText.setFillColor(m_statusColor);
         sf::FloatRect textBounds = statusText.getLocalBounds();
         statusText.setPosition(400.f - textBounds.width / 2.f, 560.f);
-        m_window.draw(statusText);
+        draw(statusText);
     }
     
-    m_window.display();
+    if (m_showPerfHud) {
+        renderPerfHud();
+    }
+    
+    // Frame time covers event handling and drawing, not the vsync wait in display()
+    m_frameTimes.add(m_frameClock.getElapsedTime().asMicroseconds() / 1000.0);
+    m_lastFrameDrawCalls = m_drawCalls;
+    m_drawCalls = 0;
+    
+    trace::Span present("gui", "display");
+    if (m_headless) {
+        m_offscreen.display();
+    } else {
+        m_window.display();
+    }
 }
 
 void BankGUI::renderLogin() {
@@ -592,25 +907,25 @@ void BankGUI::renderLogin() {
     usernameLabel.setString("Username:");
     usernameLabel.setCharacterSize(16);
     usernameLabel.setPosition(200, 205);
-    m_window.draw(usernameLabel);
+    draw(usernameLabel);
     
     sf::Text passwordLabel;
     passwordLabel.setFont(m_font);
     passwordLabel.setString("Password:");
     passwordLabel.setCharacterSize(16);
     passwordLabel.setPosition(200, 255);
-    m_window.draw(passwordLabel);
+    draw(passwordLabel);
     
     // Input fields
-    m_usernameInput->render(m_window);
-    m_passwordInput->render(m_window);
+    draw(input(InputField::Username));
+    draw(input(InputField::Password));
     
     // Buttons
     Button loginBtn(300, 310, 200, 40, "Login", m_font);
-    loginBtn.render(m_window);
+    draw(loginBtn);
     
     Button registerBtn(300, 360, 200, 40, "Create Account", m_font);
-    registerBtn.render(m_window);
+    draw(registerBtn);
 }
 
 void BankGUI::renderRegister() {
@@ -624,40 +939,40 @@ void BankGUI::renderRegister() {
     
     label.setString("Username:");
     label.setPosition(200, 205);
-    m_window.draw(label);
-    m_usernameInput->render(m_window);
+    draw(label);
+    draw(input(InputField::Username));
     
     label.setString("Password:");
     label.setPosition(200, 255);
-    m_window.draw(label);
-    m_passwordInput->render(m_window);
+    draw(label);
+    draw(input(InputField::Password));
     
     label.setString("Confirm:");
     label.setPosition(200, 305);
-    m_window.draw(label);
-    m_confirmPasswordInput->render(m_window);
+    draw(label);
+    draw(input(InputField::ConfirmPassword));
     
     label.setString("Full Name:");
     label.setPosition(200, 355);
-    m_window.draw(label);
-    m_fullNameInput->render(m_window);
+    draw(label);
+    draw(input(InputField::FullName));
     
     label.setString("Email:");
     label.setPosition(200, 405);
-    m_window.draw(label);
-    m_emailInput->render(m_window);
+    draw(label);
+    draw(input(InputField::Email));
     
     label.setString("Phone:");
     label.setPosition(200, 455);
-    m_window.draw(label);
-    m_phoneInput->render(m_window);
+    draw(label);
+    draw(input(InputField::Phone));
     
     // Buttons
     Button registerBtn(300, 510, 200, 40, "Register", m_font);
-    registerBtn.render(m_window);
+    draw(registerBtn);
     
     Button backBtn(300, 560, 200, 40, "Back to Login", m_font);
-    backBtn.render(m_window);
+    draw(backBtn);
 }
 
 void BankGUI::renderDashboard() {
@@ -669,19 +984,18 @@ void BankGUI::renderDashboard() {
         welcomeText.setString("Welcome, " + m_currentUser->getFullName());
         welcomeText.setCharacterSize(16);
         welcomeText.setPosition(50, 70);
-        m_window.draw(welcomeText);
+        draw(welcomeText);
         
         // Total balance
-        double totalBalance = m_service->getTotalBalance(m_currentUser->getUserId());
         std::stringstream ss;
-        ss << "Total Balance: $" << std::fixed << std::setprecision(2) << totalBalance;
+        ss << "Total Balance: $" << std::fixed << std::setprecision(2) << m_totalBalance;
         sf::Text balanceText;
         balanceText.setFont(m_font);
         balanceText.setString(ss.str());
         balanceText.setCharacterSize(18);
         balanceText.setFillColor(sf::Color::Green);
         balanceText.setPosition(50, 100);
-        m_window.draw(balanceText);
+        draw(balanceText);
     }
     
     // Account list
@@ -690,7 +1004,7 @@ void BankGUI::renderDashboard() {
     accountsLabel.setString("Your Accounts:");
     accountsLabel.setCharacterSize(16);
     accountsLabel.setPosition(50, 130);
-    m_window.draw(accountsLabel);
+    draw(accountsLabel);
     
     float startY = 150;
     for (size_t i = 0; i < m_userAccounts.size() && i < 4; ++i) {
@@ -707,15 +1021,15 @@ void BankGUI::renderDashboard() {
             box.setOutlineColor(sf::Color(60, 60, 70));
         }
         box.setOutlineThickness(2);
-        m_window.draw(box);
+        draw(box);
         
         // Account info
         sf::Text accNum;
         accNum.setFont(m_font);
-        accNum.setString(account.getAccountNumber());
+        accNum.setString(std::string(account.getAccountNumber()));
         accNum.setCharacterSize(14);
         accNum.setPosition(60, startY + i * 80 + 10);
-        m_window.draw(accNum);
+        draw(accNum);
         
         std::string typeStr = Account::typeToString(account.getType());
         typeStr[0] = static_cast<char>(std::toupper(typeStr[0]));
@@ -725,7 +1039,7 @@ void BankGUI::renderDashboard() {
         accType.setCharacterSize(12);
         accType.setFillColor(sf::Color(150, 150, 150));
         accType.setPosition(60, startY + i * 80 + 30);
-        m_window.draw(accType);
+        draw(accType);
         
         std::stringstream ss;
         ss << "$" << std::fixed << std::setprecision(2) << account.getBalance();
@@ -735,31 +1049,43 @@ void BankGUI::renderDashboard() {
         accBalance.setCharacterSize(16);
         accBalance.setFillColor(sf::Color::Green);
         accBalance.setPosition(250, startY + i * 80 + 20);
-        m_window.draw(accBalance);
+        draw(accBalance);
     }
     
     // Action buttons
     Button newAccountBtn(400, 150, 150, 40, "New Account", m_font);
-    newAccountBtn.render(m_window);
+    draw(newAccountBtn);
     
     Button depositBtn(400, 200, 150, 40, "Deposit", m_font);
     depositBtn.setEnabled(m_selectedAccountIndex >= 0);
-    depositBtn.render(m_window);
+    draw(depositBtn);
     
     Button withdrawBtn(560, 200, 150, 40, "Withdraw", m_font);
     withdrawBtn.setEnabled(m_selectedAccountIndex >= 0);
-    withdrawBtn.render(m_window);
+    draw(withdrawBtn);
     
     Button transferBtn(400, 250, 150, 40, "Transfer", m_font);
     transferBtn.setEnabled(m_selectedAccountIndex >= 0);
-    transferBtn.render(m_window);
+    draw(transferBtn);
     
     Button historyBtn(560, 250, 150, 40, "History", m_font);
     historyBtn.setEnabled(m_selectedAccountIndex >= 0);
-    historyBtn.render(m_window);
+    draw(historyBtn);
     
     Button logoutBtn(650, 20, 120, 35, "Logout", m_font);
-    logoutBtn.render(m_window);
+    draw(logoutBtn);
+    
+    // Balance history of the selected account
+    if (m_selectedAccountIndex >= 0) {
+        sf::Text chartLabel;
+        chartLabel.setFont(m_font);
+        chartLabel.setString("Balance History:");
+        chartLabel.setCharacterSize(14);
+        chartLabel.setPosition(400, 305);
+        draw(chartLabel);
+        
+        draw(m_balanceChart);
+    }
 }
 
 void BankGUI::renderCreateAccount() {
@@ -767,16 +1093,16 @@ void BankGUI::renderCreateAccount() {
     drawCenteredText("Select Account Type:", 160, 18);
     
     Button savingsBtn(250, 200, 140, 50, "Savings", m_font);
-    savingsBtn.render(m_window);
+    draw(savingsBtn);
     
     Button checkingBtn(400, 200, 140, 50, "Checking", m_font);
-    checkingBtn.render(m_window);
+    draw(checkingBtn);
     
     Button fixedBtn(250, 260, 290, 50, "Fixed Deposit", m_font);
-    fixedBtn.render(m_window);
+    draw(fixedBtn);
     
     Button backBtn(300, 350, 200, 40, "Back", m_font);
-    backBtn.render(m_window);
+    draw(backBtn);
 }
 
 void BankGUI::renderDeposit() {
@@ -785,7 +1111,7 @@ void BankGUI::renderDeposit() {
     if (m_selectedAccountIndex >= 0 && 
         static_cast<size_t>(m_selectedAccountIndex) < m_userAccounts.size()) {
         const auto& account = m_userAccounts[static_cast<size_t>(m_selectedAccountIndex)];
-        drawCenteredText("Account: " + account.getAccountNumber(), 160, 16);
+        drawCenteredText("Account: " + std::string(account.getAccountNumber()), 160, 16);
         
         std::stringstream ss;
         ss << "Current Balance: $" << std::fixed << std::setprecision(2) << account.getBalance();
@@ -797,14 +1123,14 @@ void BankGUI::renderDeposit() {
     label.setString("Amount:");
     label.setCharacterSize(14);
     label.setPosition(230, 255);
-    m_window.draw(label);
-    m_amountInput->render(m_window);
+    draw(label);
+    draw(input(InputField::Amount));
     
     Button depositBtn(300, 310, 200, 40, "Deposit", m_font);
-    depositBtn.render(m_window);
+    draw(depositBtn);
     
     Button backBtn(300, 360, 200, 40, "Back", m_font);
-    backBtn.render(m_window);
+    draw(backBtn);
 }
 
 void BankGUI::renderWithdraw() {
@@ -813,7 +1139,7 @@ void BankGUI::renderWithdraw() {
     if (m_selectedAccountIndex >= 0 && 
         static_cast<size_t>(m_selectedAccountIndex) < m_userAccounts.size()) {
         const auto& account = m_userAccounts[static_cast<size_t>(m_selectedAccountIndex)];
-        drawCenteredText("Account: " + account.getAccountNumber(), 160, 16);
+        drawCenteredText("Account: " + std::string(account.getAccountNumber()), 160, 16);
         
         std::stringstream ss;
         ss << "Current Balance: $" << std::fixed << std::setprecision(2) << account.getBalance();
@@ -825,14 +1151,14 @@ void BankGUI::renderWithdraw() {
     label.setString("Amount:");
     label.setCharacterSize(14);
     label.setPosition(230, 255);
-    m_window.draw(label);
-    m_amountInput->render(m_window);
+    draw(label);
+    draw(input(InputField::Amount));
     
     Button withdrawBtn(300, 310, 200, 40, "Withdraw", m_font);
-    withdrawBtn.render(m_window);
+    draw(withdrawBtn);
     
     Button backBtn(300, 360, 200, 40, "Back", m_font);
-    backBtn.render(m_window);
+    draw(backBtn);
 }
 
 void BankGUI::renderTransfer() {
@@ -841,7 +1167,7 @@ void BankGUI::renderTransfer() {
     if (m_selectedAccountIndex >= 0 && 
         static_cast<size_t>(m_selectedAccountIndex) < m_userAccounts.size()) {
         const auto& account = m_userAccounts[static_cast<size_t>(m_selectedAccountIndex)];
-        drawCenteredText("From Account: " + account.getAccountNumber(), 160, 16);
+        drawCenteredText("From Account: " + std::string(account.getAccountNumber()), 160, 16);
         
         std::stringstream ss;
         ss << "Current Balance: $" << std::fixed << std::setprecision(2) << account.getBalance();
@@ -854,24 +1180,24 @@ void BankGUI::renderTransfer() {
     
     label.setString("Amount:");
     label.setPosition(200, 255);
-    m_window.draw(label);
-    m_amountInput->render(m_window);
+    draw(label);
+    draw(input(InputField::Amount));
     
     label.setString("To Account:");
     label.setPosition(185, 305);
-    m_window.draw(label);
-    m_targetAccountInput->render(m_window);
+    draw(label);
+    draw(input(InputField::TargetAccount));
     
     label.setString("Description:");
     label.setPosition(185, 355);
-    m_window.draw(label);
-    m_descriptionInput->render(m_window);
+    draw(label);
+    draw(input(InputField::Description));
     
     Button transferBtn(300, 410, 200, 40, "Transfer", m_font);
-    transferBtn.render(m_window);
+    draw(transferBtn);
     
     Button backBtn(300, 460, 200, 40, "Back", m_font);
-    backBtn.render(m_window);
+    draw(backBtn);
 }
 
 void BankGUI::renderTransactionHistory() {
@@ -880,7 +1206,7 @@ void BankGUI::renderTransactionHistory() {
     if (m_selectedAccountIndex >= 0 && 
         static_cast<size_t>(m_selectedAccountIndex) < m_userAccounts.size()) {
         const auto& account = m_userAccounts[static_cast<size_t>(m_selectedAccountIndex)];
-        drawCenteredText("Account: " + account.getAccountNumber(), 70, 16);
+        drawCenteredText("Account: " + std::string(account.getAccountNumber()), 70, 16);
     }
     
     // Transaction list
@@ -895,7 +1221,7 @@ void BankGUI::renderTransactionHistory() {
         box.setFillColor(sf::Color(40, 40, 50));
         box.setOutlineColor(sf::Color(60, 60, 70));
         box.setOutlineThickness(1);
-        m_window.draw(box);
+        draw(box);
         
         // Type
         std::string typeStr = Transaction::typeToString(trans.getType());
@@ -912,7 +1238,7 @@ void BankGUI::renderTransactionHistory() {
         }
         typeText.setFillColor(typeColor);
         typeText.setPosition(60, startY + i * 50 + 12);
-        m_window.draw(typeText);
+        draw(typeText);
         
         // Amount
         std::stringstream ss;
@@ -925,7 +1251,7 @@ void BankGUI::renderTransactionHistory() {
         amountText.setCharacterSize(14);
         amountText.setFillColor(typeColor);
         amountText.setPosition(200, startY + i * 50 + 12);
-        m_window.draw(amountText);
+        draw(amountText);
         
         // Description
         sf::Text descText;
@@ -934,20 +1260,75 @@ void BankGUI::renderTransactionHistory() {
         descText.setCharacterSize(12);
         descText.setFillColor(sf::Color(150, 150, 150));
         descText.setPosition(320, startY + i * 50 + 14);
-        m_window.draw(descText);
+        draw(descText);
         
         // Date
         sf::Text dateText;
         dateText.setFont(m_font);
-        dateText.setString(trans.getCreatedAt());
+        dateText.setString(trans.getCreatedAt().toString());
         dateText.setCharacterSize(10);
         dateText.setFillColor(sf::Color(100, 100, 100));
         dateText.setPosition(580, startY + i * 50 + 15);
-        m_window.draw(dateText);
+        draw(dateText);
     }
     
     Button backBtn(300, 530, 200, 40, "Back", m_font);
-    backBtn.render(m_window);
+    draw(backBtn);
+}
+
+void BankGUI::renderPerfHud() {
+    const auto& calls = m_service->getRecentCalls();
+    
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2);
+    ss << "Frame ms  p50 " << m_frameTimes.percentile(50)
+       << "  p95 " << m_frameTimes.percentile(95)
+       << "  p99 " << m_frameTimes.percentile(99)
+       << "  max " << m_frameTimes.max() << "\n";
+    ss << "Draw calls " << m_lastFrameDrawCalls << "\n";
+    ss << "Service calls (total / db ms, round trips, rows)\n";
+    
+    size_t shown = 0;
+    for (auto it = calls.rbegin(); it != calls.rend() && shown < 8; ++it, ++shown) {
+        ss << "  " << std::left << std::setw(22) << it->operation << std::right
+           << std::setw(8) << it->millis << " / " << std::setw(7) << it->dbMillis
+           << "  " << it->roundTrips << " rt  " << it->rows << " rows\n";
+    }
+    
+    sf::Text hudText;
+    hudText.setFont(m_font);
+    hudText.setString(ss.str());
+    hudText.setCharacterSize(12);
+    hudText.setFillColor(sf::Color(220, 220, 120));
+    hudText.setPosition(15, 15);
+    
+    sf::FloatRect textBounds = hudText.getGlobalBounds();
+    sf::RectangleShape background(sf::Vector2f(textBounds.width + 20, textBounds.height + 20));
+    background.setPosition(5, 5);
+    background.setFillColor(sf::Color(0, 0, 0, 200));
+    
+    draw(background);
+    draw(hudText);
+}
+
+void BankGUI::draw(const sf::Drawable& drawable) {
+    m_target->draw(drawable);
+    ++m_drawCalls;
+}
+
+void BankGUI::draw(Button& button) {
+    button.render(*m_target);
+    m_drawCalls += 2; // Shape and label
+}
+
+void BankGUI::draw(TextInput& input) {
+    input.render(*m_target);
+    m_drawCalls += 2; // Shape and either the text or the placeholder
+}
+
+void BankGUI::draw(BalanceChart& chart) {
+    chart.render(*m_target);
+    ++m_drawCalls;
 }
 
 void BankGUI::showStatus(const std::string& message, bool isError) {
@@ -956,15 +1337,11 @@ void BankGUI::showStatus(const std::string& message, bool isError) {
 }
 
 void BankGUI::clearInputs() {
-    m_usernameInput->clear();
-    m_passwordInput->clear();
-    m_confirmPasswordInput->clear();
-    m_fullNameInput->clear();
-    m_emailInput->clear();
-    m_phoneInput->clear();
-    m_amountInput->clear();
-    m_targetAccountInput->clear();
-    m_descriptionInput->clear();
+    for (auto& field : m_inputs) {
+        if (field) {
+            field->clear();
+        }
+    }
     m_statusMessage.clear();
 }
 
@@ -974,13 +1351,66 @@ void BankGUI::refreshAccounts() {
         if (!m_userAccounts.empty() && m_selectedAccountIndex < 0) {
             m_selectedAccountIndex = 0;
         }
+        m_totalBalance = 0.0;
+        for (const auto& account : m_userAccounts) {
+            m_totalBalance += account.getBalance();
+        }
+        m_transactionsAccountId = -1;
+        // Balances may have changed, so reload even for the same account
+        m_chartAccountId = -1;
+        refreshBalanceChart();
+    }
+}
+
+void BankGUI::applyDashboard(DashboardData dashboard) {
+    m_currentUser = std::move(dashboard.user);
+    m_userAccounts = std::move(dashboard.accounts);
+    m_totalBalance = dashboard.totalBalance;
+    m_selectedAccountIndex = m_userAccounts.empty() ? -1 : 0;
+    
+    // The prefetched history and chart belong to the default (first) account
+    m_transactions = std::move(dashboard.history);
+    m_transactionsAccountId = dashboard.defaultAccountId;
+    m_chartAccountId = dashboard.defaultAccountId;
+    if (m_chartAccountId >= 0) {
+        m_balanceChart.setSeries(m_chartAccountId, std::move(dashboard.balanceHistory));
+    } else {
+        m_balanceChart.clear();
+    }
+}
+
+void BankGUI::refreshBalanceChart() {
+    if (m_selectedAccountIndex < 0 || 
+        static_cast<size_t>(m_selectedAccountIndex) >= m_userAccounts.size()) {
+        m_chartAccountId = -1;
+        m_balanceChart.clear();
+        return;
+    }
+    
+    int accountId = m_userAccounts[static_cast<size_t>(m_selectedAccountIndex)].getAccountId();
+    if (accountId == m_chartAccountId) {
+        return;
+    }
+    
+    m_chartAccountId = accountId;
+    if (!m_chartService) {
+        m_balanceChart.setSeries(accountId, m_service->getBalanceHistory(accountId));
+        return;
     }
+    m_balanceChart.load(accountId, [service = m_chartService, accountId]() {
+        return service->getBalanceHistory(accountId);
+    });
 }
 
 void BankGUI::logout() {
     m_currentUser.reset();
     m_userAccounts.clear();
+    m_totalBalance = 0.0;
+    m_transactions.clear();
+    m_transactionsAccountId = -1;
     m_selectedAccountIndex = -1;
+    m_chartAccountId = -1;
+    m_balanceChart.clear();
     m_currentState = AppState::Login;
     clearInputs();
 }
@@ -995,7 +1425,7 @@ void BankGUI::drawCenteredText(const std::string& text, float y, unsigned int si
     sfText.setFillColor(color);
     sf::FloatRect textBounds = sfText.getLocalBounds();
     sfText.setPosition(400.f - textBounds.width / 2.f, y);
-    m_window.draw(sfText);
+    draw(sfText);
 }
 
 } // namespace bank
@@ -0,0 +1,218 @@
+#include "InputRecorder.hpp"
+#include "BankApi.hpp"
+#include <random>
+#include <sstream>
+
+namespace bank {
+
+namespace {
+
+const char* kSessionHeader = "# bank_management input session v1";
+
+void writeEvent(std::ostream& out, const sf::Event& event) {
+    switch (event.type) {
+        case sf::Event::Closed:
+            out << "closed";
+            break;
+        case sf::Event::TextEntered:
+            out << "text " << event.text.unicode;
+            break;
+        case sf::Event::KeyPressed:
+        case sf::Event::KeyReleased:
+            out << (event.type == sf::Event::KeyPressed ? "keydown " : "keyup ")
+                << static_cast<int>(event.key.code) << ' '
+                << event.key.alt << ' ' << event.key.control << ' '
+                << event.key.shift << ' ' << event.key.system;
+            break;
+        case sf::Event::MouseButtonPressed:
+        case sf::Event::MouseButtonReleased:
+            out << (event.type == sf::Event::MouseButtonPressed ? "mousedown " : "mouseup ")
+                << static_cast<int>(event.mouseButton.button) << ' '
+                << event.mouseButton.x << ' ' << event.mouseButton.y;
+            break;
+        case sf::Event::MouseMoved:
+            out << "mousemove " << event.mouseMove.x << ' ' << event.mouseMove.y;
+            break;
+        default:
+            break;
+    }
+}
+
+bool readEvent(std::istream& in, const std::string& type, sf::Event& event) {
+    if (type == "closed") {
+        event.type = sf::Event::Closed;
+        return true;
+    }
+    if (type == "text") {
+        event.type = sf::Event::TextEntered;
+        return static_cast<bool>(in >> event.text.unicode);
+    }
+    if (type == "keydown" || type == "keyup") {
+        event.type = type == "keydown" ? sf::Event::KeyPressed : sf::Event::KeyReleased;
+        int code = 0;
+        if (!(in >> code >> event.key.alt >> event.key.control >> 
+              event.key.shift >> event.key.system)) {
+            return false;
+        }
+        event.key.code = static_cast<sf::Keyboard::Key>(code);
+        return true;
+    }
+    if (type == "mousedown" || type == "mouseup") {
+        event.type = type == "mousedown" ? sf::Event::MouseButtonPressed 
+                                         : sf::Event::MouseButtonReleased;
+        int button = 0;
+        if (!(in >> button >> event.mouseButton.x >> event.mouseButton.y)) {
+            return false;
+        }
+        event.mouseButton.button = static_cast<sf::Mouse::Button>(button);
+        return true;
+    }
+    if (type == "mousemove") {
+        event.type = sf::Event::MouseMoved;
+        return static_cast<bool>(in >> event.mouseMove.x >> event.mouseMove.y);
+    }
+    return false;
+}
+
+bool isRecordable(const sf::Event& event) {
+    switch (event.type) {
+        case sf::Event::Closed:
+        case sf::Event::TextEntered:
+        case sf::Event::KeyPressed:
+        case sf::Event::KeyReleased:
+        case sf::Event::MouseButtonPressed:
+        case sf::Event::MouseButtonReleased:
+        case sf::Event::MouseMoved:
+            return true;
+        default:
+            return false;
+    }
+}
+
+} // namespace
+
+std::optional<InputSession> InputSession::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        return std::nullopt;
+    }
+
+    std::string line;
+    if (!std::getline(in, line) || line != kSessionHeader) {
+        return std::nullopt;
+    }
+
+    InputSession session;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::istringstream fields(line);
+        std::string first;
+        fields >> first;
+
+        if (first == "end") {
+            if (!(fields >> session.frameCount)) {
+                return std::nullopt;
+            }
+            return session;
+        }
+
+        RecordedEvent recorded{};
+        std::string type;
+        try {
+            recorded.frame = std::stoull(first);
+        } catch (...) {
+            return std::nullopt;
+        }
+        if (!(fields >> recorded.millis >> type) || 
+            !readEvent(fields, type, recorded.event)) {
+            return std::nullopt;
+        }
+        session.events.push_back(recorded);
+    }
+
+    // A session cut short (e.g. the client crashed) still replays up to its last event
+    session.frameCount = session.events.empty() ? 0 : session.events.back().frame + 1;
+    return session;
+}
+
+InputRecorder::~InputRecorder() {
+    finish(m_lastFrame + 1);
+}
+
+bool InputRecorder::open(const std::string& path) {
+    m_out.open(path, std::ios::trunc);
+    if (!m_out) {
+        return false;
+    }
+    m_out << kSessionHeader << '\n';
+    m_start = std::chrono::steady_clock::now();
+    m_lastFrame = 0;
+    return true;
+}
+
+void InputRecorder::record(const sf::Event& event, std::uint64_t frame) {
+    if (!m_out.is_open() || !isRecordable(event)) {
+        return;
+    }
+
+    double millis = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - m_start).count();
+    m_out << frame << ' ' << millis << ' ';
+    writeEvent(m_out, event);
+    m_out << '\n';
+    m_lastFrame = frame;
+}
+
+void InputRecorder::finish(std::uint64_t frameCount) {
+    if (!m_out.is_open()) {
+        return;
+    }
+    m_out << "end " << frameCount << '\n';
+    m_out.close();
+}
+
+bool seedReplayFixture(BankApi& service) {
+    if (service.getUserByUsername("replay").has_value()) {
+        return true;
+    }
+
+    auto user = service.createUser("replay", "replay123", "Replay User",
+                                   "replay@example.com", "555-0100");
+    if (!user.has_value()) {
+        return false;
+    }
+
+    auto savings = service.createAccount(user->getUserId(), AccountType::Savings, 5000.0);
+    auto checking = service.createAccount(user->getUserId(), AccountType::Checking, 1000.0);
+    if (!savings.has_value() || !checking.has_value()) {
+        return false;
+    }
+
+    // Fixed seed so every fixture has the same history and chart shape
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<> op(0, 2);
+    std::uniform_real_distribution<> amount(5.0, 250.0);
+
+    for (int i = 0; i < 500; ++i) {
+        double value = static_cast<int>(amount(gen) * 100) / 100.0;
+        switch (op(gen)) {
+            case 0:
+                service.deposit(savings->getAccountId(), value, "Replay deposit");
+                break;
+            case 1:
+                service.withdraw(savings->getAccountId(), value, "Replay withdrawal");
+                break;
+            default:
+                service.transfer(savings->getAccountId(), checking->getAccountId(), 
+                                 value, "Replay transfer");
+                break;
+        }
+    }
+
+    return true;
+}
+
+} // namespace bank
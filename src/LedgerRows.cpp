@@ -0,0 +1,93 @@
+#include "LedgerRows.hpp"
+#include <cstdlib>
+#include <string_view>
+
+namespace bank {
+
+namespace {
+
+// std::stoi/stod need a std::string; arena fields are parsed in place
+int toInt(const std::string& field) {
+    return std::stoi(field);
+}
+
+int toInt(const std::pmr::string& field) {
+    return static_cast<int>(std::strtol(field.c_str(), nullptr, 10));
+}
+
+double toDouble(const std::string& field) {
+    return std::stod(field);
+}
+
+double toDouble(const std::pmr::string& field) {
+    return std::strtod(field.c_str(), nullptr);
+}
+
+const std::string& toString(const std::string& field) {
+    return field;
+}
+
+std::string toString(const std::pmr::string& field) {
+    return std::string(field.data(), field.size());
+}
+
+template <typename Row>
+User decodeUser(const Row& row) {
+    return User(toInt(row[0]), toString(row[1]), toString(row[2]), toString(row[3]),
+                toString(row[4]), toString(row[5]));
+}
+
+template <typename Row>
+Account decodeAccount(const Row& row) {
+    return Account(
+        toInt(row[0]),
+        toInt(row[1]),
+        std::string_view(row[2]),
+        Account::stringToType(std::string_view(row[3])),
+        toDouble(row[4]),
+        toDouble(row[5]),
+        Account::stringToStatus(std::string_view(row[6]))
+    );
+}
+
+template <typename Row>
+Transaction decodeTransaction(const Row& row) {
+    Transaction t;
+    t.setTransactionId(toInt(row[0]));
+    t.setAccountId(toInt(row[1]));
+    t.setType(Transaction::stringToType(std::string_view(row[2])));
+    t.setAmount(toDouble(row[3]));
+    t.setBalanceAfter(toDouble(row[4]));
+    t.setDescription(toString(row[5]));
+    t.setRelatedAccountId(row[6].empty() ? -1 : toInt(row[6]));
+    t.setCreatedAt(Timestamp::parse(std::string_view(row[7])).value_or(Timestamp()));
+    return t;
+}
+
+} // namespace
+
+User userFromRow(const std::vector<std::string>& row) {
+    return decodeUser(row);
+}
+
+User userFromRow(const ArenaRow& row) {
+    return decodeUser(row);
+}
+
+Account accountFromRow(const std::vector<std::string>& row) {
+    return decodeAccount(row);
+}
+
+Account accountFromRow(const ArenaRow& row) {
+    return decodeAccount(row);
+}
+
+Transaction transactionFromRow(const std::vector<std::string>& row) {
+    return decodeTransaction(row);
+}
+
+Transaction transactionFromRow(const ArenaRow& row) {
+    return decodeTransaction(row);
+}
+
+} // namespace bank
@@ -0,0 +1,36 @@
+#include "LedgerStore.hpp"
+
+namespace bank {
+
+std::optional<DashboardData> LedgerStore::loadDashboard(int userId, int historyLimit, int balancePoints) {
+    auto user = findUserById(userId);
+    if (!user.has_value()) {
+        return std::nullopt;
+    }
+
+    DashboardData data;
+    data.user = *user;
+    data.accounts = findAccountsByUser(userId);
+    for (const auto& account : data.accounts) {
+        data.totalBalance += account.getBalance();
+    }
+    if (!data.accounts.empty()) {
+        data.defaultAccountId = data.accounts.front().getAccountId();
+        data.history = scanHistory(data.defaultAccountId, historyLimit);
+        data.balanceHistory = balanceHistory(data.defaultAccountId, balancePoints);
+    }
+    return data;
+}
+
+std::optional<DashboardData> LedgerStore::loadDashboardForLogin(const std::string& username,
+                                                                const std::string& passwordHash,
+                                                                int historyLimit, int balancePoints)
+{
+    auto credentials = findCredentials(username);
+    if (!credentials.has_value() || credentials->second != passwordHash) {
+        return std::nullopt;
+    }
+    return loadDashboard(credentials->first, historyLimit, balancePoints);
+}
+
+} // namespace bank
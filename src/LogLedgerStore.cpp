@@ -0,0 +1,806 @@
+#include "LogLedgerStore.hpp"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#define BANK_HAVE_POSIX_FILES 1
+#elif defined(_WIN32)
+#include <io.h>
+#endif
+
+namespace bank {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Log and snapshot frames: u32 length, u32 CRC-32 of the records, records.
+// Records use the network protocol's encoding, starting with a Record tag.
+constexpr std::size_t kFrameHeader = 8;
+constexpr std::uint32_t kMaxFrame = 1u << 30;
+constexpr std::size_t kSnapshotFrameBytes = 1 << 20;
+constexpr std::uint32_t kSnapshotMagic = 0x424b534e;   // "BKSN"
+constexpr std::uint32_t kSnapshotVersion = 2;   // 2: creation times as int64 micros
+
+std::uint32_t crc32(const char* data, std::size_t size) {
+    static const auto table = []() {
+        std::array<std::uint32_t, 256> entries{};
+        for (std::uint32_t i = 0; i < 256; ++i) {
+            std::uint32_t c = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            entries[i] = c;
+        }
+        return entries;
+    }();
+
+    std::uint32_t crc = 0xFFFFFFFFu;
+    for (std::size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+void putBigEndian(std::string& out, std::uint32_t value) {
+    out.push_back(static_cast<char>(value >> 24));
+    out.push_back(static_cast<char>(value >> 16));
+    out.push_back(static_cast<char>(value >> 8));
+    out.push_back(static_cast<char>(value));
+}
+
+void appendFrameTo(std::string& out, const std::string& records) {
+    putBigEndian(out, static_cast<std::uint32_t>(records.size() + 4));
+    putBigEndian(out, crc32(records.data(), records.size()));
+    out += records;
+}
+
+/**
+ * @brief Encoded record without the protocol's length prefix
+ */
+std::string recordBytes(protocol::MessageWriter& writer) {
+    return writer.finish().substr(protocol::kLengthPrefix);
+}
+
+/**
+ * @brief Find the next complete, intact frame
+ * @return Size of the frame, or 0 if the data at pos is torn or corrupt
+ */
+std::size_t checkFrame(const std::string& data, std::size_t pos) {
+    if (data.size() - pos < kFrameHeader) {
+        return 0;
+    }
+    std::uint32_t length = protocol::readLength(data.data() + pos);
+    if (length < 4 || length > kMaxFrame || data.size() - pos - protocol::kLengthPrefix < length) {
+        return 0;
+    }
+    const char* records = data.data() + pos + kFrameHeader;
+    if (crc32(records, length - 4) != protocol::readLength(data.data() + pos + 4)) {
+        return 0;
+    }
+    return protocol::kLengthPrefix + length;
+}
+
+bool readFile(const std::string& path, std::string& data) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !file.bad();
+}
+
+bool syncFile(std::FILE* file) {
+#if defined(__linux__)
+    return ::fdatasync(fileno(file)) == 0;
+#elif defined(BANK_HAVE_POSIX_FILES)
+    return ::fsync(fileno(file)) == 0;
+#elif defined(_WIN32)
+    return _commit(_fileno(file)) == 0;
+#else
+    return true;
+#endif
+}
+
+/**
+ * @brief Make a rename or file creation in a directory durable
+ */
+bool syncDirectory(const std::string& path) {
+#ifdef BANK_HAVE_POSIX_FILES
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+#else
+    (void)path;
+    return true;
+#endif
+}
+
+} // namespace
+
+LogLedgerStore::LogLedgerStore(LogStoreOptions options)
+    : m_options(std::move(options))
+    , m_open(false)
+    , m_failed(false)
+    , m_appended(0)
+    , m_durable(0)
+    , m_generation(1)
+    , m_generationStart(0)
+    , m_log(nullptr)
+    , m_logFailed(false)
+    , m_stopping(false)
+    , m_checkpointing(false)
+    , m_lockFd(-1)
+{
+}
+
+LogLedgerStore::~LogLedgerStore() {
+    if (m_flusher.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_logMutex);
+            m_stopping = true;
+        }
+        // A running checkpoint still needs the flusher to drain the log
+        m_checkpointDue.notify_one();
+        m_checkpointer.join();
+        m_logReady.notify_one();
+        m_flusher.join();
+    }
+    if (m_log) {
+        std::fclose(m_log);
+    }
+#ifdef BANK_HAVE_POSIX_FILES
+    if (m_lockFd >= 0) {
+        ::close(m_lockFd);
+    }
+#endif
+}
+
+std::string LogLedgerStore::logPath(std::uint32_t generation) const {
+    return (fs::path(m_options.directory) / ("wal-" + std::to_string(generation) + ".log")).string();
+}
+
+// Recovery
+
+bool LogLedgerStore::open() {
+    Lock lock(m_mutex);
+    if (m_open) {
+        return true;
+    }
+
+    std::error_code error;
+    fs::create_directories(m_options.directory, error);
+    if (error) {
+        return fail("Could not create " + m_options.directory + ": " + error.message());
+    }
+    fs::path directory(m_options.directory);
+
+#ifdef BANK_HAVE_POSIX_FILES
+    // Two processes appending to the same log would corrupt it
+    if (m_lockFd < 0) {
+        m_lockFd = ::open((directory / "LOCK").string().c_str(), O_RDWR | O_CREAT, 0644);
+        if (m_lockFd < 0 || ::flock(m_lockFd, LOCK_EX | LOCK_NB) != 0) {
+            return fail(m_options.directory + " is in use by another process");
+        }
+    }
+#endif
+    fs::remove(directory / "snapshot.tmp", error);
+
+    std::uint32_t generation = 1;
+    std::string snapshot = (directory / "snapshot.bin").string();
+    if (fs::exists(snapshot) && !loadSnapshot(snapshot, generation)) {
+        return false;
+    }
+
+    // Replay the logs written since the snapshot, oldest first
+    std::uint32_t newest = generation;
+    while (fs::exists(logPath(newest + 1))) {
+        ++newest;
+    }
+    for (std::uint32_t g = generation; g <= newest; ++g) {
+        if (fs::exists(logPath(g)) && !replayLog(logPath(g), g == newest)) {
+            return false;
+        }
+    }
+
+    // Logs older than the snapshot are left over from an interrupted checkpoint
+    for (const auto& entry : fs::directory_iterator(directory, error)) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind("wal-", 0) == 0 && std::strtoul(name.c_str() + 4, nullptr, 10) < generation) {
+            fs::remove(entry.path(), error);
+        }
+    }
+
+    std::lock_guard<std::mutex> logLock(m_logMutex);
+    m_durable = m_appended;
+    m_generationStart = 0;
+    if (!openLog(newest)) {
+        return false;
+    }
+
+    m_stats = StoreStats{};
+    m_open = true;
+    m_flusher = std::thread(&LogLedgerStore::flushLoop, this);
+    m_checkpointer = std::thread(&LogLedgerStore::checkpointLoop, this);
+    return true;
+}
+
+bool LogLedgerStore::loadSnapshot(const std::string& path, std::uint32_t& generation) {
+    std::string data;
+    if (!readFile(path, data)) {
+        return fail("Could not read " + path);
+    }
+
+    bool begun = false;
+    std::size_t pos = 0;
+    while (pos < data.size()) {
+        std::size_t frame = checkFrame(data, pos);
+        if (frame == 0) {
+            return fail("Corrupt snapshot " + path);
+        }
+
+        protocol::MessageReader reader(data.data() + pos + kFrameHeader, frame - kFrameHeader);
+        pos += frame;
+        while (!reader.atEnd()) {
+            auto record = static_cast<Record>(reader.getU8());
+            if (record == Record::SnapshotBegin) {
+                std::uint32_t magic = reader.getU32();
+                std::uint32_t version = reader.getU32();
+                generation = reader.getU32();
+                if (!reader.ok() || magic != kSnapshotMagic || version != kSnapshotVersion) {
+                    return fail("Unsupported snapshot " + path);
+                }
+                begun = true;
+            } else if (record == Record::SnapshotEnd) {
+                m_nextUserId = reader.getI32();
+                m_nextAccountId = reader.getI32();
+                m_nextTransactionId = reader.getI32();
+                return reader.ok() ? true : fail("Corrupt snapshot " + path);
+            } else if (!begun || !applyRecord(reader, record)) {
+                return fail("Corrupt snapshot " + path);
+            }
+        }
+    }
+    return fail("Incomplete snapshot " + path);
+}
+
+bool LogLedgerStore::replayLog(const std::string& path, bool newest) {
+    std::string data;
+    if (!readFile(path, data)) {
+        return fail("Could not read " + path);
+    }
+
+    std::size_t pos = 0;
+    while (pos < data.size()) {
+        std::size_t frame = checkFrame(data, pos);
+        if (frame == 0) {
+            break;
+        }
+        protocol::MessageReader reader(data.data() + pos + kFrameHeader, frame - kFrameHeader);
+        while (!reader.atEnd()) {
+            if (!applyRecord(reader, static_cast<Record>(reader.getU8()))) {
+                return fail("Corrupt record in " + path);
+            }
+        }
+        pos += frame;
+    }
+
+    if (pos < data.size()) {
+        // Only the newest log can end in a frame that was being written during a crash
+        if (!newest) {
+            return fail("Corrupt frame in " + path);
+        }
+        std::error_code error;
+        fs::resize_file(path, pos, error);
+        if (error) {
+            return fail("Could not truncate " + path + ": " + error.message());
+        }
+    }
+    m_appended += pos;
+    return true;
+}
+
+bool LogLedgerStore::applyRecord(protocol::MessageReader& reader, Record record) {
+    // Records carry the ids assigned when they were first applied
+    switch (record) {
+        case Record::InsertUser: {
+            User user = reader.getUser();
+            if (!reader.ok()) {
+                return false;
+            }
+            int next = std::max(m_nextUserId, user.getUserId() + 1);
+            m_nextUserId = user.getUserId();
+            bool ok = MemoryLedgerStore::insertUser(user).has_value();
+            m_nextUserId = next;
+            return ok;
+        }
+        case Record::UpdateUser: {
+            User user = reader.getUser();
+            return reader.ok() && MemoryLedgerStore::updateUser(user);
+        }
+        case Record::DeleteUser: {
+            int userId = reader.getI32();
+            return reader.ok() && MemoryLedgerStore::deleteUser(userId);
+        }
+        case Record::InsertAccount: {
+            Account account = reader.getAccount();
+            if (!reader.ok()) {
+                return false;
+            }
+            int next = std::max(m_nextAccountId, account.getAccountId() + 1);
+            m_nextAccountId = account.getAccountId();
+            bool ok = MemoryLedgerStore::insertAccount(account).has_value();
+            m_nextAccountId = next;
+            return ok;
+        }
+        case Record::SetAccountStatus: {
+            int accountId = reader.getI32();
+            auto status = static_cast<AccountStatus>(reader.getU8());
+            return reader.ok() && MemoryLedgerStore::setAccountStatus(accountId, status);
+        }
+        case Record::DeleteAccount: {
+            int accountId = reader.getI32();
+            return reader.ok() && MemoryLedgerStore::deleteAccount(accountId);
+        }
+        case Record::SetBalance: {
+            int accountId = reader.getI32();
+            double balance = reader.getF64();
+            auto it = m_accounts.find(accountId);
+            if (!reader.ok() || it == m_accounts.end()) {
+                return false;
+            }
+            it->second.account.setBalance(balance);
+            return true;
+        }
+        case Record::AppendTransaction: {
+            Transaction transaction = reader.getTransaction();
+            Timestamp createdAt = reader.getTimestamp();
+            if (!reader.ok()) {
+                return false;
+            }
+            int next = std::max(m_nextTransactionId, transaction.getTransactionId() + 1);
+            m_nextTransactionId = transaction.getTransactionId();
+            bool ok = appendTransactionAt(transaction, createdAt);
+            m_nextTransactionId = next;
+            return ok;
+        }
+        case Record::SnapshotBegin:
+        case Record::SnapshotEnd:
+            break;
+    }
+    return false;
+}
+
+// Write-ahead log
+
+bool LogLedgerStore::openLog(std::uint32_t generation) {
+    std::string path = logPath(generation);
+    std::FILE* file = std::fopen(path.c_str(), "ab");
+    if (!file) {
+        return fail("Could not open " + path + ": " + std::strerror(errno));
+    }
+    syncDirectory(m_options.directory);
+
+    if (m_log) {
+        std::fclose(m_log);
+    }
+    m_log = file;
+    m_generation = generation;
+    return true;
+}
+
+std::uint64_t LogLedgerStore::appendFrame(const std::string& records) {
+    std::lock_guard<std::mutex> lock(m_logMutex);
+    std::size_t before = m_logBuffer.size();
+    appendFrameTo(m_logBuffer, records);
+    m_appended += m_logBuffer.size() - before;
+    m_logReady.notify_one();
+    return m_appended;
+}
+
+void LogLedgerStore::flushLoop() {
+    std::unique_lock<std::mutex> lock(m_logMutex);
+    while (true) {
+        m_logReady.wait(lock, [this] { return !m_logBuffer.empty() || m_stopping; });
+        if (m_logBuffer.empty()) {
+            break;
+        }
+        if (m_logFailed) {
+            m_logBuffer.clear();
+            continue;
+        }
+
+        // Everything appended while the previous sync ran goes out in one write
+        std::string batch;
+        batch.swap(m_logBuffer);
+        std::uint64_t target = m_appended;
+        std::FILE* file = m_log;
+        lock.unlock();
+
+        bool ok = std::fwrite(batch.data(), 1, batch.size(), file) == batch.size() &&
+                  std::fflush(file) == 0 && (!m_options.sync || syncFile(file));
+        int error = errno;
+
+        lock.lock();
+        if (ok) {
+            m_durable = target;
+        } else {
+            m_logFailed = true;
+            m_logError = "Could not write " + logPath(m_generation) + ": " + std::strerror(error);
+        }
+        m_logDurable.notify_all();
+    }
+}
+
+bool LogLedgerStore::waitDurable(std::uint64_t position) {
+    if (position == 0) {
+        return true;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    bool durable;
+    std::string error;
+    {
+        std::unique_lock<std::mutex> lock(m_logMutex);
+        m_logDurable.wait(lock, [&] { return m_durable >= position || m_logFailed; });
+        durable = m_durable >= position;
+        error = m_logError;
+    }
+
+    {
+        Lock lock(m_mutex);
+        m_stats.millis += std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+        if (!durable) {
+            // Memory already holds the change, so accept no further ones
+            m_failed = true;
+            return fail(error);
+        }
+    }
+
+    maybeCheckpoint();
+    return true;
+}
+
+template <typename Apply, typename Encode>
+auto LogLedgerStore::logged(Apply apply, Encode encode) -> decltype(apply()) {
+    using Result = decltype(apply());
+    std::uint64_t position = 0;
+    Result result{};
+    {
+        Lock lock(m_mutex);
+        if (!m_open || m_failed) {
+            fail(m_open ? "The write-ahead log failed; the store is read-only" : "Store is not open");
+            return result;
+        }
+
+        result = apply();
+        if (!result) {
+            return result;
+        }
+
+        protocol::MessageWriter writer;
+        encode(writer, result);
+        if (m_scopeMarks.empty()) {
+            position = appendFrame(recordBytes(writer));
+        } else {
+            m_pending += recordBytes(writer);
+        }
+    }
+
+    if (!waitDurable(position)) {
+        return Result{};
+    }
+    return result;
+}
+
+// Transaction scope
+
+bool LogLedgerStore::begin() {
+    {
+        Lock lock(m_mutex);
+        if (!m_open || m_failed) {
+            return fail(m_open ? "The write-ahead log failed; the store is read-only" : "Store is not open");
+        }
+    }
+
+    MemoryLedgerStore::begin();
+    m_pendingMarks.push_back(m_pending.size());
+    return true;
+}
+
+bool LogLedgerStore::commit() {
+    std::uint64_t position = 0;
+    {
+        Lock lock(m_mutex);
+        if (m_pendingMarks.empty()) {
+            return fail("No transaction in progress");
+        }
+
+        // The outermost commit logs the whole scope as one frame
+        m_pendingMarks.pop_back();
+        if (m_pendingMarks.empty() && !m_pending.empty()) {
+            position = appendFrame(m_pending);
+            m_pending.clear();
+        }
+        MemoryLedgerStore::commit();
+    }
+    return waitDurable(position);
+}
+
+bool LogLedgerStore::rollback() {
+    Lock lock(m_mutex);
+    if (m_pendingMarks.empty()) {
+        return fail("No transaction in progress");
+    }
+
+    m_pending.resize(m_pendingMarks.back());
+    m_pendingMarks.pop_back();
+    return MemoryLedgerStore::rollback();
+}
+
+// Logged changes
+
+std::optional<int> LogLedgerStore::insertUser(const User& user) {
+    return logged([&]() { return MemoryLedgerStore::insertUser(user); },
+                  [&](protocol::MessageWriter& record, std::optional<int> userId) {
+                      User stored = user;
+                      stored.setUserId(*userId);
+                      record.putU8(static_cast<std::uint8_t>(Record::InsertUser));
+                      record.putUser(stored);
+                  });
+}
+
+bool LogLedgerStore::updateUser(const User& user) {
+    return logged([&]() { return MemoryLedgerStore::updateUser(user); },
+                  [&](protocol::MessageWriter& record, bool) {
+                      record.putU8(static_cast<std::uint8_t>(Record::UpdateUser));
+                      record.putUser(user);
+                  });
+}
+
+bool LogLedgerStore::deleteUser(int userId) {
+    return logged([&]() { return MemoryLedgerStore::deleteUser(userId); },
+                  [&](protocol::MessageWriter& record, bool) {
+                      record.putU8(static_cast<std::uint8_t>(Record::DeleteUser));
+                      record.putI32(userId);
+                  });
+}
+
+std::optional<int> LogLedgerStore::insertAccount(const Account& account) {
+    return logged([&]() { return MemoryLedgerStore::insertAccount(account); },
+                  [&](protocol::MessageWriter& record, std::optional<int> accountId) {
+                      Account stored = account;
+                      stored.setAccountId(*accountId);
+                      record.putU8(static_cast<std::uint8_t>(Record::InsertAccount));
+                      record.putAccount(stored);
+                  });
+}
+
+bool LogLedgerStore::setAccountStatus(int accountId, AccountStatus status) {
+    return logged([&]() { return MemoryLedgerStore::setAccountStatus(accountId, status); },
+                  [&](protocol::MessageWriter& record, bool) {
+                      record.putU8(static_cast<std::uint8_t>(Record::SetAccountStatus));
+                      record.putI32(accountId);
+                      record.putU8(static_cast<std::uint8_t>(status));
+                  });
+}
+
+bool LogLedgerStore::deleteAccount(int accountId) {
+    return logged([&]() { return MemoryLedgerStore::deleteAccount(accountId); },
+                  [&](protocol::MessageWriter& record, bool) {
+                      record.putU8(static_cast<std::uint8_t>(Record::DeleteAccount));
+                      record.putI32(accountId);
+                  });
+}
+
+std::optional<double> LogLedgerStore::adjustBalance(int accountId, double delta) {
+    // The new balance is logged rather than the delta, so replay is idempotent
+    return logged([&]() { return MemoryLedgerStore::adjustBalance(accountId, delta); },
+                  [&](protocol::MessageWriter& record, std::optional<double> balance) {
+                      record.putU8(static_cast<std::uint8_t>(Record::SetBalance));
+                      record.putI32(accountId);
+                      record.putF64(*balance);
+                  });
+}
+
+bool LogLedgerStore::appendTransaction(const Transaction& transaction) {
+    return logged([&]() { return MemoryLedgerStore::appendTransaction(transaction); },
+                  [&](protocol::MessageWriter& record, bool) {
+                      const TransactionBatch& history = m_accounts.at(transaction.getAccountId()).history;
+                      std::size_t last = history.size() - 1;
+                      record.putU8(static_cast<std::uint8_t>(Record::AppendTransaction));
+                      record.putTransaction(history.at(last));
+                      record.putI64(history.createdAtMicros(last));
+                  });
+}
+
+// Snapshots
+
+LogLedgerStore::SnapshotState LogLedgerStore::copyState() const {
+    SnapshotState state;
+    state.users.reserve(m_users.size());
+    for (const auto& entry : m_users) {
+        state.users.push_back(entry.second);
+    }
+    state.accounts.reserve(m_accounts.size());
+    for (const auto& entry : m_accounts) {
+        state.accounts.emplace_back(entry.second.account, entry.second.history);
+    }
+    // Pool strings never move or change, so views of them outlive the lock
+    state.descriptions.reserve(m_descriptions->size());
+    for (std::uint32_t id = 0; id < m_descriptions->size(); ++id) {
+        state.descriptions.push_back(m_descriptions->get(id));
+    }
+    state.nextUserId = m_nextUserId;
+    state.nextAccountId = m_nextAccountId;
+    state.nextTransactionId = m_nextTransactionId;
+    return state;
+}
+
+std::string LogLedgerStore::snapshotData(SnapshotState state, std::uint32_t generation) {
+    std::string data;
+    std::string records;
+    auto add = [&](protocol::MessageWriter& writer) {
+        records += recordBytes(writer);
+        if (records.size() >= kSnapshotFrameBytes) {
+            appendFrameTo(data, records);
+            records.clear();
+        }
+    };
+
+    protocol::MessageWriter header;
+    header.putU8(static_cast<std::uint8_t>(Record::SnapshotBegin));
+    header.putU32(kSnapshotMagic);
+    header.putU32(kSnapshotVersion);
+    header.putU32(generation);
+    add(header);
+
+    // Ids in ascending order recreate each user's accounts in creation order
+    std::sort(state.users.begin(), state.users.end(),
+              [](const User& a, const User& b) { return a.getUserId() < b.getUserId(); });
+    for (const User& user : state.users) {
+        protocol::MessageWriter writer;
+        writer.putU8(static_cast<std::uint8_t>(Record::InsertUser));
+        writer.putUser(user);
+        add(writer);
+    }
+
+    // The store keeps interning into its pool, so the copied histories read a pool of their own
+    auto descriptions = std::make_shared<StringPool>();
+    for (std::string_view description : state.descriptions) {
+        descriptions->intern(description);
+    }
+
+    std::sort(state.accounts.begin(), state.accounts.end(), [](const auto& a, const auto& b) {
+        return a.first.getAccountId() < b.first.getAccountId();
+    });
+    for (auto& [account, history] : state.accounts) {
+        protocol::MessageWriter writer;
+        writer.putU8(static_cast<std::uint8_t>(Record::InsertAccount));
+        writer.putAccount(account);
+        add(writer);
+
+        history.setDescriptions(descriptions);
+        for (std::size_t i = 0; i < history.size(); ++i) {
+            protocol::MessageWriter transaction;
+            transaction.putU8(static_cast<std::uint8_t>(Record::AppendTransaction));
+            transaction.putTransaction(history.at(i));
+            transaction.putI64(history.createdAtMicros(i));
+            add(transaction);
+        }
+    }
+
+    protocol::MessageWriter trailer;
+    trailer.putU8(static_cast<std::uint8_t>(Record::SnapshotEnd));
+    trailer.putI32(state.nextUserId);
+    trailer.putI32(state.nextAccountId);
+    trailer.putI32(state.nextTransactionId);
+    records += recordBytes(trailer);
+    appendFrameTo(data, records);
+    return data;
+}
+
+bool LogLedgerStore::checkpoint() {
+    std::lock_guard<std::mutex> checkpointLock(m_checkpointMutex);
+    SnapshotState state;
+    std::uint32_t generation;
+    {
+        Lock lock(m_mutex);
+        if (!m_open || m_failed) {
+            return fail("Store is not writable");
+        }
+        if (!m_scopeMarks.empty()) {
+            return fail("Cannot checkpoint inside a transaction scope");
+        }
+
+        // The snapshot covers everything in the current log; changes after
+        // it go to the next generation, which recovery replays after it
+        std::unique_lock<std::mutex> logLock(m_logMutex);
+        m_logDurable.wait(logLock, [this] { return m_durable == m_appended || m_logFailed; });
+        if (m_logFailed) {
+            m_failed = true;
+            return fail(m_logError);
+        }
+
+        generation = m_generation + 1;
+        state = copyState();
+        if (!openLog(generation)) {
+            return false;
+        }
+        m_generationStart = m_appended;
+    }
+
+    // Until the new snapshot is in place the old one and all logs still recover
+    if (!writeSnapshot(snapshotData(std::move(state), generation), generation)) {
+        return false;
+    }
+
+    std::error_code error;
+    for (const auto& entry : fs::directory_iterator(m_options.directory, error)) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind("wal-", 0) == 0 && std::strtoul(name.c_str() + 4, nullptr, 10) < generation) {
+            fs::remove(entry.path(), error);
+        }
+    }
+    return true;
+}
+
+bool LogLedgerStore::writeSnapshot(const std::string& data, std::uint32_t generation) {
+    fs::path directory(m_options.directory);
+    std::string temporary = (directory / "snapshot.tmp").string();
+    std::FILE* file = std::fopen(temporary.c_str(), "wb");
+    bool ok = file && std::fwrite(data.data(), 1, data.size(), file) == data.size() &&
+              std::fflush(file) == 0 && syncFile(file);
+    if (file) {
+        ok = std::fclose(file) == 0 && ok;
+    }
+
+    std::error_code error;
+    if (ok) {
+        fs::rename(temporary, directory / "snapshot.bin", error);
+        ok = !error && syncDirectory(m_options.directory);
+    }
+    if (!ok) {
+        Lock lock(m_mutex);
+        return fail("Could not write snapshot " + std::to_string(generation) + " in " + m_options.directory);
+    }
+    return true;
+}
+
+void LogLedgerStore::maybeCheckpoint() {
+    std::lock_guard<std::mutex> lock(m_logMutex);
+    if (!m_checkpointing && m_appended - m_generationStart >= m_options.snapshotBytes) {
+        m_checkpointing = true;
+        m_checkpointDue.notify_one();
+    }
+}
+
+void LogLedgerStore::checkpointLoop() {
+    std::unique_lock<std::mutex> lock(m_logMutex);
+    while (true) {
+        m_checkpointDue.wait(lock, [this] { return m_checkpointing || m_stopping; });
+        if (m_stopping) {
+            break;
+        }
+        lock.unlock();
+        checkpoint();
+        lock.lock();
+        m_checkpointing = false;
+    }
+}
+
+} // namespace bank
@@ -0,0 +1,313 @@
+#include "Logger.hpp"
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <iostream>
+
+namespace bank {
+
+namespace {
+
+constexpr std::size_t kWriteBatchBytes = 64 * 1024;
+constexpr auto kIdleWait = std::chrono::seconds(1);
+
+void appendEscaped(std::string& out, std::string_view text) {
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+}
+
+} // namespace
+
+const char* logLevelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::Debug: return "debug";
+        case LogLevel::Info:  return "info";
+        case LogLevel::Warn:  return "warn";
+        case LogLevel::Error: return "error";
+        case LogLevel::Off:   return "off";
+    }
+    return "unknown";
+}
+
+std::optional<LogLevel> parseLogLevel(const std::string& name) {
+    for (LogLevel level : {LogLevel::Debug, LogLevel::Info, LogLevel::Warn, LogLevel::Error, LogLevel::Off}) {
+        if (name == logLevelName(level)) {
+            return level;
+        }
+    }
+    return std::nullopt;
+}
+
+namespace detail {
+
+std::uint32_t logThreadNumber() {
+    static std::atomic<std::uint32_t> next{1};
+    thread_local std::uint32_t number = next.fetch_add(1, std::memory_order_relaxed);
+    return number;
+}
+
+} // namespace detail
+
+Logger::Logger(LoggerOptions options)
+    : m_options(std::move(options))
+    , m_mask(0)
+    , m_enqueue(0)
+    , m_dequeue(0)
+    , m_dropped(0)
+    , m_written(0)
+    , m_sleeping(false)
+    , m_writtenPosition(0)
+    , m_stopping(false)
+    , m_fileBytes(0)
+    , m_droppedReported(0)
+    , m_stampSecond(-1)
+    , m_stamp{}
+{
+    std::size_t capacity = 2;
+    while (capacity < m_options.queueCapacity) {
+        capacity *= 2;
+    }
+    m_mask = capacity - 1;
+    m_cells = std::make_unique<Cell[]>(capacity);
+    for (std::size_t i = 0; i < capacity; ++i) {
+        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+Logger::~Logger() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        m_sleeping.store(false);
+    }
+    m_wake.notify_one();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+bool Logger::open() {
+    if (!m_options.path.empty() && !m_file.is_open()) {
+        m_file.open(m_options.path, std::ios::app | std::ios::binary);
+        if (!m_file) {
+            m_lastError = "Could not open " + m_options.path;
+            return false;
+        }
+        std::error_code error;
+        auto size = std::filesystem::file_size(m_options.path, error);
+        m_fileBytes = error ? 0 : size;
+    }
+    if (!m_thread.joinable()) {
+        m_thread = std::thread(&Logger::run, this);
+    }
+    return true;
+}
+
+void Logger::flush() {
+    if (!m_thread.joinable()) {
+        return;
+    }
+    std::size_t target = m_enqueue.load(std::memory_order_acquire);
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_sleeping.store(false);
+    m_wake.notify_one();
+    m_flushed.wait(lock, [&] { return m_writtenPosition >= target || m_stopping; });
+}
+
+Logger::Cell* Logger::claim(std::size_t& position) {
+    position = m_enqueue.load(std::memory_order_relaxed);
+    while (true) {
+        Cell& cell = m_cells[position & m_mask];
+        std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        auto lag = static_cast<std::ptrdiff_t>(sequence - position);
+        if (lag == 0) {
+            if (m_enqueue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                return &cell;
+            }
+        } else if (lag < 0) {
+            // The logging thread has not freed this cell yet: the queue is full
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        } else {
+            position = m_enqueue.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void Logger::publish(Cell* cell, std::size_t position) {
+    cell->sequence.store(position + 1, std::memory_order_release);
+
+    // Pairs with the fence in run(): either it sees this record or we see it sleeping
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_sleeping.load(std::memory_order_relaxed) && m_sleeping.exchange(false)) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_wake.notify_one();
+    }
+}
+
+bool Logger::hasPending() const {
+    const Cell& cell = m_cells[m_dequeue & m_mask];
+    return cell.sequence.load(std::memory_order_acquire) == m_dequeue + 1;
+}
+
+void Logger::run() {
+    std::string line;
+    while (true) {
+        while (hasPending()) {
+            Cell& cell = m_cells[m_dequeue & m_mask];
+            format(cell.record, line);
+            cell.sequence.store(m_dequeue + m_mask + 1, std::memory_order_release);
+            ++m_dequeue;
+            append(line);
+            m_written.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        std::uint64_t dropped = m_dropped.load(std::memory_order_relaxed);
+        if (dropped > m_droppedReported) {
+            LogRecord record{};
+            record.time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            record.event = "log_dropped";
+            record.level = LogLevel::Warn;
+            record.thread = detail::logThreadNumber();
+            detail::addLogFields(record, "count", dropped - m_droppedReported);
+            format(record, line);
+            append(line);
+            m_droppedReported = dropped;
+        }
+        writePending();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_writtenPosition = m_dequeue;
+        m_flushed.notify_all();
+        if (m_stopping && !hasPending()) {
+            return;
+        }
+
+        m_sleeping.store(true);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!hasPending()) {
+            m_wake.wait_for(lock, kIdleWait, [this] { return !m_sleeping.load() || m_stopping; });
+        }
+        m_sleeping.store(false);
+    }
+}
+
+void Logger::format(const LogRecord& record, std::string& out) {
+    out.clear();
+
+    // gmtime only once per second of timestamps
+    std::int64_t second = record.time / 1000000000;
+    if (second != m_stampSecond) {
+        std::time_t seconds = static_cast<std::time_t>(second);
+        std::tm utc{};
+        gmtime_r(&seconds, &utc);
+        std::strftime(m_stamp, sizeof(m_stamp), "%Y-%m-%dT%H:%M:%S", &utc);
+        m_stampSecond = second;
+    }
+    char number[32];
+    std::snprintf(number, sizeof(number), ".%06dZ", static_cast<int>(record.time % 1000000000 / 1000));
+
+    out += "{\"ts\":\"";
+    out += m_stamp;
+    out += number;
+    out += "\",\"level\":\"";
+    out += logLevelName(record.level);
+    out += "\",\"thread\":";
+    out += std::to_string(record.thread);
+    out += ",\"event\":\"";
+    appendEscaped(out, record.event);
+    out += '"';
+
+    for (std::size_t i = 0; i < record.fieldCount; ++i) {
+        const LogField& field = record.fields[i];
+        out += ",\"";
+        appendEscaped(out, field.key);
+        out += "\":";
+        switch (field.kind) {
+            case LogField::Kind::Int:
+                out += std::to_string(field.value.i);
+                break;
+            case LogField::Kind::Uint:
+                out += std::to_string(field.value.u);
+                break;
+            case LogField::Kind::Double:
+                if (field.value.d == field.value.d && field.value.d - field.value.d == 0) {
+                    std::snprintf(number, sizeof(number), "%.15g", field.value.d);
+                    out += number;
+                } else {
+                    out += "null";   // JSON has no NaN or infinity
+                }
+                break;
+            case LogField::Kind::Bool:
+                out += field.value.b ? "true" : "false";
+                break;
+            case LogField::Kind::Text:
+                out += '"';
+                appendEscaped(out, std::string_view(record.text + field.textOffset, field.textLength));
+                out += '"';
+                break;
+        }
+    }
+    out += "}\n";
+}
+
+void Logger::append(const std::string& line) {
+    if (m_file.is_open() && m_options.maxFileBytes > 0) {
+        std::uint64_t size = m_fileBytes + m_pending.size();
+        if (size > 0 && size + line.size() > m_options.maxFileBytes) {
+            writePending();
+            rotate();
+        }
+    }
+    m_pending += line;
+    if (m_pending.size() >= kWriteBatchBytes) {
+        writePending();
+    }
+}
+
+void Logger::writePending() {
+    if (m_pending.empty()) {
+        return;
+    }
+    if (m_file.is_open()) {
+        m_file.write(m_pending.data(), static_cast<std::streamsize>(m_pending.size()));
+        m_file.flush();
+        m_fileBytes += m_pending.size();
+    } else {
+        std::cerr.write(m_pending.data(), static_cast<std::streamsize>(m_pending.size()));
+        std::cerr.flush();
+    }
+    m_pending.clear();
+}
+
+void Logger::rotate() {
+    // path.N-1 -> path.N, ..., path -> path.1; rename replaces the oldest
+    m_file.close();
+    std::error_code error;
+    const std::string& path = m_options.path;
+    if (m_options.maxFiles > 0) {
+        for (int i = m_options.maxFiles - 1; i >= 1; --i) {
+            std::filesystem::rename(path + "." + std::to_string(i), path + "." + std::to_string(i + 1), error);
+        }
+        std::filesystem::rename(path, path + ".1", error);
+    }
+
+    m_file.open(path, std::ios::trunc | std::ios::binary);
+    m_fileBytes = 0;
+    if (!m_file) {
+        std::cerr << "Logger: could not reopen " << path << ", logging to stderr\n";
+    }
+}
+
+} // namespace bank
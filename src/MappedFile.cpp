@@ -0,0 +1,100 @@
+#include "MappedFile.hpp"
+#include <fstream>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define BANK_HAVE_MMAP 1
+#endif
+
+namespace bank {
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        m_mapped = other.m_mapped;
+        m_size = other.m_size;
+        if (m_mapped) {
+            m_data = other.m_data;
+        } else {
+            m_buffer = std::move(other.m_buffer);
+            m_data = m_buffer.empty() ? nullptr : m_buffer.data();
+        }
+        other.m_buffer.clear();
+        other.m_data = nullptr;
+        other.m_size = 0;
+        other.m_mapped = false;
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+#ifdef BANK_HAVE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void* addr = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        return false;
+    }
+
+    m_data = addr;
+    m_size = static_cast<std::size_t>(info.st_size);
+    m_mapped = true;
+    return true;
+#else
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        return false;
+    }
+    std::streamsize length = in.tellg();
+    if (length <= 0) {
+        return false;
+    }
+    m_buffer.resize(static_cast<std::size_t>(length));
+    in.seekg(0);
+    if (!in.read(m_buffer.data(), length)) {
+        m_buffer.clear();
+        return false;
+    }
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+    return true;
+#endif
+}
+
+void MappedFile::close() {
+#ifdef BANK_HAVE_MMAP
+    if (m_mapped && m_data != nullptr) {
+        ::munmap(const_cast<void*>(m_data), m_size);
+    }
+#endif
+    m_buffer.clear();
+    m_data = nullptr;
+    m_size = 0;
+    m_mapped = false;
+}
+
+} // namespace bank
@@ -0,0 +1,664 @@
+#include "MemoryLedgerStore.hpp"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <optional>
+#include <tuple>
+
+namespace bank {
+
+namespace {
+
+/**
+ * @brief Index of the first transaction created at or after t
+ */
+std::size_t lowerBound(const TransactionBatch& history, Timestamp t) {
+    std::size_t low = 0;
+    std::size_t high = history.size();
+    while (low < high) {
+        std::size_t mid = low + (high - low) / 2;
+        if (history.createdAtMicros(mid) < t.micros()) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+/**
+ * @brief Index of the first rollup starting at or after t
+ */
+std::size_t lowerBound(const std::vector<ActivityTotal>& rollups, Timestamp t) {
+    auto it = std::lower_bound(rollups.begin(), rollups.end(), t,
+                               [](const ActivityTotal& total, Timestamp start) { return total.start < start; });
+    return static_cast<std::size_t>(it - rollups.begin());
+}
+
+bool isCredit(TransactionType type) {
+    return type == TransactionType::Deposit || type == TransactionType::TransferIn;
+}
+
+/**
+ * @brief Add one total, or one transaction given as a total, to a running sum
+ */
+void accumulate(ActivityTotal& sum, const ActivityTotal& total) {
+    sum.credits += total.credits;
+    sum.debits += total.debits;
+    sum.count += total.count;
+    sum.closingBalance = total.closingBalance;
+}
+
+} // namespace
+
+MemoryLedgerStore::MemoryLedgerStore()
+    : m_descriptions(std::make_shared<StringPool>())
+    , m_nextUserId(1)
+    , m_nextAccountId(1)
+    , m_nextTransactionId(1)
+{
+}
+
+// Transaction scope
+
+bool MemoryLedgerStore::begin() {
+    m_mutex.lock();
+    m_scopeMarks.push_back(m_undoLog.size());
+    return true;
+}
+
+bool MemoryLedgerStore::commit() {
+    Lock lock(m_mutex);
+    if (m_scopeMarks.empty()) {
+        return fail("No transaction in progress");
+    }
+
+    // An inner commit keeps its undo entries for a rollback of the outer scope
+    m_scopeMarks.pop_back();
+    if (m_scopeMarks.empty()) {
+        m_undoLog.clear();
+    }
+    m_mutex.unlock();
+    return true;
+}
+
+bool MemoryLedgerStore::rollback() {
+    Lock lock(m_mutex);
+    if (m_scopeMarks.empty()) {
+        return fail("No transaction in progress");
+    }
+
+    std::size_t mark = m_scopeMarks.back();
+    m_scopeMarks.pop_back();
+    while (m_undoLog.size() > mark) {
+        m_undoLog.back()();
+        m_undoLog.pop_back();
+    }
+    m_mutex.unlock();
+    return true;
+}
+
+void MemoryLedgerStore::onUndo(std::function<void()> undo) {
+    if (!m_scopeMarks.empty()) {
+        m_undoLog.push_back(std::move(undo));
+    }
+}
+
+bool MemoryLedgerStore::fail(const std::string& error) {
+    m_lastError = error;
+    return false;
+}
+
+void MemoryLedgerStore::count(std::size_t rows) {
+    ++m_stats.operations;
+    m_stats.rows += rows;
+}
+
+// Users
+
+std::optional<int> MemoryLedgerStore::insertUser(const User& user) {
+    Lock lock(m_mutex);
+    count(1);
+    if (m_usernames.count(user.getUsername()) != 0 || m_emails.count(user.getEmail()) != 0) {
+        fail("Username or email already exists");
+        return std::nullopt;
+    }
+
+    int userId = m_nextUserId++;
+    User stored = user;
+    stored.setUserId(userId);
+    m_users.emplace(userId, stored);
+    m_usernames.emplace(user.getUsername(), userId);
+    m_emails.emplace(user.getEmail(), userId);
+
+    onUndo([this, userId, username = user.getUsername(), email = user.getEmail()]() {
+        m_users.erase(userId);
+        m_usernames.erase(username);
+        m_emails.erase(email);
+    });
+    return userId;
+}
+
+std::optional<User> MemoryLedgerStore::findUserById(int userId) {
+    Lock lock(m_mutex);
+    auto it = m_users.find(userId);
+    count(it != m_users.end() ? 1 : 0);
+    if (it == m_users.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+std::optional<User> MemoryLedgerStore::findUserByUsername(const std::string& username) {
+    Lock lock(m_mutex);
+    auto it = m_usernames.find(username);
+    count(it != m_usernames.end() ? 1 : 0);
+    if (it == m_usernames.end()) {
+        return std::nullopt;
+    }
+    return m_users.at(it->second);
+}
+
+std::optional<std::pair<int, std::string>> MemoryLedgerStore::findCredentials(const std::string& username) {
+    Lock lock(m_mutex);
+    auto it = m_usernames.find(username);
+    count(it != m_usernames.end() ? 1 : 0);
+    if (it == m_usernames.end()) {
+        return std::nullopt;
+    }
+    return std::make_pair(it->second, m_users.at(it->second).getPasswordHash());
+}
+
+bool MemoryLedgerStore::updateUser(const User& user) {
+    Lock lock(m_mutex);
+    count(0);
+    auto it = m_users.find(user.getUserId());
+    if (it == m_users.end()) {
+        // Like an UPDATE matching no rows: not an error
+        return true;
+    }
+
+    User old = it->second;
+    auto takenBy = [](const std::unordered_map<std::string, int>& index, const std::string& key) {
+        auto found = index.find(key);
+        return found == index.end() ? -1 : found->second;
+    };
+    int usernameOwner = takenBy(m_usernames, user.getUsername());
+    int emailOwner = takenBy(m_emails, user.getEmail());
+    if ((usernameOwner >= 0 && usernameOwner != old.getUserId()) ||
+        (emailOwner >= 0 && emailOwner != old.getUserId())) {
+        return fail("Username or email already exists");
+    }
+
+    // The password hash is not part of a profile update
+    User updated = user;
+    updated.setPasswordHash(old.getPasswordHash());
+    m_usernames.erase(old.getUsername());
+    m_emails.erase(old.getEmail());
+    m_usernames[updated.getUsername()] = updated.getUserId();
+    m_emails[updated.getEmail()] = updated.getUserId();
+    it->second = updated;
+    m_stats.rows += 1;
+
+    onUndo([this, old, updated]() {
+        m_usernames.erase(updated.getUsername());
+        m_emails.erase(updated.getEmail());
+        m_usernames[old.getUsername()] = old.getUserId();
+        m_emails[old.getEmail()] = old.getUserId();
+        m_users[old.getUserId()] = old;
+    });
+    return true;
+}
+
+bool MemoryLedgerStore::deleteUser(int userId) {
+    Lock lock(m_mutex);
+    count(0);
+    auto it = m_users.find(userId);
+    if (it == m_users.end()) {
+        return true;
+    }
+
+    auto owned = m_userAccounts.find(userId);
+    if (owned != m_userAccounts.end()) {
+        std::vector<int> accountIds = owned->second;
+        for (int accountId : accountIds) {
+            removeAccount(accountId);
+        }
+    }
+
+    User old = it->second;
+    m_users.erase(it);
+    m_usernames.erase(old.getUsername());
+    m_emails.erase(old.getEmail());
+    m_userAccounts.erase(userId);
+    m_stats.rows += 1;
+
+    onUndo([this, old]() {
+        m_users.emplace(old.getUserId(), old);
+        m_usernames.emplace(old.getUsername(), old.getUserId());
+        m_emails.emplace(old.getEmail(), old.getUserId());
+    });
+    return true;
+}
+
+// Accounts
+
+std::optional<int> MemoryLedgerStore::insertAccount(const Account& account) {
+    Lock lock(m_mutex);
+    count(1);
+    if (m_users.count(account.getUserId()) == 0) {
+        fail("User does not exist");
+        return std::nullopt;
+    }
+    std::string number(account.getAccountNumber());
+    if (m_accountNumbers.count(number) != 0) {
+        fail("Account number already exists");
+        return std::nullopt;
+    }
+
+    int accountId = m_nextAccountId++;
+    AccountEntry entry{account, TransactionBatch(m_descriptions), {}};
+    entry.account.setAccountId(accountId);
+    m_accounts.emplace(accountId, std::move(entry));
+    m_accountNumbers.emplace(number, accountId);
+    m_userAccounts[account.getUserId()].push_back(accountId);
+
+    onUndo([this, accountId, userId = account.getUserId(), number]() {
+        m_accounts.erase(accountId);
+        m_accountNumbers.erase(number);
+        auto& owned = m_userAccounts[userId];
+        owned.erase(std::remove(owned.begin(), owned.end(), accountId), owned.end());
+    });
+    return accountId;
+}
+
+std::optional<Account> MemoryLedgerStore::findAccountById(int accountId) {
+    Lock lock(m_mutex);
+    auto it = m_accounts.find(accountId);
+    count(it != m_accounts.end() ? 1 : 0);
+    if (it == m_accounts.end()) {
+        return std::nullopt;
+    }
+    return it->second.account;
+}
+
+std::optional<Account> MemoryLedgerStore::findAccountByNumber(const std::string& accountNumber) {
+    Lock lock(m_mutex);
+    auto it = m_accountNumbers.find(accountNumber);
+    count(it != m_accountNumbers.end() ? 1 : 0);
+    if (it == m_accountNumbers.end()) {
+        return std::nullopt;
+    }
+    return m_accounts.at(it->second).account;
+}
+
+bool MemoryLedgerStore::accountNumberExists(const std::string& accountNumber) {
+    Lock lock(m_mutex);
+    bool exists = m_accountNumbers.count(accountNumber) != 0;
+    count(exists ? 1 : 0);
+    return exists;
+}
+
+std::vector<Account> MemoryLedgerStore::findAccountsByUser(int userId) {
+    Lock lock(m_mutex);
+    std::vector<Account> accounts;
+    auto it = m_userAccounts.find(userId);
+    if (it != m_userAccounts.end()) {
+        accounts.reserve(it->second.size());
+        for (int accountId : it->second) {
+            accounts.push_back(m_accounts.at(accountId).account);
+        }
+    }
+    count(accounts.size());
+    return accounts;
+}
+
+bool MemoryLedgerStore::setAccountStatus(int accountId, AccountStatus status) {
+    Lock lock(m_mutex);
+    auto it = m_accounts.find(accountId);
+    count(it != m_accounts.end() ? 1 : 0);
+    if (it == m_accounts.end()) {
+        return true;
+    }
+
+    AccountStatus old = it->second.account.getStatus();
+    it->second.account.setStatus(status);
+    onUndo([this, accountId, old]() {
+        m_accounts.at(accountId).account.setStatus(old);
+    });
+    return true;
+}
+
+bool MemoryLedgerStore::deleteAccount(int accountId) {
+    Lock lock(m_mutex);
+    count(m_accounts.count(accountId));
+    removeAccount(accountId);
+    return true;
+}
+
+bool MemoryLedgerStore::removeAccount(int accountId) {
+    auto it = m_accounts.find(accountId);
+    if (it == m_accounts.end()) {
+        return false;
+    }
+
+    const TransactionBatch& history = it->second.history;
+    for (std::size_t i = 0; i < history.size(); ++i) {
+        m_transactions.erase(history.transactionId(i));
+    }
+    int userId = it->second.account.getUserId();
+    std::string number(it->second.account.getAccountNumber());
+    auto& owned = m_userAccounts[userId];
+    auto position = std::find(owned.begin(), owned.end(), accountId);
+    std::size_t index = static_cast<std::size_t>(position - owned.begin());
+    owned.erase(position);
+    m_accountNumbers.erase(number);
+
+    if (m_scopeMarks.empty()) {
+        m_accounts.erase(it);
+        return true;
+    }
+
+    auto entry = std::make_shared<AccountEntry>(std::move(it->second));
+    m_accounts.erase(it);
+    onUndo([this, accountId, userId, number, index, entry]() {
+        for (std::size_t i = 0; i < entry->history.size(); ++i) {
+            m_transactions[entry->history.transactionId(i)] = {accountId, i};
+        }
+        auto& restored = m_userAccounts[userId];
+        restored.insert(restored.begin() + static_cast<std::ptrdiff_t>(std::min(index, restored.size())),
+accountId);
+        m_accountNumbers.emplace(number, accountId);
+        m_accounts.emplace(accountId, std::move(*entry));
+    });
+    return true;
+}
+
+std::vector<Account> MemoryLedgerStore::lockAccounts(std::vector<int> accountIds) {
+    // The scope already holds the store lock, so this only reads
+    Lock lock(m_mutex);
+    std::sort(accountIds.begin(), accountIds.end());
+    accountIds.erase(std::unique(accountIds.begin(), accountIds.end()), accountIds.end());
+
+    std::vector<Account> accounts;
+    for (int accountId : accountIds) {
+        auto it = m_accounts.find(accountId);
+        if (it != m_accounts.end()) {
+            accounts.push_back(it->second.account);
+        }
+    }
+    count(accounts.size());
+    return accounts;
+}
+
+std::optional<double> MemoryLedgerStore::adjustBalance(int accountId, double delta) {
+    Lock lock(m_mutex);
+    count(0);
+    auto it = m_accounts.find(accountId);
+    if (it == m_accounts.end() || it->second.account.getStatus() != AccountStatus::Active) {
+        return std::nullopt;
+    }
+
+    // Balances are stored with two decimals, like DECIMAL(15, 2)
+    double old = it->second.account.getBalance();
+    double updated = std::round((old + delta) * 100.0) / 100.0;
+    if (updated < 0) {
+        return std::nullopt;
+    }
+
+    it->second.account.setBalance(updated);
+    m_stats.rows += 1;
+    onUndo([this, accountId, old]() {
+        m_accounts.at(accountId).account.setBalance(old);
+    });
+    return updated;
+}
+
+double MemoryLedgerStore::totalBalance(int userId) {
+    Lock lock(m_mutex);
+    count(1);
+    double total = 0.0;
+    auto it = m_userAccounts.find(userId);
+    if (it != m_userAccounts.end()) {
+        for (int accountId : it->second) {
+            total += m_accounts.at(accountId).account.getBalance();
+        }
+    }
+    return total;
+}
+
+// Transactions
+
+bool MemoryLedgerStore::appendTransaction(const Transaction& transaction) {
+    return appendTransactionAt(transaction, Timestamp::now());
+}
+
+bool MemoryLedgerStore::appendTransactionAt(const Transaction& transaction, Timestamp createdAt) {
+    Lock lock(m_mutex);
+    count(1);
+    auto it = m_accounts.find(transaction.getAccountId());
+    if (it == m_accounts.end()) {
+        return fail("Account does not exist");
+    }
+
+    Transaction stored = transaction;
+    stored.setTransactionId(m_nextTransactionId++);
+
+    // Never earlier than the previous one, even if the clock steps back, so
+    // range scans can binary search the history and the transaction is the
+    // newest of its rollups
+    AccountEntry& entry = it->second;
+    if (!entry.history.empty()) {
+        Timestamp last = Timestamp::fromMicros(entry.history.createdAtMicros(entry.history.size() - 1));
+        createdAt = std::max(createdAt, last);
+    }
+    m_transactions[stored.getTransactionId()] = {transaction.getAccountId(), entry.history.size()};
+    entry.history.push_back(stored, createdAt.micros());
+
+    // Each rollup either gains a new last period or updates it; keep what it
+    // replaced. A transaction in the last hour is in the last day and month
+    // too, so those are only looked up when the hour changes.
+    ActivityTotal added;
+    (isCredit(stored.getType()) ? added.credits : added.debits) = stored.getAmount();
+    added.count = 1;
+    added.closingBalance = stored.getBalanceAfter();
+    std::array<std::optional<ActivityTotal>, std::tuple_size_v<decltype(entry.rollups)>> replaced;
+    const std::vector<ActivityTotal>& hours = entry.rollups[static_cast<std::size_t>(TimeUnit::Hour)];
+    Timestamp hour = createdAt.startOf(TimeUnit::Hour);
+    bool sameHour = !hours.empty() && hours.back().start == hour;
+    for (std::size_t unit = 0; unit < entry.rollups.size(); ++unit) {
+        std::vector<ActivityTotal>& rollup = entry.rollups[unit];
+        auto timeUnit = static_cast<TimeUnit>(unit);
+        Timestamp start = sameHour ? rollup.back().start
+                                   : timeUnit == TimeUnit::Hour ? hour : createdAt.startOf(timeUnit);
+        if (!rollup.empty() && rollup.back().start == start) {
+            replaced[unit] = rollup.back();
+        } else {
+            rollup.push_back({start});
+        }
+        accumulate(rollup.back(), added);
+    }
+
+    onUndo([this, accountId = transaction.getAccountId(), replaced]() {
+        AccountEntry& undone = m_accounts.at(accountId);
+        m_transactions.erase(undone.history.transactionId(undone.history.size() - 1));
+        undone.history.pop_back();
+        for (std::size_t unit = 0; unit < undone.rollups.size(); ++unit) {
+            if (replaced[unit]) {
+                undone.rollups[unit].back() = *replaced[unit];
+            } else {
+                undone.rollups[unit].pop_back();
+            }
+        }
+    });
+    return true;
+}
+
+std::vector<Transaction> MemoryLedgerStore::scanHistory(int accountId, int limit) {
+    Lock lock(m_mutex);
+    std::vector<Transaction> transactions;
+    auto it = m_accounts.find(accountId);
+    if (it != m_accounts.end() && limit > 0) {
+        const TransactionBatch& history = it->second.history;
+        std::size_t n = std::min(history.size(), static_cast<std::size_t>(limit));
+        transactions.reserve(n);
+        for (std::size_t i = history.size(); i > history.size() - n; --i) {
+            transactions.push_back(history.at(i - 1));
+        }
+    }
+    count(transactions.size());
+    return transactions;
+}
+
+std::optional<Transaction> MemoryLedgerStore::findTransaction(int transactionId) {
+    Lock lock(m_mutex);
+    auto it = m_transactions.find(transactionId);
+    count(it != m_transactions.end() ? 1 : 0);
+    if (it == m_transactions.end()) {
+        return std::nullopt;
+    }
+    return m_accounts.at(it->second.first).history.at(it->second.second);
+}
+
+std::vector<Transaction> MemoryLedgerStore::scanHistoryBetween(int accountId, const TimeRange& range,
+                                                               int limit)
+{
+    Lock lock(m_mutex);
+    std::vector<Transaction> transactions;
+    auto it = m_accounts.find(accountId);
+    if (it != m_accounts.end() && limit > 0 && range.from < range.to) {
+        const TransactionBatch& history = it->second.history;
+        std::size_t begin = lowerBound(history, range.from);
+        std::size_t end = std::min(lowerBound(history, range.to), begin + static_cast<std::size_t>(limit));
+        transactions.reserve(end > begin ? end - begin : 0);
+        for (std::size_t i = begin; i < end; ++i) {
+            transactions.push_back(history.at(i));
+        }
+    }
+    count(transactions.size());
+    return transactions;
+}
+
+std::vector<ActivityTotal> MemoryLedgerStore::dailyTotals(int accountId, const TimeRange& range) {
+    Lock lock(m_mutex);
+    std::vector<ActivityTotal> totals;
+    auto it = m_accounts.find(accountId);
+    if (it != m_accounts.end()) {
+        const TransactionBatch& history = it->second.history;
+        for (std::size_t i = lowerBound(history, range.from);
+             i < history.size() && history.createdAtMicros(i) < range.to.micros(); ++i) {
+            Timestamp day = Timestamp::fromMicros(history.createdAtMicros(i)).startOf(TimeUnit::Day);
+            if (totals.empty() || totals.back().start != day) {
+                totals.emplace_back();
+                totals.back().start = day;
+            }
+            ActivityTotal& total = totals.back();
+            (isCredit(history.type(i)) ? total.credits : total.debits) += history.amount(i);
+            ++total.count;
+            total.closingBalance = history.balanceAfter(i);
+        }
+    }
+    count(totals.size());
+    return totals;
+}
+
+std::vector<ActivityTotal> MemoryLedgerStore::rollups(int accountId, TimeUnit unit, const TimeRange& range) {
+    Lock lock(m_mutex);
+    std::vector<ActivityTotal> totals;
+    auto it = m_accounts.find(accountId);
+    if (it != m_accounts.end() && !range.empty()) {
+        const std::vector<ActivityTotal>& rollup = it->second.rollups[static_cast<std::size_t>(unit)];
+        totals.assign(rollup.begin() + static_cast<std::ptrdiff_t>(lowerBound(rollup, range.from)),
+                      rollup.begin() + static_cast<std::ptrdiff_t>(lowerBound(rollup, range.to)));
+    }
+    count(totals.size());
+    return totals;
+}
+
+ActivityTotal MemoryLedgerStore::summarizeActivity(int accountId, const RangeCover& cover) {
+    Lock lock(m_mutex);
+    ActivityTotal summary;
+    summary.start = cover.rest[0].from;
+    std::size_t rows = 0;
+    auto it = m_accounts.find(accountId);
+    if (it == m_accounts.end()) {
+        count(rows);
+        return summary;
+    }
+
+    const AccountEntry& entry = it->second;
+    auto addRollups = [&](TimeUnit unit, const TimeRange& range) {
+        if (range.empty()) {
+            return;
+        }
+        const std::vector<ActivityTotal>& rollup = entry.rollups[static_cast<std::size_t>(unit)];
+        for (std::size_t i = lowerBound(rollup, range.from), end = lowerBound(rollup, range.to); i < end; ++i) {
+            accumulate(summary, rollup[i]);
+            ++rows;
+        }
+    };
+    auto addTransactions = [&](const TimeRange& range) {
+        if (range.empty()) {
+            return;
+        }
+        const TransactionBatch& history = entry.history;
+        for (std::size_t i = lowerBound(history, range.from), end = lowerBound(history, range.to); i < end; ++i) {
+            ActivityTotal one;
+            (isCredit(history.type(i)) ? one.credits : one.debits) = history.amount(i);
+            one.count = 1;
+            one.closingBalance = history.balanceAfter(i);
+            accumulate(summary, one);
+            ++rows;
+        }
+    };
+
+    // In time order, so the last piece with activity sets the closing balance
+    addTransactions(cover.rest[0]);
+    addRollups(TimeUnit::Hour, cover.hours[0]);
+    addRollups(TimeUnit::Day, cover.days[0]);
+    addRollups(TimeUnit::Month, cover.months);
+    addRollups(TimeUnit::Day, cover.days[1]);
+    addRollups(TimeUnit::Hour, cover.hours[1]);
+    addTransactions(cover.rest[1]);
+    count(rows);
+    return summary;
+}
+
+std::vector<BalancePoint> MemoryLedgerStore::balanceHistory(int accountId, int maxPoints) {
+    Lock lock(m_mutex);
+    std::vector<BalancePoint> points;
+    auto it = m_accounts.find(accountId);
+    if (it == m_accounts.end() || maxPoints <= 0 || it->second.history.empty()) {
+        count(0);
+        return points;
+    }
+
+    // Same buckets as NTILE: the first (n % buckets) buckets get one extra row
+    const AccountEntry& entry = it->second;
+    std::size_t n = entry.history.size();
+    std::size_t buckets = std::min(n, static_cast<std::size_t>(maxPoints));
+    std::size_t base = n / buckets;
+    std::size_t extra = n % buckets;
+    points.reserve(buckets);
+
+    std::size_t end = 0;
+    for (std::size_t b = 0; b < buckets; ++b) {
+        end += base + (b < extra ? 1 : 0);
+        points.push_back({static_cast<double>(entry.history.createdAtMicros(end - 1)) / 1e6,
+                          entry.history.balanceAfter(end - 1)});
+    }
+    count(points.size());
+    return points;
+}
+
+StoreStats MemoryLedgerStore::getStats() const {
+    Lock lock(m_mutex);
+    return m_stats;
+}
+
+std::string MemoryLedgerStore::getLastError() const {
+    Lock lock(m_mutex);
+    return m_lastError;
+}
+
+} // namespace bank
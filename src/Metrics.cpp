@@ -0,0 +1,320 @@
+#include "Metrics.hpp"
+#include "AllocationTracker.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <memory>
+
+namespace bank {
+
+namespace {
+
+// Prometheus histogram bounds in seconds, from 100 us to 10 s
+constexpr const char* kBucketLabels[] = {
+    "0.0001", "0.00025", "0.0005", "0.001", "0.0025", "0.005", "0.01",
+    "0.025", "0.05", "0.1", "0.25", "0.5", "1", "2.5", "5", "10"
+};
+constexpr std::uint64_t kBucketNanos[] = {
+    100000, 250000, 500000, 1000000, 2500000, 5000000, 10000000,
+    25000000, 50000000, 100000000, 250000000, 500000000, 1000000000,
+    2500000000, 5000000000, 10000000000
+};
+
+int magnitudeOf(std::uint64_t value) {
+    int magnitude = 0;
+    while (value >>= 1) {
+        ++magnitude;
+    }
+    return magnitude;
+}
+
+std::string escapeLabel(const std::string& value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            escaped += '\\';
+            escaped += c;
+        } else if (c == '\n') {
+            escaped += "\\n";
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+std::string formatSeconds(std::uint64_t nanos) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.9g", static_cast<double>(nanos) / 1e9);
+    return buffer;
+}
+
+/**
+ * @brief Append a counter family with one sample per series
+ */
+void renderCounter(std::string& out, const char* name, const char* help, const char* label,
+                   const std::vector<const MetricSeries*>& series,
+                   const std::atomic<std::uint64_t> MetricSeries::*field)
+{
+    out += "# HELP "; out += name; out += ' '; out += help; out += '\n';
+    out += "# TYPE "; out += name; out += " counter\n";
+    for (const MetricSeries* s : series) {
+        out += name; out += '{'; out += label; out += "=\"";
+        out += escapeLabel(s->label); out += "\"} ";
+        out += std::to_string((s->*field).load(std::memory_order_relaxed));
+        out += '\n';
+    }
+}
+
+/**
+ * @brief Append a histogram family with cumulative le buckets per series
+ *
+ * A fine bucket straddling an le bound is counted in the next bound up,
+ * so counts are never reported below a bound they may exceed.
+ */
+void renderHistogram(std::string& out, const char* name, const char* help, const char* label,
+                     const std::vector<const MetricSeries*>& series)
+{
+    out += "# HELP "; out += name; out += ' '; out += help; out += '\n';
+    out += "# TYPE "; out += name; out += " histogram\n";
+    for (const MetricSeries* s : series) {
+        HistogramSnapshot snapshot = s->latency.snapshot();
+        std::string labels = std::string(label) + "=\"" + escapeLabel(s->label) + "\"";
+
+        for (std::size_t i = 0; i < std::size(kBucketNanos); ++i) {
+            out += name; out += "_bucket{"; out += labels;
+            out += ",le=\""; out += kBucketLabels[i]; out += "\"} ";
+            out += std::to_string(snapshot.countAtOrBelow(kBucketNanos[i]));
+            out += '\n';
+        }
+        out += name; out += "_bucket{"; out += labels; out += ",le=\"+Inf\"} ";
+        out += std::to_string(snapshot.count); out += '\n';
+        out += name; out += "_sum{"; out += labels; out += "} ";
+        out += formatSeconds(snapshot.sumNanos); out += '\n';
+        out += name; out += "_count{"; out += labels; out += "} ";
+        out += std::to_string(snapshot.count); out += '\n';
+    }
+}
+
+} // namespace
+
+// Histograms
+
+std::uint64_t HistogramSnapshot::percentile(double q) const {
+    if (count == 0) {
+        return 0;
+    }
+    q = std::clamp(q, 0.0, 1.0);
+    auto target = static_cast<std::uint64_t>(std::ceil(q * static_cast<double>(count)));
+    target = std::max<std::uint64_t>(target, 1);
+
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= target) {
+            return std::min(LatencyHistogram::bucketHighest(i), maxNanos);
+        }
+    }
+    return maxNanos;
+}
+
+std::uint64_t HistogramSnapshot::countAtOrBelow(std::uint64_t nanos) const {
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i < counts.size() && LatencyHistogram::bucketHighest(i) <= nanos; ++i) {
+        total += counts[i];
+    }
+    return total;
+}
+
+LatencyHistogram::LatencyHistogram()
+    : m_sumNanos(0)
+    , m_maxNanos(0)
+{
+    for (auto& count : m_counts) {
+        count.store(0, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::record(std::uint64_t nanos) {
+    m_counts[bucketOf(nanos)].fetch_add(1, std::memory_order_relaxed);
+    m_sumNanos.fetch_add(nanos, std::memory_order_relaxed);
+
+    std::uint64_t max = m_maxNanos.load(std::memory_order_relaxed);
+    while (nanos > max && !m_maxNanos.compare_exchange_weak(max, nanos, std::memory_order_relaxed)) {
+    }
+}
+
+HistogramSnapshot LatencyHistogram::snapshot() const {
+    // Records may land between loads, so the count is summed from the buckets seen
+    HistogramSnapshot snapshot;
+    snapshot.counts.resize(kBuckets);
+    for (std::size_t i = 0; i < kBuckets; ++i) {
+        snapshot.counts[i] = m_counts[i].load(std::memory_order_relaxed);
+        snapshot.count += snapshot.counts[i];
+    }
+    snapshot.sumNanos = m_sumNanos.load(std::memory_order_relaxed);
+    snapshot.maxNanos = m_maxNanos.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+std::size_t LatencyHistogram::bucketOf(std::uint64_t nanos) {
+    if (nanos < kSubBuckets) {
+        return static_cast<std::size_t>(nanos);
+    }
+    int magnitude = magnitudeOf(nanos);
+    if (magnitude >= kMaxMagnitude) {
+        return kBuckets - 1;
+    }
+
+    // The top kSubBucketBits + 1 bits pick the bucket within the power of two
+    int shift = magnitude - kSubBucketBits;
+    return static_cast<std::size_t>(kSubBuckets * (shift + 1) + ((nanos >> shift) - kSubBuckets));
+}
+
+std::uint64_t LatencyHistogram::bucketLowest(std::size_t bucket) {
+    if (bucket < kSubBuckets) {
+        return bucket;
+    }
+    std::size_t shift = bucket / kSubBuckets - 1;
+    std::uint64_t sub = bucket % kSubBuckets + kSubBuckets;
+    return sub << shift;
+}
+
+std::uint64_t LatencyHistogram::bucketHighest(std::size_t bucket) {
+    if (bucket + 1 >= kBuckets) {
+        return UINT64_MAX;
+    }
+    return bucketLowest(bucket + 1) - 1;
+}
+
+void MetricSeries::record(std::uint64_t nanos, std::uint64_t rowCount, bool ok) {
+    calls.fetch_add(1, std::memory_order_relaxed);
+    if (!ok) {
+        errors.fetch_add(1, std::memory_order_relaxed);
+    }
+    rows.fetch_add(rowCount, std::memory_order_relaxed);
+    latency.record(nanos);
+}
+
+void MetricSeries::recordRoundTrips(std::uint64_t count) {
+    roundTrips.fetch_add(count, std::memory_order_relaxed);
+}
+
+void MetricSeries::recordAllocations(std::uint64_t count, std::uint64_t bytes) {
+    allocations.fetch_add(count, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+// Registry
+
+MetricsRegistry::Family::Family()
+    : m_other("other")
+{
+    for (auto& slot : m_slots) {
+        slot.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+MetricsRegistry::Family::~Family() {
+    for (auto& slot : m_slots) {
+        delete slot.load(std::memory_order_relaxed);
+    }
+}
+
+MetricSeries& MetricsRegistry::Family::find(const std::string& label) {
+    std::size_t start = std::hash<std::string>{}(label) % kMaxSeries;
+    std::unique_ptr<MetricSeries> created;
+
+    for (std::size_t probe = 0; probe < kMaxSeries; ++probe) {
+        auto& slot = m_slots[(start + probe) % kMaxSeries];
+        MetricSeries* series = slot.load(std::memory_order_acquire);
+        if (series == nullptr) {
+            if (!created) {
+                created = std::make_unique<MetricSeries>(label);
+            }
+            // Losing the race leaves the winner in series; it may hold this label
+            if (slot.compare_exchange_strong(series, created.get(), std::memory_order_acq_rel)) {
+                return *created.release();
+            }
+        }
+        if (series->label == label) {
+            return *series;
+        }
+    }
+    return m_other;
+}
+
+std::vector<const MetricSeries*> MetricsRegistry::Family::list() const {
+    std::vector<const MetricSeries*> series;
+    for (const auto& slot : m_slots) {
+        if (const MetricSeries* s = slot.load(std::memory_order_acquire)) {
+            series.push_back(s);
+        }
+    }
+    std::sort(series.begin(), series.end(), [](const MetricSeries* a, const MetricSeries* b) {
+        return a->label < b->label;
+    });
+    if (m_other.calls.load(std::memory_order_relaxed) > 0) {
+        series.push_back(&m_other);
+    }
+    return series;
+}
+
+MetricsRegistry::MetricsRegistry() = default;
+MetricsRegistry::~MetricsRegistry() = default;
+
+std::string MetricsRegistry::renderPrometheus() const {
+    std::vector<const MetricSeries*> statements = m_statements.list();
+    std::vector<const MetricSeries*> operations = m_operations.list();
+
+    std::string out;
+    renderCounter(out, "bank_db_statements_total", "Statements sent, by verb and table.",
+                  "statement", statements, &MetricSeries::calls);
+    renderCounter(out, "bank_db_statement_errors_total", "Statements that failed.",
+                  "statement", statements, &MetricSeries::errors);
+    renderCounter(out, "bank_db_rows_total", "Rows returned or affected.",
+                  "statement", statements, &MetricSeries::rows);
+    renderHistogram(out, "bank_db_statement_duration_seconds",
+                    "Time from sending a statement to having its result.",
+                    "statement", statements);
+
+    renderCounter(out, "bank_service_calls_total", "Service operations called.",
+                  "operation", operations, &MetricSeries::calls);
+    renderCounter(out, "bank_service_errors_total", "Service operations that failed.",
+                  "operation", operations, &MetricSeries::errors);
+    renderCounter(out, "bank_service_round_trips_total", "Database round trips made by operations.",
+                  "operation", operations, &MetricSeries::roundTrips);
+    renderCounter(out, "bank_service_rows_total", "Rows returned or affected by operations.",
+                  "operation", operations, &MetricSeries::rows);
+    renderHistogram(out, "bank_service_call_duration_seconds",
+                    "Time spent in service operations, including the database.",
+                    "operation", operations);
+    if (alloc::kEnabled) {
+        renderCounter(out, "bank_service_allocations_total", "Heap allocations made by operations.",
+                      "operation", operations, &MetricSeries::allocations);
+        renderCounter(out, "bank_service_allocated_bytes_total", "Heap bytes allocated by operations.",
+                      "operation", operations, &MetricSeries::allocatedBytes);
+    }
+    return out;
+}
+
+bool MetricsRegistry::writeFile(const std::string& path) const {
+    std::string text = renderPrometheus();
+
+    // Scrapers of the old file never see a partial one
+    std::string temporary = path + ".tmp";
+    std::FILE* file = std::fopen(temporary.c_str(), "wb");
+    bool ok = file && std::fwrite(text.data(), 1, text.size(), file) == text.size();
+    if (file) {
+        ok = std::fclose(file) == 0 && ok;
+    }
+    if (!ok || std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+} // namespace bank
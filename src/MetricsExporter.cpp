@@ -0,0 +1,207 @@
+#include "MetricsExporter.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace bank {
+
+namespace {
+
+constexpr std::size_t kMaxRequest = 8 * 1024;
+
+bool sendAll(int fd, const std::string& data) {
+    std::size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        sent += static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+std::string httpResponse(const char* status, const char* contentType, const std::string& body) {
+    return std::string("HTTP/1.1 ") + status + "\r\n"
+           "Content-Type: " + contentType + "\r\n"
+           "Content-Length: " + std::to_string(body.size()) + "\r\n"
+           "Connection: close\r\n\r\n" + body;
+}
+
+} // namespace
+
+MetricsExporter::MetricsExporter(std::shared_ptr<const MetricsRegistry> metrics,
+                                 MetricsExporterOptions options)
+    : m_metrics(std::move(metrics))
+    , m_options(std::move(options))
+    , m_listenFd(-1)
+    , m_wakeFd(-1)
+    , m_running(false)
+{
+}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+    for (int fd : {m_listenFd, m_wakeFd}) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+}
+
+bool MetricsExporter::start() {
+    m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_wakeFd < 0) {
+        m_lastError = std::string("Could not create eventfd: ") + std::strerror(errno);
+        return false;
+    }
+    if (m_options.port > 0 && !listenTcp()) {
+        return false;
+    }
+    if (!m_options.path.empty() && !m_metrics->writeFile(m_options.path)) {
+        m_lastError = "Could not write " + m_options.path;
+        return false;
+    }
+
+    m_running = true;
+    m_thread = std::thread(&MetricsExporter::run, this);
+    return true;
+}
+
+void MetricsExporter::stop() {
+    if (!m_running.exchange(false)) {
+        return;
+    }
+    std::uint64_t one = 1;
+    ssize_t written = ::write(m_wakeFd, &one, sizeof(one));
+    (void)written;  // A full counter already guarantees a wakeup
+    m_thread.join();
+    if (!m_options.path.empty()) {
+        writeFile();
+    }
+}
+
+bool MetricsExporter::listenTcp() {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    addrinfo* addresses = nullptr;
+    std::string port = std::to_string(m_options.port);
+    int rc = getaddrinfo(m_options.host.c_str(), port.c_str(), &hints, &addresses);
+    if (rc != 0) {
+        m_lastError = "Could not resolve " + m_options.host + ": " + gai_strerror(rc);
+        return false;
+    }
+
+    for (addrinfo* address = addresses; address != nullptr; address = address->ai_next) {
+        int fd = socket(address->ai_family, address->ai_socktype | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            continue;
+        }
+        int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        if (bind(fd, address->ai_addr, address->ai_addrlen) == 0 && listen(fd, 16) == 0) {
+            m_listenFd = fd;
+            break;
+        }
+        m_lastError = std::strerror(errno);
+        ::close(fd);
+    }
+    freeaddrinfo(addresses);
+
+    if (m_listenFd < 0) {
+        m_lastError = "Could not listen on " + m_options.host + ":" + port + ": " + m_lastError;
+        return false;
+    }
+    return true;
+}
+
+void MetricsExporter::run() {
+    auto nextWrite = std::chrono::steady_clock::now() + m_options.interval;
+
+    while (m_running) {
+        pollfd fds[2] = {{m_wakeFd, POLLIN, 0}, {m_listenFd, POLLIN, 0}};
+        nfds_t count = m_listenFd >= 0 ? 2 : 1;
+        int timeout = -1;
+        if (!m_options.path.empty()) {
+            auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(
+                nextWrite - std::chrono::steady_clock::now());
+            timeout = std::max(0, static_cast<int>(wait.count()));
+        }
+        int ready = ::poll(fds, count, timeout);
+        if (ready < 0 && errno != EINTR) {
+            std::cerr << "Metrics exporter: poll failed: " << std::strerror(errno) << "\n";
+            return;
+        }
+
+        if (count == 2 && (fds[1].revents & POLLIN)) {
+            int client = accept4(m_listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client >= 0) {
+                serve(client);
+                ::close(client);
+            }
+        }
+        if (!m_options.path.empty() && std::chrono::steady_clock::now() >= nextWrite) {
+            writeFile();
+            nextWrite += m_options.interval;
+        }
+    }
+}
+
+void MetricsExporter::serve(int fd) {
+    // A stalled client must not hold up the file or other scrapers for long
+    timeval timeout{1, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < kMaxRequest) {
+        ssize_t n = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return;
+        }
+        request.append(buffer, static_cast<std::size_t>(n));
+    }
+
+    std::string line = request.substr(0, request.find("\r\n"));
+    if (line.compare(0, 4, "GET ") != 0 && line.compare(0, 5, "HEAD ") != 0) {
+        sendAll(fd, httpResponse("405 Method Not Allowed", "text/plain", "Only GET is supported\n"));
+        return;
+    }
+    std::size_t target = line.find(' ') + 1;
+    std::string path = line.substr(target, line.find(' ', target) - target);
+    if (path != "/metrics" && path.compare(0, 9, "/metrics?") != 0) {
+        sendAll(fd, httpResponse("404 Not Found", "text/plain", "Metrics are served at /metrics\n"));
+        return;
+    }
+
+    std::string response = httpResponse("200 OK", "text/plain; version=0.0.4; charset=utf-8",
+                                         m_metrics->renderPrometheus());
+    if (line[0] == 'H') {
+        response.resize(response.find("\r\n\r\n") + 4);
+    }
+    sendAll(fd, response);
+}
+
+void MetricsExporter::writeFile() {
+    if (!m_metrics->writeFile(m_options.path)) {
+        std::cerr << "Metrics exporter: could not write " << m_options.path << "\n";
+    }
+}
+
+} // namespace bank
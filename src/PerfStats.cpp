@@ -0,0 +1,47 @@
+#include "PerfStats.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace bank {
+
+SampleWindow::SampleWindow(std::size_t capacity)
+    : m_samples(capacity > 0 ? capacity : 1, 0.0)
+    , m_next(0)
+    , m_count(0)
+{
+}
+
+void SampleWindow::add(double value) {
+    m_samples[m_next] = value;
+    m_next = (m_next + 1) % m_samples.size();
+    if (m_count < m_samples.size()) {
+        ++m_count;
+    }
+}
+
+void SampleWindow::clear() {
+    m_next = 0;
+    m_count = 0;
+}
+
+double SampleWindow::percentile(double p) const {
+    if (m_count == 0) {
+        return 0.0;
+    }
+
+    std::vector<double> sorted(m_samples.begin(), m_samples.begin() + static_cast<long>(m_count));
+    p = std::clamp(p, 0.0, 100.0);
+    std::size_t rank = static_cast<std::size_t>(std::ceil(p / 100.0 * static_cast<double>(m_count)));
+    std::size_t index = rank > 0 ? rank - 1 : 0;
+    std::nth_element(sorted.begin(), sorted.begin() + static_cast<long>(index), sorted.end());
+    return sorted[index];
+}
+
+double SampleWindow::max() const {
+    if (m_count == 0) {
+        return 0.0;
+    }
+    return *std::max_element(m_samples.begin(), m_samples.begin() + static_cast<long>(m_count));
+}
+
+} // namespace bank
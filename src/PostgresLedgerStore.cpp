@@ -0,0 +1,346 @@
+#include "PostgresLedgerStore.hpp"
+#include "LedgerRows.hpp"
+#include "LedgerStatements.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace bank {
+
+namespace {
+
+constexpr int kMaxReservedRows = 1000;   // Cap on reserving a whole history page up front
+
+Transaction makeTransaction(int transactionId, int accountId, TransactionType type, double amount,
+                            double balanceAfter, std::string description,
+                            std::optional<int> relatedAccountId, Timestamp createdAt)
+{
+    Transaction transaction;
+    transaction.setTransactionId(transactionId);
+    transaction.setAccountId(accountId);
+    transaction.setType(type);
+    transaction.setAmount(amount);
+    transaction.setBalanceAfter(balanceAfter);
+    transaction.setDescription(std::move(description));
+    transaction.setRelatedAccountId(relatedAccountId.value_or(-1));
+    transaction.setCreatedAt(createdAt);
+    return transaction;
+}
+
+} // namespace
+
+PostgresLedgerStore::PostgresLedgerStore(std::shared_ptr<Database> db)
+    : m_db(db)
+{
+}
+
+bool PostgresLedgerStore::begin() {
+    return m_db->beginTransaction();
+}
+
+bool PostgresLedgerStore::commit() {
+    return m_db->commitTransaction();
+}
+
+bool PostgresLedgerStore::rollback() {
+    return m_db->rollbackTransaction();
+}
+
+// Users
+
+std::optional<int> PostgresLedgerStore::insertUser(const User& user) {
+    std::optional<int> userId;
+    sql::query(*m_db, ledger::kInsertUser, [&](int id) { userId = id; },
+               user.getUsername(), user.getPasswordHash(), user.getFullName(),
+               user.getEmail(), user.getPhone());
+    return userId;
+}
+
+std::optional<User> PostgresLedgerStore::findUserById(int userId) {
+    std::optional<User> user;
+    sql::query(*m_db, ledger::kFindUserById, [&](auto&&... columns) { user.emplace(columns...); }, userId);
+    return user;
+}
+
+std::optional<User> PostgresLedgerStore::findUserByUsername(const std::string& username) {
+    std::optional<User> user;
+    sql::query(*m_db, ledger::kFindUserByUsername, [&](auto&&... columns) { user.emplace(columns...); },
+               username);
+    return user;
+}
+
+std::optional<std::pair<int, std::string>> PostgresLedgerStore::findCredentials(const std::string& username) {
+    std::optional<std::pair<int, std::string>> credentials;
+    sql::query(*m_db, ledger::kFindCredentials, [&](int userId, std::string passwordHash) {
+        credentials.emplace(userId, std::move(passwordHash));
+    }, username);
+    return credentials;
+}
+
+bool PostgresLedgerStore::updateUser(const User& user) {
+    return sql::execute(*m_db, ledger::kUpdateUser, user.getUsername(), user.getFullName(),
+                        user.getEmail(), user.getPhone(), user.getUserId());
+}
+
+bool PostgresLedgerStore::deleteUser(int userId) {
+    return sql::execute(*m_db, ledger::kDeleteUser, userId);
+}
+
+// Accounts
+
+std::optional<int> PostgresLedgerStore::insertAccount(const Account& account) {
+    std::optional<int> accountId;
+    sql::query(*m_db, ledger::kInsertAccount, [&](int id) { accountId = id; },
+               account.getUserId(), std::string(account.getAccountNumber()), account.getType(),
+               account.getBalance(), account.getInterestRate());
+    return accountId;
+}
+
+std::optional<Account> PostgresLedgerStore::findAccountById(int accountId) {
+    std::optional<Account> account;
+    sql::query(*m_db, ledger::kFindAccountById, [&](auto... columns) { account.emplace(columns...); },
+               accountId);
+    return account;
+}
+
+std::optional<Account> PostgresLedgerStore::findAccountByNumber(const std::string& accountNumber) {
+    std::optional<Account> account;
+    sql::query(*m_db, ledger::kFindAccountByNumber, [&](auto... columns) { account.emplace(columns...); },
+               accountNumber);
+    return account;
+}
+
+bool PostgresLedgerStore::accountNumberExists(const std::string& accountNumber) {
+    bool exists = false;
+    sql::query(*m_db, ledger::kAccountNumberExists, [&](int) { exists = true; }, accountNumber);
+    return exists;
+}
+
+std::vector<Account> PostgresLedgerStore::findAccountsByUser(int userId) {
+    std::vector<Account> accounts;
+    sql::query(*m_db, ledger::kFindAccountsByUser, [&](auto... columns) { accounts.emplace_back(columns...); },
+               userId);
+    return accounts;
+}
+
+bool PostgresLedgerStore::setAccountStatus(int accountId, AccountStatus status) {
+    return sql::execute(*m_db, ledger::kSetAccountStatus, status, accountId);
+}
+
+bool PostgresLedgerStore::deleteAccount(int accountId) {
+    return sql::execute(*m_db, ledger::kDeleteAccount, accountId);
+}
+
+std::vector<Account> PostgresLedgerStore::lockAccounts(std::vector<int> accountIds) {
+    std::vector<Account> accounts;
+    if (accountIds.empty()) {
+        return accounts;
+    }
+    
+    // Row locks are taken in scan order, so order by id to avoid deadlocks
+    std::string placeholders;
+    ArenaParams params(requestArena());
+    params.reserve(accountIds.size());
+    for (int accountId : accountIds) {
+        params.emplace_back(std::to_string(accountId));
+        placeholders += (placeholders.empty() ? "$" : ", $") + std::to_string(params.size());
+    }
+    std::string query = std::string("SELECT ") + kAccountColumns + " FROM accounts "
+                        "WHERE account_id IN (" + placeholders + ") ORDER BY account_id FOR UPDATE";
+    auto results = m_db->queryParams(query, params, requestArena());
+    
+    accounts.reserve(results.size());
+    for (const auto& row : results) {
+        accounts.push_back(accountFromRow(row));
+    }
+    return accounts;
+}
+
+std::optional<double> PostgresLedgerStore::adjustBalance(int accountId, double delta) {
+    std::optional<double> balance;
+    auto read = [&](double newBalance) { balance = newBalance; };
+    if (delta >= 0) {
+        sql::query(*m_db, ledger::kCreditBalance, read, delta, accountId);
+    } else {
+        sql::query(*m_db, ledger::kDebitBalance, read, -delta, accountId);
+    }
+    return balance;
+}
+
+double PostgresLedgerStore::totalBalance(int userId) {
+    double total = 0.0;
+    sql::query(*m_db, ledger::kTotalBalance, [&](double sum) { total = sum; }, userId);
+    return total;
+}
+
+// Transactions
+
+bool PostgresLedgerStore::appendTransaction(const Transaction& transaction) {
+    if (transaction.getRelatedAccountId() >= 0) {
+        return sql::execute(*m_db, ledger::kInsertRelatedTransaction, transaction.getAccountId(),
+                            transaction.getType(), transaction.getAmount(), transaction.getBalanceAfter(),
+                            transaction.getDescription(), transaction.getRelatedAccountId());
+    }
+    return sql::execute(*m_db, ledger::kInsertTransaction, transaction.getAccountId(),
+                        transaction.getType(), transaction.getAmount(), transaction.getBalanceAfter(),
+                        transaction.getDescription());
+}
+
+std::vector<Transaction> PostgresLedgerStore::scanHistory(int accountId, int limit) {
+    std::vector<Transaction> transactions;
+    transactions.reserve(static_cast<std::size_t>(std::clamp(limit, 0, kMaxReservedRows)));
+    sql::query(*m_db, ledger::kScanHistory, [&](auto&&... columns) {
+        transactions.push_back(makeTransaction(std::move(columns)...));
+    }, accountId, limit);
+    return transactions;
+}
+
+std::optional<Transaction> PostgresLedgerStore::findTransaction(int transactionId) {
+    std::optional<Transaction> transaction;
+    sql::query(*m_db, ledger::kFindTransaction, [&](auto&&... columns) {
+        transaction = makeTransaction(std::move(columns)...);
+    }, transactionId);
+    return transaction;
+}
+
+std::vector<Transaction> PostgresLedgerStore::scanHistoryBetween(int accountId, const TimeRange& range,
+                                                                 int limit)
+{
+    std::vector<Transaction> transactions;
+    sql::query(*m_db, ledger::kScanHistoryBetween, [&](auto&&... columns) {
+        transactions.push_back(makeTransaction(std::move(columns)...));
+    }, accountId, range.from, range.to, limit);
+    return transactions;
+}
+
+std::vector<ActivityTotal> PostgresLedgerStore::dailyTotals(int accountId, const TimeRange& range) {
+    std::vector<ActivityTotal> totals;
+    sql::query(*m_db, ledger::kDailyTotals, [&](Timestamp day, double credits, double debits, int count,
+                                                double closingBalance) {
+        totals.push_back({day, credits, debits, count, closingBalance});
+    }, accountId, range.from, range.to);
+    return totals;
+}
+
+std::vector<ActivityTotal> PostgresLedgerStore::rollups(int accountId, TimeUnit unit, const TimeRange& range) {
+    std::vector<ActivityTotal> totals;
+    sql::query(*m_db, ledger::kRollups, [&](Timestamp start, double credits, double debits, int count,
+                                            double closingBalance) {
+        totals.push_back({start, credits, debits, count, closingBalance});
+    }, accountId, unit, range.from, range.to);
+    return totals;
+}
+
+ActivityTotal PostgresLedgerStore::summarizeActivity(int accountId, const RangeCover& cover) {
+    ActivityTotal summary;
+    summary.start = cover.rest[0].from;
+    sql::query(*m_db, ledger::kSummarizeActivity, [&](double credits, double debits, int count,
+                                                      std::optional<double> closingBalance) {
+        summary.credits = credits;
+        summary.debits = debits;
+        summary.count = count;
+        summary.closingBalance = closingBalance.value_or(0.0);
+    }, accountId, cover.months.from, cover.months.to, cover.days[0].from, cover.days[0].to,
+       cover.days[1].from, cover.days[1].to, cover.hours[0].from, cover.hours[0].to,
+       cover.hours[1].from, cover.hours[1].to, cover.rest[0].from, cover.rest[0].to,
+       cover.rest[1].from, cover.rest[1].to);
+    return summary;
+}
+
+std::vector<BalancePoint> PostgresLedgerStore::balanceHistory(int accountId, int maxPoints) {
+    std::vector<BalancePoint> points;
+    sql::query(*m_db, ledger::kBalanceHistory, [&](double time, double balance) {
+        points.push_back({time, balance});
+    }, accountId, maxPoints);
+    return points;
+}
+
+std::optional<DashboardData> PostgresLedgerStore::loadDashboard(int userId, int historyLimit, 
+                                                               int balancePoints) 
+{
+    return pipelineDashboard({sql::pipelined(ledger::kFindUserById, userId),
+                              sql::pipelined(ledger::kFindAccountsByUser, userId),
+                              sql::pipelined(ledger::kDashboardHistory, userId, historyLimit),
+                              sql::pipelined(ledger::kDashboardBalanceHistory, userId, balancePoints)});
+}
+
+std::optional<DashboardData> PostgresLedgerStore::loadDashboardForLogin(const std::string& username,
+                                                                        const std::string& passwordHash,
+                                                                        int historyLimit, int balancePoints)
+{
+    return pipelineDashboard({sql::pipelined(ledger::kLoginUser, username, passwordHash),
+                              sql::pipelined(ledger::kLoginAccounts, username, passwordHash),
+                              sql::pipelined(ledger::kLoginHistory, username, historyLimit, passwordHash),
+                              sql::pipelined(ledger::kLoginBalanceHistory, username, balancePoints,
+                                             passwordHash)});
+}
+
+std::optional<DashboardData> PostgresLedgerStore::pipelineDashboard(const std::vector<PipelinedQuery>& queries) {
+    auto results = m_db->queryPipelined(queries);
+    if (results.size() != queries.size() || results[0].empty()) {
+        return std::nullopt;
+    }
+
+    // Both variants select the columns of the statements decoding them here
+    DashboardData data;
+    bool ok = ledger::kFindUserById.decode(
+        sql::StringRows(results[0], ledger::kFindUserById.kColumns),
+        [&](auto&&... columns) { data.user = User(columns...); });
+
+    data.accounts.reserve(results[1].size());
+    ok = ok && ledger::kFindAccountsByUser.decode(
+        sql::StringRows(results[1], ledger::kFindAccountsByUser.kColumns),
+        [&](auto... columns) {
+            data.accounts.emplace_back(columns...);
+            data.totalBalance += data.accounts.back().getBalance();
+        });
+    if (!data.accounts.empty()) {
+        data.defaultAccountId = data.accounts.front().getAccountId();
+    }
+
+    data.history.reserve(results[2].size());
+    ok = ok && ledger::kDashboardHistory.decode(
+        sql::StringRows(results[2], ledger::kDashboardHistory.kColumns),
+        [&](auto&&... columns) { data.history.push_back(makeTransaction(std::move(columns)...)); });
+
+    data.balanceHistory.reserve(results[3].size());
+    ok = ok && ledger::kDashboardBalanceHistory.decode(
+        sql::StringRows(results[3], ledger::kDashboardBalanceHistory.kColumns),
+        [&](double time, double balance) { data.balanceHistory.push_back({time, balance}); });
+
+    if (!ok) {
+        return std::nullopt;
+    }
+    return data;
+}
+
+std::optional<std::vector<Account>> PostgresLedgerStore::findAccountsUpdatedSince(
+    const std::string& since, int slackSeconds, std::string& watermark)
+{
+    // Read first, so rows changed while the delta is fetched are seen again next time
+    std::optional<std::string> now;
+    if (!sql::query(*m_db, ledger::kLocalTimestamp, [&](std::string time) { now = std::move(time); }) ||
+        !now.has_value()) {
+        return std::nullopt;
+    }
+
+    std::vector<Account> accounts;
+    if (!since.empty() &&
+        !sql::query(*m_db, ledger::kFindAccountsUpdatedSince,
+                    [&](auto... columns) { accounts.emplace_back(columns...); }, since, slackSeconds)) {
+        return std::nullopt;
+    }
+
+    watermark = std::move(*now);
+    return accounts;
+}
+
+StoreStats PostgresLedgerStore::getStats() const {
+    const QueryStats& queries = m_db->getQueryStats();
+    StoreStats stats;
+    stats.operations = queries.statements;
+    stats.rows = queries.rows;
+    stats.millis = queries.millis;
+    return stats;
+}
+
+} // namespace bank
@@ -0,0 +1,256 @@
+#include "Protocol.hpp"
+#include <cstring>
+#include <utility>
+
+namespace bank {
+namespace protocol {
+
+MessageWriter::MessageWriter()
+    : m_buffer(kLengthPrefix, '\0')
+{
+}
+
+void MessageWriter::putU8(std::uint8_t value) {
+    m_buffer.push_back(static_cast<char>(value));
+}
+
+void MessageWriter::putU32(std::uint32_t value) {
+    char bytes[4] = {
+        static_cast<char>(value >> 24), static_cast<char>(value >> 16),
+        static_cast<char>(value >> 8), static_cast<char>(value)
+    };
+    m_buffer.append(bytes, 4);
+}
+
+void MessageWriter::putI32(std::int32_t value) {
+    putU32(static_cast<std::uint32_t>(value));
+}
+
+void MessageWriter::putI64(std::int64_t value) {
+    auto bits = static_cast<std::uint64_t>(value);
+    putU32(static_cast<std::uint32_t>(bits >> 32));
+    putU32(static_cast<std::uint32_t>(bits));
+}
+
+void MessageWriter::putF64(double value) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    putU32(static_cast<std::uint32_t>(bits >> 32));
+    putU32(static_cast<std::uint32_t>(bits));
+}
+
+void MessageWriter::putString(std::string_view value) {
+    putU32(static_cast<std::uint32_t>(value.size()));
+    m_buffer.append(value);
+}
+
+std::size_t MessageWriter::reserveU32() {
+    std::size_t position = m_buffer.size();
+    putU32(0);
+    return position;
+}
+
+void MessageWriter::setU32(std::size_t position, std::uint32_t value) {
+    m_buffer[position] = static_cast<char>(value >> 24);
+    m_buffer[position + 1] = static_cast<char>(value >> 16);
+    m_buffer[position + 2] = static_cast<char>(value >> 8);
+    m_buffer[position + 3] = static_cast<char>(value);
+}
+
+void MessageWriter::putUser(const User& user) {
+    putI32(user.getUserId());
+    putString(user.getUsername());
+    putString(user.getPasswordHash());
+    putString(user.getFullName());
+    putString(user.getEmail());
+    putString(user.getPhone());
+}
+
+void MessageWriter::putAccount(const Account& account) {
+    putI32(account.getAccountId());
+    putI32(account.getUserId());
+    putString(account.getAccountNumber());
+    putU8(static_cast<std::uint8_t>(account.getType()));
+    putF64(account.getBalance());
+    putF64(account.getInterestRate());
+    putU8(static_cast<std::uint8_t>(account.getStatus()));
+}
+
+void MessageWriter::putTransaction(const Transaction& transaction) {
+    putI32(transaction.getTransactionId());
+    putI32(transaction.getAccountId());
+    putU8(static_cast<std::uint8_t>(transaction.getType()));
+    putF64(transaction.getAmount());
+    putF64(transaction.getBalanceAfter());
+    putString(transaction.getDescription());
+    putI32(transaction.getRelatedAccountId());
+    putTimestamp(transaction.getCreatedAt());
+}
+
+void MessageWriter::putActivityTotal(const ActivityTotal& total) {
+    putTimestamp(total.start);
+    putF64(total.credits);
+    putF64(total.debits);
+    putI32(total.count);
+    putF64(total.closingBalance);
+}
+
+void MessageWriter::putDashboard(const DashboardData& dashboard) {
+    putUser(dashboard.user);
+    putU32(static_cast<std::uint32_t>(dashboard.accounts.size()));
+    for (const auto& account : dashboard.accounts) {
+        putAccount(account);
+    }
+    putF64(dashboard.totalBalance);
+    putI32(dashboard.defaultAccountId);
+    putU32(static_cast<std::uint32_t>(dashboard.history.size()));
+    for (const auto& transaction : dashboard.history) {
+        putTransaction(transaction);
+    }
+    putU32(static_cast<std::uint32_t>(dashboard.balanceHistory.size()));
+    for (const auto& point : dashboard.balanceHistory) {
+        putF64(point.timestamp);
+        putF64(point.balance);
+    }
+}
+
+std::string MessageWriter::finish() {
+    setU32(0, static_cast<std::uint32_t>(m_buffer.size() - kLengthPrefix));
+    return std::move(m_buffer);
+}
+
+MessageReader::MessageReader(const char* data, std::size_t size)
+    : m_data(data)
+    , m_size(size)
+    , m_pos(0)
+    , m_ok(true)
+{
+}
+
+bool MessageReader::need(std::size_t bytes) {
+    if (!m_ok || m_size - m_pos < bytes) {
+        m_ok = false;
+        return false;
+    }
+    return true;
+}
+
+std::uint8_t MessageReader::getU8() {
+    if (!need(1)) {
+        return 0;
+    }
+    return static_cast<std::uint8_t>(m_data[m_pos++]);
+}
+
+std::uint32_t MessageReader::getU32() {
+    if (!need(4)) {
+        return 0;
+    }
+    std::uint32_t value = readLength(m_data + m_pos);
+    m_pos += 4;
+    return value;
+}
+
+std::int32_t MessageReader::getI32() {
+    return static_cast<std::int32_t>(getU32());
+}
+
+std::int64_t MessageReader::getI64() {
+    std::uint64_t bits = static_cast<std::uint64_t>(getU32()) << 32;
+    bits |= getU32();
+    return static_cast<std::int64_t>(bits);
+}
+
+double MessageReader::getF64() {
+    std::uint64_t bits = static_cast<std::uint64_t>(getU32()) << 32;
+    bits |= getU32();
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+std::string MessageReader::getString() {
+    std::uint32_t length = getU32();
+    if (!need(length)) {
+        return std::string();
+    }
+    std::string value(m_data + m_pos, length);
+    m_pos += length;
+    return value;
+}
+
+User MessageReader::getUser() {
+    int userId = getI32();
+    std::string username = getString();
+    std::string passwordHash = getString();
+    std::string fullName = getString();
+    std::string email = getString();
+    std::string phone = getString();
+    return User(userId, username, passwordHash, fullName, email, phone);
+}
+
+Account MessageReader::getAccount() {
+    int accountId = getI32();
+    int userId = getI32();
+    std::string accountNumber = getString();
+    auto type = static_cast<AccountType>(getU8());
+    double balance = getF64();
+    double interestRate = getF64();
+    auto status = static_cast<AccountStatus>(getU8());
+    if (accountNumber.size() > Account::kMaxNumberLength) {
+        m_ok = false;
+        return Account();
+    }
+    return Account(accountId, userId, accountNumber, type, balance, interestRate, status);
+}
+
+Transaction MessageReader::getTransaction() {
+    Transaction t;
+    t.setTransactionId(getI32());
+    t.setAccountId(getI32());
+    t.setType(static_cast<TransactionType>(getU8()));
+    t.setAmount(getF64());
+    t.setBalanceAfter(getF64());
+    t.setDescription(getString());
+    t.setRelatedAccountId(getI32());
+    t.setCreatedAt(getTimestamp());
+    return t;
+}
+
+ActivityTotal MessageReader::getActivityTotal() {
+    ActivityTotal total;
+    total.start = getTimestamp();
+    total.credits = getF64();
+    total.debits = getF64();
+    total.count = getI32();
+    total.closingBalance = getF64();
+    return total;
+}
+
+DashboardData MessageReader::getDashboard() {
+    DashboardData dashboard;
+    dashboard.user = getUser();
+    for (std::uint32_t i = getU32(); i > 0 && m_ok; --i) {
+        dashboard.accounts.push_back(getAccount());
+    }
+    dashboard.totalBalance = getF64();
+    dashboard.defaultAccountId = getI32();
+    for (std::uint32_t i = getU32(); i > 0 && m_ok; --i) {
+        dashboard.history.push_back(getTransaction());
+    }
+    for (std::uint32_t i = getU32(); i > 0 && m_ok; --i) {
+        BalancePoint point;
+        point.timestamp = getF64();
+        point.balance = getF64();
+        dashboard.balanceHistory.push_back(point);
+    }
+    return dashboard;
+}
+
+std::uint32_t readLength(const char* data) {
+    auto byte = [data](int i) { return static_cast<std::uint32_t>(static_cast<unsigned char>(data[i])); };
+    return (byte(0) << 24) | (byte(1) << 16) | (byte(2) << 8) | byte(3);
+}
+
+} // namespace protocol
+} // namespace bank
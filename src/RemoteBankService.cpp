@@ -0,0 +1,605 @@
+#include "RemoteBankService.hpp"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace bank {
+
+using protocol::MessageReader;
+using protocol::MessageWriter;
+using protocol::Opcode;
+using protocol::Status;
+
+RemoteBankService::RemoteBankService(std::string address)
+    : m_address(std::move(address))
+    , m_fd(-1)
+    , m_nextRequestId(0)
+{
+}
+
+RemoteBankService::~RemoteBankService() {
+    disconnect();
+}
+
+bool RemoteBankService::connect() {
+    if (m_fd >= 0) {
+        return true;
+    }
+
+    const std::string unixPrefix = "unix:";
+    if (m_address.compare(0, unixPrefix.size(), unixPrefix) == 0) {
+        std::string path = m_address.substr(unixPrefix.size());
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path)) {
+            m_lastError = "Socket path too long: " + path;
+            return false;
+        }
+        std::strcpy(address.sun_path, path.c_str());
+
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            m_lastError = "Could not connect to " + path + ": " + std::strerror(errno);
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            return false;
+        }
+        m_fd = fd;
+        return true;
+    }
+
+    std::size_t colon = m_address.rfind(':');
+    if (colon == std::string::npos) {
+        m_lastError = "Server address must be host:port or unix:/path";
+        return false;
+    }
+    std::string host = m_address.substr(0, colon);
+    std::string port = m_address.substr(colon + 1);
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    int rc = getaddrinfo(host.c_str(), port.c_str(), &hints, &addresses);
+    if (rc != 0) {
+        m_lastError = "Could not resolve " + host + ": " + gai_strerror(rc);
+        return false;
+    }
+
+    std::string error = "No addresses for " + host;
+    for (addrinfo* address = addresses; address != nullptr; address = address->ai_next) {
+        int fd = socket(address->ai_family, address->ai_socktype | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            continue;
+        }
+        if (::connect(fd, address->ai_addr, address->ai_addrlen) == 0) {
+            int on = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+            m_fd = fd;
+            break;
+        }
+        error = "Could not connect to " + m_address + ": " + std::strerror(errno);
+        ::close(fd);
+    }
+    freeaddrinfo(addresses);
+
+    if (m_fd < 0) {
+        m_lastError = error;
+        return false;
+    }
+    return true;
+}
+
+void RemoteBankService::disconnect() {
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+MessageWriter RemoteBankService::beginRequest(Opcode opcode) {
+    MessageWriter request;
+    request.putU8(static_cast<std::uint8_t>(opcode));
+    request.putU32(++m_nextRequestId);
+    return request;
+}
+
+std::optional<MessageReader> RemoteBankService::call(const char* operation, MessageWriter& request) {
+    if (m_fd < 0 && !connect()) {
+        return std::nullopt;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    char prefix[protocol::kLengthPrefix];
+    if (!sendAll(request.finish()) || !receiveAll(prefix, sizeof(prefix))) {
+        disconnect();
+        return std::nullopt;
+    }
+
+    std::uint32_t length = protocol::readLength(prefix);
+    if (length < protocol::kResponseHeader || length > protocol::kMaxFrameSize) {
+        m_lastError = "Malformed response from server";
+        disconnect();
+        return std::nullopt;
+    }
+    m_response.resize(length);
+    if (!receiveAll(&m_response[0], length)) {
+        disconnect();
+        return std::nullopt;
+    }
+
+    MessageReader in(m_response.data(), m_response.size());
+    std::uint32_t requestId = in.getU32();
+    auto status = static_cast<Status>(in.getU8());
+    std::uint32_t dbMicros = in.getU32();
+    std::uint32_t roundTrips = in.getU32();
+    std::uint32_t rows = in.getU32();
+    if (requestId != m_nextRequestId) {
+        m_lastError = "Response does not match the request";
+        disconnect();
+        return std::nullopt;
+    }
+
+    if (m_recentCalls.size() >= kRecentCallLimit) {
+        m_recentCalls.pop_front();
+    }
+    m_recentCalls.push_back(ServiceCall{
+        operation,
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(),
+        dbMicros / 1000.0,
+        static_cast<int>(roundTrips),
+        static_cast<int>(rows)
+    });
+
+    if (status != Status::Ok) {
+        m_lastError = status == Status::BadRequest ? "Server rejected the request" 
+                                                   : "Server failed to execute the request";
+        return std::nullopt;
+    }
+    return in;
+}
+
+bool RemoteBankService::sendAll(const std::string& data) {
+    std::size_t offset = 0;
+    while (offset < data.size()) {
+        ssize_t sent = ::send(m_fd, data.data() + offset, data.size() - offset, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            m_lastError = std::string("Lost connection to server: ") + std::strerror(errno);
+            return false;
+        }
+        offset += static_cast<std::size_t>(sent);
+    }
+    return true;
+}
+
+bool RemoteBankService::receiveAll(char* data, std::size_t size) {
+    std::size_t offset = 0;
+    while (offset < size) {
+        ssize_t received = ::recv(m_fd, data + offset, size - offset, 0);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            m_lastError = received == 0 ? std::string("Server closed the connection")
+                                        : std::string("Lost connection to server: ") + std::strerror(errno);
+            return false;
+        }
+        offset += static_cast<std::size_t>(received);
+    }
+    return true;
+}
+
+bool RemoteBankService::checkDecoded(const MessageReader& reader) {
+    if (!reader.ok() || !reader.atEnd()) {
+        m_lastError = "Malformed response from server";
+        return false;
+    }
+    return true;
+}
+
+// User operations
+
+std::optional<User> RemoteBankService::createUser(const std::string& username, 
+                                                  const std::string& password,
+                                                  const std::string& fullName, 
+                                                  const std::string& email,
+                                                  const std::string& phone) 
+{
+    auto request = beginRequest(Opcode::CreateUser);
+    request.putString(username);
+    request.putString(password);
+    request.putString(fullName);
+    request.putString(email);
+    request.putString(phone);
+
+    auto in = call("createUser", request);
+    if (!in || !in->getBool()) {
+        return std::nullopt;
+    }
+    User user = in->getUser();
+    return checkDecoded(*in) ? std::optional<User>(user) : std::nullopt;
+}
+
+std::optional<User> RemoteBankService::authenticateUser(const std::string& username, 
+                                                        const std::string& password) 
+{
+    auto request = beginRequest(Opcode::AuthenticateUser);
+    request.putString(username);
+    request.putString(password);
+
+    auto in = call("authenticateUser", request);
+    if (!in || !in->getBool()) {
+        return std::nullopt;
+    }
+    User user = in->getUser();
+    return checkDecoded(*in) ? std::optional<User>(user) : std::nullopt;
+}
+
+std::optional<int> RemoteBankService::verifyCredentials(const std::string& username, 
+                                                        const std::string& password) 
+{
+    auto request = beginRequest(Opcode::VerifyCredentials);
+    request.putString(username);
+    request.putString(password);
+
+    auto in = call("verifyCredentials", request);
+    if (!in || !in->getBool()) {
+        return std::nullopt;
+    }
+    int userId = in->getI32();
+    return checkDecoded(*in) ? std::optional<int>(userId) : std::nullopt;
+}
+
+std::optional<DashboardData> RemoteBankService::loadDashboard(int userId, int historyLimit) {
+    auto request = beginRequest(Opcode::LoadDashboard);
+    request.putI32(userId);
+    request.putI32(historyLimit);
+
+    auto in = call("loadDashboard", request);
+    if (!in || !in->getBool()) {
+        return std::nullopt;
+    }
+    DashboardData dashboard = in->getDashboard();
+    if (!checkDecoded(*in)) {
+        return std::nullopt;
+    }
+    return dashboard;
+}
+
+std::optional<DashboardData> RemoteBankService::login(const std::string& username, const std::string& password,
+                                                      int historyLimit)
+{
+    auto request = beginRequest(Opcode::Login);
+    request.putString(username);
+    request.putString(password);
+    request.putI32(historyLimit);
+
+    auto in = call("login", request);
+    if (!in || !in->getBool()) {
+        return std::nullopt;
+    }
+    DashboardData dashboard = in->getDashboard();
+    if (!checkDecoded(*in)) {
+        return std::nullopt;
+    }
+    return dashboard;
+}
+
+std::optional<User> RemoteBankService::getUserById(int userId) {
+    auto request = beginRequest(Opcode::GetUserById);
+    request.putI32(userId);
+
+    auto in = call("getUserById", request);
+    if (!in || !in->getBool()) {
+        return std::nullopt;
+    }
+    User user = in->getUser();
+    return checkDecoded(*in) ? std::optional<User>(user) : std::nullopt;
+}
+
+std::optional<User> RemoteBankService::getUserByUsername(const std::string& username) {
+    auto request = beginRequest(Opcode::GetUserByUsername);
+    request.putString(username);
+
+    auto in = call("getUserByUsername", request);
+    if (!in || !in->getBool()) {
+        return std::nullopt;
+    }
+    User user = in->getUser();
+    return checkDecoded(*in) ? std::optional<User>(user) : std::nullopt;
+}
+
+bool RemoteBankService::updateUser(const User& user) {
+    auto request = beginRequest(Opcode::UpdateUser);
+    request.putUser(user);
+
+    auto in = call("updateUser", request);
+    return in && in->getBool() && checkDecoded(*in);
+}
+
+bool RemoteBankService::deleteUser(int userId) {
+    auto request = beginRequest(Opcode::DeleteUser);
+    request.putI32(userId);
+
+    auto in = call("deleteUser", request);
+    return in && in->getBool() && checkDecoded(*in);
+}
+
+// Account operations
+
+std::optional<Account> RemoteBankService::createAccount(int userId, AccountType type, 
+                                                        double initialDeposit) 
+{
+    auto request = beginRequest(Opcode::CreateAccount);
+    request.putI32(userId);
+    request.putU8(static_cast<std::uint8_t>(type));
+    request.putF64(initialDeposit);
+
+    auto in = call("createAccount", request);
+    if (!in || !in->getBool()) {
+        return std::nullopt;
+    }
+    Account account = in->getAccount();
+    return checkDecoded(*in) ? std::optional<Account>(account) : std::nullopt;
+}
+
+std::optional<Account> RemoteBankService::getAccountById(int accountId) {
+    auto request = beginRequest(Opcode::GetAccountById);
+    request.putI32(accountId);
+
+    auto in = call("getAccountById", request);
+    if (!in || !in->getBool()) {
+        return std::nullopt;
+    }
+    Account account = in->getAccount();
+    return checkDecoded(*in) ? std::optional<Account>(account) : std::nullopt;
+}
+
+std::optional<Account> RemoteBankService::getAccountByNumber(const std::string& accountNumber) {
+    auto request = beginRequest(Opcode::GetAccountByNumber);
+    request.putString(accountNumber);
+
+    auto in = call("getAccountByNumber", request);
+    if (!in || !in->getBool()) {
+        return std::nullopt;
+    }
+    Account account = in->getAccount();
+    return checkDecoded(*in) ? std::optional<Account>(account) : std::nullopt;
+}
+
+std::vector<Account> RemoteBankService::getAccountsByUserId(int userId) {
+    auto request = beginRequest(Opcode::GetAccountsByUserId);
+    request.putI32(userId);
+
+    std::vector<Account> accounts;
+    auto in = call("getAccountsByUserId", request);
+    if (!in) {
+        return accounts;
+    }
+    for (std::uint32_t i = in->getU32(); i > 0 && in->ok(); --i) {
+        accounts.push_back(in->getAccount());
+    }
+    if (!checkDecoded(*in)) {
+        accounts.clear();
+    }
+    return accounts;
+}
+
+bool RemoteBankService::updateAccountStatus(int accountId, AccountStatus status) {
+    auto request = beginRequest(Opcode::UpdateAccountStatus);
+    request.putI32(accountId);
+    request.putU8(static_cast<std::uint8_t>(status));
+
+    auto in = call("updateAccountStatus", request);
+    return in && in->getBool() && checkDecoded(*in);
+}
+
+bool RemoteBankService::deleteAccount(int accountId) {
+    auto request = beginRequest(Opcode::DeleteAccount);
+    request.putI32(accountId);
+
+    auto in = call("deleteAccount", request);
+    return in && in->getBool() && checkDecoded(*in);
+}
+
+// Transaction operations
+
+bool RemoteBankService::deposit(int accountId, double amount, const std::string& description) {
+    auto request = beginRequest(Opcode::Deposit);
+    request.putI32(accountId);
+    request.putF64(amount);
+    request.putString(description);
+
+    auto in = call("deposit", request);
+    return in && in->getBool() && checkDecoded(*in);
+}
+
+bool RemoteBankService::withdraw(int accountId, double amount, const std::string& description) {
+    auto request = beginRequest(Opcode::Withdraw);
+    request.putI32(accountId);
+    request.putF64(amount);
+    request.putString(description);
+
+    auto in = call("withdraw", request);
+    return in && in->getBool() && checkDecoded(*in);
+}
+
+bool RemoteBankService::transfer(int fromAccountId, int toAccountId, double amount, 
+                                 const std::string& description) 
+{
+    auto request = beginRequest(Opcode::Transfer);
+    request.putI32(fromAccountId);
+    request.putI32(toAccountId);
+    request.putF64(amount);
+    request.putString(description);
+
+    auto in = call("transfer", request);
+    return in && in->getBool() && checkDecoded(*in);
+}
+
+std::vector<Transaction> RemoteBankService::getTransactionHistory(int accountId, int limit) {
+    auto request = beginRequest(Opcode::GetTransactionHistory);
+    request.putI32(accountId);
+    request.putI32(limit);
+
+    std::vector<Transaction> history;
+    auto in = call("getTransactionHistory", request);
+    if (!in) {
+        return history;
+    }
+    for (std::uint32_t i = in->getU32(); i > 0 && in->ok(); --i) {
+        history.push_back(in->getTransaction());
+    }
+    if (!checkDecoded(*in)) {
+        history.clear();
+    }
+    return history;
+}
+
+std::optional<Transaction> RemoteBankService::getTransactionById(int transactionId) {
+    auto request = beginRequest(Opcode::GetTransactionById);
+    request.putI32(transactionId);
+
+    auto in = call("getTransactionById", request);
+    if (!in || !in->getBool()) {
+        return std::nullopt;
+    }
+    Transaction transaction = in->getTransaction();
+    return checkDecoded(*in) ? std::optional<Transaction>(transaction) : std::nullopt;
+}
+
+std::vector<BalancePoint> RemoteBankService::getBalanceHistory(int accountId, int maxPoints) {
+    auto request = beginRequest(Opcode::GetBalanceHistory);
+    request.putI32(accountId);
+    request.putI32(maxPoints);
+
+    std::vector<BalancePoint> points;
+    auto in = call("getBalanceHistory", request);
+    if (!in) {
+        return points;
+    }
+    for (std::uint32_t i = in->getU32(); i > 0 && in->ok(); --i) {
+        BalancePoint point;
+        point.timestamp = in->getF64();
+        point.balance = in->getF64();
+        points.push_back(point);
+    }
+    if (!checkDecoded(*in)) {
+        points.clear();
+    }
+    return points;
+}
+
+std::vector<Transaction> RemoteBankService::getTransactionsBetween(int accountId, Timestamp from, Timestamp to,
+                                                                   int limit)
+{
+    auto request = beginRequest(Opcode::GetTransactionsBetween);
+    request.putI32(accountId);
+    request.putTimestamp(from);
+    request.putTimestamp(to);
+    request.putI32(limit);
+
+    std::vector<Transaction> transactions;
+    auto in = call("getTransactionsBetween", request);
+    if (!in) {
+        return transactions;
+    }
+    for (std::uint32_t i = in->getU32(); i > 0 && in->ok(); --i) {
+        transactions.push_back(in->getTransaction());
+    }
+    if (!checkDecoded(*in)) {
+        transactions.clear();
+    }
+    return transactions;
+}
+
+std::vector<ActivityTotal> RemoteBankService::getDailyTotals(int accountId, const TimeRange& range) {
+    auto request = beginRequest(Opcode::GetDailyTotals);
+    request.putI32(accountId);
+    request.putTimestamp(range.from);
+    request.putTimestamp(range.to);
+
+    std::vector<ActivityTotal> totals;
+    auto in = call("getDailyTotals", request);
+    if (!in) {
+        return totals;
+    }
+    for (std::uint32_t i = in->getU32(); i > 0 && in->ok(); --i) {
+        totals.push_back(in->getActivityTotal());
+    }
+    if (!checkDecoded(*in)) {
+        totals.clear();
+    }
+    return totals;
+}
+
+std::vector<ActivityTotal> RemoteBankService::getActivity(int accountId, TimeUnit unit, const TimeRange& range) {
+    auto request = beginRequest(Opcode::GetActivity);
+    request.putI32(accountId);
+    request.putU8(static_cast<std::uint8_t>(unit));
+    request.putTimestamp(range.from);
+    request.putTimestamp(range.to);
+
+    std::vector<ActivityTotal> totals;
+    auto in = call("getActivity", request);
+    if (!in) {
+        return totals;
+    }
+    for (std::uint32_t i = in->getU32(); i > 0 && in->ok(); --i) {
+        totals.push_back(in->getActivityTotal());
+    }
+    if (!checkDecoded(*in)) {
+        totals.clear();
+    }
+    return totals;
+}
+
+ActivityTotal RemoteBankService::getActivitySummary(int accountId, const TimeRange& range) {
+    auto request = beginRequest(Opcode::GetActivitySummary);
+    request.putI32(accountId);
+    request.putTimestamp(range.from);
+    request.putTimestamp(range.to);
+
+    ActivityTotal summary;
+    summary.start = range.from;
+    auto in = call("getActivitySummary", request);
+    if (!in) {
+        return summary;
+    }
+    ActivityTotal decoded = in->getActivityTotal();
+    return checkDecoded(*in) ? decoded : summary;
+}
+
+// Utility operations
+
+double RemoteBankService::getTotalBalance(int userId) {
+    auto request = beginRequest(Opcode::GetTotalBalance);
+    request.putI32(userId);
+
+    auto in = call("getTotalBalance", request);
+    if (!in) {
+        return 0.0;
+    }
+    double total = in->getF64();
+    return checkDecoded(*in) ? total : 0.0;
+}
+
+bool RemoteBankService::accountExists(const std::string& accountNumber) {
+    auto request = beginRequest(Opcode::AccountExists);
+    request.putString(accountNumber);
+
+    auto in = call("accountExists", request);
+    return in && in->getBool() && checkDecoded(*in);
+}
+
+} // namespace bank
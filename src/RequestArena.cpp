@@ -0,0 +1,35 @@
+#include "RequestArena.hpp"
+
+namespace bank {
+
+namespace {
+
+thread_local RequestArena* t_current = nullptr;
+
+} // namespace
+
+RequestArena::RequestArena()
+    : m_resource(m_buffer, sizeof(m_buffer), std::pmr::new_delete_resource())
+{
+}
+
+RequestArena::Scope::Scope(RequestArena& arena)
+    : m_arena(t_current == nullptr ? &arena : nullptr)
+{
+    if (m_arena != nullptr) {
+        t_current = m_arena;
+    }
+}
+
+RequestArena::Scope::~Scope() {
+    if (m_arena != nullptr) {
+        t_current = nullptr;
+        m_arena->release();
+    }
+}
+
+std::pmr::memory_resource* requestArena() {
+    return t_current != nullptr ? t_current->resource() : std::pmr::get_default_resource();
+}
+
+} // namespace bank
@@ -0,0 +1,453 @@
+#include "ShardedLedger.hpp"
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <utility>
+
+namespace bank {
+
+namespace {
+
+double toAmount(long long cents) {
+    return static_cast<double>(cents) / 100.0;
+}
+
+} // namespace
+
+// Command queue
+
+ShardedLedger::CommandQueue::CommandQueue()
+    : m_head(&m_stub)
+    , m_tail(&m_stub)
+{
+}
+
+void ShardedLedger::CommandQueue::push(Command* command) {
+    command->next.store(nullptr, std::memory_order_relaxed);
+    Command* previous = m_head.exchange(command, std::memory_order_seq_cst);
+    previous->next.store(command, std::memory_order_release);
+}
+
+ShardedLedger::Command* ShardedLedger::CommandQueue::pop() {
+    Command* tail = m_tail;
+    Command* next = tail->next.load(std::memory_order_acquire);
+    if (tail == &m_stub) {
+        if (next == nullptr) {
+            return nullptr;
+        }
+        m_tail = next;
+        tail = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+    if (next != nullptr) {
+        m_tail = next;
+        return tail;
+    }
+
+    // tail is the last command unless a producer is between its two steps
+    if (tail != m_head.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    push(&m_stub);
+    next = tail->next.load(std::memory_order_acquire);
+    if (next != nullptr) {
+        m_tail = next;
+        return tail;
+    }
+    return nullptr;
+}
+
+bool ShardedLedger::CommandQueue::empty() const {
+    return m_tail == &m_stub && m_head.load(std::memory_order_seq_cst) == &m_stub;
+}
+
+// Engine
+
+ShardedLedger::ShardedLedger(std::shared_ptr<LedgerStore> store, ShardedLedgerOptions options)
+    : m_store(std::move(store))
+    , m_options(options)
+    , m_accepting(true)
+    , m_halting(false)
+    , m_failed(false)
+    , m_rejected(0)
+    , m_crossShard(0)
+    , m_refunds(0)
+    , m_stopping(false)
+    , m_batches(0)
+    , m_storeScopes(0)
+    , m_records(0)
+    , m_inFlight(0)
+{
+    std::size_t count = m_options.shards;
+    if (count == 0) {
+        count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    m_options.maxBatch = std::max<std::size_t>(1, m_options.maxBatch);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        m_shards.push_back(std::make_unique<Shard>());
+        m_shards.back()->batch = std::make_unique<Batch>();
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        m_shards[i]->thread = std::thread(&ShardedLedger::shardLoop, this, i);
+    }
+    m_persister = std::thread(&ShardedLedger::persistLoop, this);
+}
+
+ShardedLedger::~ShardedLedger() {
+    m_accepting = false;
+    drain();
+
+    m_halting = true;
+    for (auto& shard : m_shards) {
+        {
+            std::lock_guard<std::mutex> lock(shard->wakeMutex);
+            shard->sleeping = false;
+        }
+        shard->wake.notify_one();
+        shard->thread.join();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_persistMutex);
+        m_stopping = true;
+    }
+    m_persistReady.notify_one();
+    m_persister.join();
+}
+
+void ShardedLedger::deposit(int accountId, double amount, std::string description, Completion done) {
+    submit(Step::Deposit, accountId, -1, amount, std::move(description), std::move(done));
+}
+
+void ShardedLedger::withdraw(int accountId, double amount, std::string description, Completion done) {
+    submit(Step::Withdraw, accountId, -1, amount, std::move(description), std::move(done));
+}
+
+void ShardedLedger::transfer(int fromAccountId, int toAccountId, double amount, std::string description,
+                             Completion done)
+{
+    submit(Step::Transfer, fromAccountId, toAccountId, amount, std::move(description), std::move(done));
+}
+
+void ShardedLedger::inquire(int accountId, Completion done) {
+    submit(Step::Inquire, accountId, -1, 0.0, std::string(), std::move(done));
+}
+
+void ShardedLedger::drain() {
+    std::unique_lock<std::mutex> lock(m_drainMutex);
+    m_drained.wait(lock, [this]() { return m_inFlight.load() == 0; });
+}
+
+ShardedLedgerStats ShardedLedger::getStats() const {
+    ShardedLedgerStats stats;
+    for (const auto& shard : m_shards) {
+        stats.shardCommands.push_back(shard->commands.load(std::memory_order_relaxed));
+    }
+    stats.rejected = m_rejected.load(std::memory_order_relaxed);
+    stats.crossShardTransfers = m_crossShard.load(std::memory_order_relaxed);
+    stats.refunds = m_refunds.load(std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(m_persistMutex);
+    stats.batches = m_batches;
+    stats.storeScopes = m_storeScopes;
+    stats.records = m_records;
+    return stats;
+}
+
+std::string ShardedLedger::getLastError() const {
+    std::lock_guard<std::mutex> lock(m_persistMutex);
+    return m_lastError;
+}
+
+void ShardedLedger::submit(Step step, int accountId, int otherAccountId, double amount,
+                           std::string description, Completion done)
+{
+    auto* command = new Command();
+    command->step = step;
+    command->accountId = accountId;
+    command->otherAccountId = otherAccountId;
+    command->cents = std::llround(amount * 100.0);
+    command->balance = 0;
+    command->description = std::move(description);
+    command->done = std::move(done);
+
+    // Counted before checking m_accepting, so the destructor's drain() sees it
+    m_inFlight.fetch_add(1);
+    bool valid = step == Step::Inquire ||
+                 (command->cents > 0 && (step != Step::Transfer || accountId != otherAccountId));
+    if (!m_accepting.load() || m_failed.load() || !valid) {
+        m_rejected.fetch_add(1, std::memory_order_relaxed);
+        finish(command, false);
+        return;
+    }
+    route(command, accountId);
+}
+
+void ShardedLedger::route(Command* command, int accountId) {
+    Shard& shard = *m_shards[shardOf(accountId)];
+    shard.queue.push(command);
+    if (shard.sleeping.load()) {
+        {
+            std::lock_guard<std::mutex> lock(shard.wakeMutex);
+            shard.sleeping = false;
+        }
+        shard.wake.notify_one();
+    }
+}
+
+std::size_t ShardedLedger::shardOf(int accountId) const {
+    return static_cast<std::size_t>(static_cast<unsigned int>(accountId)) % m_shards.size();
+}
+
+// Shard threads
+
+void ShardedLedger::shardLoop(std::size_t index) {
+    Shard& shard = *m_shards[index];
+    while (true) {
+        while (Command* command = shard.queue.pop()) {
+            apply(shard, command);
+            shard.commands.fetch_add(1, std::memory_order_relaxed);
+            if (shard.batched >= m_options.maxBatch) {
+                seal(shard);
+            }
+        }
+
+        // Nothing more queued: whatever was applied so far is one batch
+        if (!shard.batch->commands.empty()) {
+            seal(shard);
+        }
+
+        std::unique_lock<std::mutex> lock(shard.wakeMutex);
+        shard.sleeping = true;
+        if (!shard.queue.empty()) {
+            shard.sleeping = false;
+            continue;
+        }
+        if (m_halting) {
+            return;
+        }
+        shard.wake.wait(lock, [&]() { return !shard.sleeping.load() || m_halting.load(); });
+        shard.sleeping = false;
+    }
+}
+
+void ShardedLedger::apply(Shard& shard, Command* command) {
+    Batch& batch = *shard.batch;
+    switch (command->step) {
+        case Step::Inquire: {
+            Holding* account = holding(shard, command->accountId);
+            command->balance = account ? account->balance : 0;
+            finish(command, account != nullptr);
+            return;
+        }
+
+        case Step::Deposit:
+        case Step::Withdraw: {
+            bool deposit = command->step == Step::Deposit;
+            Holding* account = holding(shard, command->accountId);
+            if (!account || account->status != AccountStatus::Active ||
+                (!deposit && account->balance < command->cents)) {
+                m_rejected.fetch_add(1, std::memory_order_relaxed);
+                finish(command, false);
+                return;
+            }
+            long long delta = deposit ? command->cents : -command->cents;
+            account->balance += delta;
+            command->balance = account->balance;
+            batch.deltas[command->accountId] += delta;
+            record(batch, command->accountId, deposit ? TransactionType::Deposit : TransactionType::Withdrawal,
+                   command->cents, account->balance, command->description);
+            batch.commands.push_back(command);
+            ++shard.batched;
+            return;
+        }
+
+        case Step::Transfer: {
+            Holding* from = holding(shard, command->accountId);
+            if (!from || from->status != AccountStatus::Active || from->balance < command->cents) {
+                m_rejected.fetch_add(1, std::memory_order_relaxed);
+                finish(command, false);
+                return;
+            }
+            from->balance -= command->cents;
+            command->balance = from->balance;
+            command->fromNumber = from->number;
+
+            if (shardOf(command->otherAccountId) == shardOf(command->accountId)) {
+                command->step = Step::Credit;
+                apply(shard, command);
+                return;
+            }
+
+            // The credit shard persists both halves. Our earlier changes to the
+            // source must reach the store first, or it could see the debit
+            // before the deposits that paid for it.
+            if (!batch.commands.empty()) {
+                seal(shard);
+            }
+            m_crossShard.fetch_add(1, std::memory_order_relaxed);
+            command->step = Step::Credit;
+            route(command, command->otherAccountId);
+            return;
+        }
+
+        case Step::Credit: {
+            Holding* to = holding(shard, command->otherAccountId);
+            if (!to || to->status != AccountStatus::Active) {
+                m_rejected.fetch_add(1, std::memory_order_relaxed);
+                command->step = Step::Refund;
+                if (shardOf(command->accountId) == shardOf(command->otherAccountId)) {
+                    apply(shard, command);
+                } else {
+                    route(command, command->accountId);
+                }
+                return;
+            }
+            to->balance += command->cents;
+            batch.deltas[command->accountId] -= command->cents;
+            batch.deltas[command->otherAccountId] += command->cents;
+            record(batch, command->accountId, TransactionType::TransferOut, command->cents, command->balance,
+                   command->description + " to " + to->number, command->otherAccountId);
+            record(batch, command->otherAccountId, TransactionType::TransferIn, command->cents, to->balance,
+                   command->description + " from " + command->fromNumber, command->accountId);
+            batch.commands.push_back(command);
+            ++shard.batched;
+            return;
+        }
+
+        case Step::Refund: {
+            // Nothing of the transfer was persisted; only the debit is undone
+            Holding* from = holding(shard, command->accountId);
+            from->balance += command->cents;
+            command->balance = from->balance;
+            if (shardOf(command->accountId) != shardOf(command->otherAccountId)) {
+                m_refunds.fetch_add(1, std::memory_order_relaxed);
+            }
+            finish(command, false);
+            return;
+        }
+    }
+}
+
+ShardedLedger::Holding* ShardedLedger::holding(Shard& shard, int accountId) {
+    auto it = shard.accounts.find(accountId);
+    if (it != shard.accounts.end()) {
+        return &it->second;
+    }
+
+    std::optional<Account> account;
+    {
+        std::lock_guard<std::mutex> lock(m_storeMutex);
+        account = m_store->findAccountById(accountId);
+    }
+    if (!account.has_value()) {
+        return nullptr;
+    }
+    Holding loaded{std::llround(account->getBalance() * 100.0), account->getStatus(), std::string(account->getAccountNumber())};
+    return &shard.accounts.emplace(accountId, std::move(loaded)).first->second;
+}
+
+void ShardedLedger::record(Batch& batch, int accountId, TransactionType type, long long cents,
+                           long long balanceAfter, const std::string& description, int relatedAccountId)
+{
+    Transaction transaction;
+    transaction.setAccountId(accountId);
+    transaction.setType(type);
+    transaction.setAmount(toAmount(cents));
+    transaction.setBalanceAfter(toAmount(balanceAfter));
+    transaction.setDescription(description);
+    transaction.setRelatedAccountId(relatedAccountId);
+    batch.records.push_back(std::move(transaction));
+}
+
+void ShardedLedger::seal(Shard& shard) {
+    {
+        std::lock_guard<std::mutex> lock(m_persistMutex);
+        m_sealed.push_back(std::move(shard.batch));
+    }
+    m_persistReady.notify_one();
+    shard.batch = std::make_unique<Batch>();
+    shard.batched = 0;
+}
+
+// Persistence
+
+void ShardedLedger::persistLoop() {
+    while (true) {
+        std::vector<std::unique_ptr<Batch>> batches;
+        {
+            std::unique_lock<std::mutex> lock(m_persistMutex);
+            m_persistReady.wait(lock, [this]() { return m_stopping || !m_sealed.empty(); });
+            if (m_sealed.empty()) {
+                return;
+            }
+            for (auto& batch : m_sealed) {
+                batches.push_back(std::move(batch));
+            }
+            m_sealed.clear();
+        }
+
+        bool ok = !m_failed && persist(batches);
+        for (const auto& batch : batches) {
+            for (Command* command : batch->commands) {
+                finish(command, ok);
+            }
+        }
+    }
+}
+
+bool ShardedLedger::persist(const std::vector<std::unique_ptr<Batch>>& batches) {
+    // Batches are in hand-off order, so every prefix leaves balances
+    // non-negative and their sum can be applied as one change per account
+    std::unordered_map<int, long long> deltas;
+    std::size_t records = 0;
+    for (const auto& batch : batches) {
+        for (const auto& [accountId, delta] : batch->deltas) {
+            deltas[accountId] += delta;
+        }
+        records += batch->records.size();
+    }
+
+    std::string error;
+    {
+        std::lock_guard<std::mutex> storeLock(m_storeMutex);
+        TransactionScope scope(*m_store);
+        bool ok = scope.isOpen();
+        for (auto it = deltas.begin(); ok && it != deltas.end(); ++it) {
+            ok = it->second == 0 || m_store->adjustBalance(it->first, toAmount(it->second)).has_value();
+        }
+        for (auto batch = batches.begin(); ok && batch != batches.end(); ++batch) {
+            for (auto record = (*batch)->records.begin(); ok && record != (*batch)->records.end(); ++record) {
+                ok = m_store->appendTransaction(*record);
+            }
+        }
+        if (ok && scope.commit()) {
+            std::lock_guard<std::mutex> lock(m_persistMutex);
+            m_batches += batches.size();
+            m_storeScopes += 1;
+            m_records += records;
+            return true;
+        }
+        error = m_store->getLastError();
+    }
+
+    std::lock_guard<std::mutex> lock(m_persistMutex);
+    m_lastError = "Store rejected a batch, ledger stopped: " +
+                  (error.empty() ? std::string("balance or status changed outside the ledger") : error);
+    m_failed = true;
+    return false;
+}
+
+void ShardedLedger::finish(Command* command, bool ok) {
+    if (command->done) {
+        command->done(ok, toAmount(command->balance));
+    }
+    delete command;
+    if (m_inFlight.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(m_drainMutex);
+        m_drained.notify_all();
+    }
+}
+
+} // namespace bank
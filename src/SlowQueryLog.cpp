@@ -0,0 +1,229 @@
+#include "SlowQueryLog.hpp"
+#include <cctype>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace bank {
+
+namespace {
+
+std::string timestamp() {
+    std::time_t now = std::time(nullptr);
+    std::tm local{};
+    localtime_r(&now, &local);
+    char buffer[32];
+    std::size_t length = std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &local);
+    return std::string(buffer, length);
+}
+
+bool isWordChar(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$';
+}
+
+/**
+ * @brief Only statements that produce a plan can be explained
+ */
+bool isExplainable(const std::string& shape) {
+    std::string verb = shape.substr(0, shape.find(' '));
+    for (auto& c : verb) {
+        c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    }
+    return verb == "SELECT" || verb == "INSERT" || verb == "UPDATE" || verb == "DELETE" || verb == "WITH";
+}
+
+} // namespace
+
+SlowQueryLog::SlowQueryLog(SlowQueryOptions options, ConnectionFactory connect)
+    : m_options(std::move(options))
+    , m_connect(std::move(connect))
+    , m_slowCount(0)
+    , m_stopping(false)
+{
+}
+
+SlowQueryLog::~SlowQueryLog() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_one();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+bool SlowQueryLog::open() {
+    if (!m_options.path.empty()) {
+        m_file.open(m_options.path, std::ios::app);
+        if (!m_file) {
+            m_lastError = "Could not open " + m_options.path;
+            return false;
+        }
+    }
+    if (m_options.explain && m_connect && !m_thread.joinable()) {
+        m_thread = std::thread(&SlowQueryLog::explainLoop, this);
+    }
+    return true;
+}
+
+void SlowQueryLog::report(std::string_view query, const char* const* values, int count,
+                          int rows, double millis, bool ok)
+{
+    m_slowCount.fetch_add(1, std::memory_order_relaxed);
+    std::string shape = shapeOf(std::string(query));
+
+    std::ostringstream line;
+    line << timestamp() << " slow query " << std::fixed << std::setprecision(1) << millis << " ms, "
+         << (ok ? std::to_string(rows) + " rows" : std::string("failed")) << ": " << shape;
+    if (values != nullptr && count > 0) {
+        line << " [";
+        for (int i = 0; i < count; ++i) {
+            line << (i > 0 ? ", " : "") << '$' << i + 1;
+            if (values[i] == nullptr) {
+                line << "=NULL";
+                continue;
+            }
+            std::size_t length = std::strlen(values[i]);
+            line << "=<" << length << (length == 1 ? " char>" : " chars>");
+        }
+        line << "]";
+    }
+    line << "\n";
+    write(line.str());
+
+    if (!m_thread.joinable() || !isExplainable(shape)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_seenShapes.size() >= kMaxShapes || m_jobs.size() >= kMaxPendingPlans ||
+            !m_seenShapes.insert(shape).second)
+        {
+            return;
+        }
+        // The parameters outlive the statement only for the first slow run of a shape
+        std::vector<std::string> params;
+        if (values != nullptr) {
+            params.reserve(static_cast<std::size_t>(count));
+            for (int i = 0; i < count; ++i) {
+                params.emplace_back(values[i] != nullptr ? values[i] : "");
+            }
+        }
+        m_jobs.push_back(PlanJob{std::move(shape), std::string(query), std::move(params),
+                                 values != nullptr, millis});
+    }
+    m_wake.notify_one();
+}
+
+std::vector<SlowQueryPlan> SlowQueryLog::getPlans() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_plans;
+}
+
+std::string SlowQueryLog::shapeOf(const std::string& query) {
+    std::string shape;
+    shape.reserve(query.size());
+    for (std::size_t i = 0; i < query.size(); ++i) {
+        char c = query[i];
+        bool afterWord = !shape.empty() && isWordChar(shape.back());
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            if (!shape.empty() && shape.back() != ' ') {
+                shape += ' ';
+            }
+        } else if (c == '\'') {
+            // Quoted literal, with '' as an escaped quote
+            ++i;
+            while (i < query.size() && !(query[i] == '\'' && (i + 1 >= query.size() || query[i + 1] != '\''))) {
+                i += query[i] == '\'' ? 2 : 1;
+            }
+            shape += '?';
+        } else if (std::isdigit(static_cast<unsigned char>(c)) && !afterWord) {
+            while (i + 1 < query.size() && (std::isdigit(static_cast<unsigned char>(query[i + 1])) || query[i + 1] == '.')) {
+                ++i;
+            }
+            shape += '?';
+        } else {
+            shape += c;
+        }
+    }
+    if (!shape.empty() && shape.back() == ' ') {
+        shape.pop_back();
+    }
+    return shape;
+}
+
+void SlowQueryLog::explainLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_wake.wait(lock, [this] { return m_stopping || !m_jobs.empty(); });
+        if (m_stopping) {
+            return;
+        }
+        PlanJob job = std::move(m_jobs.front());
+        m_jobs.pop_front();
+        lock.unlock();
+
+        std::string plan = explain(job);
+        std::ostringstream block;
+        block << timestamp() << " plan for: " << job.shape << "\n";
+        std::istringstream lines(plan);
+        for (std::string line; std::getline(lines, line);) {
+            block << "    " << line << "\n";
+        }
+        write(block.str());
+
+        lock.lock();
+        m_plans.push_back({std::move(job.shape), job.millis, std::move(plan)});
+    }
+}
+
+std::string SlowQueryLog::explain(const PlanJob& job) {
+    if (!m_side || !m_side->isConnected()) {
+        m_side = m_connect();
+        if (!m_side || !m_side->connect()) {
+            std::string error = m_side ? m_side->getLastError() : "no connection";
+            m_side.reset();
+            return "(no plan: could not connect: " + error + ")";
+        }
+    }
+
+    // ANALYZE runs the statement, so never let it commit or wait long on locks
+    Database& db = *m_side;
+    if (!db.execute("BEGIN")) {
+        return "(no plan: " + db.getLastError() + ")";
+    }
+    db.execute("SET LOCAL lock_timeout = '2s'");
+    db.execute("SET LOCAL statement_timeout = '60s'");
+
+    std::string sql = "EXPLAIN (ANALYZE, BUFFERS) " + job.query;
+    auto rows = job.hasParams ? db.queryParams(sql, job.params) : db.query(sql);
+    std::string error = rows.empty() ? db.getLastError() : std::string();
+    db.execute("ROLLBACK");
+
+    if (rows.empty()) {
+        return "(no plan: " + error + ")";
+    }
+    std::string plan;
+    for (const auto& row : rows) {
+        if (!row.empty()) {
+            plan += row[0];
+            plan += '\n';
+        }
+    }
+    return plan;
+}
+
+void SlowQueryLog::write(const std::string& text) {
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    if (m_file.is_open()) {
+        m_file << text;
+        m_file.flush();
+    } else {
+        std::cerr << text;
+    }
+}
+
+} // namespace bank
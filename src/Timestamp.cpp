@@ -0,0 +1,405 @@
+#include "Timestamp.hpp"
+#include <chrono>
+#include <ctime>
+
+namespace bank {
+
+namespace {
+
+constexpr std::int64_t kMicrosPerSecond = 1000000;
+constexpr std::int64_t kSecondsPerDay = 86400;
+
+constexpr std::int64_t floorDiv(std::int64_t value, std::int64_t divisor) {
+    return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+// Days since 1970-01-01 of a proleptic Gregorian date, and back
+// (the algorithms of http://howardhinnant.github.io/date_algorithms.html)
+constexpr std::int64_t daysFromCivil(std::int64_t year, unsigned month, unsigned day) {
+    year -= month <= 2 ? 1 : 0;
+    std::int64_t era = (year >= 0 ? year : year - 399) / 400;
+    auto yearOfEra = static_cast<unsigned>(year - era * 400);
+    unsigned dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + static_cast<std::int64_t>(dayOfEra) - 719468;
+}
+
+constexpr bool isLeapYear(std::int64_t year) {
+    return year % 4 == 0 && (year % 100 != 0 || year % 400 == 0);
+}
+
+constexpr unsigned daysInMonth(std::int64_t year, unsigned month) {
+    constexpr unsigned kDays[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    return month == 2 && isLeapYear(year) ? 29 : kDays[month - 1];
+}
+
+void civilFromDays(std::int64_t days, std::int64_t& year, unsigned& month, unsigned& day) {
+    days += 719468;
+    std::int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    auto dayOfEra = static_cast<unsigned>(days - era * 146097);
+    unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    unsigned shiftedMonth = (5 * dayOfYear + 2) / 153;
+    day = dayOfYear - (153 * shiftedMonth + 2) / 5 + 1;
+    month = shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9;
+    year = static_cast<std::int64_t>(yearOfEra) + era * 400 + (month <= 2 ? 1 : 0);
+}
+
+/**
+ * @brief Local time minus UTC, in seconds, at a UTC instant
+ */
+std::int64_t offsetAt(std::int64_t utcSeconds) {
+    std::time_t time = static_cast<std::time_t>(utcSeconds);
+    std::tm local{};
+    localtime_r(&time, &local);
+    std::int64_t localSeconds =
+        daysFromCivil(local.tm_year + 1900, static_cast<unsigned>(local.tm_mon + 1),
+                      static_cast<unsigned>(local.tm_mday)) * kSecondsPerDay +
+        local.tm_hour * 3600 + local.tm_min * 60 + local.tm_sec;
+    return localSeconds - utcSeconds;
+}
+
+/**
+ * @brief UTC seconds [from, to) over which the local UTC offset is constant
+ *
+ * before and after are the offsets either side; an edge that is only the
+ * end of the search rather than a change of offset has them equal to offset.
+ */
+struct OffsetSpan {
+    std::int64_t from = 0;
+    std::int64_t to = 0;
+    std::int64_t offset = 0;
+    std::int64_t before = 0;
+    std::int64_t after = 0;
+
+    bool contains(std::int64_t utcSeconds) const { return utcSeconds >= from && utcSeconds < to; }
+};
+
+/**
+ * @brief First second in (low, high] whose offset differs from the one at low
+ *
+ * The offset must change exactly once in the range.
+ */
+std::int64_t findChange(std::int64_t low, std::int64_t high, std::int64_t offsetAtLow) {
+    while (high - low > 1) {
+        std::int64_t middle = low + (high - low) / 2;
+        (offsetAt(middle) == offsetAtLow ? low : high) = middle;
+    }
+    return high;
+}
+
+/**
+ * @brief The span of constant offset around a UTC instant, searched a day either side
+ *
+ * Zones change their offset at most once a day, so a probe a day away
+ * that sees another offset brackets exactly one change, found to the
+ * second by bisection.
+ */
+OffsetSpan findSpan(std::int64_t utcSeconds) {
+    OffsetSpan span;
+    span.offset = offsetAt(utcSeconds);
+    span.from = utcSeconds - kSecondsPerDay;
+    span.before = offsetAt(span.from);
+    if (span.before != span.offset) {
+        span.from = findChange(span.from, utcSeconds, span.before);
+    }
+    span.to = utcSeconds + kSecondsPerDay;
+    span.after = offsetAt(span.to);
+    if (span.after != span.offset) {
+        span.to = findChange(utcSeconds, span.to, span.offset);
+    }
+    return span;
+}
+
+/**
+ * @brief The span containing a UTC instant, cached per thread
+ */
+const OffsetSpan& spanContaining(std::int64_t utcSeconds) {
+    thread_local OffsetSpan cached;
+    if (!cached.contains(utcSeconds)) {
+        cached = findSpan(utcSeconds);
+    }
+    return cached;
+}
+
+std::int64_t localOffset(std::int64_t utcSeconds) {
+    return spanContaining(utcSeconds).offset;
+}
+
+/**
+ * @brief UTC seconds of a local wall-clock time
+ *
+ * Every instant whose own offset maps it to the wall time is a candidate,
+ * and the earliest wins: a time repeated when clocks go back resolves to
+ * its first pass, so instants in the second pass do not survive a trip
+ * through local text (TIMESTAMP columns cannot tell the two apart). A time
+ * skipped when clocks go forward is read with the offset before the
+ * change, as mktime() does. localtime_r is used rather than mktime(),
+ * which rereads the zone on every call.
+ */
+std::int64_t localToUtc(std::int64_t localSeconds) {
+    OffsetSpan span = spanContaining(localSeconds);
+    std::int64_t utc = localSeconds - span.offset;
+    // The guess lands in a span that is only cut short by the search; look there
+    for (int i = 0; i < 3; ++i) {
+        bool pastSearch = (utc < span.from && span.before == span.offset) ||
+                          (utc >= span.to && span.after == span.offset);
+        if (!pastSearch) {
+            break;
+        }
+        span = spanContaining(utc);
+        utc = localSeconds - span.offset;
+    }
+    std::int64_t earlier = localSeconds - span.before;
+    if (span.before != span.offset && earlier < span.from) {
+        return earlier;
+    }
+    if (span.contains(utc)) {
+        return utc;
+    }
+    if (utc < span.from) {
+        return earlier;
+    }
+    std::int64_t later = localSeconds - span.after;
+    return later >= span.to ? later : utc;
+}
+
+/**
+ * @brief Reads fixed-width fields from the front of a string
+ */
+class Cursor {
+public:
+    explicit Cursor(std::string_view text) : m_text(text), m_pos(0) {}
+
+    bool atEnd() const { return m_pos == m_text.size(); }
+    char peek() const { return atEnd() ? '\0' : m_text[m_pos]; }
+
+    bool skip(char c) {
+        if (peek() != c) {
+            return false;
+        }
+        ++m_pos;
+        return true;
+    }
+
+    bool digits(int count, int& value) {
+        value = 0;
+        for (int i = 0; i < count; ++i, ++m_pos) {
+            char c = peek();
+            if (c < '0' || c > '9') {
+                return false;
+            }
+            value = value * 10 + (c - '0');
+        }
+        return true;
+    }
+
+    // Fraction of a second as microseconds; digits past the sixth are dropped
+    bool fraction(std::int64_t& micros) {
+        micros = 0;
+        int count = 0;
+        for (char c = peek(); c >= '0' && c <= '9'; c = peek()) {
+            if (count++ < 6) {
+                micros = micros * 10 + (c - '0');
+            }
+            ++m_pos;
+        }
+        for (int i = count; i < 6; ++i) {
+            micros *= 10;
+        }
+        return count > 0;
+    }
+
+private:
+    std::string_view m_text;
+    std::size_t m_pos;
+};
+
+/**
+ * @brief Start of the local period containing local wall-clock seconds, or of the step'th after it
+ */
+std::int64_t periodStart(std::int64_t local, TimeUnit unit, int step) {
+    switch (unit) {
+        case TimeUnit::Hour:
+            return (floorDiv(local, 3600) + step) * 3600;
+        case TimeUnit::Day:
+            return (floorDiv(local, kSecondsPerDay) + step) * kSecondsPerDay;
+        case TimeUnit::Month:
+            break;
+    }
+    std::int64_t year = 0;
+    unsigned month = 0;
+    unsigned day = 0;
+    civilFromDays(floorDiv(local, kSecondsPerDay), year, month, day);
+    month += static_cast<unsigned>(step);
+    if (month > 12) {
+        month -= 12;
+        ++year;
+    }
+    return daysFromCivil(year, month, 1) * kSecondsPerDay;
+}
+
+std::int64_t toLocal(std::int64_t utcMicros) {
+    std::int64_t seconds = floorDiv(utcMicros, kMicrosPerSecond);
+    return seconds + localOffset(seconds);
+}
+
+void putDigits(char* out, std::int64_t value, int count) {
+    for (int i = count - 1; i >= 0; --i) {
+        out[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+}
+
+} // namespace
+
+Timestamp Timestamp::now() {
+    return Timestamp(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+std::optional<Timestamp> Timestamp::parse(std::string_view text) {
+    Cursor in(text);
+    int year = 0;
+    int month = 0;
+    int day = 0;
+    if (!in.digits(4, year) || !in.skip('-') || !in.digits(2, month) || !in.skip('-') ||
+        !in.digits(2, day) || month < 1 || month > 12 || day < 1 ||
+        static_cast<unsigned>(day) > daysInMonth(year, static_cast<unsigned>(month))) {
+        return std::nullopt;
+    }
+
+    int hour = 0;
+    int minute = 0;
+    int second = 0;
+    std::int64_t micros = 0;
+    if (in.skip('T') || in.skip(' ')) {
+        if (!in.digits(2, hour) || !in.skip(':') || !in.digits(2, minute) || hour > 23 || minute > 59) {
+            return std::nullopt;
+        }
+        if (in.skip(':')) {
+            if (!in.digits(2, second) || second > 59) {
+                return std::nullopt;
+            }
+            if ((in.skip('.') || in.skip(',')) && !in.fraction(micros)) {
+                return std::nullopt;
+            }
+        }
+    }
+
+    std::int64_t seconds = daysFromCivil(year, static_cast<unsigned>(month), static_cast<unsigned>(day)) *
+                           kSecondsPerDay + hour * 3600 + minute * 60 + second;
+    if (in.skip('Z') || in.skip('z')) {
+        // Already UTC
+    } else if (in.peek() == '+' || in.peek() == '-') {
+        int sign = in.peek() == '-' ? -1 : 1;
+        in.skip(in.peek());
+        int offsetHours = 0;
+        int offsetMinutes = 0;
+        if (!in.digits(2, offsetHours)) {
+            return std::nullopt;
+        }
+        if (!in.atEnd()) {
+            in.skip(':');
+            if (!in.digits(2, offsetMinutes)) {
+                return std::nullopt;
+            }
+        }
+        seconds -= sign * (offsetHours * 3600 + offsetMinutes * 60);
+    } else {
+        seconds = localToUtc(seconds);
+    }
+
+    if (!in.atEnd()) {
+        return std::nullopt;
+    }
+    return Timestamp(seconds * kMicrosPerSecond + micros);
+}
+
+void Timestamp::format(char* out) const {
+    std::int64_t seconds = floorDiv(m_micros, kMicrosPerSecond);
+    std::int64_t micros = m_micros - seconds * kMicrosPerSecond;
+    std::int64_t local = seconds + localOffset(seconds);
+    std::int64_t days = floorDiv(local, kSecondsPerDay);
+    std::int64_t secondOfDay = local - days * kSecondsPerDay;
+
+    std::int64_t year = 0;
+    unsigned month = 0;
+    unsigned day = 0;
+    civilFromDays(days, year, month, day);
+    if (year < 0 || year > 9999) {
+        year = year < 0 ? 0 : 9999;
+    }
+
+    putDigits(out, year, 4);
+    out[4] = '-';
+    putDigits(out + 5, month, 2);
+    out[7] = '-';
+    putDigits(out + 8, day, 2);
+    out[10] = ' ';
+    putDigits(out + 11, secondOfDay / 3600, 2);
+    out[13] = ':';
+    putDigits(out + 14, secondOfDay / 60 % 60, 2);
+    out[16] = ':';
+    putDigits(out + 17, secondOfDay % 60, 2);
+    out[19] = '.';
+    putDigits(out + 20, micros, 6);
+}
+
+std::string Timestamp::toString() const {
+    char buffer[kTextLength];
+    format(buffer);
+    return std::string(buffer, kTextLength);
+}
+
+Timestamp Timestamp::startOf(TimeUnit unit) const {
+    return Timestamp(localToUtc(periodStart(toLocal(m_micros), unit, 0)) * kMicrosPerSecond);
+}
+
+Timestamp Timestamp::startOfNext(TimeUnit unit) const {
+    return Timestamp(localToUtc(periodStart(toLocal(m_micros), unit, 1)) * kMicrosPerSecond);
+}
+
+RangeCover RangeCover::of(const TimeRange& range) {
+    RangeCover cover;
+    cover.rest[0] = range;
+    if (range.empty()) {
+        return cover;
+    }
+
+    // Boundaries are found in local wall-clock seconds, then each is converted once
+    auto ceil = [](std::int64_t local, bool exact, TimeUnit unit) {
+        std::int64_t start = periodStart(local, unit, 0);
+        return start == local && exact ? start : periodStart(local, unit, 1);
+    };
+    std::int64_t hourFrom = ceil(toLocal(range.from.micros()), range.from.micros() % kMicrosPerSecond == 0,
+                                 TimeUnit::Hour);
+    std::int64_t hourTo = periodStart(toLocal(range.to.micros()), TimeUnit::Hour, 0);
+    if (hourTo <= hourFrom) {
+        return cover;
+    }
+
+    // Each pair collapses onto the one inside it when no whole period fits
+    std::int64_t dayFrom = ceil(hourFrom, true, TimeUnit::Day);
+    std::int64_t dayTo = periodStart(hourTo, TimeUnit::Day, 0);
+    if (dayTo <= dayFrom) {
+        dayFrom = dayTo = hourTo;
+    }
+    std::int64_t monthFrom = ceil(dayFrom, true, TimeUnit::Month);
+    std::int64_t monthTo = periodStart(dayTo, TimeUnit::Month, 0);
+    if (monthTo <= monthFrom) {
+        monthFrom = monthTo = dayTo;
+    }
+
+    auto utc = [](std::int64_t local) { return Timestamp::fromMicros(localToUtc(local) * kMicrosPerSecond); };
+    cover.rest[0] = {range.from, utc(hourFrom)};
+    cover.hours[0] = {cover.rest[0].to, utc(dayFrom)};
+    cover.days[0] = {cover.hours[0].to, utc(monthFrom)};
+    cover.months = {cover.days[0].to, utc(monthTo)};
+    cover.days[1] = {cover.months.to, utc(dayTo)};
+    cover.hours[1] = {cover.days[1].to, utc(hourTo)};
+    cover.rest[1] = {cover.hours[1].to, range.to};
+    return cover;
+}
+
+} // namespace bank
@@ -0,0 +1,226 @@
+#include "Trace.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace bank {
+
+namespace trace {
+
+namespace detail {
+std::atomic<bool> g_enabled{false};
+} // namespace detail
+
+namespace {
+
+struct Event {
+    std::uint64_t start;
+    std::uint64_t duration;
+    const char* category;
+    const char* name;
+    std::uint32_t thread;
+    std::uint8_t detailLength;
+    char detail[kMaxDetail];
+};
+
+/**
+ * @brief Ring of recent events, written by one thread at a time
+ *
+ * The mutex is only ever contended by writeChromeTrace() and start().
+ */
+struct ThreadBuffer {
+    std::mutex mutex;
+    std::vector<Event> events;
+    std::uint64_t written = 0;
+};
+
+/**
+ * @brief Every buffer ever handed out, plus those of exited threads
+ *
+ * A thread's buffer goes back on the free list when it exits and is
+ * reused, events included, by the next thread that records; each event
+ * carries its own thread number. Thread-per-request code therefore needs
+ * as many buffers as it has threads at once, not in total.
+ */
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::vector<ThreadBuffer*> free;
+    std::unordered_map<std::uint32_t, std::string> names;
+    std::size_t capacity = kDefaultEventsPerThread;
+    std::uint32_t nextThread = 1;
+};
+
+Registry& registry() {
+    // Never destroyed: exiting threads return their buffers after static destruction
+    static Registry* instance = new Registry;
+    return *instance;
+}
+
+struct ThreadState {
+    std::uint32_t thread = 0;
+    ThreadBuffer* buffer = nullptr;
+
+    std::uint32_t id() {
+        if (thread == 0) {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            thread = r.nextThread++;
+        }
+        return thread;
+    }
+
+    ThreadBuffer& acquire() {
+        if (buffer == nullptr) {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            if (r.free.empty()) {
+                r.buffers.push_back(std::make_unique<ThreadBuffer>());
+                buffer = r.buffers.back().get();
+                buffer->events.resize(r.capacity);
+            } else {
+                buffer = r.free.back();
+                r.free.pop_back();
+            }
+        }
+        return *buffer;
+    }
+
+    ~ThreadState() {
+        if (buffer != nullptr) {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            r.free.push_back(buffer);
+        }
+    }
+};
+
+thread_local ThreadState t_state;
+
+void writeEscaped(std::ostream& out, std::string_view text) {
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out << escaped;
+        } else {
+            out << c;
+        }
+    }
+}
+
+void writeMicros(std::ostream& out, std::uint64_t nanos) {
+    out << nanos / 1000 << '.';
+    char fraction[4];
+    std::snprintf(fraction, sizeof(fraction), "%03u", static_cast<unsigned>(nanos % 1000));
+    out << fraction;
+}
+
+} // namespace
+
+void start(std::size_t eventsPerThread) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.capacity = std::max<std::size_t>(eventsPerThread, 1);
+    for (auto& buffer : r.buffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        buffer->events.assign(r.capacity, Event{});
+        buffer->written = 0;
+    }
+    detail::g_enabled.store(true, std::memory_order_relaxed);
+}
+
+void stop() {
+    detail::g_enabled.store(false, std::memory_order_relaxed);
+}
+
+void setThreadName(const std::string& name) {
+    std::uint32_t thread = t_state.id();
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.names[thread] = name;
+}
+
+void record(const char* category, const char* name, std::string_view detail,
+            std::uint64_t startNanos, std::uint64_t endNanos)
+{
+    std::uint32_t thread = t_state.id();
+    ThreadBuffer& buffer = t_state.acquire();
+
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    Event& event = buffer.events[buffer.written % buffer.events.size()];
+    event.start = startNanos;
+    event.duration = endNanos > startNanos ? endNanos - startNanos : 0;
+    event.category = category;
+    event.name = name;
+    event.thread = thread;
+    event.detailLength = static_cast<std::uint8_t>(std::min(detail.size(), kMaxDetail));
+    std::copy_n(detail.data(), event.detailLength, event.detail);
+    ++buffer.written;
+}
+
+bool writeChromeTrace(const std::string& path) {
+    std::vector<Event> events;
+    std::unordered_map<std::uint32_t, std::string> names;
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        names = r.names;
+        for (auto& buffer : r.buffers) {
+            std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+            std::uint64_t size = buffer->events.size();
+            std::uint64_t kept = std::min(buffer->written, size);
+            for (std::uint64_t i = buffer->written - kept; i < buffer->written; ++i) {
+                events.push_back(buffer->events[i % size]);
+            }
+        }
+    }
+
+    // Parents start no later than their children, so they come first
+    std::sort(events.begin(), events.end(), [](const Event& a, const Event& b) {
+        return a.start != b.start ? a.start < b.start : a.duration > b.duration;
+    });
+    std::uint64_t origin = events.empty() ? 0 : events.front().start;
+
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+    out << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n";
+    bool first = true;
+    for (const auto& [thread, name] : names) {
+        out << (first ? "" : ",\n") << "{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": 1, \"tid\": "
+            << thread << ", \"args\": {\"name\": \"";
+        writeEscaped(out, name);
+        out << "\"}}";
+        first = false;
+    }
+    for (const auto& event : events) {
+        // The detail goes into the name, e.g. "sql UPDATE accounts", so the viewer shows it
+        std::string_view detail(event.detail, event.detailLength);
+        out << (first ? "" : ",\n") << "{\"ph\": \"X\", \"cat\": \"" << event.category
+            << "\", \"name\": \"" << event.name;
+        if (!detail.empty()) {
+            out << ' ';
+            writeEscaped(out, detail);
+        }
+        out << "\", \"pid\": 1, \"tid\": " << event.thread << ", \"ts\": ";
+        writeMicros(out, event.start - origin);
+        out << ", \"dur\": ";
+        writeMicros(out, event.duration);
+        out << "}";
+        first = false;
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out.flush());
+}
+
+} // namespace trace
+
+} // namespace bank
@@ -0,0 +1,117 @@
+#include "TransactionBatch.hpp"
+
+namespace bank {
+
+// StringPool
+
+std::size_t StringPool::recentSlot(std::string_view text) {
+    if (text.empty()) {
+        return 0;
+    }
+    auto first = static_cast<unsigned char>(text.front());
+    auto last = static_cast<unsigned char>(text.back());
+    return (text.size() * 31 + first * 7 + last) % kRecentSlots;
+}
+
+std::uint32_t StringPool::intern(std::string_view text) {
+    Recent& recent = m_recent[recentSlot(text)];
+    if (recent.text.data() != nullptr && recent.text == text) {
+        return recent.id;
+    }
+
+    auto it = m_ids.find(text);
+    if (it == m_ids.end()) {
+        auto id = static_cast<std::uint32_t>(m_strings.size());
+        const std::string& stored = m_strings.emplace_back(text);
+        it = m_ids.emplace(std::string_view(stored), id).first;
+    }
+    recent.text = it->first;
+    recent.id = it->second;
+    return it->second;
+}
+
+// TransactionBatch
+
+TransactionBatch::TransactionBatch()
+    : TransactionBatch(std::make_shared<StringPool>())
+{
+}
+
+TransactionBatch::TransactionBatch(std::shared_ptr<StringPool> descriptions)
+    : m_descriptions(std::move(descriptions))
+{
+}
+
+void TransactionBatch::reserve(std::size_t count) {
+    m_transactionIds.reserve(count);
+    m_accountIds.reserve(count);
+    m_relatedAccountIds.reserve(count);
+    m_types.reserve(count);
+    m_descriptionIds.reserve(count);
+    m_amounts.reserve(count);
+    m_balancesAfter.reserve(count);
+    m_createdAt.reserve(count);
+}
+
+void TransactionBatch::clear() {
+    m_transactionIds.clear();
+    m_accountIds.clear();
+    m_relatedAccountIds.clear();
+    m_types.clear();
+    m_descriptionIds.clear();
+    m_amounts.clear();
+    m_balancesAfter.clear();
+    m_createdAt.clear();
+}
+
+void TransactionBatch::push_back(const Transaction& transaction) {
+    push_back(transaction, transaction.getCreatedAt().micros());
+}
+
+void TransactionBatch::push_back(const Transaction& transaction, std::int64_t createdAtMicros) {
+    m_transactionIds.push_back(transaction.getTransactionId());
+    m_accountIds.push_back(transaction.getAccountId());
+    m_relatedAccountIds.push_back(transaction.getRelatedAccountId());
+    m_types.push_back(transaction.getType());
+    m_descriptionIds.push_back(m_descriptions->intern(transaction.getDescription()));
+    m_amounts.push_back(transaction.getAmount());
+    m_balancesAfter.push_back(transaction.getBalanceAfter());
+    m_createdAt.push_back(createdAtMicros);
+}
+
+void TransactionBatch::pop_back() {
+    m_transactionIds.pop_back();
+    m_accountIds.pop_back();
+    m_relatedAccountIds.pop_back();
+    m_types.pop_back();
+    m_descriptionIds.pop_back();
+    m_amounts.pop_back();
+    m_balancesAfter.pop_back();
+    m_createdAt.pop_back();
+}
+
+Transaction TransactionBatch::at(std::size_t i) const {
+    Transaction transaction;
+    transaction.setTransactionId(m_transactionIds[i]);
+    transaction.setAccountId(m_accountIds[i]);
+    transaction.setType(m_types[i]);
+    transaction.setAmount(m_amounts[i]);
+    transaction.setBalanceAfter(m_balancesAfter[i]);
+    transaction.setDescription(std::string(description(i)));
+    transaction.setRelatedAccountId(m_relatedAccountIds[i]);
+    transaction.setCreatedAt(Timestamp::fromMicros(m_createdAt[i]));
+    return transaction;
+}
+
+std::size_t TransactionBatch::memoryBytes() const {
+    return m_transactionIds.capacity() * sizeof(std::int32_t) +
+           m_accountIds.capacity() * sizeof(std::int32_t) +
+           m_relatedAccountIds.capacity() * sizeof(std::int32_t) +
+           m_types.capacity() * sizeof(TransactionType) +
+           m_descriptionIds.capacity() * sizeof(std::uint32_t) +
+           m_amounts.capacity() * sizeof(double) +
+           m_balancesAfter.capacity() * sizeof(double) +
+           m_createdAt.capacity() * sizeof(std::int64_t);
+}
+
+} // namespace bank
@@ -0,0 +1,126 @@
+#include "WorkStealingPool.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace bank {
+
+WorkStealingPool::WorkStealingPool(std::size_t workers, std::size_t queueCapacity)
+    : m_capacity(std::max<std::size_t>(1, queueCapacity))
+    , m_queued(0)
+    , m_stopping(false)
+    , m_executed(0)
+    , m_stolen(0)
+    , m_blocked(0)
+{
+    if (workers == 0) {
+        workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (std::size_t i = 0; i < workers; ++i) {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+    for (std::size_t i = 0; i < workers; ++i) {
+        m_workers[i]->thread = std::thread(&WorkStealingPool::run, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_idleMutex);
+        m_stopping = true;
+    }
+    m_workReady.notify_all();
+    for (auto& worker : m_workers) {
+        {
+            std::lock_guard<std::mutex> lock(worker->mutex);
+        }
+        worker->notFull.notify_all();
+    }
+    for (auto& worker : m_workers) {
+        worker->thread.join();
+    }
+}
+
+bool WorkStealingPool::submit(std::size_t affinity, Task task) {
+    Worker& worker = *m_workers[affinity % m_workers.size()];
+    {
+        std::unique_lock<std::mutex> lock(worker.mutex);
+        if (worker.tasks.size() >= m_capacity) {
+            m_blocked.fetch_add(1, std::memory_order_relaxed);
+            worker.notFull.wait(lock, [&]() {
+                return worker.tasks.size() < m_capacity || m_stopping;
+            });
+        }
+        if (m_stopping) {
+            return false;
+        }
+        worker.tasks.push_back(std::move(task));
+    }
+
+    // Counted after the push so a woken worker always finds the task
+    m_queued.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(m_idleMutex);
+    }
+    m_workReady.notify_one();
+    return true;
+}
+
+PoolStats WorkStealingPool::getStats() const {
+    PoolStats stats;
+    stats.executed = m_executed.load(std::memory_order_relaxed);
+    stats.stolen = m_stolen.load(std::memory_order_relaxed);
+    stats.blocked = m_blocked.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void WorkStealingPool::run(std::size_t index) {
+    while (true) {
+        Task task;
+        if (takeLocal(index, task) || steal(index, task)) {
+            m_queued.fetch_sub(1);
+            task(index);
+            m_executed.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_idleMutex);
+        m_workReady.wait(lock, [this]() { return m_queued.load() > 0 || m_stopping; });
+        if (m_stopping && m_queued.load() == 0) {
+            return;
+        }
+    }
+}
+
+bool WorkStealingPool::takeLocal(std::size_t index, Task& task) {
+    Worker& worker = *m_workers[index];
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (worker.tasks.empty()) {
+            return false;
+        }
+        task = std::move(worker.tasks.front());
+        worker.tasks.pop_front();
+    }
+    worker.notFull.notify_one();
+    return true;
+}
+
+bool WorkStealingPool::steal(std::size_t index, Task& task) {
+    // The owner takes from the front, thieves from the back
+    for (std::size_t offset = 1; offset < m_workers.size(); ++offset) {
+        Worker& victim = *m_workers[(index + offset) % m_workers.size()];
+        std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || victim.tasks.empty()) {
+            continue;
+        }
+        task = std::move(victim.tasks.back());
+        victim.tasks.pop_back();
+        lock.unlock();
+        victim.notFull.notify_one();
+        m_stolen.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+} // namespace bank
@@ -1,9 +1,22 @@
 #include <iostream>
+#include <iomanip>
 #include <memory>
+#include <chrono>
+#include <future>
 #include <cstdlib>
 #include "Database.hpp"
 #include "BankService.hpp"
+#include "LogLedgerStore.hpp"
+#include "BatchRunner.hpp"
+#include "RemoteBankService.hpp"
 #include "GUI.hpp"
+#include "Logger.hpp"
+#include "Trace.hpp"
+
+double millisSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+}
 
 void printUsage() {
     std::cout << "Bank Management System\n\n";
@@ -13,16 +26,153 @@ void printUsage() {
     std::cout << "  DB_NAME     - Database name (default: bank_management)\n";
     std::cout << "  DB_USER     - Database user (default: postgres)\n";
     std::cout << "  DB_PASSWORD - Database password (default: empty)\n";
+    std::cout << "  BANK_SERVER - bank_server address; same as --server\n";
+    std::cout << "  BANK_DATA_DIR - Embedded store directory; same as --data-dir\n";
     std::cout << "\nUsage:\n";
-    std::cout << "  ./bank_management      - Run the GUI application\n";
-    std::cout << "  ./bank_management -h   - Show this help\n";
+    std::cout << "  ./bank_management                  - Run the GUI application\n";
+    std::cout << "  ./bank_management --server <addr>  - Run the GUI against a bank_server instead of\n";
+    std::cout << "                                       the database (host:port or unix:/path)\n";
+    std::cout << "  ./bank_management --data-dir <dir> - Run the GUI on an embedded store in <dir>\n";
+    std::cout << "                                       instead of PostgreSQL\n";
+    std::cout << "  ./bank_management --record <file>  - Run the GUI and record input to <file>\n";
+    std::cout << "  ./bank_management --replay <file>  - Replay a recorded session headlessly\n";
+    std::cout << "                                       and report frame times per screen\n";
+    std::cout << "  ./bank_management --seed-replay    - Create the replay fixture user before\n";
+    std::cout << "                                       starting (login: replay / replay123)\n";
+    std::cout << "  ./bank_management --log-file <file>\n";
+    std::cout << "                                     - Audit log of every change and login as\n";
+    std::cout << "                                       JSON lines (not with --server)\n";
+    std::cout << "  ./bank_management --trace <file>   - Record trace spans; F4 or exiting writes\n";
+    std::cout << "                                       them to <file> (Chrome trace format)\n";
+    std::cout << "  ./bank_management --batch <file>   - Execute an operation file without a GUI\n";
+    std::cout << "      [--output <file>]                  Result file (default: stdout)\n";
+    std::cout << "      [--jobs <n>]                       Parallel workers (default: 1)\n";
+    std::cout << "      [--batch-size <n>]                 Operations per commit (default: 1)\n";
+    std::cout << "  ./bank_management -h               - Show this help\n";
+}
+
+int runBatch(const bank::BatchOptions& options, const std::string& host, const std::string& port,
+             const std::string& name, const std::string& user, const std::string& password) 
+{
+    bank::BatchRunner runner([&]() {
+        auto db = std::make_shared<bank::Database>(host, port, name, user, password);
+        db->connect();
+        return db;
+    }, options);
+
+    auto summary = runner.run();
+    if (!summary.has_value()) {
+        std::cerr << "Error: " << runner.getLastError() << "\n";
+        return 1;
+    }
+
+    // Results may go to stdout, so the summary goes to stderr
+    std::cerr << std::fixed << std::setprecision(3)
+              << "Batch: " << summary->total << " operations (" << summary->succeeded 
+              << " ok, " << summary->failed << " failed) in " << summary->seconds << " s, "
+              << (summary->seconds > 0 ? summary->total / summary->seconds : 0.0) << " ops/s\n"
+              << "Latency ms: p50 " << summary->p50Millis << ", p95 " << summary->p95Millis
+              << ", p99 " << summary->p99Millis << ", max " << summary->maxMillis << "\n";
+    return summary->failed == 0 ? 0 : 2;
+}
+
+int runReplay(std::shared_ptr<bank::BankApi> service, const std::string& sessionPath) {
+    auto session = bank::InputSession::load(sessionPath);
+    if (!session.has_value()) {
+        std::cerr << "Error: Could not read input session " << sessionPath << "\n";
+        return 1;
+    }
+
+    bank::BankGUI gui(service, true);
+    auto report = gui.replay(*session);
+
+    std::cout << "Replayed " << session->frameCount << " frames, " 
+              << session->events.size() << " events\n\n";
+    std::cout << std::left << std::setw(20) << "Screen" << std::right
+              << std::setw(8) << "Frames" << std::setw(10) << "p50 ms"
+              << std::setw(10) << "p95 ms" << std::setw(10) << "p99 ms"
+              << std::setw(10) << "max ms" << "\n";
+    std::cout << std::fixed << std::setprecision(3);
+    for (const auto& screen : report) {
+        std::cout << std::left << std::setw(20) << bank::appStateName(screen.screen) << std::right
+                  << std::setw(8) << screen.frames << std::setw(10) << screen.p50
+                  << std::setw(10) << screen.p95 << std::setw(10) << screen.p99
+                  << std::setw(10) << screen.max << "\n";
+    }
+    return 0;
 }
 
+/**
+ * @brief Writes the recorded trace when main returns, whichever way it does
+ */
+struct TraceWriter {
+    std::string path;
+
+    ~TraceWriter() {
+        if (path.empty()) {
+            return;
+        }
+        bank::trace::stop();
+        if (bank::trace::writeChromeTrace(path)) {
+            std::cerr << "Trace written to " << path << "\n";
+        } else {
+            std::cerr << "Error: Could not write " << path << "\n";
+        }
+    }
+};
+
 int main(int argc, char* argv[]) {
-    // Check for help flag
-    if (argc > 1 && (std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help")) {
-        printUsage();
-        return 0;
+    std::string recordPath;
+    std::string replayPath;
+    bool seedReplay = false;
+    const char* bankServer = std::getenv("BANK_SERVER");
+    std::string serverAddress = bankServer ? bankServer : "";
+    const char* bankDataDir = std::getenv("BANK_DATA_DIR");
+    std::string dataDir = bankDataDir ? bankDataDir : "";
+    bank::BatchOptions batchOptions;
+    TraceWriter traceWriter;
+    bank::LoggerOptions logOptions;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            printUsage();
+            return 0;
+        } else if (arg == "--record" && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (arg == "--replay" && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else if (arg == "--server" && i + 1 < argc) {
+            serverAddress = argv[++i];
+        } else if (arg == "--data-dir" && i + 1 < argc) {
+            dataDir = argv[++i];
+        } else if (arg == "--trace" && i + 1 < argc) {
+            traceWriter.path = argv[++i];
+        } else if (arg == "--log-file" && i + 1 < argc) {
+            logOptions.path = argv[++i];
+        } else if (arg == "--seed-replay") {
+            seedReplay = true;
+        } else if (arg == "--batch" && i + 1 < argc) {
+            batchOptions.inputPath = argv[++i];
+        } else if (arg == "--output" && i + 1 < argc) {
+            batchOptions.outputPath = argv[++i];
+        } else if ((arg == "--jobs" || arg == "--batch-size") && i + 1 < argc) {
+            int value = std::atoi(argv[++i]);
+            if (value < 1) {
+                std::cerr << arg << " must be a positive number\n";
+                return 1;
+            }
+            (arg == "--jobs" ? batchOptions.jobs : batchOptions.batchSize) = value;
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n\n";
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (!traceWriter.path.empty()) {
+        bank::trace::start();
+        bank::trace::setThreadName("main");
     }
 
     // Get database configuration from environment variables
@@ -38,30 +188,138 @@ int main(int argc, char* argv[]) {
     std::string user = dbUser ? dbUser : "postgres";
     std::string password = dbPassword ? dbPassword : "";
 
-    std::cout << "Connecting to database " << name << " at " << host << ":" << port << "...\n";
-
-    // Create database connection
-    auto db = std::make_shared<bank::Database>(host, port, name, user, password);
-    
-    if (!db->connect()) {
-        std::cerr << "Error: Failed to connect to database!\n";
-        std::cerr << "Details: " << db->getLastError() << "\n\n";
-        std::cerr << "Please ensure PostgreSQL is running and the database exists.\n";
-        std::cerr << "You can create the database and schema using:\n";
-        std::cerr << "  createdb " << name << "\n";
-        std::cerr << "  psql -d " << name << " -f sql/schema.sql\n";
-        return 1;
+    // Batch mode never creates a window and always talks to the database directly
+    if (!batchOptions.inputPath.empty()) {
+        return runBatch(batchOptions, host, port, name, user, password);
     }
 
-    std::cout << "Database connected successfully!\n";
+    auto startupBegin = std::chrono::steady_clock::now();
 
-    // Create bank service
-    auto service = std::make_shared<bank::BankService>(db);
+    // The server keeps its own audit log
+    std::shared_ptr<bank::Logger> logger;
+    if (!logOptions.path.empty() && serverAddress.empty()) {
+        logger = std::make_shared<bank::Logger>(logOptions);
+        if (!logger->open()) {
+            std::cerr << "Error: " << logger->getLastError() << "\n";
+            return 1;
+        }
+    }
+
+    // Create the bank service on a database connection, an embedded store or as a server client
+    std::shared_ptr<bank::Database> db;
+    std::shared_ptr<bank::LogLedgerStore> store;
+    std::shared_ptr<bank::RemoteBankService> remote;
+    std::shared_ptr<bank::BankApi> service;
+    if (!serverAddress.empty()) {
+        std::cout << "Connecting to bank server " << serverAddress << "...\n";
+        remote = std::make_shared<bank::RemoteBankService>(serverAddress);
+        service = remote;
+    } else if (!dataDir.empty()) {
+        std::cout << "Opening embedded store in " << dataDir << "...\n";
+        bank::LogStoreOptions storeOptions;
+        storeOptions.directory = dataDir;
+        store = std::make_shared<bank::LogLedgerStore>(storeOptions);
+        auto local = std::make_shared<bank::BankService>(store);
+        local->setLogger(logger);
+        service = local;
+    } else {
+        std::cout << "Connecting to database " << name << " at " << host << ":" << port << "...\n";
+        db = std::make_shared<bank::Database>(host, port, name, user, password);
+        auto local = std::make_shared<bank::BankService>(db);
+        local->setLogger(logger);
+        service = local;
+    }
+    // Balance charts load on a worker thread through a service of their own,
+    // so a chart fetch never holds up the UI's connection
+    std::shared_ptr<bank::Database> chartDb;
+    std::shared_ptr<bank::RemoteBankService> chartRemote;
+    std::shared_ptr<bank::BankApi> chartService;
+    if (replayPath.empty()) {
+        if (remote) {
+            chartRemote = std::make_shared<bank::RemoteBankService>(serverAddress);
+            chartService = chartRemote;
+        } else if (store) {
+            // The store is thread safe; the service's call records are per instance
+            chartService = std::make_shared<bank::BankService>(store);
+        } else {
+            chartDb = std::make_shared<bank::Database>(host, port, name, user, password);
+            chartService = std::make_shared<bank::BankService>(chartDb);
+        }
+    }
+    auto lastError = [&]() {
+        return db ? db->getLastError() : store ? store->getLastError() : remote->getLastError();
+    };
+
+    // Connect (or recover the store) in the background while the window opens and the font loads
+    auto connectResult = std::async(std::launch::async, [db, store, remote]() {
+        auto start = std::chrono::steady_clock::now();
+        bool connected = db ? db->connect() : store ? store->open() : remote->connect();
+        return std::make_pair(connected, millisSince(start));
+    });
+    auto chartConnectResult = std::async(std::launch::async, [chartDb, chartRemote]() {
+        return chartDb ? chartDb->connect() : chartRemote ? chartRemote->connect() : true;
+    });
 
-    // Run GUI
     try {
-        bank::BankGUI gui(service);
-        gui.run();
+        std::unique_ptr<bank::BankGUI> gui;
+        if (replayPath.empty()) {
+            gui = std::make_unique<bank::BankGUI>(service);
+        }
+
+        auto waitStart = std::chrono::steady_clock::now();
+        auto [connected, connectMillis] = connectResult.get();
+        double waitMillis = millisSince(waitStart);
+
+        if (!connected && remote) {
+            std::cerr << "Error: Failed to connect to bank server!\n";
+            std::cerr << "Details: " << remote->getLastError() << "\n";
+            return 1;
+        }
+        if (!connected && store) {
+            std::cerr << "Error: Failed to open embedded store in " << dataDir << "!\n";
+            std::cerr << "Details: " << store->getLastError() << "\n";
+            return 1;
+        }
+        if (!connected) {
+            std::cerr << "Error: Failed to connect to database!\n";
+            std::cerr << "Details: " << db->getLastError() << "\n\n";
+            std::cerr << "Please ensure PostgreSQL is running and the database exists.\n";
+            std::cerr << "You can create the database and schema using:\n";
+            std::cerr << "  createdb " << name << "\n";
+            std::cerr << "  psql -d " << name << " -f sql/schema.sql\n";
+            return 1;
+        }
+
+        std::cout << (remote ? "Connected to bank server!\n" : 
+                      store ? "Embedded store recovered!\n" : "Database connected successfully!\n");
+
+        // Replays always run against the fixture so sessions see the same data
+        if (seedReplay || !replayPath.empty()) {
+            if (!bank::seedReplayFixture(*service)) {
+                std::cerr << "Error: Failed to seed replay fixture: " << lastError() << "\n";
+                return 1;
+            }
+        }
+
+        if (!replayPath.empty()) {
+            return runReplay(service, replayPath);
+        }
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << "Startup: window " << gui->getWindowMillis() << " ms, font "
+                  << gui->getFontMillis() << " ms, " << (remote ? "server" : store ? "store" : "database") 
+                  << " connect " << connectMillis << " ms (waited " << waitMillis << " ms), ready in "
+                  << millisSince(startupBegin) << " ms\n";
+
+        gui->setTraceFile(traceWriter.path);
+        if (chartService && chartConnectResult.get()) {
+            gui->setChartService(chartService);
+        }
+        if (!recordPath.empty() && !gui->startRecording(recordPath)) {
+            std::cerr << "Error: Could not open " << recordPath << " for recording\n";
+            return 1;
+        }
+        gui->run();
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << "\n";
         return 1;
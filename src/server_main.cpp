@@ -0,0 +1,390 @@
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "AccountCache.hpp"
+#include "BankServer.hpp"
+#include "ConnectionPool.hpp"
+#include "Database.hpp"
+#include "Logger.hpp"
+#include "Metrics.hpp"
+#include "MetricsExporter.hpp"
+#include "SlowQueryLog.hpp"
+#include "Trace.hpp"
+
+namespace {
+
+bank::BankServer* g_server = nullptr;
+
+void handleSignal(int) {
+    if (g_server != nullptr) {
+        g_server->stop();
+    }
+}
+
+void printUsage() {
+    std::cout << "Bank Management Server\n\n";
+    std::cout << "Database settings are read from DB_HOST, DB_PORT, DB_NAME, DB_USER and\n";
+    std::cout << "DB_PASSWORD, as for bank_management.\n";
+    std::cout << "\nUsage:\n";
+    std::cout << "  ./bank_server [options]\n";
+    std::cout << "      [--listen <host:port>]             TCP endpoint (default: 0.0.0.0:7878)\n";
+    std::cout << "      [--no-tcp]                         Only listen on the Unix socket\n";
+    std::cout << "      [--unix <path>]                    Also listen on a Unix socket\n";
+    std::cout << "      [--workers <n>]                    Request threads (default: 4)\n";
+    std::cout << "      [--db-connections <n>]             Pooled connections (default: workers)\n";
+    std::cout << "      [--account-cache <file>]           Cache accounts, persisted to <file> so\n";
+    std::cout << "                                         restarts begin warm\n";
+    std::cout << "      [--reconcile-interval <s>]         Seconds between cache refreshes (default: 5)\n";
+    std::cout << "      [--snapshot-interval <s>]          Seconds between cache snapshots (default: 300)\n";
+    std::cout << "      [--metrics-file <file>]            Write Prometheus metrics to <file>\n";
+    std::cout << "      [--metrics-port <port>]            Serve GET /metrics on 127.0.0.1:<port>\n";
+    std::cout << "      [--metrics-interval <s>]           Seconds between metrics file writes (default: 10)\n";
+    std::cout << "      [--slow-query-ms <ms>]             Log statements taking at least <ms> and\n";
+    std::cout << "                                         EXPLAIN the first of each shape\n";
+    std::cout << "      [--slow-query-log <file>]          Slow query log (default: stderr)\n";
+    std::cout << "      [--log-file <file>]                Audit log of every change and login as JSON\n";
+    std::cout << "                                         lines, rotated at 64 MB\n";
+    std::cout << "      [--log-level <level>]              debug, info, warn or error (default: info);\n";
+    std::cout << "                                         logs to stderr without --log-file\n";
+    std::cout << "      [--trace <file>]                   Record trace spans, written to <file> on exit\n";
+    std::cout << "  ./bank_server -h                   - Show this help\n";
+}
+
+double millisSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Background refresh and persistence of the account cache
+ *
+ * Uses its own connection, so it never waits for a pooled one.
+ */
+class CacheMaintainer {
+public:
+    CacheMaintainer(bank::AccountCache& cache, std::shared_ptr<bank::Database> db,
+                    int reconcileSeconds, int snapshotSeconds)
+        : m_cache(cache)
+        , m_store(db)
+        , m_reconcileSeconds(reconcileSeconds)
+        , m_snapshotSeconds(snapshotSeconds)
+    {
+    }
+
+    ~CacheMaintainer() {
+        stop();
+    }
+
+    /**
+     * @brief Catch up with the changes made since the snapshot was written
+     */
+    bool catchUp() {
+        auto changed = m_cache.reconcile(m_store);
+        if (!changed.has_value()) {
+            return false;
+        }
+        m_caughtUp = *changed;
+        return true;
+    }
+
+    std::size_t caughtUp() const { return m_caughtUp; }
+
+    void start() {
+        m_thread = std::thread([this]() { run(); });
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wake.notify_one();
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+    }
+
+private:
+    void run() {
+        auto lastSnapshot = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_wake.wait_for(lock, std::chrono::seconds(m_reconcileSeconds), [this] { return m_stopping; })) {
+            lock.unlock();
+            if (!m_cache.reconcile(m_store).has_value()) {
+                std::cerr << "Account cache: reconcile failed: " << m_cache.getLastError() << "\n";
+            }
+            if (std::chrono::steady_clock::now() - lastSnapshot >= std::chrono::seconds(m_snapshotSeconds)) {
+                if (!m_cache.writeSnapshot()) {
+                    std::cerr << "Account cache: " << m_cache.getLastError() << "\n";
+                }
+                lastSnapshot = std::chrono::steady_clock::now();
+            }
+            lock.lock();
+        }
+    }
+
+    bank::AccountCache& m_cache;
+    bank::PostgresLedgerStore m_store;
+    int m_reconcileSeconds;
+    int m_snapshotSeconds;
+    std::size_t m_caughtUp = 0;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stopping = false;
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    bank::ServerOptions options;
+    int dbConnections = 0;
+    std::string cachePath;
+    int reconcileSeconds = 5;
+    int snapshotSeconds = 300;
+    bank::MetricsExporterOptions metricsOptions;
+    std::string tracePath;
+    bank::SlowQueryOptions slowQueryOptions;
+    slowQueryOptions.thresholdMillis = 0.0;
+    bank::LoggerOptions logOptions;
+    bool logging = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            printUsage();
+            return 0;
+        } else if (arg == "--listen" && i + 1 < argc) {
+            std::string endpoint = argv[++i];
+            std::size_t colon = endpoint.rfind(':');
+            if (colon == std::string::npos || std::atoi(endpoint.c_str() + colon + 1) <= 0) {
+                std::cerr << "--listen expects <host:port>\n";
+                return 1;
+            }
+            options.host = endpoint.substr(0, colon);
+            options.port = std::atoi(endpoint.c_str() + colon + 1);
+        } else if (arg == "--no-tcp") {
+            options.host.clear();
+        } else if (arg == "--unix" && i + 1 < argc) {
+            options.unixPath = argv[++i];
+        } else if ((arg == "--workers" || arg == "--db-connections") && i + 1 < argc) {
+            int value = std::atoi(argv[++i]);
+            if (value < 1) {
+                std::cerr << arg << " must be a positive number\n";
+                return 1;
+            }
+            (arg == "--workers" ? options.workers : dbConnections) = value;
+        } else if (arg == "--account-cache" && i + 1 < argc) {
+            cachePath = argv[++i];
+        } else if ((arg == "--reconcile-interval" || arg == "--snapshot-interval") && i + 1 < argc) {
+            int value = std::atoi(argv[++i]);
+            if (value < 1) {
+                std::cerr << arg << " must be a positive number\n";
+                return 1;
+            }
+            (arg == "--reconcile-interval" ? reconcileSeconds : snapshotSeconds) = value;
+        } else if (arg == "--trace" && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else if (arg == "--slow-query-ms" && i + 1 < argc) {
+            slowQueryOptions.thresholdMillis = std::atof(argv[++i]);
+            if (slowQueryOptions.thresholdMillis <= 0) {
+                std::cerr << arg << " must be a positive number\n";
+                return 1;
+            }
+        } else if (arg == "--slow-query-log" && i + 1 < argc) {
+            slowQueryOptions.path = argv[++i];
+        } else if (arg == "--log-file" && i + 1 < argc) {
+            logOptions.path = argv[++i];
+            logging = true;
+        } else if (arg == "--log-level" && i + 1 < argc) {
+            auto level = bank::parseLogLevel(argv[++i]);
+            if (!level.has_value()) {
+                std::cerr << arg << " expects debug, info, warn, error or off\n";
+                return 1;
+            }
+            logOptions.level = *level;
+            logging = true;
+        } else if (arg == "--metrics-file" && i + 1 < argc) {
+            metricsOptions.path = argv[++i];
+        } else if ((arg == "--metrics-port" || arg == "--metrics-interval") && i + 1 < argc) {
+            int value = std::atoi(argv[++i]);
+            if (value < 1) {
+                std::cerr << arg << " must be a positive number\n";
+                return 1;
+            }
+            if (arg == "--metrics-port") {
+                metricsOptions.port = value;
+            } else {
+                metricsOptions.interval = std::chrono::seconds(value);
+            }
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n\n";
+            printUsage();
+            return 1;
+        }
+    }
+    if (dbConnections == 0) {
+        dbConnections = options.workers;
+    }
+    if (!tracePath.empty()) {
+        bank::trace::start();
+    }
+
+    const char* dbHost = std::getenv("DB_HOST");
+    const char* dbPort = std::getenv("DB_PORT");
+    const char* dbName = std::getenv("DB_NAME");
+    const char* dbUser = std::getenv("DB_USER");
+    const char* dbPassword = std::getenv("DB_PASSWORD");
+
+    std::string host = dbHost ? dbHost : "localhost";
+    std::string port = dbPort ? dbPort : "5432";
+    std::string name = dbName ? dbName : "bank_management";
+    std::string user = dbUser ? dbUser : "postgres";
+    std::string password = dbPassword ? dbPassword : "";
+
+    std::cout << "Opening " << dbConnections << " connections to database " << name 
+              << " at " << host << ":" << port << "...\n";
+
+    auto openDatabase = [&]() {
+        return std::make_shared<bank::Database>(host, port, name, user, password);
+    };
+
+    // EXPLAIN runs on a side connection of the log's own, which must not report to it
+    std::shared_ptr<bank::SlowQueryLog> slowQueries;
+    if (!slowQueryOptions.path.empty() && slowQueryOptions.thresholdMillis <= 0) {
+        std::cerr << "--slow-query-log needs --slow-query-ms\n";
+        return 1;
+    }
+    if (slowQueryOptions.thresholdMillis > 0) {
+        slowQueries = std::make_shared<bank::SlowQueryLog>(slowQueryOptions, openDatabase);
+        if (!slowQueries->open()) {
+            std::cerr << "Error: " << slowQueries->getLastError() << "\n";
+            return 1;
+        }
+    }
+
+    auto connect = [&]() {
+        auto db = openDatabase();
+        db->setSlowQueryLog(slowQueries);
+        return db;
+    };
+
+    // Map the last snapshot and catch up with what changed while we were down
+    std::shared_ptr<bank::AccountCache> cache;
+    std::unique_ptr<CacheMaintainer> maintainer;
+    if (!cachePath.empty()) {
+        auto start = std::chrono::steady_clock::now();
+        cache = std::make_shared<bank::AccountCache>(cachePath);
+        bool mapped = cache->load();
+        double mapMillis = millisSince(start);
+
+        auto db = connect();
+        if (!db->connect()) {
+            std::cerr << "Error: " << db->getLastError() << "\n";
+            return 1;
+        }
+        maintainer = std::make_unique<CacheMaintainer>(*cache, db, reconcileSeconds, snapshotSeconds);
+        start = std::chrono::steady_clock::now();
+        if (!maintainer->catchUp()) {
+            std::cerr << "Error: " << cache->getLastError() << "\n";
+            return 1;
+        }
+        std::cout << "Account cache: " << (mapped ? "mapped " + std::to_string(cache->getStats().snapshotAccounts) + 
+                                                    " accounts" : "no snapshot, starting cold")
+                  << " in " << mapMillis << " ms, " << maintainer->caughtUp() << " changes applied in " 
+                  << millisSince(start) << " ms\n";
+    }
+
+    // Statements and calls are only timed into the registry when something exports it
+    std::shared_ptr<bank::MetricsRegistry> metrics;
+    std::unique_ptr<bank::MetricsExporter> exporter;
+    if (!metricsOptions.path.empty() || metricsOptions.port > 0) {
+        metrics = std::make_shared<bank::MetricsRegistry>();
+        exporter = std::make_unique<bank::MetricsExporter>(metrics, metricsOptions);
+    }
+
+    std::shared_ptr<bank::Logger> logger;
+    if (logging) {
+        logger = std::make_shared<bank::Logger>(logOptions);
+        if (!logger->open()) {
+            std::cerr << "Error: " << logger->getLastError() << "\n";
+            return 1;
+        }
+    }
+
+    bank::ConnectionPool pool(connect, static_cast<std::size_t>(dbConnections), cache, metrics, logger);
+    if (!pool.open()) {
+        std::cerr << "Error: " << pool.getLastError() << "\n";
+        return 1;
+    }
+
+    bank::BankServer server(pool, options);
+    if (!server.start()) {
+        std::cerr << "Error: " << server.getLastError() << "\n";
+        return 1;
+    }
+
+    g_server = &server;
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    if (!options.host.empty()) {
+        std::cout << "Listening on " << options.host << ":" << options.port << "\n";
+    }
+    if (!options.unixPath.empty()) {
+        std::cout << "Listening on " << options.unixPath << "\n";
+    }
+    std::cout << options.workers << " workers, " << dbConnections << " database connections\n";
+
+    if (exporter) {
+        if (!exporter->start()) {
+            std::cerr << "Error: " << exporter->getLastError() << "\n";
+            return 1;
+        }
+        if (metricsOptions.port > 0) {
+            std::cout << "Metrics on http://" << metricsOptions.host << ":" << metricsOptions.port << "/metrics\n";
+        }
+    }
+
+    if (maintainer) {
+        maintainer->start();
+    }
+    server.run();
+    g_server = nullptr;
+
+    if (exporter) {
+        exporter->stop();
+    }
+    if (!tracePath.empty()) {
+        bank::trace::stop();
+        if (!bank::trace::writeChromeTrace(tracePath)) {
+            std::cerr << "Error: Could not write " << tracePath << "\n";
+        }
+    }
+
+    if (maintainer) {
+        maintainer->stop();
+        auto stats = cache->getStats();
+        if (!cache->writeSnapshot()) {
+            std::cerr << "Error: " << cache->getLastError() << "\n";
+        }
+        std::cout << "Account cache: " << stats.hits << " hits, " << stats.misses << " misses\n";
+    }
+
+    if (logger && logger->getDropped() > 0) {
+        std::cerr << "Log: " << logger->getDropped() << " records dropped, the queue was full\n";
+    }
+
+    if (!server.getLastError().empty()) {
+        std::cerr << "Error: " << server.getLastError() << "\n";
+        return 1;
+    }
+    std::cout << "Server stopped\n";
+    return 0;
+}
@@ -0,0 +1,110 @@
+// Account cache reads that race with writes must not cache what they saw before the write
+#include <cstdio>
+#include <memory>
+#include "AccountCache.hpp"
+#include "CachingLedgerStore.hpp"
+#include "MemoryLedgerStore.hpp"
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            ++failures; \
+        } \
+    } while (0)
+
+/**
+ * @brief Store whose next account read is overtaken by a write from another caller
+ *
+ * The read returns the account as it was before the write, like a database
+ * read whose row was updated (and its cache entry invalidated) before the
+ * reader got around to caching it.
+ */
+class RacingStore : public bank::MemoryLedgerStore {
+public:
+    std::shared_ptr<bank::LedgerStore> writer;
+    bool raceNextRead = false;
+
+    std::optional<bank::Account> findAccountById(int accountId) override {
+        auto account = MemoryLedgerStore::findAccountById(accountId);
+        race(accountId);
+        return account;
+    }
+
+    std::optional<bank::Account> findAccountByNumber(const std::string& accountNumber) override {
+        auto account = MemoryLedgerStore::findAccountByNumber(accountNumber);
+        if (account.has_value()) {
+            race(account->getAccountId());
+        }
+        return account;
+    }
+
+private:
+    void race(int accountId) {
+        if (raceNextRead) {
+            raceNextRead = false;
+            writer->adjustBalance(accountId, 50.0);
+        }
+    }
+};
+
+void testTicketRejectsPutAfterInvalidate() {
+    bank::AccountCache cache("/nonexistent/account_cache_test.snapshot");
+    bank::Account stale(7, 1, "ACC0000007", bank::AccountType::Checking, 100.0, 0.0, 
+                        bank::AccountStatus::Active);
+
+    std::uint64_t ticket = cache.readTicket();
+    cache.invalidate(7);
+    CHECK(!cache.put(stale, ticket));
+    CHECK(!cache.findById(7).has_value());
+    CHECK(!cache.findByNumber("ACC0000007").has_value());
+
+    // A read that started after the invalidation is cached
+    CHECK(cache.put(stale, cache.readTicket()));
+    CHECK(cache.findById(7).has_value());
+}
+
+void testMissInvalidatePut() {
+    auto store = std::make_shared<RacingStore>();
+    auto cache = std::make_shared<bank::AccountCache>("/nonexistent/account_cache_test.snapshot");
+    bank::CachingLedgerStore reader(store, cache);
+    store->writer = std::make_shared<bank::CachingLedgerStore>(store, cache);
+
+    int userId = store->insertUser(bank::User(0, "cache", "", "Cache Test", "cache@example.org", "")).value_or(0);
+    int accountId = store->insertAccount(bank::Account(0, userId, "ACC0000001", bank::AccountType::Checking, 
+                                                       100.0, 0.0, bank::AccountStatus::Active)).value_or(0);
+
+    // Miss, the writer updates and invalidates, then the reader puts its stale copy
+    store->raceNextRead = true;
+    auto first = reader.findAccountById(accountId);
+    CHECK(first.has_value() && first->getBalance() == 100.0);
+    auto cached = cache->findById(accountId);
+    CHECK(!cached.has_value());
+    auto second = reader.findAccountById(accountId);
+    CHECK(second.has_value() && second->getBalance() == 150.0);
+
+    // The same through a lookup by number, which learns the id only from the read
+    cache->invalidate(accountId);
+    store->raceNextRead = true;
+    auto byNumber = reader.findAccountByNumber("ACC0000001");
+    CHECK(byNumber.has_value() && byNumber->getBalance() == 150.0);
+    cached = cache->findById(accountId);
+    CHECK(!cached.has_value());
+    byNumber = reader.findAccountByNumber("ACC0000001");
+    CHECK(byNumber.has_value() && byNumber->getBalance() == 200.0);
+}
+
+} // namespace
+
+int main() {
+    testTicketRejectsPutAfterInvalidate();
+    testMissInvalidatePut();
+    if (failures == 0) {
+        std::printf("account_cache_test: ok\n");
+    }
+    return failures == 0 ? 0 : 1;
+}
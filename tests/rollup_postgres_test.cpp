@@ -0,0 +1,121 @@
+// Rollup closing balances when transactions commit out of created_at order
+//
+// Needs a throwaway database with sql/schema.sql loaded, named by
+// BANK_TEST_DB_NAME (DB_HOST, DB_PORT, DB_USER and DB_PASSWORD as for
+// bank_bench). Skipped when it is not set.
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include "Database.hpp"
+#include "PostgresLedgerStore.hpp"
+#include "Timestamp.hpp"
+
+namespace {
+
+constexpr int kSkipped = 77;
+
+int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            ++failures; \
+        } \
+    } while (0)
+
+std::string env(const char* name, const char* fallback) {
+    const char* value = std::getenv(name);
+    return value ? value : fallback;
+}
+
+std::shared_ptr<bank::Database> connect(const std::string& name) {
+    auto db = std::make_shared<bank::Database>(env("DB_HOST", "localhost"), env("DB_PORT", "5432"), name,
+                                               env("DB_USER", "postgres"), env("DB_PASSWORD", ""));
+    if (!db->connect()) {
+        std::fprintf(stderr, "Could not connect to %s: %s\n", name.c_str(), db->getLastError().c_str());
+        return nullptr;
+    }
+    return db;
+}
+
+/**
+ * @brief closing_balance and transaction_count of one rollup bucket, or -1 if it is missing
+ */
+std::pair<double, int> bucket(bank::Database& db, const std::string& accountId, const char* unit,
+                              const char* start)
+{
+    auto rows = db.queryParams("SELECT closing_balance, transaction_count FROM account_rollups "
+                               "WHERE account_id = $1 AND time_unit = $2 AND bucket_start = $3",
+                               {accountId, unit, start});
+    if (rows.size() != 1 || rows[0].size() != 2) {
+        return {-1.0, -1};
+    }
+    return {std::stod(rows[0][0]), std::stoi(rows[0][1])};
+}
+
+// The earlier transaction (10:59:59) commits after the later one (11:00:01).
+// Day and month must keep the later balance; each hour has its own.
+void testOverlappingTransactionsAcrossHours(const std::string& name) {
+    auto first = connect(name);
+    auto second = connect(name);
+    if (!first || !second) {
+        ++failures;
+        return;
+    }
+
+    std::string suffix = std::to_string(getpid()) + "_" + std::to_string(std::time(nullptr));
+    auto user = second->queryParams("INSERT INTO users (username, password_hash, full_name, email) "
+                                    "VALUES ($1, '', 'Rollup Test', $2) RETURNING user_id",
+                                    {"rollup_" + suffix, "rollup_" + suffix + "@example.org"});
+    auto account = second->queryParams("INSERT INTO accounts (user_id, account_number, account_type) "
+                                       "VALUES ($1, $2, 'checking') RETURNING account_id",
+                                       {user.at(0).at(0), ("RT" + suffix).substr(0, 20)});
+    std::string userId = user.at(0).at(0);
+    std::string accountId = account.at(0).at(0);
+
+    const char* insert = "INSERT INTO transactions (account_id, transaction_type, amount, balance_after, created_at) "
+                         "VALUES ($1, 'deposit', $2, $3, $4)";
+    CHECK(first->beginTransaction());
+    CHECK(second->executeParams(insert, {accountId, "50", "150", "2030-01-15 11:00:01"}));
+    CHECK(first->executeParams(insert, {accountId, "100", "100", "2030-01-15 10:59:59"}));
+    CHECK(first->commitTransaction());
+
+    CHECK(bucket(*second, accountId, "hour", "2030-01-15 10:00:00") == std::make_pair(100.0, 1));
+    CHECK(bucket(*second, accountId, "hour", "2030-01-15 11:00:00") == std::make_pair(150.0, 1));
+    CHECK(bucket(*second, accountId, "day", "2030-01-15 00:00:00") == std::make_pair(150.0, 2));
+    CHECK(bucket(*second, accountId, "month", "2030-01-01 00:00:00") == std::make_pair(150.0, 2));
+
+    // A summary stitched from the transactions before 11:00 and the hour rollups after agrees
+    bank::PostgresLedgerStore store(second);
+    auto from = bank::Timestamp::parse("2030-01-15 10:30:00");
+    auto to = bank::Timestamp::parse("2030-01-16 00:00:00");
+    CHECK(from.has_value() && to.has_value());
+    if (from && to) {
+        auto summary = store.summarizeActivity(std::stoi(accountId), bank::RangeCover::of({*from, *to}));
+        CHECK(summary.count == 2);
+        CHECK(summary.credits == 150.0);
+        CHECK(summary.closingBalance == 150.0);
+    }
+
+    second->executeParams("DELETE FROM users WHERE user_id = $1", {userId});
+}
+
+} // namespace
+
+int main() {
+    const char* name = std::getenv("BANK_TEST_DB_NAME");
+    if (name == nullptr) {
+        std::printf("rollup_postgres_test: skipped, BANK_TEST_DB_NAME is not set\n");
+        return kSkipped;
+    }
+
+    testOverlappingTransactionsAcrossHours(name);
+    if (failures == 0) {
+        std::printf("rollup_postgres_test: ok\n");
+    }
+    return failures == 0 ? 0 : 1;
+}
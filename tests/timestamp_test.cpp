@@ -0,0 +1,111 @@
+// Local timestamp text must round-trip through zones with DST, and parse must reject impossible dates
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include "Timestamp.hpp"
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            ++failures; \
+        } \
+    } while (0)
+
+constexpr std::int64_t kSecondsPerDay = 86400;
+
+/**
+ * @brief Local time minus UTC at a UTC instant, straight from the C library
+ */
+std::int64_t offsetAt(std::int64_t utcSeconds) {
+    std::time_t time = static_cast<std::time_t>(utcSeconds);
+    std::tm local{};
+    localtime_r(&time, &local);
+    return local.tm_gmtoff;
+}
+
+/**
+ * @brief The earliest instant showing the same wall-clock time as utcSeconds
+ *
+ * Differs from utcSeconds only in the second pass of a repeated hour.
+ */
+std::int64_t earliestWithSameWallTime(std::int64_t utcSeconds) {
+    std::int64_t wall = utcSeconds + offsetAt(utcSeconds);
+    std::int64_t earliest = utcSeconds;
+    for (std::int64_t probe : {utcSeconds - kSecondsPerDay, utcSeconds + kSecondsPerDay}) {
+        std::int64_t offset = offsetAt(probe);
+        std::int64_t candidate = wall - offset;
+        if (candidate < earliest && offsetAt(candidate) == offset) {
+            earliest = candidate;
+        }
+    }
+    return earliest;
+}
+
+void checkRoundTrip(std::int64_t utcSeconds, std::int64_t micros, int& mismatches) {
+    auto timestamp = bank::Timestamp::fromMicros(utcSeconds * 1000000 + micros);
+    auto parsed = bank::Timestamp::parse(timestamp.toString());
+    std::int64_t expected = earliestWithSameWallTime(utcSeconds) * 1000000 + micros;
+    if (!parsed.has_value() || parsed->micros() != expected) {
+        if (mismatches++ < 5) {
+            std::fprintf(stderr, "%s: %s read back as %lld, expected %lld\n", std::getenv("TZ"),
+                         timestamp.toString().c_str(),
+                         parsed.has_value() ? static_cast<long long>(parsed->micros()) : -1LL,
+                         static_cast<long long>(expected));
+        }
+    }
+}
+
+void testZone(const char* zone) {
+    std::string file = std::string("/usr/share/zoneinfo/") + zone;
+    if (access(file.c_str(), R_OK) != 0) {
+        std::fprintf(stderr, "skipping %s: no zoneinfo\n", zone);
+        return;
+    }
+    setenv("TZ", zone, 1);
+    tzset();
+
+    int mismatches = 0;
+    // Random instants from 1970 to 2100
+    std::mt19937_64 random(42);
+    std::uniform_int_distribution<std::int64_t> seconds(0, 4102444800LL);
+    std::uniform_int_distribution<std::int64_t> micros(0, 999999);
+    for (int i = 0; i < 200000; ++i) {
+        checkRoundTrip(seconds(random), micros(random), mismatches);
+    }
+    // Every 37 seconds through 2024, crossing each change of offset closely
+    for (std::int64_t t = 1704067200; t < 1735689600; t += 37) {
+        checkRoundTrip(t, 0, mismatches);
+    }
+    CHECK(mismatches == 0);
+}
+
+void testParseRejectsDaysPastMonthEnd() {
+    CHECK(bank::Timestamp::parse("2024-02-29").has_value());
+    CHECK(bank::Timestamp::parse("2000-02-29 12:00:00").has_value());
+    CHECK(bank::Timestamp::parse("2024-04-30").has_value());
+    CHECK(!bank::Timestamp::parse("2024-02-30").has_value());
+    CHECK(!bank::Timestamp::parse("2023-02-29").has_value());
+    CHECK(!bank::Timestamp::parse("1900-02-29").has_value());
+    CHECK(!bank::Timestamp::parse("2024-04-31 08:00").has_value());
+}
+
+} // namespace
+
+int main() {
+    testParseRejectsDaysPastMonthEnd();
+    testZone("Australia/Lord_Howe");
+    testZone("America/New_York");
+    if (failures == 0) {
+        std::printf("timestamp_test: ok\n");
+    }
+    return failures == 0 ? 0 : 1;
+}